@@ -0,0 +1,740 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lv2c/JsonBufferReader.hpp"
+#include "Utf8Utils.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace lv2c;
+
+static constexpr uint16_t UTF16_SURROGATE_1_BASE = 0xD800U;
+static constexpr uint16_t UTF16_SURROGATE_2_BASE = 0xDC00U;
+static constexpr uint16_t UTF16_SURROGATE_MASK = 0x3FFU;
+
+static inline bool is_whitespace(char c)
+{
+    return c == 0x20 || c == 0x0A || c == 0x0D || c == 0x09;
+}
+
+json_buffer_reader::json_buffer_reader(std::string_view text)
+    : start(text.data()), p(text.data()), end(text.data() + text.length())
+{
+}
+
+void json_buffer_reader::throw_format_error(const std::string &message)
+{
+    std::stringstream s;
+    s << "Invalid file format. " << message << " (offset " << (p - start) << ")";
+    throw json_exception(s.str());
+}
+
+void json_buffer_reader::skip_whitespace()
+{
+    while (p != end)
+    {
+        char c = *p;
+        if (is_whitespace(c))
+        {
+            ++p;
+        }
+        else if (c == '/')
+        {
+            ++p;
+            if (p != end && *p == '/')
+            {
+                // skip to end of line.
+                while (p != end && *p != '\r' && *p != '\n')
+                {
+                    ++p;
+                }
+            }
+            else if (p != end && *p == '*')
+            {
+                ++p;
+                int level = 1;
+                while (true)
+                {
+                    if (end - p < 2)
+                    {
+                        p = end;
+                        throw_format_error("Unexpected end of file");
+                    }
+                    if (p[0] == '*' && p[1] == '/')
+                    {
+                        p += 2;
+                        if (--level == 0)
+                        {
+                            break;
+                        }
+                    }
+                    else if (p[0] == '/' && p[1] == '*')
+                    {
+                        p += 2;
+                        ++level;
+                    }
+                    else
+                    {
+                        ++p;
+                    }
+                }
+            }
+            else
+            {
+                throw_format_error("Unexpected character: '/'");
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+void json_buffer_reader::consume_token(const char *token, const char *errorMessage)
+{
+    size_t length = strlen(token);
+    if ((size_t)(end - p) < length || memcmp(p, token, length) != 0)
+    {
+        throw_format_error(errorMessage);
+    }
+    p += length;
+}
+
+uint16_t json_buffer_reader::read_hex4()
+{
+    if (end - p < 4)
+    {
+        throw_format_error("Unexpected end of file");
+    }
+    uint16_t result = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        char c = *p++;
+        uint16_t digit;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (c >= 'A' && c <= 'F')
+            digit = c - 'A' + 10;
+        else if (c >= 'a' && c <= 'f')
+            digit = c - 'a' + 10;
+        else
+            throw_format_error("Invalid \\u escape character");
+        result = result * 16 + digit;
+    }
+    return result;
+}
+
+void json_buffer_reader::read_u_escape(std::string &output)
+{
+    // p is positioned after "\u".
+    char16_t units[2];
+    units[0] = (char16_t)read_hex4();
+    size_t length = 1;
+    if (units[0] >= UTF16_SURROGATE_1_BASE && units[0] <= UTF16_SURROGATE_1_BASE + UTF16_SURROGATE_MASK)
+    {
+        // MUST be a UTF16_SURROGATE 2 to be legal.
+        if (end - p < 2 || p[0] != '\\' || p[1] != 'u')
+        {
+            throw_format_error("Invalid UTF16 surrogate pair");
+        }
+        p += 2;
+        units[1] = (char16_t)read_hex4();
+        if (units[1] < UTF16_SURROGATE_2_BASE || units[1] > UTF16_SURROGATE_2_BASE + UTF16_SURROGATE_MASK)
+        {
+            throw_format_error("Invalid UTF16 surrogate pair");
+        }
+        length = 2;
+    }
+    output.append(Utf16ToUtf8(std::u16string_view(units, length)));
+}
+
+std::string_view json_buffer_reader::read_string()
+{
+    char quote = *p++;
+
+    // Fast path: no escapes, so return a view into the buffer.
+    const char *stringStart = p;
+    while (p != end && *p != quote && *p != '\\')
+    {
+        ++p;
+    }
+    if (p == end)
+    {
+        throw_format_error("Unexpected end of file");
+    }
+    if (*p == quote && (p + 1 == end || p[1] != quote))
+    {
+        return std::string_view(stringStart, (size_t)(p++ - stringStart));
+    }
+
+    scratch.assign(stringStart, p);
+    while (true)
+    {
+        if (p == end)
+        {
+            throw_format_error("Unexpected end of file");
+        }
+        char c = *p++;
+        if (c == quote)
+        {
+            if (p != end && *p == quote) //  "" -> "
+            {
+                ++p;
+                scratch.push_back(c);
+                continue;
+            }
+            break;
+        }
+        if (c != '\\')
+        {
+            scratch.push_back(c);
+            continue;
+        }
+        if (p == end)
+        {
+            throw_format_error("Unexpected end of file");
+        }
+        c = *p++;
+        switch (c)
+        {
+        case 'r':
+            scratch.push_back('\r');
+            break;
+        case 'b':
+            scratch.push_back('\b');
+            break;
+        case 'f':
+            scratch.push_back('\f');
+            break;
+        case 'n':
+            scratch.push_back('\n');
+            break;
+        case 't':
+            scratch.push_back('\t');
+            break;
+        case 'u':
+            read_u_escape(scratch);
+            break;
+        default:
+            scratch.push_back(c);
+            break;
+        }
+    }
+    return std::string_view(scratch);
+}
+
+double json_buffer_reader::read_number()
+{
+    if (allowNaN_ && *p == 'N')
+    {
+        consume_token("NaN", "Expecting a number.");
+        return std::nan("");
+    }
+    const char *numberStart = p;
+    if (*p == '+')
+    {
+        ++p;
+    }
+    // from_chars also accepts "nan" and "inf", which json_reader doesn't.
+    const char *digits = (p != end && *p == '-') ? p + 1 : p;
+    if (digits == end || !((*digits >= '0' && *digits <= '9') || *digits == '.'))
+    {
+        p = numberStart;
+        throw_format_error("Expecting a value.");
+    }
+    double value;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc())
+    {
+        p = numberStart;
+        throw_format_error("Expecting a value.");
+    }
+    p = result.ptr;
+    return value;
+}
+
+void json_buffer_reader::parse_value(json_sax_handler &handler, size_t depth)
+{
+    if (depth > MAX_DEPTH)
+    {
+        throw_format_error("Nesting too deep.");
+    }
+    skip_whitespace();
+    if (p == end)
+    {
+        throw_format_error("Unexpected end of file");
+    }
+    switch (*p)
+    {
+    case '[':
+        ++p;
+        handler.start_array();
+        skip_whitespace();
+        if (p != end && *p == ']')
+        {
+            ++p;
+        }
+        else
+        {
+            while (true)
+            {
+                parse_value(handler, depth + 1);
+                skip_whitespace();
+                if (p == end)
+                {
+                    throw_format_error("Unexpected end of file");
+                }
+                char c = *p++;
+                if (c == ']')
+                {
+                    break;
+                }
+                if (c != ',')
+                {
+                    --p;
+                    throw_format_error("Expecting ']'");
+                }
+            }
+        }
+        handler.end_array();
+        break;
+    case '{':
+        ++p;
+        handler.start_object();
+        skip_whitespace();
+        if (p != end && *p == '}')
+        {
+            ++p;
+        }
+        else
+        {
+            while (true)
+            {
+                skip_whitespace();
+                if (p == end || (*p != '"' && *p != '\''))
+                {
+                    throw_format_error("Expecting a key.");
+                }
+                handler.key(read_string());
+                skip_whitespace();
+                if (p == end || *p != ':')
+                {
+                    throw_format_error("Expecting ':'");
+                }
+                ++p;
+                parse_value(handler, depth + 1);
+                skip_whitespace();
+                if (p == end)
+                {
+                    throw_format_error("Unexpected end of file");
+                }
+                char c = *p++;
+                if (c == '}')
+                {
+                    break;
+                }
+                if (c != ',')
+                {
+                    --p;
+                    throw_format_error("Expecting '}'");
+                }
+            }
+        }
+        handler.end_object();
+        break;
+    case '"':
+    case '\'':
+        handler.string_value(read_string());
+        break;
+    case 'n':
+        consume_token("null", "Expecting a value.");
+        handler.null_value();
+        break;
+    case 't':
+        consume_token("true", "Expecting a value.");
+        handler.bool_value(true);
+        break;
+    case 'f':
+        consume_token("false", "Expecting a value.");
+        handler.bool_value(false);
+        break;
+    default:
+        handler.number_value(read_number());
+        break;
+    }
+}
+
+void json_buffer_reader::parse(json_sax_handler &handler)
+{
+    parse_value(handler, 0);
+    skip_whitespace();
+    if (p != end)
+    {
+        throw_format_error("Unexpected characters after value.");
+    }
+}
+
+namespace
+{
+    // Builds json_variants directly from parse events.
+    class json_variant_builder : public json_sax_handler
+    {
+    public:
+        json_variant result;
+
+        void null_value() override { add(json_variant()); }
+        void bool_value(bool value) override { add(json_variant(value)); }
+        void number_value(double value) override { add(json_variant(value)); }
+        void string_value(std::string_view value) override { add(json_variant(std::string(value))); }
+        void start_array() override
+        {
+            stack.push_back(json_variant::make_array());
+        }
+        void end_array() override
+        {
+            json_variant value = std::move(stack.back());
+            stack.pop_back();
+            add(std::move(value));
+        }
+        void start_object() override
+        {
+            stack.push_back(json_variant::make_object());
+        }
+        void key(std::string_view key) override
+        {
+            keys.push_back(std::string(key));
+        }
+        void end_object() override
+        {
+            end_array();
+        }
+
+    private:
+        void add(json_variant &&value)
+        {
+            if (stack.empty())
+            {
+                result = std::move(value);
+            }
+            else if (stack.back().is_array())
+            {
+                stack.back().as_array()->push_back(std::move(value));
+            }
+            else
+            {
+                (*stack.back().as_object())[keys.back()] = std::move(value);
+                keys.pop_back();
+            }
+        }
+        std::vector<json_variant> stack;
+        std::vector<std::string> keys;
+    };
+}
+
+void json_buffer_reader::read(json_variant *value)
+{
+    json_variant_builder builder;
+    parse(builder);
+    *value = std::move(builder.result);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void json_value::require_type(ContentType contentType) const
+{
+    if (this->content_type != contentType)
+    {
+        throw std::runtime_error("Content type is not valid.");
+    }
+}
+
+bool json_value::as_bool() const
+{
+    require_type(ContentType::Bool);
+    return bool_value;
+}
+
+double json_value::as_number() const
+{
+    require_type(ContentType::Number);
+    return double_value;
+}
+
+std::string_view json_value::as_string() const
+{
+    require_type(ContentType::String);
+    return std::string_view(string_value.data, string_value.length);
+}
+
+size_t json_value::size() const
+{
+    if (content_type != ContentType::Object)
+    {
+        require_type(ContentType::Array);
+    }
+    return container_value.count;
+}
+
+const json_value *json_value::array_begin() const
+{
+    require_type(ContentType::Array);
+    return (const json_value *)container_value.items;
+}
+const json_value *json_value::array_end() const
+{
+    return array_begin() + container_value.count;
+}
+
+const json_member *json_value::object_begin() const
+{
+    require_type(ContentType::Object);
+    return (const json_member *)container_value.items;
+}
+const json_member *json_value::object_end() const
+{
+    return object_begin() + container_value.count;
+}
+
+const json_value &json_value::operator[](size_t index) const
+{
+    if (index >= size())
+    {
+        throw std::out_of_range("index out of range.");
+    }
+    return array_begin()[index];
+}
+
+const json_value *json_value::find(std::string_view key) const
+{
+    // Search backwards: as with json_object, the last duplicate key wins.
+    const json_member *begin = object_begin();
+    for (const json_member *member = object_end(); member != begin; )
+    {
+        --member;
+        if (member->key == key)
+        {
+            return &member->value;
+        }
+    }
+    return nullptr;
+}
+
+json_variant json_value::to_variant() const
+{
+    switch (content_type)
+    {
+    case ContentType::Null:
+    default:
+        return json_variant();
+    case ContentType::Bool:
+        return json_variant(bool_value);
+    case ContentType::Number:
+        return json_variant(double_value);
+    case ContentType::String:
+        return json_variant(std::string(as_string()));
+    case ContentType::Array:
+    {
+        auto array = std::make_shared<json_array>();
+        for (const json_value *item = array_begin(); item != array_end(); ++item)
+        {
+            array->push_back(item->to_variant());
+        }
+        return json_variant(std::move(array));
+    }
+    case ContentType::Object:
+    {
+        auto object = std::make_shared<json_object>();
+        for (const json_member *member = object_begin(); member != object_end(); ++member)
+        {
+            (*object)[std::string(member->key)] = member->value.to_variant();
+        }
+        return json_variant(std::move(object));
+    }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+static constexpr size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+json_document::json_document(std::string &&text)
+    : text(std::move(text))
+{
+}
+
+void *json_document::allocate(size_t size)
+{
+    constexpr size_t ALIGNMENT = alignof(std::max_align_t);
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (size > blockRemaining)
+    {
+        size_t blockSize = std::max(size, ARENA_BLOCK_SIZE);
+        blocks.push_back(std::unique_ptr<char[]>(new char[blockSize]));
+        blockPosition = blocks.back().get();
+        blockRemaining = blockSize;
+        arenaBytes += blockSize;
+    }
+    void *result = blockPosition;
+    blockPosition += size;
+    blockRemaining -= size;
+    return result;
+}
+
+// Collects values on a flat stack. When a container closes, its children are
+// copied into a single contiguous arena allocation.
+class json_document::builder : public json_sax_handler
+{
+public:
+    builder(json_document *document) : document(document) {}
+
+    void null_value() override
+    {
+        values.emplace_back();
+    }
+    void bool_value(bool value) override
+    {
+        json_value &v = values.emplace_back();
+        v.content_type = json_value::ContentType::Bool;
+        v.bool_value = value;
+    }
+    void number_value(double value) override
+    {
+        json_value &v = values.emplace_back();
+        v.content_type = json_value::ContentType::Number;
+        v.double_value = value;
+    }
+    void string_value(std::string_view value) override
+    {
+        std::string_view stored = store(value);
+        json_value &v = values.emplace_back();
+        v.content_type = json_value::ContentType::String;
+        v.string_value.data = stored.data();
+        v.string_value.length = stored.length();
+    }
+    void start_array() override
+    {
+        containers.push_back(Container{values.size(), keys.size()});
+    }
+    void end_array() override
+    {
+        Container container = containers.back();
+        containers.pop_back();
+        size_t count = values.size() - container.valueStart;
+        json_value *items = nullptr;
+        if (count != 0)
+        {
+            items = (json_value *)document->allocate(count * sizeof(json_value));
+            std::copy(values.begin() + container.valueStart, values.end(), items);
+        }
+        values.resize(container.valueStart);
+        json_value &v = values.emplace_back();
+        v.content_type = json_value::ContentType::Array;
+        v.container_value.items = items;
+        v.container_value.count = count;
+    }
+    void start_object() override
+    {
+        containers.push_back(Container{values.size(), keys.size()});
+    }
+    void key(std::string_view key) override
+    {
+        keys.push_back(store(key));
+    }
+    void end_object() override
+    {
+        Container container = containers.back();
+        containers.pop_back();
+        size_t count = values.size() - container.valueStart;
+        json_member *members = nullptr;
+        if (count != 0)
+        {
+            members = (json_member *)document->allocate(count * sizeof(json_member));
+            for (size_t i = 0; i < count; ++i)
+            {
+                new (members + i) json_member{keys[container.keyStart + i], values[container.valueStart + i]};
+            }
+        }
+        values.resize(container.valueStart);
+        keys.resize(container.keyStart);
+        json_value &v = values.emplace_back();
+        v.content_type = json_value::ContentType::Object;
+        v.container_value.items = members;
+        v.container_value.count = count;
+    }
+
+    json_value result() const { return values.back(); }
+
+private:
+    // Strings that are views into the source text are kept as-is. Decoded strings
+    // (which live in the reader's scratch buffer) are copied into the arena.
+    std::string_view store(std::string_view value)
+    {
+        const char *textBegin = document->text.data();
+        const char *textEnd = textBegin + document->text.length();
+        if (value.data() >= textBegin && value.data() + value.length() <= textEnd)
+        {
+            return value;
+        }
+        char *copy = (char *)document->allocate(value.length());
+        memcpy(copy, value.data(), value.length());
+        return std::string_view(copy, value.length());
+    }
+
+    struct Container
+    {
+        size_t valueStart;
+        size_t keyStart;
+    };
+    json_document *document;
+    std::vector<json_value> values;
+    std::vector<std::string_view> keys;
+    std::vector<Container> containers;
+};
+
+json_document::ptr json_document::parse(std::string text, bool allowNaN)
+{
+    ptr document = ptr(new json_document(std::move(text)));
+    json_buffer_reader reader(document->text);
+    reader.allowNaN(allowNaN);
+    builder builder(document.get());
+    reader.parse(builder);
+    document->root_ = builder.result();
+    return document;
+}
+
+json_document::ptr json_document::load(const std::string &filename, bool allowNaN)
+{
+    std::ifstream f(filename, std::ios_base::binary);
+    if (!f.is_open())
+    {
+        throw std::runtime_error("Can't open file " + filename);
+    }
+    f.seekg(0, std::ios_base::end);
+    std::string text((size_t)f.tellg(), '\0');
+    f.seekg(0, std::ios_base::beg);
+    f.read(text.data(), (std::streamsize)text.length());
+    return parse(std::move(text), allowNaN);
+}
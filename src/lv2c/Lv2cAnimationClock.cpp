@@ -0,0 +1,44 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lv2c/Lv2cAnimationClock.hpp"
+#include <stdexcept>
+
+using namespace lv2c;
+
+std::atomic<bool> Lv2cAnimationClock::manual{false};
+std::atomic<Lv2cAnimationClock::rep> Lv2cAnimationClock::manualTime{0};
+
+void Lv2cAnimationClock::Manual(bool value)
+{
+    if (value && !manual)
+    {
+        manualTime = base_clock::now().time_since_epoch().count();
+    }
+    manual = value;
+}
+
+void Lv2cAnimationClock::Advance(duration value)
+{
+    if (!manual)
+    {
+        throw std::logic_error("Lv2cAnimationClock is not in manual mode.");
+    }
+    manualTime += value.count();
+}
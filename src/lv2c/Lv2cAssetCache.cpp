@@ -0,0 +1,246 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lv2c/Lv2cAssetCache.hpp"
+
+using namespace lv2c;
+
+Lv2cAssetCache &Lv2cAssetCache::Instance()
+{
+    static Lv2cAssetCache instance;
+    return instance;
+}
+
+bool Lv2cAssetCache::Entry::InUse() const
+{
+    if (png && cairo_surface_get_reference_count(const_cast<Lv2cSurface &>(png).get()) > 1)
+    {
+        return true;
+    }
+    return svg && svg.use_count() > 1;
+}
+
+std::string Lv2cAssetCache::MakeKey(const std::filesystem::path &path, char type, std::filesystem::file_time_type *modified)
+{
+    std::error_code ec;
+    std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, ec);
+    if (ec)
+    {
+        canonicalPath = path;
+    }
+    *modified = std::filesystem::last_write_time(canonicalPath, ec);
+    if (ec)
+    {
+        *modified = std::filesystem::file_time_type::min();
+    }
+    std::string key;
+    key += type;
+    key += ':';
+    key += canonicalPath.string();
+    return key;
+}
+
+Lv2cAssetCache::Entry *Lv2cAssetCache::Find(const std::string &key, std::filesystem::file_time_type modified)
+{
+    auto f = index.find(key);
+    if (f != index.end())
+    {
+        if (f->second->modified == modified)
+        {
+            ++stats.hits;
+            entries.splice(entries.begin(), entries, f->second);
+            return &(*f->second);
+        }
+        // the file has changed.
+        ++stats.reloads;
+        bytes -= f->second->bytes;
+        entries.erase(f->second);
+        index.erase(f);
+    }
+    ++stats.misses;
+    return nullptr;
+}
+
+Lv2cAssetCache::Entry &Lv2cAssetCache::Add(Entry &&entry)
+{
+    auto f = index.find(entry.key);
+    if (f != index.end() && f->second->modified == entry.modified)
+    {
+        // loaded concurrently by another thread. Share the first copy.
+        return *f->second;
+    }
+    if (f != index.end())
+    {
+        bytes -= f->second->bytes;
+        entries.erase(f->second);
+        index.erase(f);
+    }
+    bytes += entry.bytes;
+    entries.push_front(std::move(entry));
+    index[entries.front().key] = entries.begin();
+    Entry &result = entries.front();
+    Trim();
+    return result;
+}
+
+void Lv2cAssetCache::Trim()
+{
+    if (maxBytes == 0)
+    {
+        return;
+    }
+    auto i = entries.end();
+    while (bytes > maxBytes && i != entries.begin())
+    {
+        --i;
+        // the most recently used entry is the one being returned to a caller.
+        if (i != entries.begin() && !i->InUse())
+        {
+            bytes -= i->bytes;
+            index.erase(i->key);
+            i = entries.erase(i);
+            ++stats.evictions;
+        }
+    }
+}
+
+void Lv2cAssetCache::DiscardUnused()
+{
+    for (auto i = entries.begin(); i != entries.end();)
+    {
+        if (i->InUse())
+        {
+            ++i;
+        }
+        else
+        {
+            bytes -= i->bytes;
+            index.erase(i->key);
+            i = entries.erase(i);
+            ++stats.evictions;
+        }
+    }
+}
+
+void Lv2cAssetCache::AddClient()
+{
+    std::lock_guard lock{mutex};
+    ++clients;
+}
+
+void Lv2cAssetCache::ReleaseClient()
+{
+    std::lock_guard lock{mutex};
+    if (clients != 0 && --clients == 0)
+    {
+        DiscardUnused();
+    }
+}
+
+Lv2cSurface Lv2cAssetCache::GetPng(const std::filesystem::path &path)
+{
+    std::filesystem::file_time_type modified;
+    std::string key = MakeKey(path, 'p', &modified);
+    {
+        std::lock_guard lock{mutex};
+        Entry *entry = Find(key, modified);
+        if (entry)
+        {
+            return entry->png;
+        }
+    }
+    // load without holding the lock.
+    Lv2cSurface result = Lv2cSurface::create_from_png(path.string());
+    if (!result || result.status() != cairo_status_t::CAIRO_STATUS_SUCCESS)
+    {
+        return result; // not cached. The caller reports the error.
+    }
+    Entry entry;
+    entry.key = key;
+    entry.modified = modified;
+    entry.png = result;
+    entry.bytes = (size_t)cairo_image_surface_get_stride(result.get()) * (size_t)cairo_image_surface_get_height(result.get());
+
+    std::lock_guard lock{mutex};
+    return Add(std::move(entry)).png;
+}
+
+Lv2cSvg::ptr Lv2cAssetCache::GetSvg(const std::filesystem::path &path)
+{
+    std::filesystem::file_time_type modified;
+    std::string key = MakeKey(path, 's', &modified);
+    {
+        std::lock_guard lock{mutex};
+        Entry *entry = Find(key, modified);
+        if (entry)
+        {
+            return entry->svg;
+        }
+    }
+    Lv2cSvg::ptr result = Lv2cSvg::Create();
+    result->load(path.string());
+
+    Entry entry;
+    entry.key = key;
+    entry.modified = modified;
+    entry.svg = result;
+    std::error_code ec;
+    entry.bytes = (size_t)std::filesystem::file_size(path, ec);
+    if (ec)
+    {
+        entry.bytes = 0;
+    }
+
+    std::lock_guard lock{mutex};
+    return Add(std::move(entry)).svg;
+}
+
+void Lv2cAssetCache::MaxBytes(size_t maxBytes)
+{
+    std::lock_guard lock{mutex};
+    this->maxBytes = maxBytes;
+    Trim();
+}
+size_t Lv2cAssetCache::MaxBytes() const
+{
+    std::lock_guard lock{mutex};
+    return maxBytes;
+}
+
+void Lv2cAssetCache::Clear()
+{
+    std::lock_guard lock{mutex};
+    index.clear();
+    entries.clear();
+    bytes = 0;
+}
+
+Lv2cAssetCache::Stats Lv2cAssetCache::GetStats() const
+{
+    std::lock_guard lock{mutex};
+    Stats result = stats;
+    result.entries = entries.size();
+    result.bytes = bytes;
+    return result;
+}
+void Lv2cAssetCache::ResetStats()
+{
+    std::lock_guard lock{mutex};
+    stats = Stats();
+}
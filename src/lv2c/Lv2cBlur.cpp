@@ -0,0 +1,342 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lv2c/Lv2cBlur.hpp"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+using namespace lv2c;
+
+static double ShadowFn(int x_, int y_, int radius)
+{
+    double x = x_;
+    double y = y_;
+    double d = std::sqrt(x * x + y * y) / radius;
+    if (d < radius - 0.5)
+        return 1;
+    if (d > radius + 0.5)
+        return 0;
+    return d - (radius - 0.5);
+}
+
+int64_t Lv2cBlur::KernelRadius(double radius)
+{
+    int64_t iRadius = (int64_t)std::ceil(radius);
+    if (iRadius < 1)
+        iRadius = 1;
+    return iRadius;
+}
+
+std::vector<float> Lv2cBlur::MakeKernel(double radius, int64_t iRadius, double xOffsetFrac, double yOffsetFrac)
+{
+    if (radius < 0.5)
+        radius = 0.5;
+    int64_t filterSize = iRadius * 2;
+    std::vector<float> filter;
+    filter.resize(filterSize * filterSize);
+
+    double norm = 0;
+    for (int64_t r = 0; r < filterSize; ++r)
+    {
+        for (int64_t c = 0; c < filterSize; ++c)
+        {
+            float y = ShadowFn(r - iRadius - xOffsetFrac, c - iRadius - yOffsetFrac, radius);
+            filter[r * filterSize + c] = y;
+            norm += y;
+        }
+    }
+    norm = 1 / norm;
+    for (size_t i = 0; i < filter.size(); ++i)
+    {
+        filter[i] *= norm;
+    }
+    return filter;
+}
+
+bool Lv2cBlur::IsUniform(const std::vector<float> &kernel)
+{
+    for (size_t i = 1; i < kernel.size(); ++i)
+    {
+        if (kernel[i] != kernel[0])
+            return false;
+    }
+    return true;
+}
+
+void Lv2cBlur::DropShadow(
+    uint8_t *buffer, int64_t width, int64_t height, int64_t stride,
+    double radius, double xOffsetFrac, double yOffsetFrac)
+{
+    int64_t iRadius = KernelRadius(radius);
+    if (IsUniform(MakeKernel(radius, iRadius, xOffsetFrac, yOffsetFrac)))
+    {
+        BoxBlur(buffer, width, height, stride, iRadius, false, 0, 0);
+    }
+    else
+    {
+        DropShadowReference(buffer, width, height, stride, radius, xOffsetFrac, yOffsetFrac);
+    }
+}
+
+void Lv2cBlur::InsetShadow(
+    uint8_t *buffer, int64_t width, int64_t height, int64_t stride,
+    double radius, int64_t xOffset, int64_t yOffset, double xOffsetFrac, double yOffsetFrac)
+{
+    int64_t iRadius = KernelRadius(radius);
+    if (IsUniform(MakeKernel(radius, iRadius, xOffsetFrac, yOffsetFrac)))
+    {
+        BoxBlur(buffer, width, height, stride, iRadius, true, xOffset, yOffset);
+    }
+    else
+    {
+        InsetShadowReference(buffer, width, height, stride, radius, xOffset, yOffset, xOffsetFrac, yOffsetFrac);
+    }
+}
+
+void Lv2cBlur::BoxBlur(
+    uint8_t *buffer, int64_t width, int64_t height, int64_t stride,
+    int64_t iRadius, bool inset, int64_t xOffset, int64_t yOffset)
+{
+    if (width <= 0 || height <= 0)
+        return;
+
+    // Each output pixel is the average of a filterSize x filterSize box of source pixels
+    // covering [x-iRadius, x+iRadius) x [y-iRadius, y+iRadius). Inset shadows shift the source by
+    // (xOffset,yOffset) and blur the inverse of the source, with out-of-bounds pixels treated as 255.
+    int64_t filterSize = iRadius * 2;
+    uint32_t outOfBounds = inset ? 255 : 0;
+
+    // Pass 1: horizontal running sums. Row h of the result holds sums for source row h-iRadius,
+    // so that the vertical pass never has to deal with out-of-bounds rows.
+    int64_t paddedWidth = width + filterSize;
+    int64_t paddedHeight = height + filterSize;
+    std::vector<uint32_t> horizontal;
+    horizontal.resize(width * paddedHeight);
+
+    std::vector<uint32_t> paddedRow;
+    paddedRow.resize(paddedWidth);
+    uint32_t *pRow = &paddedRow[0];
+
+    for (int64_t h = 0; h < paddedHeight; ++h)
+    {
+        for (int64_t i = 0; i < paddedWidth; ++i)
+        {
+            pRow[i] = outOfBounds;
+        }
+        int64_t sourceY = h - iRadius - yOffset;
+        if (sourceY >= 0 && sourceY < height)
+        {
+            // padded column p holds source column p-shift.
+            const uint8_t *pIn = buffer + sourceY * stride;
+            int64_t shift = iRadius + xOffset;
+            int64_t pStart = std::max(int64_t(0), shift);
+            int64_t pEnd = std::min(paddedWidth, width + shift);
+            if (inset)
+            {
+                for (int64_t p = pStart; p < pEnd; ++p)
+                {
+                    pRow[p] = 255 - pIn[p - shift];
+                }
+            }
+            else
+            {
+                for (int64_t p = pStart; p < pEnd; ++p)
+                {
+                    pRow[p] = pIn[p - shift];
+                }
+            }
+        }
+
+        uint32_t *pOut = &horizontal[h * width];
+        uint32_t sum = 0;
+        for (int64_t i = 0; i < filterSize; ++i)
+        {
+            sum += pRow[i];
+        }
+        for (int64_t x = 0; x < width; ++x)
+        {
+            pOut[x] = sum;
+            sum += pRow[x + filterSize];
+            sum -= pRow[x];
+        }
+    }
+
+    // Pass 2: vertical running sums. Each step adds one row and subtracts another, over
+    // contiguous rows, which the compiler vectorizes.
+    std::vector<uint32_t> columnSums;
+    columnSums.resize(width);
+    uint32_t *pSums = &columnSums[0];
+
+    for (int64_t h = 0; h < filterSize; ++h)
+    {
+        const uint32_t *pIn = &horizontal[h * width];
+        for (int64_t x = 0; x < width; ++x)
+        {
+            pSums[x] += pIn[x];
+        }
+    }
+
+    float scale = 1.0f / (float)(filterSize * filterSize);
+    for (int64_t row = 0; row < height; ++row)
+    {
+        uint8_t *pOut = buffer + row * stride;
+        for (int64_t x = 0; x < width; ++x)
+        {
+            uint32_t value = (uint32_t)(pSums[x] * scale);
+            pOut[x] = (uint8_t)(value > 255 ? 255 : value);
+        }
+        if (row + 1 < height)
+        {
+            const uint32_t *pAdd = &horizontal[(row + filterSize) * width];
+            const uint32_t *pRemove = &horizontal[row * width];
+            for (int64_t x = 0; x < width; ++x)
+            {
+                pSums[x] += pAdd[x] - pRemove[x];
+            }
+        }
+    }
+}
+
+void Lv2cBlur::DropShadowReference(
+    uint8_t *surfaceBuffer, int64_t width, int64_t height, int64_t stride,
+    double radius, double xOffsetFrac, double yOffsetFrac)
+{
+    int64_t iRadius = KernelRadius(radius);
+    std::vector<float> filter = MakeKernel(radius, iRadius, xOffsetFrac, yOffsetFrac);
+    int64_t filterSize = iRadius * 2;
+
+    std::vector<uint8_t> workingBuffer;
+    int64_t workingBufferStride = stride;
+    workingBuffer.resize(workingBufferStride * height);
+    memcpy(&(workingBuffer[0]), surfaceBuffer, workingBufferStride * height);
+
+    for (int64_t row = 0; row < height; ++row)
+    {
+        for (int64_t column = 0; column < width; ++column)
+        {
+            float sum = 0;
+            for (int64_t filterY = 0; filterY < filterSize; ++filterY)
+            {
+                int64_t sourceRow = row - iRadius + filterY;
+                if (sourceRow >= 0 && sourceRow < height)
+                {
+                    auto pFilterSource = &(filter[filterSize * filterY]);
+                    uint8_t *pRowSource = &(workingBuffer[sourceRow * workingBufferStride]);
+                    int64_t sourceX = -iRadius + column;
+                    if (sourceX >= 0 && sourceX + filterSize < width)
+                    {
+                        pRowSource += sourceX;
+                        for (int64_t filterX = 0; filterX < filterSize; ++filterX)
+                        {
+                            float v = (*pRowSource++) * (*pFilterSource++);
+                            sum += v;
+                        }
+                    }
+                    else
+                    {
+                        for (int64_t filterX = 0; filterX < filterSize; ++filterX)
+                        {
+                            int64_t tx = sourceX + filterX;
+                            if (tx >= 0 && tx < width)
+                            {
+                                float v = pRowSource[tx] * (*pFilterSource);
+                                sum += v;
+                            }
+                            pFilterSource++;
+                        }
+                    }
+                }
+            }
+            uint64_t value = (uint64_t)(sum);
+            if (value > 255)
+                value = 255;
+            surfaceBuffer[row * stride + column] = (uint8_t)value;
+        }
+    }
+}
+
+void Lv2cBlur::InsetShadowReference(
+    uint8_t *surfaceBuffer, int64_t width, int64_t height, int64_t stride,
+    double radius, int64_t ixOffset, int64_t iyOffset, double xOffsetFrac, double yOffsetFrac)
+{
+    int64_t iRadius = KernelRadius(radius);
+    std::vector<float> filter = MakeKernel(radius, iRadius, xOffsetFrac, yOffsetFrac);
+    int64_t filterSize = iRadius * 2;
+
+    std::vector<uint8_t> workingBuffer;
+    int64_t workingBufferSpan = stride;
+    workingBuffer.resize(workingBufferSpan * height);
+    memcpy(&workingBuffer[0], surfaceBuffer, workingBufferSpan * height);
+
+    for (int64_t row = 0; row < height; ++row)
+    {
+        for (int64_t column = 0; column < width; ++column)
+        {
+            float sum = 0;
+            for (int64_t filterY = 0; filterY < filterSize; ++filterY)
+            {
+                auto pFilterSource = &(filter[filterSize * filterY]);
+                int64_t sourceRow = row + filterY - iyOffset - iRadius;
+                if (sourceRow >= height || sourceRow < 0)
+                {
+                    for (int64_t filterX = 0; filterX < filterSize; ++filterX)
+                    {
+                        sum += 255 * pFilterSource[filterX];
+                    }
+                }
+                else
+                {
+                    uint8_t *pRowSource = &(workingBuffer[sourceRow * workingBufferSpan]);
+                    int64_t sourceX = column - iRadius - ixOffset;
+                    if (sourceX >= 0 && sourceX + filterSize < width)
+                    {
+                        pRowSource += sourceX;
+                        for (int64_t filterX = 0; filterX < filterSize; ++filterX)
+                        {
+                            float v = (255 - *pRowSource++) * (*pFilterSource++);
+                            sum += v;
+                        }
+                    }
+                    else
+                    {
+                        for (int64_t filterX = 0; filterX < filterSize; ++filterX)
+                        {
+                            if (sourceX < 0 || sourceX >= width)
+                            {
+                                float v = 255 * (*pFilterSource++);
+                                sum += v;
+                            }
+                            else
+                            {
+                                float v = (255 - pRowSource[sourceX]) * (*pFilterSource++);
+                                sum += v;
+                            }
+                            ++sourceX;
+                        }
+                    }
+                }
+            }
+            int64_t value = (int64_t)(sum);
+            if (value > 255)
+                value = 255;
+            surfaceBuffer[row * stride + column] = (uint8_t)value;
+        }
+    }
+}
@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "lv2c/Lv2cContainerElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 
 using namespace lv2c;
 
@@ -32,6 +33,7 @@ void Lv2cContainerElement::AddChild(std::shared_ptr<Lv2cElement> child, size_t p
         throw std::range_error("Child is already a childof another element.");
     }
     child->parentElement = this;
+    child->InvalidateComputedStyle();
     this->children.insert(this->children.begin()+position,child);
     if (this->window != nullptr)
     {
@@ -53,6 +55,7 @@ void Lv2cContainerElement::RemoveChild(size_t index)
         t->Unmount(this->Window());
     }
     t->parentElement = nullptr;
+    t->InvalidateComputedStyle();
     InvalidateLayout();
 }
 
@@ -63,6 +66,7 @@ bool Lv2cContainerElement::RemoveChild(std::shared_ptr<Lv2cElement> element)
         if ((*i).get() == element.get())
         {
             (*i)->parentElement = nullptr;
+            (*i)->InvalidateComputedStyle();
             if (element->window)
             {
                 element->Unmount(element->window);
@@ -354,6 +358,7 @@ Lv2cSize Lv2cContainerElement::MeasureClient(Lv2cSize clientConstraint, Lv2cSize
 }
 Lv2cSize Lv2cContainerElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
     Lv2cRectangle marginRect{0, 0, available.Width(), available.Height()};
 
     Lv2cRectangle borderRect = this->removeThickness(marginRect, Style().Margin());
@@ -426,6 +431,15 @@ Lv2cSize Lv2cContainerElement::Arrange(Lv2cSize available, Lv2cDrawingContext &c
 }
 
 
+void Lv2cContainerElement::InvalidateComputedStyle()
+{
+    super::InvalidateComputedStyle();
+    for (auto &child : children)
+    {
+        child->InvalidateComputedStyle();
+    }
+}
+
 void Lv2cContainerElement::RemoveAllChildren()
 {
     // do it the slow way to make sure we handle Mount/Unmount calls properly.
@@ -19,6 +19,8 @@
 
 #include "lv2c/Lv2cDamageList.hpp"
 #include <cmath>
+#include <algorithm>
+#include <limits>
 
 using namespace lv2c;
 
@@ -35,7 +37,7 @@ int64_t Lv2cDamageList::Height() const
 void Lv2cDamageList::SetSize(int64_t width, int64_t height)
 {
     this->bounds = DamageRect{0,width,0,height};
-    damageLines.resize(0);
+    lineCount = 0;
     Lv2cRectangle rc { 0,0,(double)width,(double)height};
     Invalidate(rc);
 }
@@ -65,35 +67,35 @@ void Lv2cDamageList::ExposeRect(DamageRect rect)
     }
 
     size_t damageLine = 0;
-    if (damageLines.size() == 0)
+    if (lineCount == 0)
     {
-        damageLines.push_back(std::make_unique<DamageLine>(rect));
+        InsertLine(0).reset(rect);
         return;
     }
-    while (damageLine < damageLines.size()) {
+    while (damageLine < lineCount) {
         auto & line = damageLines[damageLine];
-        if (line->bottom < rect.top)
+        if (line.bottom < rect.top)
         {
             ++damageLine;
         } else {
             break;
         }
     }
+    // Note that InsertLine() invalidates references to lines.
     while (rect.bottom > rect.top)
     {
-        if (damageLine >= damageLines.size())
+        if (damageLine >= lineCount)
         {
-            damageLines.push_back(std::make_unique<DamageLine>(rect));
+            InsertLine(lineCount).reset(rect);
             break;
         }
-        DamageLine*damageRow = damageLines[damageLine].get();
+        DamageLine*damageRow = &damageLines[damageLine];
 
         if (rect.top < damageRow->top)
         {
-            damageLines.insert(damageLines.begin()+damageLine, 
-                std::make_unique<DamageLine>(
-                    DamageRect {rect.left,rect.right,rect.top,damageRow->top}));
-            rect.top = damageRow->top;
+            int64_t rowTop = damageRow->top;
+            InsertLine(damageLine).reset(DamageRect {rect.left,rect.right,rect.top,rowTop});
+            rect.top = rowTop;
             ++damageLine;
         } else if (rect.top == damageRow->top)
         {
@@ -106,20 +108,22 @@ void Lv2cDamageList::ExposeRect(DamageRect rect)
                 {
                     break;
                 }
-                auto newLine = std::make_unique<DamageLine>(*damageRow); // copy construct.
-                newLine->bottom = rect.bottom;
+                DamageLine &newLine = InsertLine(damageLine);
+                damageRow = &damageLines[damageLine+1];
+                newLine.assign(*damageRow);
+                newLine.bottom = rect.bottom;
                 damageRow->top = rect.bottom;
                 rect.top = rect.bottom;
-                newLine->addRange(rect.left,rect.right);
-                damageLines.insert(damageLines.begin()+damageLine,std::move(newLine));
+                newLine.addRange(rect.left,rect.right);
                 ++damageLine;
             }
         } else if (rect.top < damageRow->bottom)
         {
-            auto newLine = std::make_unique<DamageLine>(*damageRow); // copy construct.
-            newLine->bottom = rect.top;
+            DamageLine &newLine = InsertLine(damageLine);
+            damageRow = &damageLines[damageLine+1];
+            newLine.assign(*damageRow);
+            newLine.bottom = rect.top;
             damageRow->top = rect.top;
-            damageLines.insert(damageLines.begin()+damageLine,std::move(newLine));
             ++damageLine;
         } else {
             ++damageLine;
@@ -129,44 +133,221 @@ void Lv2cDamageList::ExposeRect(DamageRect rect)
 
     size_t row = 0;
 
-    while (row < damageLines.size()-1)
+    while (row+1 < lineCount)
     {
-        if (canMerge(damageLines[row].get(),damageLines[row+1].get()))
+        if (canMerge(damageLines[row],damageLines[row+1]))
         {
-            damageLines[row]->bottom = damageLines[row+1]->bottom;
-            damageLines.erase(damageLines.begin()+row+1);
+            damageLines[row].bottom = damageLines[row+1].bottom;
+            EraseLine(row+1);
         } else {
             ++row;
         }
     }
 }
-std::vector<Lv2cRectangle> Lv2cDamageList::GetDamageList()
-{
-    std::vector<Lv2cRectangle> result;
 
-    for (auto& damageLine: damageLines)
+Lv2cDamageList::DamageLine &Lv2cDamageList::InsertLine(size_t position)
+{
+    if (lineCount == damageLines.size())
     {
-        double top = (double)(damageLine->top);
-        double bottom = (double)(damageLine->bottom);
+        damageLines.emplace_back();
+    }
+    // move a spare line (and its buffer) into place.
+    std::rotate(
+        damageLines.begin()+position,
+        damageLines.begin()+lineCount,
+        damageLines.begin()+lineCount+1);
+    ++lineCount;
+    return damageLines[position];
+}
 
-        auto &points = damageLine->points;
+void Lv2cDamageList::EraseLine(size_t position)
+{
+    // keep the erased line as a spare.
+    std::rotate(
+        damageLines.begin()+position,
+        damageLines.begin()+position+1,
+        damageLines.begin()+lineCount);
+    --lineCount;
+}
+
+std::vector<Lv2cRectangle> Lv2cDamageList::GetDamageList()
+{
+    rectBuffer.resize(0);
+    for (size_t line = 0; line < lineCount; ++line)
+    {
+        const DamageLine &damageLine = damageLines[line];
+        auto &points = damageLine.points;
 
         for (size_t i = 0; i < points.size(); i += 2)
         {
-            result.push_back(
-                Lv2cRectangle(
-                    (double)(points[i]),
-                    top,
-                    (double)(points[i+1]-points[i]),
-                    bottom-top)
-                );
+            rectBuffer.push_back(DamageRect{points[i],points[i+1],damageLine.top,damageLine.bottom});
         }
     }
-    damageLines.resize(0);
+    lineCount = 0;
+
+    MergeRects(rectBuffer);
+
+    std::vector<Lv2cRectangle> result;
+    result.reserve(rectBuffer.size());
+    for (const DamageRect &rect: rectBuffer)
+    {
+        result.push_back(
+            Lv2cRectangle(
+                (double)(rect.left),
+                (double)(rect.top),
+                (double)(rect.right-rect.left),
+                (double)(rect.bottom-rect.top))
+            );
+    }
     return result;
 }
 
+void Lv2cDamageList::SetMergePolicy(int64_t rectangleCost, size_t maxRectangles)
+{
+    this->rectangleCost = rectangleCost;
+    this->maxRectangles = maxRectangles;
+}
+
+void Lv2cDamageList::MergeRects(std::vector<DamageRect>&rects)
+{
+    if (rectangleCost <= 0 && maxRectangles == 0)
+    {
+        return;
+    }
+    // The number of undamaged pixels that drawing the union of two rectangles instead would add.
+    auto mergeCost = [](const DamageRect&r0, const DamageRect&r1)
+    {
+        return DamageRect::unionOf(r0,r1).area() - (r0.area() + r1.area() - DamageRect::intersect(r0,r1).area());
+    };
+    // Find the cheapest pair to merge in rects[0..count).
+    auto cheapestPair = [&mergeCost,&rects](size_t count, size_t &index0, size_t &index1)
+    {
+        int64_t bestCost = std::numeric_limits<int64_t>::max();
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (size_t j = i+1; j < count; ++j)
+            {
+                int64_t cost = mergeCost(rects[i],rects[j]);
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    index0 = i;
+                    index1 = j;
+                }
+            }
+        }
+        return bestCost;
+    };
+    auto mergePair = [&rects](size_t count, size_t index0, size_t index1)
+    {
+        rects[index0] = DamageRect::unionOf(rects[index0],rects[index1]);
+        rects[index1] = rects[count-1];
+    };
+
+    // In band order, merge each rectangle into the output rectangle that is cheapest to extend,
+    // if that costs less than drawing another rectangle. Output is built in place, in rects[0..count).
+    // Keeping the output at or below maxRectangles bounds the cost of the pairwise searches.
+    size_t count = 0;
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+        DamageRect rect = rects[i];
+        size_t best = count;
+        int64_t bestCost = rectangleCost;
+        for (size_t j = 0; j < count; ++j)
+        {
+            int64_t cost = mergeCost(rects[j],rect);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                best = j;
+            }
+        }
+        if (best != count)
+        {
+            rects[best] = DamageRect::unionOf(rects[best],rect);
+        } else {
+            rects[count++] = rect;
+            if (maxRectangles != 0 && count > maxRectangles)
+            {
+                size_t index0 = 0, index1 = 0;
+                cheapestPair(count,index0,index1);
+                mergePair(count,index0,index1);
+                --count;
+            }
+        }
+    }
+    // Merged rectangles may have become cheap to merge with each other.
+    while (count > 1)
+    {
+        size_t index0 = 0, index1 = 0;
+        int64_t cost = cheapestPair(count,index0,index1);
+        if (cost >= rectangleCost && (maxRectangles == 0 || count <= maxRectangles))
+        {
+            break;
+        }
+        mergePair(count,index0,index1);
+        --count;
+    }
+    rects.resize(count);
+}
+
+void Lv2cDamageList::Scroll(const Lv2cRectangle &rectangle, int64_t dx, int64_t dy)
+{
+    DamageRect scrollRect{
+        (int64_t)std::floor(rectangle.Left()),
+        (int64_t)std::ceil(rectangle.Right()),
+        (int64_t)std::floor(rectangle.Top()),
+        (int64_t)std::ceil(rectangle.Bottom())};
+    scrollRect = DamageRect::intersect(scrollRect, this->bounds);
+    if (scrollRect.isEmpty() || (dx == 0 && dy == 0))
+    {
+        return;
+    }
 
+    std::vector<DamageRect> scrolledRects;
+    for (size_t line = 0; line < lineCount; ++line)
+    {
+        const DamageLine &damageLine = damageLines[line];
+        auto &points = damageLine.points;
+        for (size_t i = 0; i < points.size(); i += 2)
+        {
+            DamageRect damageRect{points[i], points[i + 1], damageLine.top, damageLine.bottom};
+            damageRect = DamageRect::intersect(damageRect, scrollRect);
+            if (!damageRect.isEmpty())
+            {
+                DamageRect scrolled{
+                    damageRect.left + dx, damageRect.right + dx,
+                    damageRect.top + dy, damageRect.bottom + dy};
+                scrolledRects.push_back(DamageRect::intersect(scrolled, scrollRect));
+            }
+        }
+    }
+    for (auto &scrolledRect : scrolledRects)
+    {
+        if (!scrolledRect.isEmpty())
+        {
+            ExposeRect(scrolledRect);
+        }
+    }
+
+    // newly exposed strips.
+    if (dx > 0)
+    {
+        ExposeRect(DamageRect{scrollRect.left, std::min(scrollRect.left + dx, scrollRect.right), scrollRect.top, scrollRect.bottom});
+    }
+    else if (dx < 0)
+    {
+        ExposeRect(DamageRect{std::max(scrollRect.right + dx, scrollRect.left), scrollRect.right, scrollRect.top, scrollRect.bottom});
+    }
+    if (dy > 0)
+    {
+        ExposeRect(DamageRect{scrollRect.left, scrollRect.right, scrollRect.top, std::min(scrollRect.top + dy, scrollRect.bottom)});
+    }
+    else if (dy < 0)
+    {
+        ExposeRect(DamageRect{scrollRect.left, scrollRect.right, std::max(scrollRect.bottom + dy, scrollRect.top), scrollRect.bottom});
+    }
+}
 
 Lv2cDamageList::DamageRect  Lv2cDamageList::DamageRect::intersect(const DamageRect &r0, const DamageRect&r1)
 {
@@ -183,6 +364,15 @@ Lv2cDamageList::DamageRect  Lv2cDamageList::DamageRect::intersect(const DamageRe
     return DamageRect{left,right,top,bottom};
 }
 
+Lv2cDamageList::DamageRect Lv2cDamageList::DamageRect::unionOf(const DamageRect &r0, const DamageRect&r1)
+{
+    return DamageRect{
+        std::min(r0.left,r1.left),
+        std::max(r0.right,r1.right),
+        std::min(r0.top,r1.top),
+        std::max(r0.bottom,r1.bottom)};
+}
+
 
 
 void Lv2cDamageList::DamageLine::addRange(int64_t left, int64_t right)
@@ -257,9 +447,9 @@ bool Lv2cDamageList::DamageLine::contains(int64_t left, int64_t right)
 }
 
 
-bool Lv2cDamageList::canMerge(const DamageLine*line1,const DamageLine*line2) 
+bool Lv2cDamageList::canMerge(const DamageLine&line1,const DamageLine&line2) 
 {
-    if  (line1->bottom != line2->top) return false;
+    if  (line1.bottom != line2.top) return false;
 
-    return line1->points == line2->points;
+    return line1.points == line2.points;
 }
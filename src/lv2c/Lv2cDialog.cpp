@@ -145,9 +145,8 @@ void Lv2cDialog::Show(Lv2cWindow *parentWindow)
     this->windowParameters = parameters;
     this->Settings(parameters.settingsObject);
     Lv2cCreateWindowParameters scaledParameters = Lv2cWindow::Scale(this->windowParameters,windowScale);
-    this->nativeWindow = new Lv2cX11Window(
+    this->nativeWindow = parentWindow->nativeWindow->CreateChild(
         this->shared_from_this(),
-        parentWindow->nativeWindow,
         scaledParameters);
     this->windowParameters.positioning = scaledParameters.positioning;
     this->windowParameters.location = scaledParameters.location / windowScale;
@@ -23,36 +23,14 @@
 #include <memory.h>
 #include <numbers>
 #include "lv2c/Lv2cWindow.hpp"
+#include "lv2c/Lv2cBlur.hpp"
+#include "lv2c/Lv2cShadowCache.hpp"
 
 using namespace lv2c;
 
-static double ShadowFn(int x_, int y_, int radius)
+void Lv2cDropShadowElement::GetShadowOffset(double *pXOffset, double *pYOffset, double *pXOffsetFrac, double *pYOffsetFrac)
 {
-    double x = x_;
-    double y = y_;
-    double d = std::sqrt(x * x + y * y) / radius;
-    if (d < radius-0.5) return 1;
-    if (d > radius+0.5) return 0;
-    return d-(radius-0.5);
-    // if (d > 1)
-    //     return 0;
-    // // return 0.5 + 0.5 * std::cos(d * std::numbers::pi);
-    // return 1 - d;
-}
-void Lv2cDropShadowElement::BlurDropShadow(Lv2cDrawingContext &dc, cairo_surface_t *surface, double *pXOffset, double *pYOffset)
-{
-    double radius = Radius() * Window()->WindowScale();
-    if (radius < 0.5)
-        radius = 0.5;
-    int64_t iRadius = (int)std::ceil(radius);
-    if (iRadius < 1)
-        iRadius = 1;
-
-    // using SIGNED coordinates throughout because filters (may) use negative indices
-    int64_t width = cairo_image_surface_get_width(surface);
-    int64_t height = cairo_image_surface_get_height(surface);
-    int64_t stride = cairo_image_surface_get_stride(surface);
-
+    // shadows are drawn at whole device-pixel offsets; the remainder is applied by the blur filter.
     double xOffset = XOffset() * Window()->WindowScale();
     double yOffset = YOffset() * Window()->WindowScale();
 
@@ -63,112 +41,31 @@ void Lv2cDropShadowElement::BlurDropShadow(Lv2cDrawingContext &dc, cairo_surface
 
     *pXOffset = xOffset / Window()->WindowScale();
     *pYOffset = yOffset / Window()->WindowScale();
+    if (pXOffsetFrac)
+        *pXOffsetFrac = xOffsetFrac;
+    if (pYOffsetFrac)
+        *pYOffsetFrac = yOffsetFrac;
+}
 
-    std::vector<uint8_t> workingBuffer;
-
-    int64_t workingBufferStride = stride;
-
-    workingBuffer.resize(workingBufferStride * (height));
-
-    uint8_t *surfaceBuffer = (uint8_t *)cairo_image_surface_get_data(surface);
-
-    memcpy(&(workingBuffer[0]), surfaceBuffer, workingBufferStride * height);
-
-    int64_t filterSize = iRadius * 2;
-    std::vector<float> filter;
-    filter.resize(filterSize * filterSize);
-
-    double norm = 0;
-
-    for (int64_t r = 0; r < filterSize; ++r)
-    {
-        for (int64_t c = 0; c < filterSize; ++c)
-        {
-            float y = ShadowFn(r - iRadius - xOffsetFrac, c - iRadius - yOffsetFrac, radius);
-            filter[r * filterSize + c] = y;
-            norm += y;
-        }
-    }
-    norm = 1 / norm;
-    for (size_t i = 0; i < filter.size(); ++i)
-    {
-        filter[i] *= norm;
-    }
-
-    // translate to [radius,radius].
+void Lv2cDropShadowElement::BlurDropShadow(Lv2cDrawingContext &dc, cairo_surface_t *surface, double *pXOffset, double *pYOffset)
+{
+    double radius = Radius() * Window()->WindowScale();
 
-    for (int64_t row = 0; row < height; ++row)
-    {
+    double xOffsetFrac, yOffsetFrac;
+    GetShadowOffset(pXOffset, pYOffset, &xOffsetFrac, &yOffsetFrac);
 
-        for (int64_t column = 0; column < width; ++column)
-        {
-            float sum = 0;
-            for (int64_t filterY = 0; filterY < filterSize; ++filterY)
-            {
-                int64_t sourceRow = row - iRadius + filterY;
-                if (sourceRow >= 0 && sourceRow < height)
-                {
-                    auto pFilterSource = &(filter[filterSize * filterY]);
-                    uint8_t *pRowSource = &(workingBuffer[sourceRow * workingBufferStride]);
-                    int64_t sourceX = -iRadius + column;
-                    if (sourceX >= 0 && sourceX + filterSize < width)
-                    {
-                        pRowSource += sourceX;
-                        // fast, probably vectorized version.
-                        for (int64_t filterX = 0; filterX < filterSize; ++filterX)
-                        {
-                            float v = (*pRowSource++) * (*pFilterSource++);
-                            sum += v;
-                        }
-                    }
-                    else
-                    {
-                        // slow, guarded version.
-                        for (int64_t filterX = 0; filterX < filterSize; ++filterX)
-                        {
-                            int64_t tx = sourceX + filterX;
-                            if (tx >= 0 && tx < width)
-                            {
-                                float v = pRowSource[tx] * (*pFilterSource);
-                                sum += v;
-                            } else {
-
-                            }
-                            pFilterSource++;
-                        }
-                    }
-                }
-            }
-            // write back to the buffer.
-            uint64_t value = (uint64_t)(sum);
-            size_t surfaceIx = row * stride + column;
-
-            if (value > 255)
-                value = 255;
-            // int64_t surfaceValue = surfaceBuffer[surfaceIx];
-            // value = (surfaceValue*value)/255;
-            surfaceBuffer[surfaceIx] = (uint8_t)value;
-        }
-    }
+    Lv2cBlur::DropShadow(
+        cairo_image_surface_get_data(surface),
+        cairo_image_surface_get_width(surface),
+        cairo_image_surface_get_height(surface),
+        cairo_image_surface_get_stride(surface),
+        radius, xOffsetFrac, yOffsetFrac);
 }
 
 void Lv2cDropShadowElement::BlurInsetDropShadow(Lv2cDrawingContext &dc, cairo_surface_t *surface)
 {
     double windowScale = Window()->WindowScale();
     double radius = Radius() * windowScale;
-    int64_t iRadius = (int)std::ceil(radius);
-    if (radius < 0.5)
-    {
-        radius = 0.5;
-    }
-    if (iRadius < 1)
-        iRadius = 1;
-
-    // using SIGNED coordinates throughout because filters (may) use negative indices
-    int64_t width = cairo_image_surface_get_width(surface);
-    int64_t height = cairo_image_surface_get_height(surface);
-    int64_t stride = cairo_image_surface_get_stride(surface);
-    uint8_t *surfaceBuffer = cairo_image_surface_get_data(surface);
 
     double xOffset = XOffset() * windowScale;
     double yOffset = YOffset() * windowScale;
@@ -181,102 +78,55 @@ void Lv2cDropShadowElement::BlurInsetDropShadow(Lv2cDrawingContext &dc, cairo_su
     int64_t ixOffset = (int64_t)std::round(xOffset);
     int64_t iyOffset = (int64_t)std::round(yOffset);
 
-    std::vector<uint8_t> workingBuffer;
-
-    int64_t workingBufferSpan = stride;
+    Lv2cBlur::InsetShadow(
+        cairo_image_surface_get_data(surface),
+        cairo_image_surface_get_width(surface),
+        cairo_image_surface_get_height(surface),
+        cairo_image_surface_get_stride(surface),
+        radius, ixOffset, iyOffset, xOffsetFrac, yOffsetFrac);
+}
 
-    workingBuffer.resize(workingBufferSpan * height);
-    memcpy(&workingBuffer[0], surfaceBuffer, workingBufferSpan * height);
+Lv2cImageSurface Lv2cDropShadowElement::RenderShadowNinePatch(const Lv2cShadowCacheKey &key)
+{
+    Lv2cImageSurface shadowSurface{
+        cairo_format_t::CAIRO_FORMAT_A8,
+        key.width,
+        key.height};
 
-    int64_t filterSize = iRadius * 2;
-    std::vector<float> filter;
-    filter.resize(filterSize * filterSize);
+    // draw the background shape.
+    Lv2cDrawingContext bdc{shadowSurface};
 
-    double norm = 0;
-    for (int64_t r = 0; r < filterSize; ++r)
+    bdc.set_source(Lv2cColor(1, 1, 1));
+    if (key.deviceRoundCorners.is_empty())
     {
-        for (int64_t c = 0; c < filterSize; ++c)
-        {
-            float y = ShadowFn(r - iRadius - xOffsetFrac, c - iRadius - yOffsetFrac, radius);
-            filter[r * filterSize + c] = y;
-            norm += y;
-        }
+        bdc.rectangle(key.deviceBackground);
     }
-    norm = 1 / norm;
-    for (size_t i = 0; i < filter.size(); ++i)
+    else
     {
-        filter[i] *= norm;
+        bdc.round_corner_rectangle(key.deviceBackground, key.deviceRoundCorners);
     }
+    bdc.fill();
+    cairo_surface_flush(shadowSurface.get());
 
-    for (int64_t row = 0; row < height; ++row)
-    {
-
-        for (int64_t column = 0; column < width; ++column)
-        {
-            float sum = 0;
-            for (int64_t filterY = 0; filterY < filterSize; ++filterY)
-            {
-                auto pFilterSource = &(filter[filterSize * filterY]);
-                int64_t sourceRow = row + filterY - iyOffset - iRadius;
-                if (sourceRow >= height || sourceRow < 0)
-                {
-                    for (int64_t filterX = 0; filterX < filterSize; ++filterX)
-                    {
-                        sum += 255 * pFilterSource[filterX];
-                    }
-                }
-                else
-                {
-                    auto pFilterSource = &(filter[filterSize * filterY]);
-                    uint8_t *pRowSource = &(workingBuffer[sourceRow * workingBufferSpan]);
-                    int64_t sourceX = column - iRadius - ixOffset;
-                    if (sourceX >= 0 && sourceX + filterSize < width)
-                    {
-                        pRowSource += sourceX;
-                        // fast, probably vectorized version.
-                        for (int64_t filterX = 0; filterX < filterSize; ++filterX)
-                        {
-                            float v = (255 - *pRowSource++) * (*pFilterSource++);
-                            sum += v;
-                        }
-                    }
-                    else
-                    {
-                        // slow, guarded version.
-                        for (int64_t filterX = 0; filterX < filterSize; ++filterX)
-                        {
-                            if (sourceX < 0 || sourceX >= width)
-                            {
-                                float v = 255 * (*pFilterSource++);
-                                sum += v;
-                            }
-                            else
-                            {
-                                float v = (255 - pRowSource[sourceX]) * (*pFilterSource++);
-                                sum += v;
-                            }
-                            ++sourceX;
-                        }
-                    }
-                }
-            }
-            // write back to the buffer.
-            int64_t value = (int64_t)(sum);
-            size_t surfaceIx = row * stride + column;
+    double xOffset, yOffset;
+    BlurDropShadow(bdc, shadowSurface.get(), &xOffset, &yOffset);
 
+    shadowSurface.mark_dirty();
 
-            // (alpha values are linear. Review this).
-            // We'll reconcile with the original by drawing ATOP.
-            // int64_t surfaceValue = surfaceBuffer[surfaceIx];
-            // value -= (255 - surfaceValue);
-            // if (value < 0)
-            //     value = 0;
-            // if (value > 255)
-            //     value = 255;
+    Lv2cImageSurface colorSurface{
+        cairo_format_t::CAIRO_FORMAT_ARGB32,
+        shadowSurface.get_width(),
+        shadowSurface.get_height()};
 
-            surfaceBuffer[surfaceIx] = (uint8_t)value;
-        }
+    // create an argb surface from the a-only shadowSurface.
+    {
+        Lv2cDrawingContext bdcColor{colorSurface};
+        bdcColor.set_source(key.color);
+        bdcColor.mask_surface(shadowSurface, 0, 0);
     }
+    colorSurface.flush();
+    colorSurface.mark_dirty();
+    return colorSurface;
 }
 
 bool Lv2cDropShadowElement::DrawFastDropShadow(Lv2cDrawingContext &dc, const Lv2cRectangle &clipBounds)
@@ -348,63 +198,31 @@ bool Lv2cDropShadowElement::DrawFastDropShadow(Lv2cDrawingContext &dc, const Lv2
     double nineBackgroundRight = deviceBorderRectangle.Right() - deviceNineP2.x + nineXs[2];
     double nineBackgroundBottom = deviceBorderRectangle.Bottom() - deviceNineP2.y + nineYs[2];
 
-    Lv2cImageSurface shadowSurface{
-        cairo_format_t::CAIRO_FORMAT_A8,
-        (int)(nineXs[3]),
-        (int)(nineYs[3])};
-
-    // draw the background shape.
-    Lv2cRoundCorners deviceRoundCorners = roundCorners * deviceScale;
-
-    Lv2cDrawingContext bdc{shadowSurface};
-
-    bdc.set_source(Lv2cColor(1, 1, 1));
-    if (deviceRoundCorners.is_empty())
+    Lv2cShadowCacheKey key;
+    key.width = (int)(nineXs[3]);
+    key.height = (int)(nineYs[3]);
+    key.deviceBackground = Lv2cRectangle(
+        nineBackgroundLeft, nineBackgroundTop,
+        nineBackgroundRight - nineBackgroundLeft,
+        nineBackgroundBottom - nineBackgroundTop);
+    key.deviceRoundCorners = roundCorners * deviceScale;
+    key.deviceRadius = Radius() * Window()->WindowScale();
+    key.deviceXOffset = XOffset() * Window()->WindowScale();
+    key.deviceYOffset = YOffset() * Window()->WindowScale();
+    key.color = Lv2cColor(ShadowColor(), ShadowOpacity());
+    key.windowScale = Window()->WindowScale();
+
+    // the nine-patch depends only on the key, so reuse a previously rendered one if we can.
+    Lv2cShadowCache &shadowCache = Lv2cShadowCache::Instance();
+    std::optional<Lv2cImageSurface> cachedSurface = shadowCache.Get(key);
+    Lv2cImageSurface colorSurface = cachedSurface ? std::move(*cachedSurface) : RenderShadowNinePatch(key);
+    if (!cachedSurface)
     {
-            bdc.rectangle(
-                Lv2cRectangle(
-                    nineBackgroundLeft, nineBackgroundTop,
-                    nineBackgroundRight - nineBackgroundLeft,
-                    nineBackgroundBottom - nineBackgroundTop)
-                    );
-
-    } else {
-    bdc.round_corner_rectangle(
-        Lv2cRectangle(
-            nineBackgroundLeft, nineBackgroundTop,
-            nineBackgroundRight - nineBackgroundLeft,
-            nineBackgroundBottom - nineBackgroundTop),
-        deviceRoundCorners);
+        shadowCache.Put(key, colorSurface);
     }
-    bdc.fill();
-    cairo_surface_flush(shadowSurface.get());
 
     double xOffset, yOffset;
-
-    (void)xOffset;
-    (void)yOffset;
-    BlurDropShadow(bdc, shadowSurface.get(), &xOffset, &yOffset);
-
-    shadowSurface.mark_dirty();
-
-    Lv2cImageSurface colorSurface{
-        cairo_format_t::CAIRO_FORMAT_ARGB32,
-        shadowSurface.get_width(),
-        shadowSurface.get_height()};
-
-    // create an argb surface from the a-only shadowSurface.
-    Lv2cDrawingContext bdcColor{colorSurface};
-    bdcColor.set_source(Lv2cColor(ShadowColor(),ShadowOpacity()));
-    bdcColor.mask_surface(shadowSurface, 0, 0);
-
-    // bdcColor.move_to(0,0);
-    // bdcColor.line_to(shadowSurface.get_width(),shadowSurface.get_height());
-    // bdcColor.set_source(Lv2cColor(1,0,0));
-    // bdcColor.set_line_width(3);
-    // bdcColor.stroke();
-
-    colorSurface.mark_dirty();
-    cairo_surface_mark_dirty(colorSurface.get());
+    GetShadowOffset(&xOffset, &yOffset, nullptr, nullptr);
 
     // debug: show the ninepatch.
     // {
@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "lv2c/Lv2cDropdownElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include "lv2c/Lv2cTypographyElement.hpp"
 #include "lv2c/Lv2cFlexGridElement.hpp"
 #include "lv2c/Lv2cSvgElement.hpp"
@@ -59,7 +60,7 @@ namespace lv2c::implementation
 
     class AnimatedDropdownElement : public Lv2cDropShadowElement
     {
-        using clock_t = std::chrono::steady_clock;
+        using clock_t = animation_clock_t;
         static constexpr int ANIMATION_DURATION = 200;
         // static constexpr int ANIMATION_DURATION = 2000;
     public:
@@ -210,6 +211,7 @@ Lv2cSize DropdownItemLayoutElement::MeasureClient(Lv2cSize clientConstraint, Lv2
 }
 Lv2cSize DropdownItemLayoutElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
     double x = 0;
     size_t childIx = 0;
     for (size_t column = 0; column < columnCounts.size(); ++column)
@@ -249,26 +251,19 @@ Lv2cSize Lv2cDropdownElement::MeasureClient(Lv2cSize clientConstraint, Lv2cSize
         {
             pangoLayout = pango_layout_new(GetPangoContext());
         }
-        PangoFontDescription *desc = gPangoContext.GetFontDescription(Style());
-
-        pango_layout_set_font_description(pangoLayout, desc);
+        const PangoFontDescription *desc = gPangoContext.GetSharedFontDescription(Style());
 
         double maxWidth = 20;
         for (auto &dropdownItem : this->DropdownItems())
         {
-            pango_layout_set_text(pangoLayout, dropdownItem.Text().c_str(), dropdownItem.Text().length());
-            pango_cairo_update_layout(context.get(), pangoLayout);
-
-            PangoRectangle pangoExtent;
-            pango_layout_get_extents(pangoLayout, nullptr, &pangoExtent);
-            double width = std::ceil(pangoExtent.width / PANGO_SCALE);
+            int textWidth, textHeight;
+            gPangoContext.GetSingleLineSize(pangoLayout, context.get(), desc, dropdownItem.Text(), false, &textWidth, &textHeight);
+            double width = std::ceil(textWidth / PANGO_SCALE);
             if (width > maxWidth)
                 maxWidth = width;
         }
         maxWidth += 4; // for good luck.
 
-        pango_font_description_free(desc);
-
         clientConstraint.Width(maxWidth + iconMeasure.Width());
 
         return super::MeasureClient(clientConstraint, clientAvailable, context);
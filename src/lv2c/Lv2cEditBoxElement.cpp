@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "lv2c/Lv2cEditBoxElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include "lv2c/Lv2cWindow.hpp"
 #include "lv2c/Lv2cLog.hpp"
 #include "lv2c/Lv2cPangoContext.hpp"
@@ -64,61 +65,8 @@ Lv2cEditBoxElement &Lv2cEditBoxElement::Text(const std::string &text)
     return *this;
 }
 
-static std::vector<std::string> splitFamilies(const std::string &text, char delimiter)
-{
-    std::vector<std::string> result;
-    std::stringstream s(text);
-    std::string line;
-    while (std::getline(s, line, delimiter))
-    {
-        size_t start = 0;
-        while (start < line.length() && line[start] == ' ')
-            ++start;
-        size_t end;
-        for (end = line.length(); end > start && line[end - 1] == ' '; --end)
-        {
-        }
-        std::string t = line.substr(start, end - start);
-        if (t.length() != 0)
-        {
-            result.push_back(t);
-        }
-    }
-    return result;
-}
 const std::string &Lv2cEditBoxElement::Text()  const { return TextProperty.get(); }
 
-std::string Lv2cEditBoxElement::GetFontFamily()
-{
-    std::string fontFamily;
-    for (Lv2cElement *element = this; element != nullptr; element = element->Parent())
-    {
-        fontFamily = element->Style().FontFamily();
-        if (fontFamily.length() != 0)
-        {
-            break;
-        }
-    }
-
-    std::vector<std::string> familyNames = splitFamilies(fontFamily, ',');
-
-    const std::set<std::string> &installedFamilies = gPangoContext.FontFamilies();
-    std::string result;
-    for (const std::string &familyName : familyNames)
-    {
-        if (installedFamilies.contains(familyName))
-        {
-            result = familyName;
-            break;
-        }
-    }
-    if (result.length() == 0)
-    {
-        result = "Serif";
-    }
-    return result;
-}
-
 Lv2cEditBoxElement::Lv2cEditBoxElement()
 {
     this->Style().HorizontalAlignment(Lv2cAlignment::Start);
@@ -142,16 +90,9 @@ Lv2cSize Lv2cEditBoxElement::MeasureClient(Lv2cSize constraint, Lv2cSize availab
         pangoLayout = pango_layout_new(GetPangoContext());
         std::string text = selectionMarkup(Text());
     }
-    PangoFontDescription *desc = GetFontDescription();
+    const PangoFontDescription *desc = GetFontDescription();
     pango_layout_set_font_description(pangoLayout, desc);
 
-    auto pangoContext = this->Window()->GetPangoContext();
-    PangoFontMetrics *metrics = pango_context_get_metrics(pangoContext,desc,nullptr);
-    double metricHeight = (pango_font_metrics_get_ascent(metrics) + pango_font_metrics_get_descent(metrics))/PANGO_SCALE;
-    (void)metricHeight;
-
-    pango_font_description_free(desc);
-
 
     double height = constraint.Height();
     if (height == 0)
@@ -210,6 +151,7 @@ Lv2cSize Lv2cEditBoxElement::MeasureClient(Lv2cSize constraint, Lv2cSize availab
 }
 Lv2cSize Lv2cEditBoxElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
     return available;
 }
 
@@ -379,52 +321,9 @@ void Lv2cEditBoxElement::OnMount()
 
 }
 
-PangoFontDescription *Lv2cEditBoxElement::GetFontDescription()
+const PangoFontDescription *Lv2cEditBoxElement::GetFontDescription()
 {
-    std::string fontFamily = GetFontFamily();
-
-    PangoFontDescription *desc = pango_font_description_new();
-
-    pango_font_description_set_family(desc, fontFamily.c_str());
-    double fontSize = this->Style().FontSize().PixelValue();
-    if (fontSize == 0)
-    {
-        fontSize = 12;
-    }
-    pango_font_description_set_size(
-        desc,
-        (gint)(fontSize * 72.0 / 96 * PANGO_SCALE));
-
-    Lv2cStyle &style = Style();
-    auto variant = style.FontVariant();
-    if (variant.has_value())
-    {
-        // cast enum class Lv2cFontVariant to enum PangoVariant!
-        PangoVariant pangoVariant = (PangoVariant)(int)(variant.value());
-        pango_font_description_set_variant(desc, pangoVariant);
-    }
-    auto vWeight = style.FontWeight();
-    if (vWeight.has_value())
-    {
-        // cast enum class Lv2cFontWeight to enum PangoWeight!
-        PangoWeight pangoWeight = (PangoWeight)(int)(vWeight.value());
-        pango_font_description_set_weight(desc, pangoWeight);
-    }
-    auto vStyle = style.FontStyle();
-    if (vStyle.has_value())
-    {
-        // cast enum class Lv2cFontStyle to enum PangoStyle.
-        PangoStyle pangoStyle = (PangoStyle)(int)(vStyle.value());
-        pango_font_description_set_style(desc, pangoStyle);
-    }
-    auto vStretch = style.FontStretch();
-    if (vStretch.has_value())
-    {
-        // cast enum class Lv2cFontStretch to enum PangoStretch.
-        PangoStretch pangoStretch = (PangoStretch)(int)(vStretch.value());
-        pango_font_description_set_stretch(desc, pangoStretch);
-    }
-    return desc;
+    return gPangoContext.GetSharedFontDescription(Style());
 }
 
 size_t Lv2cEditBoxElement::GetCharacterFromPoint(Lv2cPoint point)
@@ -22,14 +22,53 @@
 #include "lv2c/Lv2cWindow.hpp"
 #include "lv2c/Lv2cTypes.hpp"
 #include "lv2c/Lv2cContainerElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include <stdexcept>
 #include <iostream>
+#include <atomic>
 #include <numbers>
 #include "cleanup.hpp"
 #include "ss.hpp"
 
 using namespace lv2c;
 
+static std::atomic<bool> incrementalLayoutEnabled{true};
+
+static std::atomic<uint64_t> layoutCount{0};
+static std::atomic<uint64_t> partialLayoutCount{0};
+static std::atomic<uint64_t> measureRequests{0};
+static std::atomic<uint64_t> measureCacheHits{0};
+
+void Lv2cElement::EnableIncrementalLayout(bool enable)
+{
+    incrementalLayoutEnabled = enable;
+}
+bool Lv2cElement::IncrementalLayoutEnabled()
+{
+    return incrementalLayoutEnabled;
+}
+
+Lv2cElement::LayoutStatistics Lv2cElement::GetLayoutStatistics()
+{
+    LayoutStatistics result;
+    result.layouts = layoutCount.load(std::memory_order_relaxed);
+    result.partialLayouts = partialLayoutCount.load(std::memory_order_relaxed);
+    result.measureRequests = measureRequests.load(std::memory_order_relaxed);
+    result.measureCacheHits = measureCacheHits.load(std::memory_order_relaxed);
+    return result;
+}
+void Lv2cElement::CountLayout()
+{
+    layoutCount.fetch_add(1, std::memory_order_relaxed);
+}
+void Lv2cElement::ResetLayoutStatistics()
+{
+    layoutCount = 0;
+    partialLayoutCount = 0;
+    measureRequests = 0;
+    measureCacheHits = 0;
+}
+
 Lv2cElement::Lv2cElement()
 {
     this->Style().SetElement(this);
@@ -37,6 +76,7 @@ Lv2cElement::Lv2cElement()
 
 Lv2cElement::~Lv2cElement() noexcept
 {
+    LV2C_PROFILE_FORGET_ELEMENT(this);
 }
 
 // make sure sum of raddii on an edge don't exceed the length of the edge.
@@ -248,7 +288,13 @@ void Lv2cElement::Draw(Lv2cDrawingContext &dc, const Lv2cRectangle &clipBounds)
     {
         return;
     }
-    if (Style().Opacity() != 1.0)
+    LV2C_PROFILE_ELEMENT_SCOPE(Draw, this);
+    LV2C_PROFILE_DAMAGE(this, clipBounds.Intersect(this->screenDrawBounds).Area());
+    if (layer)
+    {
+        DrawLayer(dc, clipBounds);
+    }
+    else if (Style().Opacity() != 1.0)
     {
         double windowScale = Window()->WindowScale();
 
@@ -306,6 +352,120 @@ void Lv2cElement::Draw(Lv2cDrawingContext &dc, const Lv2cRectangle &clipBounds)
         }
     }
 }
+static Lv2cRectangle DeviceAlign(const Lv2cRectangle &rect, double windowScale)
+{
+    double left = std::floor(rect.Left() * windowScale);
+    double top = std::floor(rect.Top() * windowScale);
+    double right = std::ceil(rect.Right() * windowScale);
+    double bottom = std::ceil(rect.Bottom() * windowScale);
+    return Lv2cRectangle(left, top, right - left, bottom - top);
+}
+
+void Lv2cElement::DrawLayer(Lv2cDrawingContext &dc, const Lv2cRectangle &clipBounds)
+{
+    Lv2cRectangle bounds = clipBounds.Intersect(this->screenDrawBounds);
+    if (bounds.Empty())
+        return;
+
+    // The layer only covers the part of the element that is visible in its layout clip rect, so a 
+    // tall element in a scroll container doesn't get a surface the height of the whole document.
+    Lv2cRectangle visibleBounds = this->screenDrawBounds.Intersect(this->savedLayoutClipRect);
+    bounds = bounds.Intersect(visibleBounds);
+    if (bounds.Empty())
+        return;
+
+    double windowScale = Window()->WindowScale();
+
+    Lv2cRectangle deviceBounds = DeviceAlign(visibleBounds, windowScale);
+    if (!layerSurface || deviceBounds.Size() != layerDeviceBounds.Size())
+    {
+        layerSurface = Lv2cImageSurface(
+            cairo_format_t::CAIRO_FORMAT_ARGB32,
+            (int)deviceBounds.Width(),
+            (int)deviceBounds.Height());
+        layerDeviceBounds = Lv2cRectangle();
+    }
+    if (deviceBounds != layerDeviceBounds)
+    {
+        layerDeviceBounds = deviceBounds;
+        layerDirtyRect = visibleBounds;
+    }
+
+    // bring the layer up to date.
+    Lv2cRectangle dirtyRect = layerDirtyRect.Intersect(visibleBounds);
+    if (!dirtyRect.Empty())
+    {
+        // whole device pixels, so that clip edges don't blend with stale content.
+        Lv2cRectangle deviceDirtyRect = DeviceAlign(dirtyRect, windowScale);
+        dirtyRect = Lv2cRectangle(
+            deviceDirtyRect.Left() / windowScale,
+            deviceDirtyRect.Top() / windowScale,
+            deviceDirtyRect.Width() / windowScale,
+            deviceDirtyRect.Height() / windowScale);
+        {
+            Lv2cDrawingContext bdc(layerSurface);
+            bdc.translate(-layerDeviceBounds.Left(), -layerDeviceBounds.Top());
+            bdc.rectangle(deviceDirtyRect);
+            bdc.clip();
+            bdc.set_operator(cairo_operator_t::CAIRO_OPERATOR_CLEAR);
+            bdc.paint();
+            bdc.set_operator(cairo_operator_t::CAIRO_OPERATOR_OVER);
+            bdc.scale(windowScale, windowScale);
+            DrawPostOpacity(bdc, dirtyRect);
+            bdc.check_status();
+        }
+        layerSurface.flush();
+        ++layerRedrawCount;
+    }
+    layerDirtyRect = Lv2cRectangle();
+
+    // composite.
+    dc.save();
+    {
+        dc.rectangle(bounds);
+        dc.clip();
+        dc.translate(layerDeviceBounds.Left() / windowScale, layerDeviceBounds.Top() / windowScale);
+        dc.scale(1 / windowScale, 1 / windowScale);
+        dc.set_source(layerSurface, 0, 0);
+        dc.set_operator(cairo_operator_t::CAIRO_OPERATOR_OVER);
+        if (Style().Opacity() != 1.0)
+        {
+            double alpha = Style().Opacity();
+            alpha = pow(alpha, 2.2);
+            dc.paint_with_alpha(alpha);
+        }
+        else
+        {
+            dc.paint();
+        }
+    }
+    dc.restore();
+    dc.check_status();
+}
+
+void Lv2cElement::ReleaseLayer()
+{
+    layerSurface.release();
+    layerDeviceBounds = Lv2cRectangle();
+    layerDirtyRect = Lv2cRectangle();
+}
+
+Lv2cElement &Lv2cElement::Layer(bool value)
+{
+    if (value != layer)
+    {
+        layer = value;
+        ReleaseLayer();
+        Invalidate();
+    }
+    return *this;
+}
+
+bool Lv2cElement::Layer() const
+{
+    return layer;
+}
+
 void Lv2cElement::DrawPostOpacity(Lv2cDrawingContext &dc, const Lv2cRectangle &clipBounds)
 {
     if (!clipBounds.Intersects(this->screenDrawBounds))
@@ -377,6 +537,11 @@ void Lv2cElement::Unmount(Lv2cWindow *window)
         {
             window->Focus(nullptr);
         }
+        ReleaseLayer();
+        if (relayoutPending)
+        {
+            window->CancelElementLayout(this);
+        }
         this->window = nullptr;
     }
 }
@@ -405,6 +570,10 @@ void Lv2cElement::InvalidateScreenRect(const Lv2cRectangle &screenRect)
 {
     if (layoutValid)
     {
+        if (layer)
+        {
+            layerDirtyRect = layerDirtyRect.Union(screenRect.Intersect(this->screenDrawBounds));
+        }
         if (this->parentElement != nullptr)
         {
             parentElement->InvalidateScreenRect(screenRect);
@@ -428,10 +597,25 @@ void Lv2cElement::InvalidateClientRect(const Lv2cRectangle &clientRect)
 
 void Lv2cElement::InvalidateLayout()
 {
+    if (relayoutPending)
+    {
+        return;
+    }
+    bool wasLaidOut = layoutValid;
     layoutValid = false;
+    measureValid = false;
     if (parentElement)
     {
-        parentElement->InvalidateLayout();
+        if (wasLaidOut && window && IsLayoutBoundary())
+        {
+            // our size won't change, so there's no need to lay out our ancestors.
+            relayoutPending = true;
+            window->InvalidateElementLayout(this);
+        }
+        else
+        {
+            parentElement->InvalidateLayout();
+        }
     }
     else
     {
@@ -517,8 +701,79 @@ Lv2cSize Lv2cElement::MeasureClient(Lv2cSize clientConstraint, Lv2cSize clientAv
     return Lv2cSize(width, height);
 }
 
+void Lv2cElement::InvalidateMeasure()
+{
+    measureValid = false;
+    // An invalid ancestor is already going to be measured again.
+    for (Lv2cElement *ancestor = parentElement; ancestor != nullptr && ancestor->measureValid; ancestor = ancestor->parentElement)
+    {
+        ancestor->measureValid = false;
+    }
+}
+
+bool Lv2cElement::IsLayoutBoundary() const
+{
+    if (!incrementalLayoutEnabled)
+    {
+        return false;
+    }
+    const Lv2cStyle &style = Style();
+    if (style.HorizontalAlignment() == Lv2cAlignment::Stretch || style.VerticalAlignment() == Lv2cAlignment::Stretch)
+    {
+        return false;
+    }
+    auto width = style.Width();
+    auto height = style.Height();
+    if (width.isEmpty() || width.isPercent() || width.PixelValue() == 0)
+    {
+        return false;
+    }
+    if (height.isEmpty() || height.isPercent() || height.PixelValue() == 0)
+    {
+        return false;
+    }
+    // Parents call Arrange() with either the measured size or the size of the layout rectangle.
+    // Relayout can only reproduce the parent's calls if the two are the same.
+    return bounds.Width() == measure.Width() && bounds.Height() == measure.Height();
+}
+
+bool Lv2cElement::RelayoutSubtree(Lv2cDrawingContext &context)
+{
+    if (layoutValid)
+    {
+        return true;
+    }
+    partialLayoutCount.fetch_add(1, std::memory_order_relaxed);
+    Lv2cSize oldMeasure = measure;
+    Measure(savedMeasureConstraint, savedMeasureAvailable, context);
+    if (!(measure == oldMeasure))
+    {
+        // Not a boundary after all. Lay out the parent instead.
+        return false;
+    }
+    Arrange(measure, context);
+    Layout(bounds);
+    FinalizeLayout(savedLayoutClipRect, savedParentBounds, savedClippedInLayout);
+    OnLayoutComplete();
+    Invalidate();
+    return true;
+}
+
 void Lv2cElement::Measure(Lv2cSize constraint, Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Measure, this);
+    measureRequests.fetch_add(1, std::memory_order_relaxed);
+    uint64_t styleGeneration = Lv2cStyle::ClassStyleGeneration();
+    if (measureValid && incrementalLayoutEnabled && constraint == savedMeasureConstraint && available == savedMeasureAvailable && styleGeneration == savedMeasureStyleGeneration)
+    {
+        // The previous result (and any state that MeasureClient() saved for Arrange()) is still good.
+        measureCacheHits.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    savedMeasureConstraint = constraint;
+    savedMeasureAvailable = available;
+    savedMeasureStyleGeneration = styleGeneration;
+
     Lv2cStyle &style = Style();
 
     if (Style().HorizontalAlignment() != Lv2cAlignment::Stretch)
@@ -637,10 +892,12 @@ void Lv2cElement::Measure(Lv2cSize constraint, Lv2cSize available, Lv2cDrawingCo
     }
 
     SetMeasure(result);
+    measureValid = true;
 }
 
 Lv2cSize Lv2cElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
     return available;
 }
 
@@ -656,6 +913,7 @@ void Lv2cElement::FinalizeLayout(const Lv2cRectangle &layoutClipRect, const Lv2c
     this->layoutValid = true;
     this->savedLayoutClipRect = layoutClipRect; // saved in case we want to re-do layout.
     this->savedClippedInLayout = clippedInLayout;
+    this->savedParentBounds = parentBounds;
     Lv2cPoint offset = Lv2cPoint(parentBounds.Left(), parentBounds.Top());
 
     Lv2cRectangle oldBounds = this->screenDrawBounds;
@@ -686,6 +944,11 @@ void Lv2cElement::FinalizeLayout(const Lv2cRectangle &layoutClipRect, const Lv2c
         InvalidateScreenRect(oldBounds);
         InvalidateScreenRect(this->screenDrawBounds);
     }
+    if (layer)
+    {
+        // children may have moved without invalidating.
+        layerDirtyRect = this->screenDrawBounds;
+    }
     this->layoutValid = true;
 }
 
@@ -902,6 +1165,7 @@ Lv2cElement &Lv2cElement::ClearClasses()
     if (classes.size() != 0)
     {
         classes.resize(0);
+        InvalidateComputedStyle();
         InvalidateLayout();
     }
     return *this;
@@ -911,6 +1175,7 @@ Lv2cElement &Lv2cElement::AddClass(Lv2cStyle::ptr style)
     if (!style)
         return *this;
     classes.insert(classes.begin(), style);
+    InvalidateComputedStyle();
     return *this;
 }
 Lv2cElement &Lv2cElement::RemoveClass(Lv2cStyle::ptr style)
@@ -922,6 +1187,7 @@ Lv2cElement &Lv2cElement::RemoveClass(Lv2cStyle::ptr style)
         if ((*i).get() == style.get())
         {
             classes.erase(i);
+            InvalidateComputedStyle();
             break;
         }
     }
@@ -933,6 +1199,12 @@ const std::vector<Lv2cStyle::ptr> &Lv2cElement::Classes() const
     return classes;
 }
 
+void Lv2cElement::InvalidateComputedStyle()
+{
+    style.InvalidateComputedStyle();
+    InvalidateMeasure();
+}
+
 bool Lv2cElement::IsMounted() const
 {
     return this->window != nullptr;
@@ -970,6 +1242,7 @@ Lv2cElement &Lv2cElement::Classes(Lv2cStyle::ptr style)
     {
         this->classes.push_back(style);
     }
+    InvalidateComputedStyle();
     return *this;
 }
 Lv2cElement &Lv2cElement::Classes(std::vector<Lv2cStyle::ptr> styles)
@@ -983,6 +1256,7 @@ Lv2cElement &Lv2cElement::Classes(std::vector<Lv2cStyle::ptr> styles)
             this->classes.push_back(style);
         }
     }
+    InvalidateComputedStyle();
     return *this;
 }
 
@@ -1229,6 +1503,7 @@ void Lv2cElement::PartialLayout()
     }
     Lv2cDrawingContext context = window->CreateDrawingContext();
     Lv2cSize size{this->clientBounds.Width(), this->clientBounds.Height()};
+    measureValid = false;
     Measure(size, size, context);
     Arrange(size, context);
     FinalizeLayout(this->savedLayoutClipRect, this->Parent()->screenClientBounds, this->savedClippedInLayout);
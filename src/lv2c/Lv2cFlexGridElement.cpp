@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "lv2c/Lv2cFlexGridElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include "lv2c/Lv2cLog.hpp"
 
 using namespace lv2c;
@@ -477,6 +478,7 @@ Lv2cSize Lv2cFlexGridElement::MeasureClient(Lv2cSize constraint, Lv2cSize availa
 
 Lv2cSize Lv2cFlexGridElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
     Lv2cSize borderSize = this->removeThickness(available,style.Margin());
     Lv2cSize paddingSize = this->removeThickness(borderSize,style.BorderWidth());
     Lv2cSize clientSize = this->removeThickness(paddingSize,style.Padding());
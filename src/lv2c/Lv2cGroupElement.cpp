@@ -1,6 +1,7 @@
 #include "lv2c/Lv2cGroupElement.hpp"
 #include "lv2c/Lv2cTypographyElement.hpp"
 #include "lv2c/Lv2cFlexGridElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 
 using namespace lv2c;
 
@@ -24,6 +25,7 @@ Lv2cGroupElement::Lv2cGroupElement()
 
 Lv2cSize Lv2cGroupElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
     Lv2cSize result = super::Arrange(available, context);
 
     // shift the position of the typography element into the border/margin area.
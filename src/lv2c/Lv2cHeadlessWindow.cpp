@@ -0,0 +1,507 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lv2c/Lv2cHeadlessWindow.hpp"
+#include "Lv2cNativeWindow.hpp"
+#include "ss.hpp"
+#include "lv2c/Lv2cDrawingContext.hpp"
+#include <cairo/cairo.h>
+#include <pango/pangocairo.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+using namespace lv2c;
+
+namespace lv2c
+{
+    /// Native window that draws into a cairo image surface.
+    class Lv2cHeadlessNativeWindow : public Lv2cNativeWindow
+    {
+    public:
+        Lv2cHeadlessNativeWindow(
+            Lv2cWindow::ptr window,
+            Lv2cHeadlessNativeWindow *parent,
+            Lv2cCreateWindowParameters &parameters);
+        ~Lv2cHeadlessNativeWindow() override;
+
+        Lv2cNativeWindow *CreateChild(Lv2cWindow::ptr window, Lv2cCreateWindowParameters &parameters) override;
+
+        WindowHandle Handle() override { return handle; }
+        void Close() override;
+
+        void WindowTitle(const std::string &title) override { windowTitle = title; }
+        void SetMouseCursor(Lv2cCursor cursor) override { this->cursor = cursor; }
+
+        bool ProcessEvents() override;
+        bool AnimationLoop() override;
+        bool PostQuit() override
+        {
+            quitting = true;
+            return true;
+        }
+        bool Quitting() const override { return quitting; }
+        uint64_t WakeupCount() const override { return wakeupCount; }
+        void TraceEvents(bool value) override {}
+
+        cairo_surface_t *GetSurface() override { return surface; }
+        PangoContext *GetPangoContext() override { return pangoContext; }
+        void CopyArea(int64_t x, int64_t y, int64_t width, int64_t height, int64_t destX, int64_t destY) override;
+        // the image surface persists between frames, so draw into it directly, as Lv2cX11Window does.
+        bool HasBackBuffer() const override { return true; }
+
+        Lv2cSize Size() const override { return size; }
+        void Resize(int width, int height) override;
+
+        bool GrabPointer() override { return true; }
+        void UngrabPointer() override {}
+
+        void SendAnimationFrameMessage() override {}
+        void SendControlChangedMessage(int32_t control, float value) override {}
+        void SetStringProperty(const std::string &key, const std::string &value) override { properties[key] = value; }
+        void Sync() override {}
+
+        /// Animate and idle this window and its children.
+        void Frame();
+
+        Lv2cWindow::ptr GetLv2cWindow() { return cairoWindow; }
+
+    private:
+        void CreateSurface();
+        void DeleteDeadChildren();
+
+        static uint64_t nextHandle;
+
+        Lv2cWindow::ptr cairoWindow;
+        Lv2cHeadlessNativeWindow *parent = nullptr;
+        std::vector<Lv2cHeadlessNativeWindow *> childWindows;
+        WindowHandle handle;
+        Lv2cSize size;
+        Lv2cColor backgroundColor;
+        cairo_surface_t *surface = nullptr;
+        PangoContext *pangoContext = nullptr;
+        std::string windowTitle;
+        Lv2cCursor cursor = Lv2cCursor::Arrow;
+        std::map<std::string, std::string> properties;
+        bool quitting = false;
+        uint64_t wakeupCount = 0;
+    };
+}
+
+uint64_t Lv2cHeadlessNativeWindow::nextHandle = 1;
+
+Lv2cHeadlessNativeWindow::Lv2cHeadlessNativeWindow(
+    Lv2cWindow::ptr window,
+    Lv2cHeadlessNativeWindow *parent,
+    Lv2cCreateWindowParameters &parameters)
+    : cairoWindow(window),
+      parent(parent),
+      handle(nextHandle++),
+      size(parameters.size),
+      backgroundColor(parameters.backgroundColor),
+      windowTitle(parameters.title)
+{
+    if (size.Width() <= 0 || size.Height() <= 0)
+    {
+        throw std::runtime_error("Headless windows require an explicit size.");
+    }
+    if (parent)
+    {
+        parent->childWindows.push_back(this);
+    }
+    CreateSurface();
+
+    cairo_t *cr = cairo_create(surface);
+    this->pangoContext = pango_cairo_create_context(cr);
+    cairo_destroy(cr);
+
+    cairoWindow->OnX11SizeChanged(size);
+}
+
+Lv2cHeadlessNativeWindow::~Lv2cHeadlessNativeWindow()
+{
+    auto children = childWindows;
+    childWindows.resize(0);
+    for (auto child : children)
+    {
+        delete child;
+    }
+    if (cairoWindow)
+    {
+        auto t = cairoWindow;
+        cairoWindow = nullptr;
+        t->OnX11WindowClosed();
+    }
+    if (pangoContext)
+    {
+        g_object_unref(pangoContext);
+        pangoContext = nullptr;
+    }
+    if (surface)
+    {
+        cairo_surface_destroy(surface);
+        surface = nullptr;
+    }
+}
+
+Lv2cNativeWindow *Lv2cHeadlessNativeWindow::CreateChild(Lv2cWindow::ptr window, Lv2cCreateWindowParameters &parameters)
+{
+    return new Lv2cHeadlessNativeWindow(window, this, parameters);
+}
+
+void Lv2cHeadlessNativeWindow::CreateSurface()
+{
+    if (surface)
+    {
+        cairo_surface_destroy(surface);
+    }
+    surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, (int)size.Width(), (int)size.Height());
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create cairo surface.");
+    }
+    cairo_t *cr = cairo_create(surface);
+    cairo_set_source_rgb(cr, backgroundColor.R(), backgroundColor.G(), backgroundColor.B());
+    cairo_paint(cr);
+    cairo_destroy(cr);
+}
+
+void Lv2cHeadlessNativeWindow::Close()
+{
+    // Children are deleted by their parent on the next frame, as Lv2cX11Window does.
+    quitting = true;
+}
+
+void Lv2cHeadlessNativeWindow::DeleteDeadChildren()
+{
+    for (size_t i = 0; i < childWindows.size(); ++i)
+    {
+        Lv2cHeadlessNativeWindow *child = childWindows[i];
+        child->DeleteDeadChildren();
+        if (child->Quitting())
+        {
+            childWindows.erase(childWindows.begin() + i);
+            --i;
+            delete child;
+        }
+    }
+}
+
+void Lv2cHeadlessNativeWindow::Frame()
+{
+    DeleteDeadChildren();
+    ++wakeupCount;
+
+    auto children = childWindows;
+    if (cairoWindow)
+    {
+        cairoWindow->DrainWakeupEvents();
+        cairoWindow->Animate();
+    }
+    for (auto child : children)
+    {
+        child->Frame();
+    }
+    if (cairoWindow)
+    {
+        cairoWindow->Idle();
+    }
+    cairo_surface_flush(surface);
+}
+
+bool Lv2cHeadlessNativeWindow::ProcessEvents()
+{
+    // There are never any pending events; just do idle work.
+    Frame();
+    return false;
+}
+
+bool Lv2cHeadlessNativeWindow::AnimationLoop()
+{
+    constexpr auto FRAME_INTERVAL = std::chrono::duration_cast<Lv2cAnimationClock::duration>(std::chrono::microseconds(1000000 / 60));
+    while (!quitting)
+    {
+        Frame();
+        if (Lv2cAnimationClock::Manual())
+        {
+            Lv2cAnimationClock::Advance(FRAME_INTERVAL);
+        }
+    }
+    return true;
+}
+
+void Lv2cHeadlessNativeWindow::CopyArea(int64_t x, int64_t y, int64_t width, int64_t height, int64_t destX, int64_t destY)
+{
+    // mirror the clipping that XCopyArea does.
+    int64_t surfaceWidth = (int64_t)size.Width();
+    int64_t surfaceHeight = (int64_t)size.Height();
+    if (x < 0 || y < 0 || destX < 0 || destY < 0 ||
+        x + width > surfaceWidth || y + height > surfaceHeight ||
+        destX + width > surfaceWidth || destY + height > surfaceHeight ||
+        width <= 0 || height <= 0)
+    {
+        cairoWindow->OnExpose(handle, destX, destY, width, height);
+        return;
+    }
+    cairo_surface_flush(surface);
+    unsigned char *data = cairo_image_surface_get_data(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+    constexpr size_t BYTES_PER_PIXEL = 4;
+    size_t rowBytes = (size_t)width * BYTES_PER_PIXEL;
+
+    // copy rows in an order that doesn't overwrite source rows before they are copied.
+    if (destY > y)
+    {
+        for (int64_t row = height - 1; row >= 0; --row)
+        {
+            memmove(
+                data + (destY + row) * stride + destX * BYTES_PER_PIXEL,
+                data + (y + row) * stride + x * BYTES_PER_PIXEL,
+                rowBytes);
+        }
+    }
+    else
+    {
+        for (int64_t row = 0; row < height; ++row)
+        {
+            memmove(
+                data + (destY + row) * stride + destX * BYTES_PER_PIXEL,
+                data + (y + row) * stride + x * BYTES_PER_PIXEL,
+                rowBytes);
+        }
+    }
+    cairo_surface_mark_dirty_rectangle(surface, (int)destX, (int)destY, (int)width, (int)height);
+}
+
+void Lv2cHeadlessNativeWindow::Resize(int width, int height)
+{
+    Lv2cSize newSize{(double)width, (double)height};
+    if (newSize == size || width <= 0 || height <= 0)
+    {
+        return;
+    }
+    size = newSize;
+    CreateSurface();
+    if (cairoWindow)
+    {
+        cairoWindow->OnX11SizeChanged(size);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+Lv2cHeadlessWindow::Lv2cHeadlessWindow(Lv2cWindow::ptr window, const Lv2cCreateWindowParameters &parameters, bool deterministicClock)
+    : window(window), deterministicClock(deterministicClock)
+{
+    if (deterministicClock)
+    {
+        savedManualClock = Lv2cAnimationClock::Manual();
+        Lv2cAnimationClock::Manual(true);
+    }
+    window->windowParameters = parameters;
+    if (window->settings.is_null())
+    {
+        window->settings = parameters.settingsObject;
+    }
+    Lv2cCreateWindowParameters scaledParameters = Lv2cWindow::Scale(parameters, window->windowScale);
+    nativeWindow = new Lv2cHeadlessNativeWindow(window, nullptr, scaledParameters);
+    window->nativeWindow = nativeWindow;
+
+    window->MountRootElement();
+}
+
+Lv2cHeadlessWindow::~Lv2cHeadlessWindow()
+{
+    if (window->nativeWindow == nativeWindow)
+    {
+        window->nativeWindow = nullptr;
+        delete nativeWindow; // also calls OnX11WindowClosed().
+    }
+    nativeWindow = nullptr;
+    if (deterministicClock)
+    {
+        Lv2cAnimationClock::Manual(savedManualClock);
+    }
+}
+
+cairo_surface_t *Lv2cHeadlessWindow::Surface()
+{
+    return nativeWindow->GetSurface();
+}
+
+void Lv2cHeadlessWindow::WriteToPng(const std::string &filename)
+{
+    cairo_status_t status = cairo_surface_write_to_png(Surface(), filename.c_str());
+    if (status != CAIRO_STATUS_SUCCESS)
+    {
+        throw std::runtime_error(SS("Failed to write " << filename << ". " << cairo_status_to_string(status)));
+    }
+}
+
+void Lv2cHeadlessWindow::Frame()
+{
+    ++frameCount;
+    nativeWindow->Frame();
+}
+
+void Lv2cHeadlessWindow::UpdateLayout()
+{
+    window->UpdateLayout();
+}
+
+void Lv2cHeadlessWindow::AdvanceClock(clock_t::duration duration)
+{
+    Lv2cAnimationClock::Advance(duration);
+}
+
+void Lv2cHeadlessWindow::RunFor(clock_t::duration duration, clock_t::duration frameInterval)
+{
+    if (frameInterval.count() <= 0)
+    {
+        throw std::invalid_argument("frameInterval must be positive.");
+    }
+    while (duration.count() > 0)
+    {
+        clock_t::duration step = std::min(duration, frameInterval);
+        AdvanceClock(step);
+        duration -= step;
+        Frame();
+    }
+}
+
+bool Lv2cHeadlessWindow::HasPendingWork() const
+{
+    return window->HasPendingRedraw() || window->HasAnimationCallbacks() || window->NextDelayedCallbackTime().has_value();
+}
+
+int64_t Lv2cHeadlessWindow::ToDevice(double value) const
+{
+    return (int64_t)std::round(value * window->WindowScale());
+}
+
+void Lv2cHeadlessWindow::MouseMove(Lv2cPoint point, ModifierState modifierState)
+{
+    if (!window->ModalDisable())
+    {
+        window->MouseMove(nativeWindow->Handle(), ToDevice(point.x), ToDevice(point.y), modifierState);
+    }
+}
+
+void Lv2cHeadlessWindow::MouseDown(Lv2cPoint point, uint64_t button, ModifierState modifierState)
+{
+    if (!window->ModalDisable())
+    {
+        window->MouseDown(nativeWindow->Handle(), button, ToDevice(point.x), ToDevice(point.y), modifierState);
+    }
+}
+
+void Lv2cHeadlessWindow::MouseUp(Lv2cPoint point, uint64_t button, ModifierState modifierState)
+{
+    window->MouseUp(nativeWindow->Handle(), button, ToDevice(point.x), ToDevice(point.y), modifierState);
+}
+
+void Lv2cHeadlessWindow::Click(Lv2cPoint point, uint64_t button, ModifierState modifierState)
+{
+    MouseMove(point, modifierState);
+    MouseDown(point, button, modifierState);
+    MouseUp(point, button, modifierState);
+}
+
+void Lv2cHeadlessWindow::ScrollWheel(Lv2cScrollDirection direction, Lv2cPoint point, ModifierState modifierState)
+{
+    if (!window->ModalDisable())
+    {
+        window->MouseScrollWheel(nativeWindow->Handle(), direction, ToDevice(point.x), ToDevice(point.y), modifierState);
+    }
+}
+
+void Lv2cHeadlessWindow::MouseLeave()
+{
+    window->MouseLeave(nativeWindow->Handle());
+}
+
+void Lv2cHeadlessWindow::KeyDown(uint32_t keysym, ModifierState modifierState)
+{
+    if (window->ModalDisable())
+    {
+        return;
+    }
+    Lv2cKeyboardEventArgs eventArgs;
+    eventArgs.h = nativeWindow->Handle();
+    eventArgs.keysymValid = true;
+    eventArgs.keysym = keysym;
+    eventArgs.modifierState = modifierState;
+    window->OnX11KeycodeDown(eventArgs);
+    window->OnKeyDown(eventArgs);
+}
+
+void Lv2cHeadlessWindow::TypeText(const std::string &text)
+{
+    size_t i = 0;
+    while (i < text.length())
+    {
+        // split into UTF-8 characters.
+        size_t length = 1;
+        uint8_t c = (uint8_t)text[i];
+        uint32_t codePoint = c;
+        if (c >= 0xF0)
+        {
+            length = 4;
+            codePoint = c & 0x07;
+        }
+        else if (c >= 0xE0)
+        {
+            length = 3;
+            codePoint = c & 0x0F;
+        }
+        else if (c >= 0xC0)
+        {
+            length = 2;
+            codePoint = c & 0x1F;
+        }
+        length = std::min(length, text.length() - i);
+        for (size_t j = 1; j < length; ++j)
+        {
+            codePoint = (codePoint << 6) | ((uint8_t)text[i + j] & 0x3F);
+        }
+
+        if (!window->ModalDisable())
+        {
+            Lv2cKeyboardEventArgs eventArgs;
+            eventArgs.h = nativeWindow->Handle();
+            memcpy(eventArgs.text, text.data() + i, length);
+            eventArgs.text[length] = '\0';
+            eventArgs.textValid = true;
+            eventArgs.keysymValid = true;
+            // Latin-1 keysyms are the same as their code points. Others use the X11 unicode keysym range.
+            eventArgs.keysym = codePoint < 0x100 ? codePoint : 0x01000000 + codePoint;
+            window->OnKeyDown(eventArgs);
+        }
+        i += length;
+    }
+}
+
+void Lv2cHeadlessWindow::Resize(Lv2cSize size)
+{
+    nativeWindow->Resize(
+        (int)std::ceil(size.Width() * window->WindowScale()),
+        (int)std::ceil(size.Height() * window->WindowScale()));
+}
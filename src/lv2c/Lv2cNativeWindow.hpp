@@ -0,0 +1,82 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "lv2c/Lv2cWindow.hpp"
+
+typedef struct _cairo_surface cairo_surface_t;
+typedef struct _PangoContext PangoContext;
+
+namespace lv2c
+{
+    /// @brief The platform window behind a Lv2cWindow.
+    ///
+    /// Implemented by Lv2cX11Window, and by an offscreen window used by Lv2cHeadlessWindow.
+    class Lv2cNativeWindow
+    {
+    public:
+        virtual ~Lv2cNativeWindow() {}
+
+        /// @brief Create a native window for a dialog owned by this window.
+        virtual Lv2cNativeWindow *CreateChild(Lv2cWindow::ptr window, Lv2cCreateWindowParameters &parameters) = 0;
+
+        virtual WindowHandle Handle() = 0;
+        virtual void Close() = 0;
+
+        virtual void WindowTitle(const std::string &title) = 0;
+        virtual void SetMouseCursor(Lv2cCursor cursor) = 0;
+
+        /// @brief Process pending events, and perform idle work.
+        /// @returns true if any events were processed.
+        virtual bool ProcessEvents() = 0;
+        /// @brief Run the event loop until the window quits.
+        virtual bool AnimationLoop() = 0;
+        virtual bool PostQuit() = 0;
+        virtual bool Quitting() const = 0;
+        virtual uint64_t WakeupCount() const = 0;
+        virtual void TraceEvents(bool value) = 0;
+
+        virtual cairo_surface_t *GetSurface() = 0;
+        virtual PangoContext *GetPangoContext() = 0;
+        /// @brief Copy an area of the window to another location in the window (device coordinates).
+        virtual void CopyArea(int64_t x, int64_t y, int64_t width, int64_t height, int64_t destX, int64_t destY) = 0;
+
+        /// @brief True if the surface persists between frames and is shown by Present().
+        ///
+        /// Damage is then drawn directly into the surface, instead of through a temporary group.
+        virtual bool HasBackBuffer() const { return false; }
+        /// @brief Called before a frame draws into a back buffer.
+        /// Waits until the previous Present() has finished reading the surface, if necessary.
+        virtual void BeginDraw() {}
+        /// @brief Show damaged areas of the surface (device coordinates). Called once per frame.
+        virtual void Present(const std::vector<Lv2cRectangle> &deviceRectangles) {}
+
+        virtual Lv2cSize Size() const = 0;
+        virtual void Resize(int width, int height) = 0;
+
+        virtual bool GrabPointer() = 0;
+        virtual void UngrabPointer() = 0;
+
+        virtual void SendAnimationFrameMessage() = 0;
+        virtual void SendControlChangedMessage(int32_t control, float value) = 0;
+        virtual void SetStringProperty(const std::string &key, const std::string &value) = 0;
+        virtual void Sync() = 0;
+    };
+}
@@ -88,7 +88,14 @@ static std::vector<std::string> splitFamilies(const std::string &text, char deli
 
 const std::string Lv2cPangoContext::GetFontFamily(const std::string&fontFamily) const
 {
-    
+    {
+        std::lock_guard lock{cacheMutex};
+        auto f = fontFamilyCache.find(fontFamily);
+        if (f != fontFamilyCache.end())
+        {
+            return f->second;
+        }
+    }
     std::vector<std::string> familyNames = splitFamilies(fontFamily, ',');
 
     const std::set<std::string> &installedFamilies = gPangoContext.FontFamilies();
@@ -105,6 +112,10 @@ const std::string Lv2cPangoContext::GetFontFamily(const std::string&fontFamily)
     {
         result = "Serif";
     }
+    {
+        std::lock_guard lock{cacheMutex};
+        fontFamilyCache[fontFamily] = result;
+    }
     return result;
 
 }
@@ -112,50 +123,160 @@ const std::string Lv2cPangoContext::GetFontFamily(const std::string&fontFamily)
 
 PangoFontDescription*Lv2cPangoContext::GetFontDescription(Lv2cStyle&style) const
 {
-    std::string fontFamily = style.FontFamily();
-    std::string installedFont = GetFontFamily(fontFamily);
+    return pango_font_description_copy(
+        const_cast<Lv2cPangoContext*>(this)->GetSharedFontDescription(style));
+}
 
+bool Lv2cPangoContext::FontKey::operator<(const FontKey&other) const
+{
+    if (size != other.size) return size < other.size;
+    if (weight != other.weight) return weight < other.weight;
+    if (style != other.style) return style < other.style;
+    if (stretch != other.stretch) return stretch < other.stretch;
+    if (variant != other.variant) return variant < other.variant;
+    return family < other.family;
+}
 
-    PangoFontDescription *desc = pango_font_description_new();
+const PangoFontDescription*Lv2cPangoContext::GetSharedFontDescription(Lv2cStyle&style)
+{
+    FontKey key;
+    key.family = GetFontFamily(style.FontFamily());
 
-    pango_font_description_set_family(desc, installedFont.c_str());
     double fontSize = style.FontSize().PixelValue();
     if (fontSize == 0)
     {
         fontSize = 12;
     }
-    pango_font_description_set_size(
-        desc,
-        (gint)(fontSize * 72.0 / 96 * PANGO_SCALE));
+    key.size = (int)(fontSize * 72.0 / 96 * PANGO_SCALE);
 
-    auto variant = style.FontVariant();
-    if (variant.has_value())
+    // enum class Lv2cFontXxx values are the same as the corresponding PangoXxx enum values.
+    auto vVariant = style.FontVariant();
+    if (vVariant.has_value())
     {
-        // cast enum class Lv2cFontVariant to enum PangoVariant!
-        PangoVariant pangoVariant = (PangoVariant)(int)(variant.value());
-        pango_font_description_set_variant(desc, pangoVariant);
+        key.variant = (int)(vVariant.value());
     }
     auto vWeight = style.FontWeight();
     if (vWeight.has_value())
     {
-        // cast enum class Lv2cFontWeight to enum PangoWeight!
-        PangoWeight pangoWeight = (PangoWeight)(int)(vWeight.value());
-        pango_font_description_set_weight(desc, pangoWeight);
+        key.weight = (int)(vWeight.value());
     }
     auto vStyle = style.FontStyle();
     if (vStyle.has_value())
     {
-        // cast enum class Lv2cFontStyle to enum PangoStyle.
-        PangoStyle pangoStyle = (PangoStyle)(int)(vStyle.value());
-        pango_font_description_set_style(desc, pangoStyle);
+        key.style = (int)(vStyle.value());
     }
     auto vStretch = style.FontStretch();
     if (vStretch.has_value())
     {
-        // cast enum class Lv2cFontStretch to enum PangoStretch.
-        PangoStretch pangoStretch = (PangoStretch)(int)(vStretch.value());
-        pango_font_description_set_stretch(desc, pangoStretch);
+        key.stretch = (int)(vStretch.value());
+    }
+
+    std::lock_guard lock{cacheMutex};
+    auto f = fontDescriptions.find(key);
+    if (f != fontDescriptions.end())
+    {
+        return f->second;
+    }
+
+    PangoFontDescription *desc = pango_font_description_new();
+
+    pango_font_description_set_family(desc, key.family.c_str());
+    pango_font_description_set_size(desc, (gint)key.size);
+    if (key.variant != -1)
+    {
+        pango_font_description_set_variant(desc, (PangoVariant)key.variant);
+    }
+    if (key.weight != -1)
+    {
+        pango_font_description_set_weight(desc, (PangoWeight)key.weight);
+    }
+    if (key.style != -1)
+    {
+        pango_font_description_set_style(desc, (PangoStyle)key.style);
+    }
+    if (key.stretch != -1)
+    {
+        pango_font_description_set_stretch(desc, (PangoStretch)key.stretch);
     }
+    // Interned descriptions live as long as the process. The number of distinct fonts in use is small.
+    fontDescriptions[key] = desc;
     return desc;
+}
+
+size_t Lv2cPangoContext::TextKeyHash::operator()(const TextKey&key) const
+{
+    size_t h = std::hash<std::string>()(key.text);
+    h ^= std::hash<const void*>()(key.fontDescription) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= std::hash<double>()(key.scale) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h ^ (key.markup ? 1 : 0);
+}
 
+void Lv2cPangoContext::GetSingleLineSize(
+    PangoLayout*layout,
+    cairo_t*cr,
+    const PangoFontDescription*fontDescription,
+    const std::string&text,
+    bool markup,
+    int*width, int*height)
+{
+    bool cacheable = text.length() != 0 && text.length() <= MAX_TEXT_CACHE_LENGTH;
+
+    TextKey key;
+    if (cacheable)
+    {
+        // hinting can make metrics depend on the device scale.
+        cairo_matrix_t matrix;
+        cairo_get_matrix(cr, &matrix);
+
+        key.fontDescription = fontDescription;
+        key.scale = matrix.xx;
+        key.markup = markup;
+        key.text = text;
+
+        std::lock_guard lock{cacheMutex};
+        auto f = textSizes.find(key);
+        if (f != textSizes.end())
+        {
+            ++textCacheHits;
+            *width = f->second.width;
+            *height = f->second.height;
+            return;
+        }
+        ++textCacheMisses;
+    }
+    pango_layout_set_font_description(layout, fontDescription);
+    if (markup)
+    {
+        pango_layout_set_markup(layout, text.c_str(), (int)text.length());
+    }
+    else
+    {
+        pango_layout_set_text(layout, text.c_str(), (int)text.length());
+    }
+    pango_layout_set_width(layout, -1);
+    pango_layout_set_height(layout, -1);
+    pango_layout_set_ellipsize(layout, PangoEllipsizeMode::PANGO_ELLIPSIZE_NONE);
+    pango_cairo_update_layout(cr, layout);
+    pango_layout_get_size(layout, width, height);
+
+    if (cacheable)
+    {
+        std::lock_guard lock{cacheMutex};
+        if (textSizes.size() >= MAX_TEXT_CACHE_ENTRIES)
+        {
+            textSizes.clear();
+        }
+        textSizes[key] = TextSize{*width, *height};
+    }
+}
+
+Lv2cPangoContext::TextCacheStatistics Lv2cPangoContext::GetTextCacheStatistics()
+{
+    std::lock_guard lock{cacheMutex};
+    TextCacheStatistics result;
+    result.fontDescriptions = fontDescriptions.size();
+    result.entries = textSizes.size();
+    result.hits = textCacheHits;
+    result.misses = textCacheMisses;
+    return result;
 }
@@ -18,6 +18,7 @@ void Lv2cPngStripElement::Load()
     if (sourceChanged && IsMounted())
     {
         sourceChanged = false;
+        frames = nullptr;
         surface = this->Window()->GetPngImage(Source());
         if (surface)
         {
@@ -45,12 +46,62 @@ void Lv2cPngStripElement::OnMount()
     Load();
 }
 
+void Lv2cPngStripElement::OnUnmount()
+{
+    frames = nullptr;
+    super::OnUnmount();
+}
+
+bool Lv2cPngStripElement::DrawPrescaledFrame(Lv2cDrawingContext &dc, int tile)
+{
+    // Frames are resampled at a fixed device size, so only axis-aligned transforms can use them.
+    cairo_matrix_t matrix;
+    dc.get_matrix(&matrix);
+    if (matrix.xy != 0 || matrix.yx != 0 || matrix.xx <= 0 || matrix.yy <= 0)
+    {
+        return false;
+    }
+    // the tile is scaled to the width of the element (and clipped vertically).
+    Lv2cSize clientSize = ClientSize();
+    double tileHeight = clientSize.Width() * tileSize.Height() / tileSize.Width();
+    double deviceX = std::round(matrix.x0);
+    double deviceY = std::round(matrix.y0);
+    int deviceWidth = (int)std::round(clientSize.Width() * matrix.xx);
+    int deviceHeight = (int)std::round(tileHeight * matrix.yy);
+    int clipHeight = std::min(deviceHeight, (int)std::round(clientSize.Height() * matrix.yy));
+    if (deviceWidth <= 0 || clipHeight <= 0)
+    {
+        return true;
+    }
+    if (!frames || frames->DeviceWidth() != deviceWidth || frames->DeviceHeight() != deviceHeight)
+    {
+        frames = Window()->GetPngStripFrames(Source(), Lv2cSize(tileSize.Width(), tileSize.Height()), deviceWidth, deviceHeight);
+        if (!frames)
+        {
+            return false;
+        }
+    }
+    dc.save();
+    {
+        dc.identity_matrix();
+        dc.set_source(frames->Frame(tile), deviceX, deviceY);
+        dc.rectangle(deviceX, deviceY, deviceWidth, clipHeight);
+        dc.fill();
+    }
+    dc.restore();
+    return true;
+}
+
 void Lv2cPngStripElement::OnDraw(Lv2cDrawingContext &dc)
 {
     super::OnDraw(dc);
     if (surface && !tileSize.Empty())
     {
         int tile = std::round((tileCount-1) * Value());
+        if (DrawPrescaledFrame(dc, tile))
+        {
+            return;
+        }
 
         Lv2cRectangle sourceRectangle = Lv2cRectangle(0,0,tileSize.Width(),tileSize.Height());
         sourceRectangle = sourceRectangle.Translate(tileSize.Width()*tile,0);
@@ -0,0 +1,59 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lv2c/Lv2cPngStripFrames.hpp"
+#include <algorithm>
+
+using namespace lv2c;
+
+Lv2cPngStripFrames::Lv2cPngStripFrames(const Lv2cSurface &strip, Lv2cSize tileSize, int tileCount, int deviceWidth, int deviceHeight)
+    : strip(strip),
+      tileSize(tileSize),
+      deviceWidth(deviceWidth),
+      deviceHeight(deviceHeight)
+{
+    frames.resize(std::max(tileCount, 1));
+}
+
+Lv2cSurface &Lv2cPngStripFrames::Frame(int tile)
+{
+    tile = std::clamp(tile, 0, (int)frames.size() - 1);
+    Lv2cSurface &frame = frames[tile];
+    if (!frame)
+    {
+        Lv2cImageSurface surface{cairo_format_t::CAIRO_FORMAT_ARGB32, deviceWidth, deviceHeight};
+        {
+            Lv2cDrawingContext dc{surface};
+            dc.scale(deviceWidth / tileSize.Width(), deviceHeight / tileSize.Height());
+            dc.translate(-tileSize.Width() * tile, 0);
+            dc.rectangle(tileSize.Width() * tile, 0, tileSize.Width(), tileSize.Height());
+            dc.set_source(strip, 0, 0);
+            dc.fill();
+        }
+        surface.flush();
+        frame = std::move(surface);
+        ++renderedFrameCount;
+    }
+    return frame;
+}
+
+size_t Lv2cPngStripFrames::Bytes() const
+{
+    return renderedFrameCount * (size_t)cairo_format_stride_for_width(cairo_format_t::CAIRO_FORMAT_ARGB32, deviceWidth) * (size_t)deviceHeight;
+}
@@ -0,0 +1,309 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lv2c/Lv2cProfiler.hpp"
+#include "lv2c/Lv2cElement.hpp"
+#include "lv2c/Lv2cLog.hpp"
+#include "ss.hpp"
+#include <cstdio>
+#include <cxxabi.h>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace lv2c;
+
+std::atomic<bool> Lv2cProfiler::enabled{false};
+thread_local const Lv2cProfiler::Scope *Lv2cProfiler::Scope::currentElementScope = nullptr;
+
+namespace
+{
+    struct ProfilerData
+    {
+        std::mutex mutex;
+        std::vector<Lv2cProfiler::Span> spans;
+        size_t droppedSpans = 0;
+        std::map<const Lv2cElement *, Lv2cProfiler::ElementCounters> elementCounters;
+        std::atomic<bool> hasElementCounters{false};
+        Lv2cProfiler::clock_t::time_point epoch = Lv2cProfiler::clock_t::now();
+    };
+
+    ProfilerData &Data()
+    {
+        static ProfilerData data;
+        return data;
+    }
+
+    std::atomic<uint32_t> nextThreadId{1};
+    thread_local uint32_t threadId = 0;
+
+    uint32_t ThreadId()
+    {
+        if (threadId == 0)
+        {
+            threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+        }
+        return threadId;
+    }
+
+    std::string TypeName(const std::type_info *type)
+    {
+        if (!type)
+        {
+            return "";
+        }
+        int status = 0;
+        char *demangled = abi::__cxa_demangle(type->name(), nullptr, nullptr, &status);
+        if (status != 0 || !demangled)
+        {
+            return type->name();
+        }
+        std::string result = demangled;
+        free(demangled);
+        return result;
+    }
+
+    // Reads LV2C_PROFILE at startup, and writes the trace file at exit.
+    struct ProfilerEnvironment
+    {
+        ProfilerEnvironment()
+        {
+            Data(); // construct first, so that it outlives this object.
+            const char *env = getenv("LV2C_PROFILE");
+            if (!env || strcmp(env, "0") == 0 || *env == '\0')
+            {
+                return;
+            }
+            if (!Lv2cProfiler::CompiledIn())
+            {
+                LogWarning("LV2C_PROFILE is set, but profiling was not compiled in. Configure with -DLV2C_PROFILING=ON.");
+                return;
+            }
+            if (strcmp(env, "1") != 0)
+            {
+                traceFile = env;
+            }
+            Lv2cProfiler::Enable(true);
+        }
+        ~ProfilerEnvironment()
+        {
+            if (!traceFile.empty())
+            {
+                try
+                {
+                    Lv2cProfiler::WriteChromeTrace(traceFile);
+                }
+                catch (const std::exception &e)
+                {
+                    LogError(e.what());
+                }
+            }
+        }
+        std::string traceFile;
+    };
+    ProfilerEnvironment profilerEnvironment;
+}
+
+void Lv2cProfiler::Enable(bool value)
+{
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+void Lv2cProfiler::Reset()
+{
+    ProfilerData &data = Data();
+    std::lock_guard lock{data.mutex};
+    data.spans.clear();
+    data.droppedSpans = 0;
+    data.elementCounters.clear();
+    data.hasElementCounters = false;
+}
+
+std::vector<Lv2cProfiler::Span> Lv2cProfiler::GetSpans()
+{
+    ProfilerData &data = Data();
+    std::lock_guard lock{data.mutex};
+    return data.spans;
+}
+
+size_t Lv2cProfiler::DroppedSpanCount()
+{
+    ProfilerData &data = Data();
+    std::lock_guard lock{data.mutex};
+    return data.droppedSpans;
+}
+
+Lv2cProfiler::ElementCounters Lv2cProfiler::GetElementCounters(const Lv2cElement *element)
+{
+    ProfilerData &data = Data();
+    std::lock_guard lock{data.mutex};
+    auto f = data.elementCounters.find(element);
+    if (f == data.elementCounters.end())
+    {
+        return ElementCounters{};
+    }
+    return f->second;
+}
+
+std::map<const Lv2cElement *, Lv2cProfiler::ElementCounters> Lv2cProfiler::GetAllElementCounters()
+{
+    ProfilerData &data = Data();
+    std::lock_guard lock{data.mutex};
+    return data.elementCounters;
+}
+
+const char *Lv2cProfiler::PhaseName(ElementPhase phase)
+{
+    switch (phase)
+    {
+    case ElementPhase::Measure:
+        return "Measure";
+    case ElementPhase::Arrange:
+        return "Arrange";
+    case ElementPhase::Draw:
+        return "Draw";
+    default:
+        return "";
+    }
+}
+
+void Lv2cProfiler::AddSpan(const char *name, const Lv2cElement *element, ElementPhase phase, clock_t::time_point start, clock_t::time_point end)
+{
+    ProfilerData &data = Data();
+    const std::type_info *elementType = element ? &typeid(*element) : nullptr;
+    int64_t durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    std::lock_guard lock{data.mutex};
+    if (data.spans.size() < MAX_SPANS)
+    {
+        data.spans.push_back(Span{
+            name,
+            element,
+            elementType,
+            ThreadId(),
+            std::chrono::duration_cast<std::chrono::nanoseconds>(start - data.epoch).count(),
+            durationNs});
+    }
+    else
+    {
+        ++data.droppedSpans;
+    }
+    if (element && phase != ElementPhase::Unspecified)
+    {
+        ElementCounters &counters = data.elementCounters[element];
+        data.hasElementCounters = true;
+        if (counters.elementType.empty())
+        {
+            counters.elementType = TypeName(elementType);
+        }
+        switch (phase)
+        {
+        case ElementPhase::Measure:
+            ++counters.measureCount;
+            counters.measureTimeNs += durationNs;
+            break;
+        case ElementPhase::Arrange:
+            ++counters.arrangeCount;
+            counters.arrangeTimeNs += durationNs;
+            break;
+        case ElementPhase::Draw:
+            ++counters.drawCount;
+            counters.drawTimeNs += durationNs;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void Lv2cProfiler::AddDamage(const Lv2cElement *element, double area)
+{
+    ProfilerData &data = Data();
+    std::lock_guard lock{data.mutex};
+    data.elementCounters[element].damagedArea += area;
+    data.hasElementCounters = true;
+}
+
+void Lv2cProfiler::ForgetElement(const Lv2cElement *element)
+{
+    ProfilerData &data = Data();
+    if (!data.hasElementCounters)
+    {
+        return;
+    }
+    std::lock_guard lock{data.mutex};
+    data.elementCounters.erase(element);
+}
+
+void Lv2cProfiler::WriteChromeTrace(std::ostream &s)
+{
+    std::vector<Span> spans = GetSpans();
+    int pid = (int)getpid();
+
+    // Trace Event Format, "complete" (ph: X) events. Times are in microseconds.
+    s << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    std::map<const std::type_info *, std::string> typeNames;
+    bool first = true;
+    char buffer[64];
+    for (const Span &span : spans)
+    {
+        if (!first)
+        {
+            s << ",";
+        }
+        first = false;
+        s << "\n{\"name\":\"" << span.name << "\",\"cat\":\"lv2c\",\"ph\":\"X\"";
+        snprintf(buffer, sizeof(buffer), "%.3f", span.startNs / 1000.0);
+        s << ",\"ts\":" << buffer;
+        snprintf(buffer, sizeof(buffer), "%.3f", span.durationNs / 1000.0);
+        s << ",\"dur\":" << buffer;
+        s << ",\"pid\":" << pid << ",\"tid\":" << span.threadId;
+        if (span.element)
+        {
+            auto f = typeNames.find(span.elementType);
+            if (f == typeNames.end())
+            {
+                f = typeNames.insert({span.elementType, TypeName(span.elementType)}).first;
+            }
+            snprintf(buffer, sizeof(buffer), "%p", (const void *)span.element);
+            s << ",\"args\":{\"element\":\"" << f->second << "\",\"id\":\"" << buffer << "\"}";
+        }
+        s << "}";
+    }
+    s << "\n]}\n";
+}
+
+void Lv2cProfiler::WriteChromeTrace(const std::string &filename)
+{
+    std::ofstream f{filename};
+    if (!f)
+    {
+        throw std::runtime_error(SS("Can't write to " << filename));
+    }
+    WriteChromeTrace(f);
+    size_t dropped = DroppedSpanCount();
+    if (dropped != 0)
+    {
+        LogWarning(SS("Profiler trace truncated. " << dropped << " spans were dropped."));
+    }
+}
@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "lv2c/Lv2cRootElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include "lv2c/Lv2cWindow.hpp"
 
 #define XK_MISCELLANY
@@ -175,6 +176,7 @@ void Lv2cRootElement::AddPopup(std::shared_ptr<Lv2cElement> child, Lv2cElement *
 
 Lv2cSize Lv2cRootElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
     for (auto &childInfo : childInfos)
     {
 
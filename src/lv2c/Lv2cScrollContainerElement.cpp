@@ -18,7 +18,9 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "lv2c/Lv2cScrollContainerElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include "lv2c/Lv2cScrollBarElement.hpp"
+#include "lv2c/Lv2cWindow.hpp"
 #include "lv2c/Lv2cLog.hpp"
 #include <cmath>
 
@@ -167,6 +169,7 @@ Lv2cSize Lv2cScrollContainerElement::MeasureClient(Lv2cSize clientConstraint, Lv
 
 Lv2cSize Lv2cScrollContainerElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
     Lv2cRectangle marginRect{0, 0, available.Width(), available.Height()};
 
     Lv2cRectangle borderRect = this->removeThickness(marginRect, Style().Margin());
@@ -203,6 +206,7 @@ Lv2cSize Lv2cScrollContainerElement::Arrange(Lv2cSize available, Lv2cDrawingCont
             measured.Width(), measured.Height()};
         child->Layout(rectangle);
         this->childSize = measured;
+        this->layoutScrollOffset = Lv2cPoint(HorizontalScrollOffset(), VerticalScrollOffset());
     }
     else
     {
@@ -255,13 +259,100 @@ void Lv2cScrollContainerElement::RedoFinalLayout()
 {
     if (child)
     {
+        if (scrollingByBlit)
+        {
+            // scroll offset adjusted during FinalizeLayout. The outermost call scrolls by the total distance.
+            Lv2cRectangle layoutRect{-HorizontalScrollOffset(), -VerticalScrollOffset(), this->childSize.Width(), this->childSize.Height()};
+            child->Layout(layoutRect);
+            this->layoutScrollOffset = Lv2cPoint(HorizontalScrollOffset(), VerticalScrollOffset());
+            this->FinalizeLayout(this->savedLayoutClipRect, Parent()->ScreenBounds(), this->savedClippedInLayout);
+            return;
+        }
+        Lv2cPoint startOffset = this->layoutScrollOffset;
+        bool blit = CanBlitScroll();
+        scrollingByBlit = blit;
+
         // update the child's layout.
         Lv2cRectangle layoutRect{-HorizontalScrollOffset(), -VerticalScrollOffset(), this->childSize.Width(), this->childSize.Height()};
         child->Layout(layoutRect);
+        this->layoutScrollOffset = Lv2cPoint(HorizontalScrollOffset(), VerticalScrollOffset());
 
         // recompute visual rects for this and all children
         this->FinalizeLayout(this->savedLayoutClipRect, Parent()->ScreenBounds(), this->savedClippedInLayout);
+
+        if (blit)
+        {
+            scrollingByBlit = false;
+            Window()->ScrollRect(
+                ScrollViewport(),
+                startOffset.x - this->layoutScrollOffset.x,
+                startOffset.y - this->layoutScrollOffset.y);
+            // scrollbars are drawn over the viewport, and don't scroll.
+            horizontalScrollBar->Invalidate();
+            verticalScrollBar->Invalidate();
+        }
+    }
+}
+
+Lv2cRectangle Lv2cScrollContainerElement::ScrollViewport() const
+{
+    return this->savedLayoutClipRect.Intersect(ScreenClientBounds());
+}
+
+static bool RoundCornersIntersect(const Lv2cElement *element, const Lv2cRectangle &rect)
+{
+    Lv2cRoundCorners corners = element->Style().RoundCorners().PixelValue();
+    if (corners.is_empty())
+    {
+        return false;
+    }
+    const Lv2cRectangle &bounds = element->ScreenBorderRect();
+    return Lv2cRectangle(bounds.Left(), bounds.Top(), corners.topLeft, corners.topLeft).Intersects(rect) ||
+           Lv2cRectangle(bounds.Right() - corners.topRight, bounds.Top(), corners.topRight, corners.topRight).Intersects(rect) ||
+           Lv2cRectangle(bounds.Left(), bounds.Bottom() - corners.bottomLeft, corners.bottomLeft, corners.bottomLeft).Intersects(rect) ||
+           Lv2cRectangle(bounds.Right() - corners.bottomRight, bounds.Bottom() - corners.bottomRight, corners.bottomRight, corners.bottomRight).Intersects(rect);
+}
+
+bool Lv2cScrollContainerElement::CanBlitScroll() const
+{
+    if (!BlitScrolling() || !Window() || !this->layoutValid || this->savedClippedInLayout)
+    {
+        return false;
+    }
+    Lv2cRectangle viewport = ScrollViewport();
+    if (viewport.Empty())
+    {
+        return false;
+    }
+    // Everything drawn behind the viewport must look the same wherever the child is.
+    for (const Lv2cElement *element = this; element != nullptr; element = element->getParent())
+    {
+        const Lv2cStyle &style = element->Style();
+        if (element->Layer() || style.Opacity() != 1.0)
+        {
+            return false;
+        }
+        const Lv2cPattern &background = style.Background();
+        if (!background.isEmpty() && background.get_type() != cairo_pattern_type_t::CAIRO_PATTERN_TYPE_SOLID)
+        {
+            return false;
+        }
+        if (RoundCornersIntersect(element, viewport))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Lv2cScrollContainerElement::InvalidateScreenRect(const Lv2cRectangle &screenRectangle)
+{
+    if (scrollingByBlit)
+    {
+        // the viewport is redrawn by scrolling.
+        return;
     }
+    super::InvalidateScreenRect(screenRectangle);
 }
 
 bool Lv2cScrollContainerElement::ClipChildren() const
@@ -24,6 +24,7 @@
 
 #include "lv2c/Lv2cSettingsFile.hpp"
 #include "lv2c/JsonIo.hpp"
+#include "lv2c/JsonBufferReader.hpp"
 #include <fstream>
 #include <filesystem>
 #include <cstdlib>
@@ -34,13 +35,12 @@
 using namespace lv2c;
 
 
-std::filesystem::path Lv2cSettingsFile::GetSettingsPath(const std::string &identifier)
+std::filesystem::path Lv2cSettingsFile::GetSettingsDirectory(const std::string &identifier)
 {
 #ifdef __linux__ 
     std::filesystem::path home = std::getenv("HOME");
 std::filesystem::path path = home / ".config" / "io.github.rerdavies.lv2cairo" / identifier;
     std::filesystem::create_directories(path);
-    path = path / "settings.json";
     return path;
 #elif _WIN32
     // windows code goes here
@@ -55,6 +55,11 @@ std::filesystem::path path = home / ".config" / "io.github.rerdavies.lv2cairo" /
 #endif
 }
 
+std::filesystem::path Lv2cSettingsFile::GetSettingsPath(const std::string &identifier)
+{
+    return GetSettingsDirectory(identifier) / "settings.json";
+}
+
 Lv2cSettingsFile::Lv2cSettingsFile()
 {
     root = json_variant::object();
@@ -75,13 +80,15 @@ void Lv2cSettingsFile::Load(const std::string &identifier)
     {
         try {
         std::ifstream f;
-        f.open(path);
+        f.open(path, std::ios_base::binary);
         f.exceptions(std::ifstream::failbit | std::ifstream::badbit);
         if (f.is_open())
         {
-            json_reader reader(f);
+            std::string text(std::filesystem::file_size(path), '\0');
+            f.read(text.data(), (std::streamsize)text.length());
 
-            root.read(reader);
+            json_buffer_reader reader(text);
+            reader.read(&root);
 
             {
                 std::stringstream s;
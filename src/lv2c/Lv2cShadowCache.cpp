@@ -0,0 +1,121 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lv2c/Lv2cShadowCache.hpp"
+#include <functional>
+
+using namespace lv2c;
+
+static void HashCombine(size_t &seed, double value)
+{
+    seed ^= std::hash<double>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+bool Lv2cShadowCacheKey::operator==(const Lv2cShadowCacheKey &other) const
+{
+    return width == other.width &&
+           height == other.height &&
+           deviceBackground == other.deviceBackground &&
+           deviceRoundCorners.topLeft == other.deviceRoundCorners.topLeft &&
+           deviceRoundCorners.topRight == other.deviceRoundCorners.topRight &&
+           deviceRoundCorners.bottomLeft == other.deviceRoundCorners.bottomLeft &&
+           deviceRoundCorners.bottomRight == other.deviceRoundCorners.bottomRight &&
+           deviceRadius == other.deviceRadius &&
+           deviceXOffset == other.deviceXOffset &&
+           deviceYOffset == other.deviceYOffset &&
+           color == other.color &&
+           windowScale == other.windowScale;
+}
+
+size_t Lv2cShadowCacheKey::Hash() const
+{
+    size_t seed = 0;
+    HashCombine(seed, width);
+    HashCombine(seed, height);
+    HashCombine(seed, deviceBackground.Left());
+    HashCombine(seed, deviceBackground.Top());
+    HashCombine(seed, deviceBackground.Width());
+    HashCombine(seed, deviceBackground.Height());
+    HashCombine(seed, deviceRoundCorners.topLeft);
+    HashCombine(seed, deviceRoundCorners.topRight);
+    HashCombine(seed, deviceRoundCorners.bottomLeft);
+    HashCombine(seed, deviceRoundCorners.bottomRight);
+    HashCombine(seed, deviceRadius);
+    HashCombine(seed, deviceXOffset);
+    HashCombine(seed, deviceYOffset);
+    HashCombine(seed, color.R());
+    HashCombine(seed, color.G());
+    HashCombine(seed, color.B());
+    HashCombine(seed, color.A());
+    HashCombine(seed, windowScale);
+    return seed;
+}
+
+Lv2cShadowCache &Lv2cShadowCache::Instance()
+{
+    static Lv2cShadowCache instance;
+    return instance;
+}
+
+Lv2cShadowCache::Lv2cShadowCache(size_t maxBytes)
+    : cache(maxBytes)
+{
+}
+
+std::optional<Lv2cImageSurface> Lv2cShadowCache::Get(const Key &key)
+{
+    std::lock_guard lock{mutex};
+    return cache.Get(key);
+}
+
+void Lv2cShadowCache::Put(const Key &key, const Lv2cImageSurface &surface)
+{
+    std::lock_guard lock{mutex};
+    cache.Put(key, surface);
+}
+
+void Lv2cShadowCache::Clear()
+{
+    std::lock_guard lock{mutex};
+    cache.Clear();
+}
+
+void Lv2cShadowCache::MaxBytes(size_t maxBytes)
+{
+    std::lock_guard lock{mutex};
+    cache.MaxBytes(maxBytes);
+}
+
+size_t Lv2cShadowCache::MaxBytes() const
+{
+    std::lock_guard lock{mutex};
+    return cache.MaxBytes();
+}
+
+Lv2cShadowCache::Stats Lv2cShadowCache::GetStats() const
+{
+    std::lock_guard lock{mutex};
+    return cache.GetStats();
+}
+
+void Lv2cShadowCache::ResetStats()
+{
+    std::lock_guard lock{mutex};
+    cache.ResetStats();
+}
@@ -43,25 +43,18 @@ Lv2cSize Lv2cStatusTextElement::MeasureClient(Lv2cSize clientConstraint, Lv2cSiz
         if (pangoLayout == nullptr){
             pangoLayout = pango_layout_new(GetPangoContext());
         }
-        PangoFontDescription *desc = gPangoContext.GetFontDescription(Style());
-
-        pango_layout_set_font_description(pangoLayout, desc);
+        const PangoFontDescription *desc = gPangoContext.GetSharedFontDescription(Style());
 
         double maxWidth = 20; 
         for (auto &dropdownItem: this->DropdownItems())
         {
-            pango_layout_set_text(pangoLayout,dropdownItem.Text().c_str(),dropdownItem.Text().length());
-            pango_cairo_update_layout(context.get(), pangoLayout);
-
-            PangoRectangle pangoExtent;
-            pango_layout_get_extents(pangoLayout,nullptr,&pangoExtent);
-            double width = std::ceil(pangoExtent.width/PANGO_SCALE);
+            int textWidth, textHeight;
+            gPangoContext.GetSingleLineSize(pangoLayout,context.get(),desc,dropdownItem.Text(),false,&textWidth,&textHeight);
+            double width = std::ceil(textWidth/PANGO_SCALE);
             if (width > maxWidth) maxWidth = width;
         }
         maxWidth += 4; // for good luck.
 
-        pango_font_description_free(desc);
-
         clientConstraint.Width(maxWidth);
 
         return super::MeasureClient(clientConstraint,clientAvailable,context);
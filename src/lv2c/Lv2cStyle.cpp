@@ -23,6 +23,151 @@
 
 using namespace lv2c;
 
+static std::atomic<bool> computedStyleCacheEnabled{true};
+// Incremented whenever a style that isn't attached to an element (i.e. a class) changes.
+static std::atomic<uint64_t> classStyleGeneration{1};
+
+static std::atomic<uint64_t> lookupRequests{0};
+static std::atomic<uint64_t> lookupSearches{0};
+static std::atomic<uint64_t> lookupCacheHits{0};
+
+void Lv2cStyle::EnableComputedStyleCache(bool enable)
+{
+    computedStyleCacheEnabled = enable;
+    ++classStyleGeneration;
+}
+bool Lv2cStyle::ComputedStyleCacheEnabled()
+{
+    return computedStyleCacheEnabled;
+}
+uint64_t Lv2cStyle::ClassStyleGeneration()
+{
+    return classStyleGeneration.load(std::memory_order_relaxed);
+}
+
+Lv2cStyle::LookupStatistics Lv2cStyle::GetLookupStatistics()
+{
+    LookupStatistics result;
+    result.requests = lookupRequests.load(std::memory_order_relaxed);
+    result.lookups = lookupSearches.load(std::memory_order_relaxed);
+    result.cacheHits = lookupCacheHits.load(std::memory_order_relaxed);
+    return result;
+}
+void Lv2cStyle::ResetLookupStatistics()
+{
+    lookupRequests = 0;
+    lookupSearches = 0;
+    lookupCacheHits = 0;
+}
+
+const void *Lv2cStyle::ComputedStyleCache::Find(uint64_t generation, uint32_t key) const
+{
+    if (generation != this->generation)
+    {
+        return nullptr;
+    }
+    for (const auto &entry : entries)
+    {
+        if (entry.first == key)
+        {
+            return entry.second;
+        }
+    }
+    return nullptr;
+}
+
+void Lv2cStyle::ComputedStyleCache::Add(uint64_t generation, uint32_t key, const void *value)
+{
+    if (generation != this->generation)
+    {
+        entries.resize(0);
+        this->generation = generation;
+    }
+    entries.push_back(std::pair<uint32_t, const void *>(key, value));
+}
+
+void Lv2cStyle::ComputedStyleCache::Clear()
+{
+    entries.resize(0);
+    generation = 0;
+}
+
+void Lv2cStyle::InvalidateComputedStyle()
+{
+    computedStyle.Clear();
+}
+
+void Lv2cStyle::Modified()
+{
+    if (element)
+    {
+        // inherited values of descendants may have changed too.
+        element->InvalidateComputedStyle();
+    }
+    else
+    {
+        // a class, which may be shared by any number of elements.
+        ++classStyleGeneration;
+    }
+}
+
+// Search the style, the element's classes, and optionally the styles of parent elements.
+// Returns a pointer to the member that supplies the value, or to this style's (unset) member if
+// none does.
+template <typename T, typename IS_SET>
+const T *Lv2cStyle::ResolveMember(T Lv2cStyle::*pMember, bool inherit, IS_SET isSet) const
+{
+    lookupRequests.fetch_add(1, std::memory_order_relaxed);
+
+    const T *result = &(this->*pMember);
+    if (!this->element)
+    {
+        return result;
+    }
+    uint32_t key = (uint32_t)(((const char *)result - (const char *)this) * 2 + (inherit ? 1 : 0));
+    uint64_t generation = classStyleGeneration.load(std::memory_order_relaxed);
+
+    bool cacheEnabled = computedStyleCacheEnabled.load(std::memory_order_relaxed);
+    if (cacheEnabled)
+    {
+        const void *cached = computedStyle.Find(generation, key);
+        if (cached)
+        {
+            lookupCacheHits.fetch_add(1, std::memory_order_relaxed);
+            return (const T *)cached;
+        }
+    }
+    lookupSearches.fetch_add(1, std::memory_order_relaxed);
+
+    if (!isSet(*result))
+    {
+        bool found = false;
+        for (const auto &class_ : element->Classes())
+        {
+            const T *classResult = &(class_.get()->*pMember);
+            if (isSet(*classResult))
+            {
+                result = classResult;
+                found = true;
+                break;
+            }
+        }
+        if (!found && inherit && element->Parent())
+        {
+            const T *parentResult = element->Parent()->Style().ResolveMember(pMember, true, isSet);
+            if (isSet(*parentResult))
+            {
+                result = parentResult;
+            }
+        }
+    }
+    if (cacheEnabled)
+    {
+        computedStyle.Add(generation, key, result);
+    }
+    return result;
+}
+
 template <typename T>
 T Lv2cStyle::FromSelfOrClassesOrParent(InheritOptionalPtr<T> pMember, T defaultValue) const
 {
@@ -47,101 +192,105 @@ void Lv2cStyle::SetVerticalStyleContext(double height)
 template <typename T>
 T Lv2cStyle::FromSelfOrClassesT(std::optional<T> Lv2cStyle::*pMember, T defaultValue) const
 {
-    const std::optional<T> &result = (this->*pMember);
+    const std::optional<T> &result = *ResolveMember(pMember, false, [](const std::optional<T> &v)
+                                                    { return v.has_value(); });
     if (result.has_value())
     {
         return result.value();
     }
-    if (this->element)
-    {
-
-        for (const auto &class_ : element->Classes())
-        {
-            const std::optional<T> &classResult = (class_.get()->*pMember);
-            if (classResult.has_value())
-            {
-                return classResult.value();
-            }
-        }
-    }
     return defaultValue;
 }
 
 Lv2cStyle &Lv2cStyle::Margin(const Lv2cThicknessMeasurement &value)
 {
     margin = value;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::BorderWidth(const Lv2cThicknessMeasurement &value)
 {
     borderWidth = value;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::Padding(const Lv2cThicknessMeasurement &value)
 {
     padding = value;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::CellPadding(const Lv2cThicknessMeasurement &value)
 {
     cellPadding = value;
+    Modified();
     return *this;
 }
 
 Lv2cStyle &Lv2cStyle::BorderColor(const Lv2cPattern &pattern)
 {
     borderColor = pattern;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::Background(const Lv2cPattern &pattern)
 {
     background = pattern;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::Color(const Lv2cPattern &pattern)
 {
     color = pattern;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::TintColor(const Lv2cPattern &pattern)
 {
     tintColor = pattern;
+    Modified();
     return *this;
 }
 
 Lv2cStyle &Lv2cStyle::Left(const Lv2cMeasurement &value)
 {
     left = value;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::Top(const Lv2cMeasurement &value)
 {
     top = value;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::Right(const Lv2cMeasurement &value)
 {
     right = value;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::Bottom(const Lv2cMeasurement &value)
 {
     bottom = value;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::Width(const Lv2cMeasurement &value)
 {
     width = value;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::Height(const Lv2cMeasurement &value)
 {
     height = value;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::FontSize(const Lv2cMeasurement &value)
 {
     fontSize = value;
+    Modified();
     return *this;
 }
 
@@ -267,6 +416,7 @@ const Lv2cPattern &Lv2cStyle::TintColor() const
 Lv2cStyle &Lv2cStyle::FontFamily(const std::string &value)
 {
     this->fontFamily = value;
+    Modified();
     return *this;
 }
 
@@ -285,11 +435,13 @@ void Lv2cStyle::SetElement(Lv2cElement *element)
 Lv2cStyle &Lv2cStyle::HorizontalAlignment(Lv2cAlignment alignment)
 {
     horizontalAlignment = alignment;
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::VerticalAlignment(Lv2cAlignment alignment)
 {
     verticalAlignment = alignment;
+    Modified();
     return *this;
 }
 Lv2cAlignment Lv2cStyle::HorizontalAlignment() const
@@ -310,6 +462,7 @@ Lv2cStyle &Lv2cStyle::Visibility(Lv2cVisibility visibility)
         this->visibility = visibility;
 
         bool hasLayout = this->visibility != Lv2cVisibility::Collapsed;
+        Modified();
         if (element)
         {
             if (hasLayout != hadLayout)
@@ -327,223 +480,59 @@ Lv2cStyle &Lv2cStyle::Visibility(Lv2cVisibility visibility)
 
 const Lv2cMeasurement &Lv2cStyle::FromSelfOrClasses(InheritMeasurementPtr pMember) const
 {
-    const Lv2cMeasurement &result = (this->*pMember);
-    if (result.isEmpty())
-    {
-        if (this->element)
-        {
-
-            for (const auto &class_ : element->Classes())
-            {
-                const Lv2cMeasurement &classResult = (class_.get()->*pMember);
-                if (!classResult.isEmpty())
-                {
-                    return classResult;
-                }
-            }
-        }
-    }
-    return result;
+    return *ResolveMember(pMember, false, [](const Lv2cMeasurement &v)
+                          { return !v.isEmpty(); });
 }
 
 const Lv2cMeasurement &Lv2cStyle::FromSelfOrClassesOrParent(InheritMeasurementPtr pMember) const
 {
-    const Lv2cMeasurement &result = (this->*pMember);
-    if (result.isEmpty())
-    {
-        if (this->element)
-        {
-
-            for (const auto &class_ : element->Classes())
-            {
-                const Lv2cMeasurement &classResult = (class_.get()->*pMember);
-                if (!classResult.isEmpty())
-                {
-                    return classResult;
-                }
-            }
-
-            if (element->Parent())
-            {
-                const Lv2cMeasurement &parentResult = element->Parent()->Style().FromSelfOrClassesOrParent(pMember);
-                if (!parentResult.isEmpty())
-                {
-                    return parentResult;
-                }
-            }
-        }
-    }
-    return result;
+    return *ResolveMember(pMember, true, [](const Lv2cMeasurement &v)
+                          { return !v.isEmpty(); });
 }
 
 const Lv2cPattern &Lv2cStyle::FromSelfOrClasses(InheritPatternPtr pMember) const
 {
-    const Lv2cPattern &result = (this->*pMember);
-    if (result.isEmpty())
-    {
-        if (this->element)
-        {
-
-            for (const auto &class_ : element->Classes())
-            {
-                const Lv2cPattern &classResult = (class_.get()->*pMember);
-                if (!classResult.isEmpty())
-                {
-                    return classResult;
-                }
-            }
-        }
-    }
-    return result;
+    return *ResolveMember(pMember, false, [](const Lv2cPattern &v)
+                          { return !v.isEmpty(); });
 }
 
 const Lv2cPattern &Lv2cStyle::FromSelfOrClassesOrParent(InheritPatternPtr pMember) const
 {
-    const Lv2cPattern &result = (this->*pMember);
-    if (result.isEmpty())
-    {
-        if (this->element)
-        {
-
-            for (const auto &class_ : element->Classes())
-            {
-                const Lv2cPattern &classResult = (class_.get()->*pMember);
-                if (!classResult.isEmpty())
-                {
-                    return classResult;
-                }
-            }
-
-            if (element->Parent())
-            {
-                const Lv2cPattern &parentResult = element->Parent()->Style().FromSelfOrClassesOrParent(pMember);
-                if (!parentResult.isEmpty())
-                {
-                    return parentResult;
-                }
-            }
-        }
-    }
-    return result;
+    return *ResolveMember(pMember, true, [](const Lv2cPattern &v)
+                          { return !v.isEmpty(); });
 }
 
 const std::string &Lv2cStyle::FromSelfOrClassesOrParent(InheritStringPtr pMember) const
 {
-    const std::string &result = (this->*pMember);
-    if (result.length() == 0)
-    {
-        if (this->element)
-        {
-
-            for (const auto &class_ : element->Classes())
-            {
-                const std::string &classResult = (class_.get()->*pMember);
-                if (classResult.length() != 0)
-                {
-                    return classResult;
-                }
-            }
-
-            if (element->Parent())
-            {
-                const std::string &parentResult = element->Parent()->Style().FromSelfOrClassesOrParent(pMember);
-                if (parentResult.length() != 0)
-                {
-                    return parentResult;
-                }
-            }
-        }
-    }
-    return result;
+    return *ResolveMember(pMember, true, [](const std::string &v)
+                          { return v.length() != 0; });
 }
 
 template <typename T>
 inline std::shared_ptr<T> Lv2cStyle::FromSelfOrClassesOrParent(InheritOptionalSharedPtr<T> pMember) const
 {
-    std::shared_ptr<T> result = (this->*pMember);
-    if (!result)
-    {
-        if (this->element)
-        {
-
-            for (const auto &class_ : element->Classes())
-            {
-                std::shared_ptr<T> classResult = (class_.get()->*pMember);
-                if (classResult)
-                {
-                    return classResult;
-                }
-            }
-
-            if (element->Parent())
-            {
-                const std::shared_ptr<T> parentResult = element->Parent()->Style().FromSelfOrClassesOrParent(pMember);
-                if (parentResult)
-                {
-                    return parentResult;
-                }
-            }
-        }
-    }
-    return result;
+    return *ResolveMember(pMember, true, [](const std::shared_ptr<T> &v)
+                          { return (bool)v; });
 }
 
 template <typename T>
 inline std::optional<T> Lv2cStyle::FromSelfOrClassesOrParent(Lv2cStyle::InheritOptionalPtr<T> pMember) const
 {
-    std::optional<T> result = (this->*pMember);
-    if (!result.has_value())
-    {
-        if (this->element)
-        {
-
-            for (const auto &class_ : element->Classes())
-            {
-                std::optional<T> classResult = (class_.get()->*pMember);
-                if (classResult.has_value())
-                {
-                    return classResult;
-                }
-            }
-
-            if (element->Parent())
-            {
-                const std::optional<T> parentResult = element->Parent()->Style().FromSelfOrClassesOrParent(pMember);
-                if (parentResult.has_value())
-                {
-                    return parentResult;
-                }
-            }
-        }
-    }
-    return result;
+    return *ResolveMember(pMember, true, [](const std::optional<T> &v)
+                          { return v.has_value(); });
 }
 
 template <typename T>
 inline std::optional<T> Lv2cStyle::FromSelfOrClasses(Lv2cStyle::InheritOptionalPtr<T> pMember) const
 {
-    std::optional<T> result = (this->*pMember);
-    if (!result.has_value())
-    {
-        if (this->element)
-        {
-
-            for (const auto &class_ : element->Classes())
-            {
-                std::optional<T> classResult = (class_.get()->*pMember);
-                if (classResult.has_value())
-                {
-                    return classResult;
-                }
-            }
-        }
-    }
-    return result;
+    return *ResolveMember(pMember, false, [](const std::optional<T> &v)
+                          { return v.has_value(); });
 }
 template <typename T>
 inline T Lv2cStyle::FromSelfOrClasses(Lv2cStyle::InheritOptionalPtr<T> pMember, T defaultValue) const
 {
-    std::optional<T> result = FromSelfOrClasses(pMember);
+    const std::optional<T> &result = *ResolveMember(pMember, false, [](const std::optional<T> &v)
+                                                    { return v.has_value(); });
     if (!result.has_value())
     {
         return defaultValue;
@@ -554,6 +543,7 @@ inline T Lv2cStyle::FromSelfOrClasses(Lv2cStyle::InheritOptionalPtr<T> pMember,
 Lv2cStyle &Lv2cStyle::TextAlign(Lv2cTextAlign value)
 {
     this->textAlign = value;
+    Modified();
     return *this;
 }
 std::optional<Lv2cTextAlign> Lv2cStyle::TextAlignOptional() const
@@ -596,6 +586,7 @@ std::optional<Lv2cFontVariant> Lv2cStyle::FontVariant()
 Lv2cStyle &Lv2cStyle::FlexDirection(Lv2cFlexDirection flexDirection)
 {
     this->flexDirection = flexDirection;
+    Modified();
     return *this;
 }
 Lv2cFlexDirection Lv2cStyle::FlexDirection() const
@@ -606,6 +597,7 @@ Lv2cFlexDirection Lv2cStyle::FlexDirection() const
 Lv2cStyle &Lv2cStyle::FlexWrap(Lv2cFlexWrap flexWrap)
 {
     this->flexWrap = flexWrap;
+    Modified();
     return *this;
 }
 
@@ -617,6 +609,7 @@ Lv2cFlexWrap Lv2cStyle::FlexWrap() const
 Lv2cStyle &Lv2cStyle::FlexJustification(Lv2cFlexJustification flexJustification)
 {
     this->flexJustification = flexJustification;
+    Modified();
     return *this;
 }
 
@@ -629,6 +622,7 @@ Lv2cFlexJustification Lv2cStyle::FlexJustification() const
 Lv2cStyle &Lv2cStyle::FlexOverflowJustification(Lv2cFlexOverflowJustification flexOverflowJustification)
 {
     this->flexOverflowJustification = flexOverflowJustification;
+    Modified();
     return *this;
 }
 
@@ -640,6 +634,7 @@ Lv2cFlexOverflowJustification Lv2cStyle::FlexOverflowJustification() const
 Lv2cStyle &Lv2cStyle::FlexAlignItems(Lv2cAlignment flexAlignItems)
 {
     this->flexAlignItems = flexAlignItems;
+    Modified();
     return *this;
 }
 Lv2cAlignment Lv2cStyle::FlexAlignItems() const
@@ -650,9 +645,10 @@ Lv2cAlignment Lv2cStyle::FlexAlignItems() const
 Lv2cStyle &Lv2cStyle::Theme(std::shared_ptr<Lv2cTheme> theme)
 {
     this->theme = theme;
+    Modified();
     return *this;
 }
-static Lv2cTheme::ptr defaultTheme = Lv2cTheme::Create();
+static Lv2cTheme::ptr defaultTheme = Lv2cTheme::GetShared();
 
 const Lv2cTheme &Lv2cStyle::Theme() const
 {
@@ -667,6 +663,7 @@ const Lv2cTheme &Lv2cStyle::Theme() const
 Lv2cStyle &Lv2cStyle::RoundCorners(const Lv2cRoundCornersMeasurement &value)
 {
     this->roundCorners = value;
+    Modified();
     return *this;
 }
 Lv2cRoundCornersMeasurement Lv2cStyle::RoundCorners() const
@@ -684,6 +681,7 @@ Lv2cRoundCornersMeasurement Lv2cStyle::RoundCorners() const
 Lv2cStyle &Lv2cStyle::Opacity(double value)
 {
     this->opacity = value;
+    Modified();
     return *this;
 }
 double Lv2cStyle::Opacity() const
@@ -698,6 +696,7 @@ Lv2cStyle &Lv2cStyle::MarginLeft(const Lv2cMeasurement &value)
         margin = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     margin.value().Left(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::MarginTop(const Lv2cMeasurement &value)
@@ -707,6 +706,7 @@ Lv2cStyle &Lv2cStyle::MarginTop(const Lv2cMeasurement &value)
         margin = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     margin.value().Top(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::MarginRight(const Lv2cMeasurement &value)
@@ -716,6 +716,7 @@ Lv2cStyle &Lv2cStyle::MarginRight(const Lv2cMeasurement &value)
         margin = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     margin.value().Right(value);
+    Modified();
     return *this;
 }
 
@@ -727,6 +728,7 @@ Lv2cStyle &Lv2cStyle::MarginStart(const Lv2cMeasurement &value)
     }
     // stubbed in for now.
     margin.value().Left(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::MarginEnd(const Lv2cMeasurement &value)
@@ -737,6 +739,7 @@ Lv2cStyle &Lv2cStyle::MarginEnd(const Lv2cMeasurement &value)
     }
     // stubbed in for now.
     margin.value().Right(value);
+    Modified();
     return *this;
 }
 
@@ -747,6 +750,7 @@ Lv2cStyle &Lv2cStyle::MarginBottom(const Lv2cMeasurement &value)
         margin = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     margin.value().Bottom(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::BorderWidthLeft(const Lv2cMeasurement &value)
@@ -756,6 +760,7 @@ Lv2cStyle &Lv2cStyle::BorderWidthLeft(const Lv2cMeasurement &value)
         borderWidth = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     borderWidth.value().Left(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::BorderWidthTop(const Lv2cMeasurement &value)
@@ -765,6 +770,7 @@ Lv2cStyle &Lv2cStyle::BorderWidthTop(const Lv2cMeasurement &value)
         borderWidth = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     borderWidth.value().Top(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::BorderWidthRight(const Lv2cMeasurement &value)
@@ -774,6 +780,7 @@ Lv2cStyle &Lv2cStyle::BorderWidthRight(const Lv2cMeasurement &value)
         borderWidth = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     borderWidth.value().Right(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::BorderWidthStart(const Lv2cMeasurement &value)
@@ -783,6 +790,7 @@ Lv2cStyle &Lv2cStyle::BorderWidthStart(const Lv2cMeasurement &value)
         borderWidth = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     borderWidth.value().Left(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::BorderWidthEnd(const Lv2cMeasurement &value)
@@ -792,6 +800,7 @@ Lv2cStyle &Lv2cStyle::BorderWidthEnd(const Lv2cMeasurement &value)
         borderWidth = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     borderWidth.value().Right(value);
+    Modified();
     return *this;
 }
 
@@ -802,6 +811,7 @@ Lv2cStyle &Lv2cStyle::BorderWidthBottom(const Lv2cMeasurement &value)
         borderWidth = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     borderWidth.value().Bottom(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::PaddingLeft(const Lv2cMeasurement &value)
@@ -811,6 +821,7 @@ Lv2cStyle &Lv2cStyle::PaddingLeft(const Lv2cMeasurement &value)
         padding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     padding.value().Left(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::PaddingTop(const Lv2cMeasurement &value)
@@ -820,6 +831,7 @@ Lv2cStyle &Lv2cStyle::PaddingTop(const Lv2cMeasurement &value)
         padding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     padding.value().Top(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::PaddingRight(const Lv2cMeasurement &value)
@@ -829,6 +841,7 @@ Lv2cStyle &Lv2cStyle::PaddingRight(const Lv2cMeasurement &value)
         padding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     padding.value().Right(value);
+    Modified();
     return *this;
 }
 
@@ -839,6 +852,7 @@ Lv2cStyle &Lv2cStyle::PaddingStart(const Lv2cMeasurement &value)
         padding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     padding.value().Left(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::PaddingEnd(const Lv2cMeasurement &value)
@@ -848,6 +862,7 @@ Lv2cStyle &Lv2cStyle::PaddingEnd(const Lv2cMeasurement &value)
         padding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     padding.value().Right(value);
+    Modified();
     return *this;
 }
 
@@ -858,12 +873,14 @@ Lv2cStyle &Lv2cStyle::PaddingBottom(const Lv2cMeasurement &value)
         padding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     padding.value().Bottom(value);
+    Modified();
     return *this;
 }
 
 Lv2cStyle &Lv2cStyle::RowGap(const Lv2cMeasurement &value)
 {
     flexRowGap = value;
+    Modified();
     return *this;
 }
 Lv2cMeasurement Lv2cStyle::RowGap() const
@@ -876,6 +893,7 @@ Lv2cMeasurement Lv2cStyle::RowGap() const
 Lv2cStyle &Lv2cStyle::ColumnGap(const Lv2cMeasurement &value)
 {
     flexColumnGap = value;
+    Modified();
     return *this;
 }
 Lv2cMeasurement Lv2cStyle::ColumnGap() const
@@ -888,6 +906,7 @@ Lv2cMeasurement Lv2cStyle::ColumnGap() const
 Lv2cStyle &Lv2cStyle::SingleLine(bool value)
 {
     this->singleLine = value;
+    Modified();
     return *this;
 }
 bool Lv2cStyle::SingleLine() const
@@ -898,6 +917,7 @@ bool Lv2cStyle::SingleLine() const
 Lv2cStyle &Lv2cStyle::Ellipsize(Lv2cEllipsizeMode ellipsize)
 {
     this->ellipsizeMode = ellipsize;
+    Modified();
     return *this;
 }
 Lv2cEllipsizeMode Lv2cStyle::Ellipsize() const
@@ -911,13 +931,17 @@ double Lv2cStyle::LineSpacing() const {
 
 Lv2cStyle&Lv2cStyle::LineSpacing(double value)
 {
-    this->lineSpacing = value; return *this;
+    this->lineSpacing = value;
+    Modified();
+    return *this;
 }
 
 
 Lv2cStyle&Lv2cStyle::TextTransform(Lv2cTextTransform value)
 {
-    this->textTransform = value; return *this;
+    this->textTransform = value;
+    Modified();
+    return *this;
 }
 Lv2cTextTransform Lv2cStyle::TextTransform() const
 {
@@ -927,6 +951,7 @@ Lv2cTextTransform Lv2cStyle::TextTransform() const
 Lv2cStyle&Lv2cStyle::IconSize(const std::optional<double>& value)
 {
     this->iconSize = value;
+    Modified();
     return *this;
 }
 double Lv2cStyle::IconSize() const
@@ -936,6 +961,7 @@ double Lv2cStyle::IconSize() const
 Lv2cStyle&Lv2cStyle::MinWidth(const std::optional<Lv2cMeasurement>& value)
 {
     this->minWidth = value;
+    Modified();
     return *this;
 }
 std::optional<Lv2cMeasurement> Lv2cStyle::MinWidth() const
@@ -952,6 +978,7 @@ std::optional<Lv2cMeasurement> Lv2cStyle::MinWidth() const
 Lv2cStyle&Lv2cStyle::MaxWidth(const std::optional<Lv2cMeasurement>& value)
 {
     this->maxWidth = value;
+    Modified();
     return *this;
 }
 std::optional<Lv2cMeasurement> Lv2cStyle::MaxWidth() const
@@ -967,6 +994,7 @@ std::optional<Lv2cMeasurement> Lv2cStyle::MaxWidth() const
 Lv2cStyle& Lv2cStyle::Cursor(const std::optional<Lv2cCursor> & value)
 {
     this->cursor = value;
+    Modified();
     return *this;
 }
 std::optional<Lv2cCursor> Lv2cStyle::Cursor() const
@@ -984,6 +1012,7 @@ Lv2cStyle &Lv2cStyle::CellPaddingLeft(const Lv2cMeasurement &value)
         cellPadding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     cellPadding.value().Left(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::CellPaddingTop(const Lv2cMeasurement &value)
@@ -993,6 +1022,7 @@ Lv2cStyle &Lv2cStyle::CellPaddingTop(const Lv2cMeasurement &value)
         cellPadding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     cellPadding.value().Top(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::CellPaddingRight(const Lv2cMeasurement &value)
@@ -1002,6 +1032,7 @@ Lv2cStyle &Lv2cStyle::CellPaddingRight(const Lv2cMeasurement &value)
         cellPadding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     cellPadding.value().Right(value);
+    Modified();
     return *this;
 }
 
@@ -1012,6 +1043,7 @@ Lv2cStyle &Lv2cStyle::CellPaddingStart(const Lv2cMeasurement &value)
         cellPadding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     cellPadding.value().Left(value);
+    Modified();
     return *this;
 }
 Lv2cStyle &Lv2cStyle::CellPaddingEnd(const Lv2cMeasurement &value)
@@ -1021,6 +1053,7 @@ Lv2cStyle &Lv2cStyle::CellPaddingEnd(const Lv2cMeasurement &value)
         cellPadding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     cellPadding.value().Right(value);
+    Modified();
     return *this;
 }
 
@@ -1031,6 +1064,7 @@ Lv2cStyle &Lv2cStyle::CellPaddingBottom(const Lv2cMeasurement &value)
         cellPadding = Lv2cThicknessMeasurement(0, 0, 0, 0);
     }
     cellPadding.value().Bottom(value);
+    Modified();
     return *this;
 }
 
@@ -178,6 +178,7 @@ void Lv2cSvg::render(Lv2cDrawingContext &context, const Lv2cRectangle &viewport)
     rc.y = viewport.Top();
     rc.width = viewport.Width();
     rc.height = viewport.Height();
+    std::lock_guard lock{renderMutex};
     if (!rsvg_handle_render_document(this->handle, context.get(), &rc, &error))
     {
         throw std::runtime_error(SS(error->message << "(" << error->code << ")"));
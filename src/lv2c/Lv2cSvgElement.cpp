@@ -21,6 +21,7 @@
 #include "lv2c/Lv2cWindow.hpp"
 #include "lv2c/Lv2cLog.hpp"
 #include <numbers>
+#include <cmath>
 #include "ss.hpp"
 #include "lv2c/Lv2cSvg.hpp"
 
@@ -74,55 +75,132 @@ Lv2cSize Lv2cSvgElement::MeasureClient(Lv2cSize clientConstraint, Lv2cSize clien
 
 
 
-void Lv2cSvgElement::Lv2cSvgElement::OnDraw(Lv2cDrawingContext &dc)
+void Lv2cSvgElement::RenderImage(Lv2cDrawingContext &dc, const Lv2cSize &size, double rotation, const Lv2cPattern &tintColor)
 {
-    super::OnDraw(dc);
-    Lv2cSize size = measuredImageSize;
-
     Lv2cRectangle imageBounds(
         0,0,
         size.Width(),
         size.Height());
 
-    double rotation = Rotation();
-    if (image)
+    if (rotation != 0)
     {
-        Lv2cPattern tintColor = Style().TintColor();
-        if (rotation != 0)
+        dc.save();
+        dc.translate(size.Width()/2,size.Height()/2);
+        dc.rotate(rotation*std::numbers::pi/180.0);;
+        dc.translate(-size.Width()/2,-size.Height()/2);
+    }
+
+    if (tintColor.isEmpty())
+    {
+        image->render(dc,imageBounds);
+    } else {
+        if (dc.status() != cairo_status_t::CAIRO_STATUS_SUCCESS)
         {
-            dc.save();
-            dc.translate(size.Width()/2,size.Height()/2);
-            dc.rotate(rotation*std::numbers::pi/180.0);;
-            dc.translate(-size.Width()/2,-size.Height()/2);
+            throw std::runtime_error(SS("Lv2c: " << Lv2cStatusMessage(dc.status())));
         }
-
-        if (tintColor.isEmpty())
+        dc.push_group();
+        if (dc.status() != cairo_status_t::CAIRO_STATUS_SUCCESS)
         {
-            image->render(dc,imageBounds);
-        } else {
-            if (dc.status() != cairo_status_t::CAIRO_STATUS_SUCCESS)
-            {
-                throw std::runtime_error(SS("Lv2c: " << Lv2cStatusMessage(dc.status())));
-            }
-            dc.push_group();
-            if (dc.status() != cairo_status_t::CAIRO_STATUS_SUCCESS)
-            {
-                throw std::runtime_error(SS("Lv2c: " << Lv2cStatusMessage(dc.status())));
-            }
-            image->render(dc,imageBounds);
-            Lv2cPattern p = dc.pop_group();
-            dc.check_status();
-            dc.set_source(tintColor);
-            dc.mask(p);
-        
+            throw std::runtime_error(SS("Lv2c: " << Lv2cStatusMessage(dc.status())));
+        }
+        image->render(dc,imageBounds);
+        Lv2cPattern p = dc.pop_group();
+        dc.check_status();
+        dc.set_source(tintColor);
+        dc.mask(p);
+    }
+    if (rotation != 0)
+    {
+        dc.restore();
+    }
+}
 
+bool Lv2cSvgElement::DrawCachedImage(Lv2cDrawingContext &dc, const Lv2cSize &size, double rotation, const Lv2cPattern &tintColor)
+{
+    // Only cache images that can be blitted at whole device-pixel offsets without changing the result:
+    // unskewed transforms, solid tints, and rotations that don't move the image outside its bounds.
+    if (!tintColor.isEmpty() && tintColor.get_type() != cairo_pattern_type_t::CAIRO_PATTERN_TYPE_SOLID)
+    {
+        return false;
+    }
+    if (std::fmod(rotation, 180) != 0 && !(std::fmod(rotation, 90) == 0 && size.Width() == size.Height()))
+    {
+        return false;
+    }
+    cairo_matrix_t matrix;
+    dc.get_matrix(&matrix);
+    if (matrix.xy != 0 || matrix.yx != 0 || matrix.xx != matrix.yy || matrix.xx <= 0)
+    {
+        return false;
+    }
+
+    double deviceX = std::floor(matrix.x0);
+    double deviceY = std::floor(matrix.y0);
+
+    Lv2cSvgRasterKey key;
+    key.source = Source();
+    key.size = size;
+    key.deviceScale = matrix.xx;
+    key.xFraction = matrix.x0 - deviceX;
+    key.yFraction = matrix.y0 - deviceY;
+    key.rotation = rotation;
+    key.tinted = !tintColor.isEmpty();
+    if (key.tinted)
+    {
+        key.tint = tintColor.get_color();
+    }
+
+    int deviceWidth = (int)std::ceil(key.xFraction + size.Width() * key.deviceScale);
+    int deviceHeight = (int)std::ceil(key.yFraction + size.Height() * key.deviceScale);
+    if (deviceWidth <= 0 || deviceHeight <= 0)
+    {
+        return true;
+    }
+
+    Lv2cSvgRasterCache &cache = Window()->SvgRasterCache();
+    std::optional<Lv2cImageSurface> cachedSurface = cache.Get(key);
+    if (!cachedSurface)
+    {
+        Lv2cImageSurface surface{cairo_format_t::CAIRO_FORMAT_ARGB32, deviceWidth, deviceHeight};
+        {
+            Lv2cDrawingContext bdc{surface};
+            bdc.translate(key.xFraction, key.yFraction);
+            bdc.scale(key.deviceScale, key.deviceScale);
+            RenderImage(bdc, size, rotation, tintColor);
         }
-        if (rotation != 0)
+        surface.flush();
+        cache.Put(key, surface);
+        cachedSurface = std::move(surface);
+    }
+
+    dc.save();
+    dc.identity_matrix();
+    dc.set_source(*cachedSurface, deviceX, deviceY);
+    dc.rectangle(deviceX, deviceY, deviceWidth, deviceHeight);
+    dc.fill();
+    dc.restore();
+    return true;
+}
+
+void Lv2cSvgElement::Lv2cSvgElement::OnDraw(Lv2cDrawingContext &dc)
+{
+    super::OnDraw(dc);
+    Lv2cSize size = measuredImageSize;
+
+    double rotation = Rotation();
+    if (image)
+    {
+        Lv2cPattern tintColor = Style().TintColor();
+        if (!DrawCachedImage(dc, size, rotation, tintColor))
         {
-            dc.restore();
+            RenderImage(dc, size, rotation, tintColor);
         }
     } else {
         // gray marker if no image.
+        Lv2cRectangle imageBounds(
+            0,0,
+            size.Width(),
+            size.Height());
         dc.set_source(Lv2cColor(0.5,0.5,0.5,0.25));
         dc.rectangle(imageBounds);
         dc.fill();
@@ -0,0 +1,60 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lv2c/Lv2cSvgRasterCache.hpp"
+#include <functional>
+
+using namespace lv2c;
+
+static void HashCombine(size_t &seed, size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+bool Lv2cSvgRasterKey::operator==(const Lv2cSvgRasterKey &other) const
+{
+    return source == other.source &&
+           size == other.size &&
+           deviceScale == other.deviceScale &&
+           xFraction == other.xFraction &&
+           yFraction == other.yFraction &&
+           rotation == other.rotation &&
+           tinted == other.tinted &&
+           (!tinted || tint == other.tint);
+}
+
+size_t Lv2cSvgRasterKey::Hash() const
+{
+    std::hash<double> hashDouble;
+    size_t seed = std::hash<std::string>()(source);
+    HashCombine(seed, hashDouble(size.Width()));
+    HashCombine(seed, hashDouble(size.Height()));
+    HashCombine(seed, hashDouble(deviceScale));
+    HashCombine(seed, hashDouble(xFraction));
+    HashCombine(seed, hashDouble(yFraction));
+    HashCombine(seed, hashDouble(rotation));
+    if (tinted)
+    {
+        HashCombine(seed, hashDouble(tint.R()));
+        HashCombine(seed, hashDouble(tint.G()));
+        HashCombine(seed, hashDouble(tint.B()));
+        HashCombine(seed, hashDouble(tint.A()));
+    }
+    return seed;
+}
@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "lv2c/Lv2cTableElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include "lv2c/Lv2cLog.hpp"
 
 using namespace lv2c;
@@ -228,6 +229,7 @@ Lv2cSize Lv2cTableElement::MeasureClient(
 
 Lv2cSize Lv2cTableElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
     size_t rowCount = RowCount();
     size_t columnCount = ColumnCount();
     double y = 0;
@@ -249,7 +251,7 @@ Lv2cSize Lv2cTableElement::Arrange(Lv2cSize available, Lv2cDrawingContext &conte
             auto &columnDefinition = columnDefinitions[c];
 
             Lv2cSize childSize{measuredSize.Width(), measuredSize.Height()};
-            child->Arrange(available, context);
+            child->Arrange(childSize, context);
             double childX,childY;
             switch (columnDefinition.columnAlignment) {
                 case Lv2cAlignment::Start:
@@ -18,9 +18,78 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "lv2c/Lv2cTheme.hpp"
+#include <mutex>
+#include <vector>
 
 using namespace lv2c;
 
+bool Lv2cThemeColors::operator==(const Lv2cThemeColors &other) const
+{
+    return isDarkTheme == other.isDarkTheme &&
+           background == other.background &&
+           paper == other.paper &&
+           popupBackground == other.popupBackground &&
+           dividerColor == other.dividerColor &&
+           primaryColor == other.primaryColor &&
+           primaryInvertedTextColor == other.primaryInvertedTextColor &&
+           secondaryColor == other.secondaryColor &&
+           secondaryInvertedTextColor == other.secondaryInvertedTextColor &&
+           errorColor == other.errorColor &&
+           primaryTextColor == other.primaryTextColor &&
+           secondaryTextColor == other.secondaryTextColor &&
+           dialColor == other.dialColor &&
+           textSelectionColor == other.textSelectionColor &&
+           textCursorColor == other.textCursorColor &&
+           toggleTrackColor == other.toggleTrackColor &&
+           toggleThumbColor == other.toggleThumbColor &&
+           vuBackground == other.vuBackground &&
+           vuTickColor == other.vuTickColor &&
+           vuColor == other.vuColor &&
+           lampOnColor == other.lampOnColor &&
+           lampOffColor == other.lampOffColor &&
+           portGroupBorderColor == other.portGroupBorderColor &&
+           dialogBackgroundColor == other.dialogBackgroundColor &&
+           plotBackground == other.plotBackground &&
+           plotTickColor == other.plotTickColor &&
+           plotColor == other.plotColor;
+}
+
+Lv2cTheme::ptr Lv2cTheme::GetShared(bool darkTheme)
+{
+    return GetShared(Lv2cThemeColors(darkTheme));
+}
+
+Lv2cTheme::ptr Lv2cTheme::GetShared(const Lv2cThemeColors &themeColors)
+{
+    // Shared themes live for the life of the process: there are only ever a handful of them,
+    // and keeping them saves rebuilding styles each time a plugin UI is opened.
+    static std::mutex sharedThemesMutex;
+    static std::vector<Lv2cTheme::ptr> sharedThemes;
+
+    std::lock_guard lock{sharedThemesMutex};
+    for (const auto &theme : sharedThemes)
+    {
+        if (static_cast<const Lv2cThemeColors &>(*theme) == themeColors)
+        {
+            return theme;
+        }
+    }
+    Lv2cTheme::ptr theme = Create(themeColors);
+    theme->shared = true;
+    sharedThemes.push_back(theme);
+    return theme;
+}
+
+Lv2cTheme::ptr Lv2cTheme::Writable(const ptr &theme)
+{
+    if (!theme->shared)
+    {
+        return theme;
+    }
+    // Shared themes are never modified, so a theme built from the same colors is an exact copy.
+    return Create(static_cast<const Lv2cThemeColors &>(*theme));
+}
+
 Lv2cTheme::Lv2cTheme(const Lv2cThemeColors &themeColors)
     : Lv2cThemeColors(themeColors)
 {
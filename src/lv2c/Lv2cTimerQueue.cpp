@@ -0,0 +1,174 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "lv2c/Lv2cTimerQueue.hpp"
+#include <algorithm>
+
+using namespace lv2c;
+
+Lv2cTimerQueue::~Lv2cTimerQueue()
+{
+    PendingEntry *entry = pendingEntries.exchange(nullptr, std::memory_order_acquire);
+    while (entry)
+    {
+        PendingEntry *next = entry->next;
+        delete entry;
+        entry = next;
+    }
+}
+
+AnimationHandle Lv2cTimerQueue::Post(clock_t::time_point time, Callback &&callback)
+{
+    AnimationHandle handle = AnimationHandle::Next();
+    std::lock_guard guard{mutex};
+    MergePendingEntries();
+    Insert(time, handle, std::move(callback));
+    return handle;
+}
+
+AnimationHandle Lv2cTimerQueue::PostFromAnyThread(clock_t::time_point time, Callback &&callback)
+{
+    AnimationHandle handle = AnimationHandle::Next();
+    PendingEntry *entry = new PendingEntry{time, handle, std::move(callback), nullptr};
+    entry->next = pendingEntries.load(std::memory_order_relaxed);
+    while (!pendingEntries.compare_exchange_weak(
+        entry->next, entry,
+        std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+    return handle;
+}
+
+void Lv2cTimerQueue::Insert(clock_t::time_point time, AnimationHandle handle, Callback &&callback)
+{
+    callbacks[handle] = std::move(callback);
+    heap.push_back(HeapEntry{time, handle});
+    std::push_heap(heap.begin(), heap.end(), Later);
+}
+
+void Lv2cTimerQueue::MergePendingEntries()
+{
+    PendingEntry *entry = pendingEntries.exchange(nullptr, std::memory_order_acquire);
+    while (entry)
+    {
+        PendingEntry *next = entry->next;
+        Insert(entry->time, entry->handle, std::move(entry->callback));
+        delete entry;
+        entry = next;
+    }
+}
+
+void Lv2cTimerQueue::DiscardStaleEntries()
+{
+    // Cancelled entries are left in the heap until they reach the top.
+    while (heap.size() != 0 && !callbacks.contains(heap.front().handle))
+    {
+        std::pop_heap(heap.begin(), heap.end(), Later);
+        heap.pop_back();
+    }
+}
+
+void Lv2cTimerQueue::CompactHeap()
+{
+    if (heap.size() > 2 * callbacks.size() + 64)
+    {
+        auto end = std::remove_if(
+            heap.begin(), heap.end(),
+            [this](const HeapEntry &entry)
+            {
+                return !callbacks.contains(entry.handle);
+            });
+        heap.erase(end, heap.end());
+        std::make_heap(heap.begin(), heap.end(), Later);
+    }
+}
+
+bool Lv2cTimerQueue::Cancel(AnimationHandle handle)
+{
+    std::lock_guard guard{mutex};
+    MergePendingEntries();
+    auto f = callbacks.find(handle);
+    if (f == callbacks.end())
+    {
+        return false;
+    }
+    callbacks.erase(f);
+    CompactHeap();
+    return true;
+}
+
+std::optional<Lv2cTimerQueue::clock_t::time_point> Lv2cTimerQueue::NextDeadline()
+{
+    std::lock_guard guard{mutex};
+    MergePendingEntries();
+    DiscardStaleEntries();
+    if (heap.size() == 0)
+    {
+        return std::optional<clock_t::time_point>();
+    }
+    return heap.front().time;
+}
+
+size_t Lv2cTimerQueue::Dispatch(clock_t::time_point now)
+{
+    // Take a snapshot of the due entries, so that callbacks posted while dispatching
+    // wait for the next call.
+    std::vector<AnimationHandle> dueHandles;
+    {
+        std::lock_guard guard{mutex};
+        MergePendingEntries();
+        while (true)
+        {
+            DiscardStaleEntries();
+            if (heap.size() == 0 || heap.front().time > now)
+            {
+                break;
+            }
+            dueHandles.push_back(heap.front().handle);
+            std::pop_heap(heap.begin(), heap.end(), Later);
+            heap.pop_back();
+        }
+    }
+    size_t count = 0;
+    for (AnimationHandle handle : dueHandles)
+    {
+        Callback callback;
+        {
+            std::lock_guard guard{mutex};
+            auto f = callbacks.find(handle);
+            if (f == callbacks.end())
+            {
+                continue; // cancelled by an earlier callback.
+            }
+            callback = std::move(f->second);
+            callbacks.erase(f);
+        }
+        // no locks held, so the callback may freely post or cancel timers.
+        callback();
+        ++count;
+    }
+    return count;
+}
+
+size_t Lv2cTimerQueue::Size()
+{
+    std::lock_guard guard{mutex};
+    MergePendingEntries();
+    return callbacks.size();
+}
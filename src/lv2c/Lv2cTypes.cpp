@@ -374,7 +374,7 @@ AnimationHandle AnimationHandle::Next()
     result.nativeHandle = ++nextHandle;
     return result;
 }
-uint64_t AnimationHandle::nextHandle = 0;
+std::atomic<uint64_t> AnimationHandle::nextHandle = 0;
 
 Lv2cFocusEventArgs::Lv2cFocusEventArgs()
     : oldFocus(nullptr), newFocus(nullptr)
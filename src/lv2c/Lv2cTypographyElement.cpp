@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "lv2c/Lv2cTypographyElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include "lv2c/Lv2cWindow.hpp"
 #include "lv2c/IcuString.hpp"
 
@@ -112,53 +113,56 @@ Lv2cSize Lv2cTypographyElement::MeasureClient(Lv2cSize constraint, Lv2cSize avai
     }
     // ? pango_cairo_update_context ( context.get(),GetPangoContext());
 
+    const std::string *displayText = &this->Text();
     if (Style().TextTransform() == Lv2cTextTransform::Capitalize)
     {
         uppercase = icuString->toUpper(Text());
-
-        pango_layout_set_markup(pangoLayout, uppercase.c_str(), (int)(uppercase.length()));
+        displayText = &uppercase;
     }
-    else
+    SetLayoutMarkup(*displayText);
+
+    const PangoFontDescription *desc = GetFontDescription();
+    pango_layout_set_font_description(pangoLayout, desc);
+
+    int x, y;
+    if (singleLine && displayText->length() != 0)
     {
-        pango_layout_set_markup(pangoLayout, this->Text().c_str(), (int)(this->Text().length()));
+        // Measure through the shared cache. The layout keeps the width and alignment set by Arrange,
+        // so identical text isn't reshaped on every layout pass.
+        gPangoContext.GetSingleLineSize(pangoLayout, context.get(), desc, *displayText, true, &x, &y);
     }
-
-    pango_layout_set_alignment(pangoLayout, (PangoAlignment)(int)Style().TextAlign());
-    if (singleLine)
+    else
     {
-        if (this->Text().length() == 0)
+        pango_layout_set_alignment(pangoLayout, (PangoAlignment)(int)Style().TextAlign());
+        if (singleLine)
         {
             // pango returns spurious line heights if text is empty.
-            pango_layout_set_markup(pangoLayout, "x", 1);
+            SetLayoutMarkup("x");
             this->hasDrawTextChanged = true;
-        }
 
-        pango_layout_set_width(pangoLayout, -1);
-        pango_layout_set_height(pangoLayout, -1);
-        pango_layout_set_ellipsize(pangoLayout, PangoEllipsizeMode::PANGO_ELLIPSIZE_NONE);
-        pango_layout_set_alignment(pangoLayout, PangoAlignment::PANGO_ALIGN_LEFT);
-    }
-    else
-    {
-        double width = constraint.Width();
-        if (width == 0)
-        {
-            width = available.Width();
+            pango_layout_set_width(pangoLayout, -1);
+            pango_layout_set_height(pangoLayout, -1);
+            pango_layout_set_ellipsize(pangoLayout, PangoEllipsizeMode::PANGO_ELLIPSIZE_NONE);
+            pango_layout_set_alignment(pangoLayout, PangoAlignment::PANGO_ALIGN_LEFT);
         }
+        else
+        {
+            double width = constraint.Width();
+            if (width == 0)
+            {
+                width = available.Width();
+            }
 
-        pango_layout_set_ellipsize(pangoLayout, PangoEllipsizeMode::PANGO_ELLIPSIZE_NONE);
-        pango_layout_set_width(pangoLayout, ((int)std::floor(width)) * PANGO_SCALE);
-        pango_layout_set_line_spacing(pangoLayout,Style().LineSpacing());
-        //pango_layout_set_height(pangoLayout, -50000); // max 50000 lines. That should be enough/
-    }
-    PangoFontDescription *desc = GetFontDescription();
-    pango_layout_set_font_description(pangoLayout, desc);
+            pango_layout_set_ellipsize(pangoLayout, PangoEllipsizeMode::PANGO_ELLIPSIZE_NONE);
+            pango_layout_set_width(pangoLayout, ((int)std::floor(width)) * PANGO_SCALE);
+            pango_layout_set_line_spacing(pangoLayout,Style().LineSpacing());
+            //pango_layout_set_height(pangoLayout, -50000); // max 50000 lines. That should be enough/
+        }
 
-    pango_cairo_update_layout(context.get(), pangoLayout);
+        pango_cairo_update_layout(context.get(), pangoLayout);
 
-    pango_font_description_free(desc);
-    int x, y;
-    pango_layout_get_size(pangoLayout, &x, &y);
+        pango_layout_get_size(pangoLayout, &x, &y);
+    }
 
     Lv2cSize size = Lv2cSize(std::ceil(x / PANGO_SCALE), std::ceil(y / PANGO_SCALE));
 
@@ -213,6 +217,7 @@ Lv2cSize Lv2cTypographyElement::MeasureClient(Lv2cSize constraint, Lv2cSize avai
 }
 Lv2cSize Lv2cTypographyElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
     Lv2cSize borderSize = this->removeThickness(available, Style().Margin());
     Lv2cSize paddingSize = this->removeThickness(borderSize, Style().BorderWidth());
     Lv2cSize clientSize = this->removeThickness(paddingSize, Style().Padding());
@@ -244,12 +249,7 @@ Lv2cSize Lv2cTypographyElement::Arrange(Lv2cSize available, Lv2cDrawingContext &
         pango_layout_set_width(pangoLayout, ((int)std::floor(clientSize.Width())) * PANGO_SCALE);
     }
 
-    PangoFontDescription *desc = GetFontDescription();
-
-    pango_layout_set_font_description(pangoLayout, desc);
-
-    pango_font_description_free(desc);
-    desc = nullptr;
+    pango_layout_set_font_description(pangoLayout, GetFontDescription());
 
     pango_layout_set_alignment(pangoLayout, (PangoAlignment)(int)Style().TextAlign());
 
@@ -292,11 +292,11 @@ void Lv2cTypographyElement::OnDraw(Lv2cDrawingContext &dc)
             if (Style().TextTransform() == Lv2cTextTransform::Capitalize)
             {
                 this->uppercase = icuString->toUpper(Text());
-                pango_layout_set_markup(pangoLayout, uppercase.c_str(), (int)(uppercase.length()));
+                SetLayoutMarkup(uppercase);
             }
             else
             {
-                pango_layout_set_markup(pangoLayout, this->Text().c_str(), (int)(this->Text().length()));
+                SetLayoutMarkup(this->Text());
             }
             if (!SingleLine())
             {
@@ -350,9 +350,21 @@ void Lv2cTypographyElement::OnMount()
     AddClass(variantStyle);
 }
 
-PangoFontDescription *Lv2cTypographyElement::GetFontDescription()
+const PangoFontDescription *Lv2cTypographyElement::GetFontDescription()
 {
-    return gPangoContext.GetFontDescription(this->Style());
+    return gPangoContext.GetSharedFontDescription(this->Style());
+}
+
+void Lv2cTypographyElement::SetLayoutMarkup(const std::string &markup)
+{
+    // pango discards the layout's shaped lines whenever the text is set, even if it hasn't changed.
+    if (layoutMarkupValid && markup == layoutMarkup)
+    {
+        return;
+    }
+    layoutMarkup = markup;
+    layoutMarkupValid = true;
+    pango_layout_set_markup(pangoLayout, layoutMarkup.c_str(), (int)(layoutMarkup.length()));
 }
 
 bool Lv2cTypographyElement::SingleLine() const
@@ -18,6 +18,7 @@
 // CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "lv2c/Lv2cVerticalStackElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include "lv2c/Lv2cLog.hpp"
 
 using namespace lv2c;
@@ -171,6 +172,7 @@ Lv2cSize Lv2cVerticalStackElement::MeasureClient(Lv2cSize constraint, Lv2cSize a
 
 Lv2cSize Lv2cVerticalStackElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
 {
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
 
     Lv2cRectangle arrangeRectangle = Lv2cRectangle(0, 0, available.Width(), available.Height());
 
@@ -0,0 +1,345 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "lv2c/Lv2cVirtualListElement.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
+#include "lv2c/Lv2cWindow.hpp"
+#include "lv2c/Lv2cLog.hpp"
+#include <cmath>
+#include <algorithm>
+
+using namespace lv2c;
+
+Lv2cVirtualListElement::Lv2cVirtualListElement()
+{
+    OrientationProperty.SetElement(this, Lv2cBindingFlags::InvalidateLayoutOnChanged);
+    RowHeightModeProperty.SetElement(this, Lv2cBindingFlags::InvalidateLayoutOnChanged);
+    RowHeightProperty.SetElement(this, Lv2cBindingFlags::InvalidateLayoutOnChanged);
+    ColumnWidthProperty.SetElement(this, Lv2cBindingFlags::InvalidateLayoutOnChanged);
+    ColumnGapProperty.SetElement(this, Lv2cBindingFlags::InvalidateLayoutOnChanged);
+    OverscanProperty.SetElement(this, Lv2cBindingFlags::InvalidateLayoutOnChanged);
+}
+
+Lv2cVirtualListElement &Lv2cVirtualListElement::ItemTemplate(const ItemFactory &factory, const ItemBinder &binder)
+{
+    ReleaseAllItems();
+    // created by the old factory.
+    discardedItems.insert(discardedItems.end(), recyclePool.begin(), recyclePool.end());
+    recyclePool.clear();
+    this->itemFactory = factory;
+    this->itemBinder = binder;
+    this->measuredRowHeight = 0;
+    InvalidateLayout();
+    return *this;
+}
+
+size_t Lv2cVirtualListElement::ItemCount() const
+{
+    return itemCount;
+}
+
+Lv2cVirtualListElement &Lv2cVirtualListElement::ItemCount(size_t count)
+{
+    this->itemCount = count;
+    Refresh();
+    return *this;
+}
+
+void Lv2cVirtualListElement::Refresh()
+{
+    ReleaseAllItems();
+    InvalidateLayout();
+}
+
+size_t Lv2cVirtualListElement::RealizedItemCount() const
+{
+    return realizedIndexes.size();
+}
+
+size_t Lv2cVirtualListElement::CreatedItemCount() const
+{
+    return createdItemCount;
+}
+
+double Lv2cVirtualListElement::RowPitch() const
+{
+    double rowHeight = RowHeight();
+    if (RowHeightMode() == Lv2cVirtualRowHeightMode::Estimated && measuredRowHeight > rowHeight)
+    {
+        rowHeight = measuredRowHeight;
+    }
+    return std::max(1.0, rowHeight);
+}
+
+size_t Lv2cVirtualListElement::RowsPerColumn(double clientHeight) const
+{
+    if (Orientation() == Lv2cVirtualListOrientation::Vertical)
+    {
+        return std::max((size_t)1, itemCount);
+    }
+    size_t rows = (size_t)std::floor(clientHeight / RowPitch());
+    return std::max((size_t)1, rows);
+}
+
+Lv2cRectangle Lv2cVirtualListElement::GetItemBounds(size_t index) const
+{
+    double pitch = RowPitch();
+    if (Orientation() == Lv2cVirtualListOrientation::Vertical)
+    {
+        return Lv2cRectangle(0, index * pitch, clientLayoutSize.Width(), pitch);
+    }
+    size_t rows = RowsPerColumn(clientLayoutSize.Height());
+    size_t column = index / rows;
+    size_t row = index % rows;
+    return Lv2cRectangle(column * (ColumnWidth() + ColumnGap()), row * pitch, ColumnWidth(), pitch);
+}
+
+Lv2cSize Lv2cVirtualListElement::MeasureClient(Lv2cSize clientConstraint, Lv2cSize clientAvailable, Lv2cDrawingContext &context)
+{
+    // Items are measured when they are realized, so only the extent of the list is calculated here.
+    double pitch = RowPitch();
+    if (Orientation() == Lv2cVirtualListOrientation::Vertical)
+    {
+        double width = clientConstraint.Width();
+        if (width == 0)
+        {
+            width = ColumnWidth();
+        }
+        return Lv2cSize(width, itemCount * pitch);
+    }
+    else
+    {
+        double height = clientConstraint.Height();
+        if (height == 0)
+        {
+            height = clientAvailable.Height();
+            if (height > 1E12)
+            {
+                LogError("Lv2cVirtualListElement: ColumnWrap orientation requires a constrained height.");
+                height = pitch * std::max((size_t)1, itemCount);
+            }
+        }
+        size_t rows = RowsPerColumn(height);
+        size_t columns = (itemCount + rows - 1) / rows;
+        double width = 0;
+        if (columns != 0)
+        {
+            width = columns * ColumnWidth() + (columns - 1) * ColumnGap();
+        }
+        return Lv2cSize(width, height);
+    }
+}
+
+Lv2cSize Lv2cVirtualListElement::Arrange(Lv2cSize available, Lv2cDrawingContext &context)
+{
+    LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
+    Lv2cRectangle marginRect{0, 0, available.Width(), available.Height()};
+
+    Lv2cRectangle borderRect = this->removeThickness(marginRect, Style().Margin());
+    Lv2cRectangle paddingRect = this->removeThickness(borderRect, Style().BorderWidth());
+    Lv2cRectangle clientRect = this->removeThickness(paddingRect, Style().Padding());
+    this->clientLayoutSize = clientRect.Size();
+    discardedItems.clear();
+
+    // Items that are still in view get their new positions here. Items that
+    // are no longer in view are released in FinalizeLayout.
+    realizing = true;
+    for (size_t i = 0; i < children.size(); ++i)
+    {
+        if (realizedIndexes[i] >= itemCount)
+        {
+            ReleaseItem(i);
+            --i;
+            continue;
+        }
+        LayoutItem(children[i], realizedIndexes[i], context);
+    }
+    realizing = false;
+    return available;
+}
+
+void Lv2cVirtualListElement::LayoutItem(Lv2cElement::ptr &element, size_t index, Lv2cDrawingContext &context)
+{
+    Lv2cRectangle itemBounds = GetItemBounds(index);
+    Lv2cSize itemSize = itemBounds.Size();
+    if (RowHeightMode() == Lv2cVirtualRowHeightMode::Estimated)
+    {
+        element->Measure(Lv2cSize(itemSize.Width(), 0), Lv2cSize(itemSize.Width(), 3E15), context);
+        double height = element->MeasuredSize().Height();
+        if (height > RowPitch() && Window())
+        {
+            // Rows need to be taller. Lay out again once the current layout pass is complete.
+            measuredRowHeight = height;
+            if (!rowHeightChangedHandle)
+            {
+                rowHeightChangedHandle = Window()->PostDelayed(
+                    0,
+                    [this]()
+                    {
+                        rowHeightChangedHandle = AnimationHandle::InvalidHandle;
+                        InvalidateLayout();
+                    });
+            }
+        }
+    }
+    else
+    {
+        element->Measure(itemSize, itemSize, context);
+    }
+    element->Arrange(itemSize, context);
+    element->Layout(itemBounds);
+}
+
+void Lv2cVirtualListElement::GetVisibleRange(const Lv2cRectangle &visibleRect, size_t *first, size_t *last) const
+{
+    // [first,last) in item indexes.
+    double pitch = RowPitch();
+    int64_t overscan = std::max((int64_t)0, Overscan());
+    if (Orientation() == Lv2cVirtualListOrientation::Vertical)
+    {
+        int64_t firstRow = (int64_t)std::floor(visibleRect.Top() / pitch) - overscan;
+        int64_t lastRow = (int64_t)std::ceil(visibleRect.Bottom() / pitch) + overscan;
+        *first = (size_t)std::max((int64_t)0, firstRow);
+        *last = (size_t)std::max((int64_t)0, lastRow);
+    }
+    else
+    {
+        double columnPitch = std::max(1.0, ColumnWidth() + ColumnGap());
+        size_t rows = RowsPerColumn(clientLayoutSize.Height());
+        int64_t firstColumn = (int64_t)std::floor(visibleRect.Left() / columnPitch) - overscan;
+        int64_t lastColumn = (int64_t)std::ceil(visibleRect.Right() / columnPitch) + overscan;
+        *first = (size_t)std::max((int64_t)0, firstColumn) * rows;
+        *last = (size_t)std::max((int64_t)0, lastColumn) * rows;
+    }
+    *first = std::min(*first, itemCount);
+    *last = std::min(*last, itemCount);
+}
+
+void Lv2cVirtualListElement::FinalizeLayout(const Lv2cRectangle &layoutClipRect, const Lv2cRectangle &parentBounds, bool clippedInLayout)
+{
+    if (Window() && layoutValid && Style().Visibility() != Lv2cVisibility::Collapsed)
+    {
+        // The part of our client area that is inside the scroll viewport, in client coordinates.
+        Lv2cPoint clientOrigin{parentBounds.Left() + clientBounds.Left(), parentBounds.Top() + clientBounds.Top()};
+        Lv2cRectangle screenClient = clientBounds.translate(Lv2cPoint(parentBounds.Left(), parentBounds.Top()));
+        size_t first = 0, last = 0;
+        if (!clippedInLayout && layoutClipRect.Intersects(screenClient))
+        {
+            Lv2cRectangle visible = layoutClipRect.Intersect(screenClient).Translate(-clientOrigin.x, -clientOrigin.y);
+            GetVisibleRange(visible, &first, &last);
+        }
+        RealizeItems(first, last);
+    }
+    super::FinalizeLayout(layoutClipRect, parentBounds, clippedInLayout);
+}
+
+void Lv2cVirtualListElement::RealizeItems(size_t first, size_t last)
+{
+    realizing = true;
+
+    std::vector<bool> present(last - first, false);
+    for (size_t i = 0; i < children.size(); ++i)
+    {
+        size_t index = realizedIndexes[i];
+        if (index < first || index >= last)
+        {
+            ReleaseItem(i);
+            --i;
+        }
+        else
+        {
+            present[index - first] = true;
+        }
+    }
+    if (itemFactory && std::find(present.begin(), present.end(), false) != present.end())
+    {
+        Lv2cDrawingContext context = Window()->CreateDrawingContext();
+        for (size_t index = first; index < last; ++index)
+        {
+            if (!present[index - first])
+            {
+                Lv2cElement::ptr element = AcquireItem(index);
+                AddChild(element);
+                realizedIndexes.push_back(index);
+                LayoutItem(element, index, context);
+            }
+        }
+    }
+    realizing = false;
+}
+
+Lv2cElement::ptr Lv2cVirtualListElement::AcquireItem(size_t index)
+{
+    Lv2cElement::ptr element;
+    if (recyclePool.size() != 0)
+    {
+        element = std::move(recyclePool.back());
+        recyclePool.pop_back();
+    }
+    else
+    {
+        element = itemFactory();
+        ++createdItemCount;
+    }
+    if (itemBinder)
+    {
+        itemBinder(element, index);
+    }
+    return element;
+}
+
+void Lv2cVirtualListElement::ReleaseItem(size_t childIndex)
+{
+    Lv2cElement::ptr element = children[childIndex];
+    RemoveChild(childIndex);
+    realizedIndexes.erase(realizedIndexes.begin() + childIndex);
+    recyclePool.push_back(std::move(element));
+}
+
+void Lv2cVirtualListElement::ReleaseAllItems()
+{
+    bool oldRealizing = realizing;
+    realizing = true;
+    while (children.size() != 0)
+    {
+        ReleaseItem(children.size() - 1);
+    }
+    realizing = oldRealizing;
+}
+
+void Lv2cVirtualListElement::InvalidateLayout()
+{
+    if (realizing)
+    {
+        // adding and removing items is part of the current layout pass.
+        return;
+    }
+    super::InvalidateLayout();
+}
+
+void Lv2cVirtualListElement::OnUnmount()
+{
+    if (rowHeightChangedHandle && Window())
+    {
+        Window()->CancelPostDelayed(rowHeightChangedHandle);
+        rowHeightChangedHandle = AnimationHandle::InvalidHandle;
+    }
+    super::OnUnmount();
+}
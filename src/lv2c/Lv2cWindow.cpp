@@ -21,13 +21,17 @@
 #include "lv2c/Lv2cDrawingContext.hpp"
 #include "lv2c/Lv2cContainerElement.hpp"
 #include "lv2c/Lv2cSvg.hpp"
+#include "lv2c/Lv2cAssetCache.hpp"
 #include "lv2c/Lv2cSettingsFile.hpp"
 #include "lv2c/Lv2cMessageDialog.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 
 #include <stdexcept>
 #include <iostream>
 #include <memory>
 #include <filesystem>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 #define XK_MISCELLANY
 #define XK_LATIN1
@@ -61,11 +65,20 @@ namespace lv2c
 
 Lv2cWindow::Lv2cWindow()
 {
-    this->theme = std::make_shared<Lv2cTheme>(true);
+    this->uiThreadId = std::this_thread::get_id();
+    this->wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (this->wakeupFd == -1)
+    {
+        LogError("Failed to create event loop wakeup descriptor.");
+    }
+    this->theme = Lv2cTheme::GetShared(true);
+    Lv2cAssetCache::Instance().AddClient();
     auto rootWindow = Lv2cRootElement::Create();
     rootWindow->Style().Theme(this->theme);
     this->rootElement = rootWindow;
     this->rootElement->Style().Cursor(Lv2cCursor::Arrow);
+    // Each damage rectangle costs a full tree walk in Draw().
+    this->damageList.SetMergePolicy();
 }
 
 Lv2cWindow::~Lv2cWindow()
@@ -76,6 +89,15 @@ Lv2cWindow::~Lv2cWindow()
         this->rootElement = nullptr;
     }
     delete nativeWindow;
+    if (wakeupFd != -1)
+    {
+        close(wakeupFd);
+        wakeupFd = -1;
+    }
+    // release this window's references to shared assets before the cache looks for unused entries.
+    svgCache.clear();
+    pngCache.clear();
+    Lv2cAssetCache::Instance().ReleaseClient();
 }
 
 std::shared_ptr<Lv2cRootElement> Lv2cWindow::GetRootElement()
@@ -98,6 +120,92 @@ void Lv2cWindow::Invalidate(const Lv2cRectangle &bounds)
     damageList.Invalidate(rc);
 }
 
+void Lv2cWindow::ScrollRect(const Lv2cRectangle &bounds, double dx, double dy)
+{
+    if (dx == 0 && dy == 0)
+    {
+        return;
+    }
+    if (!nativeWindow || !nativeWindow->GetSurface())
+    {
+        Invalidate(bounds);
+        return;
+    }
+    // popups drawn over the area would be scrolled along with it.
+    if (rootElement)
+    {
+        auto &children = rootElement->Children();
+        for (size_t i = 1; i < children.size(); ++i)
+        {
+            if (children[i]->ScreenBounds().Intersects(bounds))
+            {
+                Invalidate(bounds);
+                return;
+            }
+        }
+    }
+
+    // only whole device pixels can be copied.
+    double deviceDx = dx * windowScale;
+    double deviceDy = dy * windowScale;
+    int64_t iDx = (int64_t)std::round(deviceDx);
+    int64_t iDy = (int64_t)std::round(deviceDy);
+    if (std::abs(deviceDx - iDx) > 1E-6 || std::abs(deviceDy - iDy) > 1E-6)
+    {
+        Invalidate(bounds);
+        return;
+    }
+
+    // pixels partially covered by the area are drawn by neighbouring elements too, so they don't scroll.
+    Lv2cRectangle windowDeviceBounds{0, 0, (double)damageList.Width(), (double)damageList.Height()};
+    double left = std::ceil(bounds.Left() * windowScale);
+    double top = std::ceil(bounds.Top() * windowScale);
+    double right = std::floor(bounds.Right() * windowScale);
+    double bottom = std::floor(bounds.Bottom() * windowScale);
+    Lv2cRectangle deviceBounds = Lv2cRectangle(left, top, right - left, bottom - top).Intersect(windowDeviceBounds);
+
+    if (deviceBounds.Width() <= std::abs(iDx) || deviceBounds.Height() <= std::abs(iDy))
+    {
+        Invalidate(bounds);
+        return;
+    }
+    damageList.Scroll(deviceBounds, iDx, iDy);
+
+    // redraw partially-covered pixels around the edges.
+    double outerLeft = std::floor(bounds.Left() * windowScale);
+    double outerTop = std::floor(bounds.Top() * windowScale);
+    double outerRight = std::ceil(bounds.Right() * windowScale);
+    double outerBottom = std::ceil(bounds.Bottom() * windowScale);
+    if (outerLeft != left)
+        damageList.Invalidate(Lv2cRectangle(outerLeft, outerTop, left - outerLeft, outerBottom - outerTop));
+    if (outerRight != right)
+        damageList.Invalidate(Lv2cRectangle(right, outerTop, outerRight - right, outerBottom - outerTop));
+    if (outerTop != top)
+        damageList.Invalidate(Lv2cRectangle(outerLeft, outerTop, outerRight - outerLeft, top - outerTop));
+    if (outerBottom != bottom)
+        damageList.Invalidate(Lv2cRectangle(outerLeft, bottom, outerRight - outerLeft, outerBottom - bottom));
+
+    pendingScrolls.push_back(PendingScroll{deviceBounds, iDx, iDy});
+}
+
+void Lv2cWindow::ApplyPendingScrolls()
+{
+    for (auto &scroll : pendingScrolls)
+    {
+        // the part of the area that is still visible after scrolling.
+        Lv2cRectangle source = scroll.deviceBounds.Intersect(
+            scroll.deviceBounds.Translate(-scroll.dx, -scroll.dy));
+        if (!source.Empty())
+        {
+            nativeWindow->CopyArea(
+                (int64_t)source.Left(), (int64_t)source.Top(),
+                (int64_t)source.Width(), (int64_t)source.Height(),
+                (int64_t)source.Left() + scroll.dx, (int64_t)source.Top() + scroll.dy);
+        }
+    }
+    pendingScrolls.resize(0);
+}
+
 void Lv2cWindow::OnExpose(WindowHandle h, int64_t x, int64_t y, int64_t width, int64_t height)
 {
     damageList.ExposeRect(x, y, width, height);
@@ -105,18 +213,35 @@ void Lv2cWindow::OnExpose(WindowHandle h, int64_t x, int64_t y, int64_t width, i
 
 Lv2cDrawingContext Lv2cWindow::CreateDrawingContext()
 {
+    if (!nativeWindow || !nativeWindow->GetSurface())
+    {
+        // Laid out before the native window exists: measure against a scratch surface.
+        Lv2cImageSurface surface{cairo_format_t::CAIRO_FORMAT_ARGB32, 1, 1};
+        return Lv2cDrawingContext(surface);
+    }
     return Lv2cDrawingContext(nativeWindow->GetSurface());
 }
 
 void Lv2cWindow::Draw()
 {
+    LV2C_PROFILE_SCOPE("Lv2cWindow::Draw");
     cairo_surface_t *surface = nativeWindow->GetSurface();
 
     Lv2cDrawingContext context{surface};
 
+    ApplyPendingScrolls();
+
     auto damageRects = this->damageList.GetDamageList();
     if (damageRects.size() == 0)
         return;
+    // With a back buffer, draw straight into the surface and present the damage once
+    // at the end of the frame. Otherwise, compose each rectangle in a temporary group
+    // so that partially drawn content never reaches the screen.
+    bool drawDirect = nativeWindow->HasBackBuffer();
+    if (drawDirect)
+    {
+        nativeWindow->BeginDraw();
+    }
     for (auto &damageRect : damageRects)
     {
 
@@ -137,7 +262,19 @@ void Lv2cWindow::Draw()
 
             context.check_status();
 
-            context.push_group_with_content(cairo_content_t::CAIRO_CONTENT_COLOR);
+            if (drawDirect)
+            {
+                // start from the same opaque black that a CAIRO_CONTENT_COLOR group starts with.
+                auto t = context.get_operator();
+                context.set_operator(cairo_operator_t::CAIRO_OPERATOR_SOURCE);
+                context.set_source(0.0f, 0.0f, 0.0f);
+                context.paint();
+                context.set_operator(t);
+            }
+            else
+            {
+                context.push_group_with_content(cairo_content_t::CAIRO_CONTENT_COLOR);
+            }
             OnDraw(context);
             if (rootElement)
             {
@@ -145,14 +282,17 @@ void Lv2cWindow::Draw()
             }
             OnDrawOver(context);
             context.check_status();
-            context.pop_group_to_source();
-
-            context.check_status();
-            auto t = context.get_operator();
-            context.set_operator(cairo_operator_t::CAIRO_OPERATOR_SOURCE);
-            context.rectangle(displayRect);
-            context.fill();
-            context.set_operator(t);
+            if (!drawDirect)
+            {
+                context.pop_group_to_source();
+
+                context.check_status();
+                auto t = context.get_operator();
+                context.set_operator(cairo_operator_t::CAIRO_OPERATOR_SOURCE);
+                context.rectangle(displayRect);
+                context.fill();
+                context.set_operator(t);
+            }
         }
         catch (const std::exception &e)
         {
@@ -161,6 +301,10 @@ void Lv2cWindow::Draw()
         context.restore();
         context.log_status();
     }
+    if (drawDirect)
+    {
+        nativeWindow->Present(damageRects);
+    }
     // std::cout << "---" << std::endl;
 }
 
@@ -235,6 +379,14 @@ void Lv2cWindow::CreateChildWindow(
     }
 }
 
+void Lv2cWindow::MountRootElement()
+{
+    if (this->rootElement)
+    {
+        rootElement->Mount(this);
+    }
+}
+
 void Lv2cWindow::CreateWindow(
     WindowHandle hParent,
     const Lv2cCreateWindowParameters &parameters)
@@ -503,6 +655,17 @@ void Lv2cWindow::OnIdle()
 }
 void Lv2cWindow::Layout()
 {
+    LV2C_PROFILE_SCOPE("Lv2cWindow::Layout");
+    Lv2cElement::CountLayout();
+    // A full layout covers any pending partial layouts.
+    for (Lv2cElement *element : dirtyLayoutElements)
+    {
+        element->relayoutPending = false;
+        element->InvalidateMeasure();
+    }
+    dirtyLayoutElements.resize(0);
+    layoutClassStyleGeneration = Lv2cStyle::ClassStyleGeneration();
+
     Lv2cSize t = nativeWindow->Size();
 
     Lv2cSize size{
@@ -522,13 +685,79 @@ void Lv2cWindow::Layout()
     }
     OnLayoutComplete();
 }
-void Lv2cWindow::Idle()
+
+void Lv2cWindow::LayoutDirtyElements()
+{
+    LV2C_PROFILE_SCOPE("Lv2cWindow::LayoutDirtyElements");
+    if (Lv2cStyle::ClassStyleGeneration() != layoutClassStyleGeneration)
+    {
+        // a shared class changed. Anything could have moved.
+        InvalidateLayout();
+        return;
+    }
+    std::vector<Lv2cElement *> elements;
+    std::swap(elements, dirtyLayoutElements);
+
+    Lv2cDrawingContext context = CreateDrawingContext();
+    for (size_t i = 0; i < elements.size(); ++i)
+    {
+        Lv2cElement *element = elements[i];
+        element->relayoutPending = false;
+        if (!this->layoutValid)
+        {
+            // escalated to a full layout.
+            element->InvalidateMeasure();
+            continue;
+        }
+        if (!element->RelayoutSubtree(context))
+        {
+            // The element's size changed. Propagate to the next boundary, or to the window.
+            element->parentElement->InvalidateLayout();
+        }
+    }
+    if (this->layoutValid)
+    {
+        OnLayoutComplete();
+    }
+}
+
+void Lv2cWindow::InvalidateElementLayout(Lv2cElement *element)
+{
+    dirtyLayoutElements.push_back(element);
+}
+
+void Lv2cWindow::CancelElementLayout(Lv2cElement *element)
 {
-    while (!this->layoutValid)
+    for (auto i = dirtyLayoutElements.begin(); i != dirtyLayoutElements.end(); ++i)
     {
-        this->layoutValid = true;
-        Layout();
+        if (*i == element)
+        {
+            dirtyLayoutElements.erase(i);
+            break;
+        }
     }
+    element->relayoutPending = false;
+}
+
+void Lv2cWindow::UpdateLayout()
+{
+    while (!this->layoutValid || !dirtyLayoutElements.empty())
+    {
+        if (!this->layoutValid)
+        {
+            this->layoutValid = true;
+            Layout();
+        }
+        else
+        {
+            LayoutDirtyElements();
+        }
+    }
+}
+
+void Lv2cWindow::Idle()
+{
+    UpdateLayout();
     if (!this->valid)
     {
         this->valid = true;
@@ -580,6 +809,7 @@ void Lv2cWindow::OnX11SizeChanged(Lv2cSize size)
         damageList.SetSize(
             (int64_t)std::ceil(size.Width()),
             (int64_t)std::ceil(size.Height()));
+        pendingScrolls.resize(0);
     }
     Size(size / windowScale);
 }
@@ -690,6 +920,7 @@ PangoContext *Lv2cWindow::GetPangoContext()
 
 void Lv2cWindow::Animate()
 {
+    LV2C_PROFILE_SCOPE("Lv2cWindow::Animate");
 
     // keep *this alive for the duration of the call.
     auto safetyPtr = this->shared_from_this();
@@ -709,89 +940,79 @@ void Lv2cWindow::Animate()
 
         for (auto &callback : callbacks)
         {
+            LV2C_PROFILE_SCOPE("AnimationCallback");
             callback(now);
         }
     }
 
-    if (delayCallbacks.size() != 0)
+    delayCallbacks.Dispatch(now);
+}
+
+AnimationHandle Lv2cWindow::PostDelayed(std::chrono::milliseconds delay, const DelayCallback &callback)
+{
+    return PostDelayed(delay, DelayCallback(callback));
+}
+AnimationHandle Lv2cWindow::PostDelayed(std::chrono::milliseconds delay, DelayCallback &&callback)
+{
+    auto time = animation_clock_t::now() + std::chrono::duration_cast<animation_clock_t::duration>(delay);
+    if (std::this_thread::get_id() == uiThreadId)
     {
+        return delayCallbacks.Post(time, std::move(callback));
+    }
+    AnimationHandle h = delayCallbacks.PostFromAnyThread(time, std::move(callback));
+    WakeEventLoop();
+    return h;
+}
+bool Lv2cWindow::CancelPostDelayed(AnimationHandle handle)
+{
+    return delayCallbacks.Cancel(handle);
+}
 
-        while (true)
+void Lv2cWindow::WakeEventLoop()
+{
+    if (wakeupFd != -1)
+    {
+        uint64_t value = 1;
+        if (write(wakeupFd, &value, sizeof(value)) < 0)
         {
-            // TODO: horrendously inefficient. Rewrite this for correct O.
-            // The challenge is that the iterator gets inalidated if any of
-            // the callbacks post a new Delayed item.
-            // Also a challenge with the mutex.
-            bool hasCallback = false;
-            DelayCallback callback;
-            {
-                std::lock_guard guard{delayCallbacksMutex};
-                for (auto &delayEntry : delayCallbacks)
-                {
-                    if (delayEntry.second.time <= now)
-                    {
-                        hasCallback = true;
-                        callback = delayEntry.second.callback;
-                        hasCallback = true;
-                        auto h = delayEntry.first;
-                        delayCallbacksMutex.unlock();
-
-                        callback();
-
-                        delayCallbacksMutex.lock();
-                        auto f = delayCallbacks.find(h);
-                        if (f != delayCallbacks.end())
-                        {
-                            delayCallbacks.erase(f);
-                        }
-
-                        break;
-                    }
-                }
-            }
-            if (!hasCallback)
-            {
-                break;
-            }
+            // EAGAIN: counter is saturated, so the event loop will wake anyway.
         }
     }
 }
 
-AnimationHandle Lv2cWindow::PostDelayed(std::chrono::milliseconds delay, const DelayCallback &callback)
+void Lv2cWindow::DrainWakeupEvents()
 {
-    AnimationHandle h = AnimationHandle::Next();
-    auto delayRecord = DelayRecord{
-        animation_clock_t::now() + std::chrono::duration_cast<animation_clock_t::duration>(delay),
-        callback};
+    if (wakeupFd != -1)
     {
-        std::lock_guard guard{delayCallbacksMutex};
-        delayCallbacks[h] = std::move(delayRecord);
+        uint64_t value;
+        while (read(wakeupFd, &value, sizeof(value)) > 0)
+        {
+        }
     }
-    return h;
 }
-AnimationHandle Lv2cWindow::PostDelayed(std::chrono::milliseconds delay, DelayCallback &&callback)
+
+bool Lv2cWindow::HasPendingRedraw() const
 {
-    AnimationHandle h = AnimationHandle::Next();
-    auto delayRecord = DelayRecord{
-        animation_clock_t::now() + duration_cast<animation_clock_t::duration>(delay),
-        std::move(callback)};
-    {
-        std::lock_guard guard{delayCallbacksMutex};
-        delayCallbacks[h] = std::move(delayRecord);
-    }
-    return h;
+    return !layoutValid || !dirtyLayoutElements.empty() || !valid || !damageList.IsEmpty();
 }
-bool Lv2cWindow::CancelPostDelayed(AnimationHandle handle)
+
+bool Lv2cWindow::HasAnimationCallbacks() const
 {
-    std::lock_guard guard{delayCallbacksMutex};
+    return animationCallbacks.size() != 0;
+}
 
-    auto f = delayCallbacks.find(handle);
-    if (f != delayCallbacks.end())
+std::optional<animation_clock_t::time_point> Lv2cWindow::NextDelayedCallbackTime()
+{
+    return delayCallbacks.NextDeadline();
+}
+
+uint64_t Lv2cWindow::WakeupCount() const
+{
+    if (nativeWindow)
     {
-        delayCallbacks.erase(f);
-        return true;
+        return nativeWindow->WakeupCount();
     }
-    return false;
+    return 0;
 }
 
 AnimationHandle Lv2cWindow::RequestAnimationCallback(const AnimationCallback &callback)
@@ -845,7 +1066,7 @@ Lv2cSurface Lv2cWindow::GetPngImage(const std::string &filename)
         LogError(SS("Can't find resourcefile " << path << ". Call static void Lv2cWindow::SetResourceDirectories()."));
         return Lv2cSurface();
     }
-    Lv2cSurface result = Lv2cSurface::create_from_png(path.string());
+    Lv2cSurface result = Lv2cAssetCache::Instance().GetPng(path);
     if (result.get())
     {
         if (result.status() != cairo_status_t::CAIRO_STATUS_SUCCESS)
@@ -865,6 +1086,45 @@ Lv2cSurface Lv2cWindow::GetPngImage(const std::string &filename)
     return result;
 }
 
+Lv2cPngStripFrames::ptr Lv2cWindow::GetPngStripFrames(const std::string &filename, Lv2cSize tileSize, int deviceWidth, int deviceHeight)
+{
+    std::string key = SS(deviceWidth << 'x' << deviceHeight << ':' << tileSize.Width() << 'x' << tileSize.Height() << ':' << filename);
+    auto f = pngStripFrames.find(key);
+    if (f != pngStripFrames.end())
+    {
+        Lv2cPngStripFrames::ptr result = f->second.lock();
+        if (result)
+        {
+            return result;
+        }
+    }
+    if (deviceWidth <= 0 || deviceHeight <= 0 || tileSize.Width() <= 0 || tileSize.Height() <= 0)
+    {
+        return nullptr;
+    }
+    Lv2cSurface strip = GetPngImage(filename);
+    if (!strip)
+    {
+        return nullptr;
+    }
+    // discard frames that are no longer in use.
+    for (auto i = pngStripFrames.begin(); i != pngStripFrames.end();)
+    {
+        if (i->second.expired())
+        {
+            i = pngStripFrames.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    int tileCount = (int)(strip.size().Width() / tileSize.Width());
+    Lv2cPngStripFrames::ptr result = Lv2cPngStripFrames::Create(strip, tileSize, tileCount, deviceWidth, deviceHeight);
+    pngStripFrames[key] = result;
+    return result;
+}
+
 Lv2cSvg::ptr Lv2cWindow::GetSvgImage(const std::string &filename)
 {
     if (svgCache.contains(filename))
@@ -878,8 +1138,7 @@ Lv2cSvg::ptr Lv2cWindow::GetSvgImage(const std::string &filename)
         LogError(SS("Can't find resourcefile " << path << ". Call static void Lv2cWindow::SetResourceDirectories()."));
         return nullptr;
     }
-    Lv2cSvg::ptr result = Lv2cSvg::Create();
-    result->load(path.string());
+    Lv2cSvg::ptr result = Lv2cAssetCache::Instance().GetSvg(path);
     svgCache[filename] = result;
     return result;
 }
@@ -1339,6 +1598,10 @@ void Lv2cWindow::SendControlChangedMessage(int32_t control, float value)
 
 Lv2cWindow &Lv2cWindow::WindowScale(double scale)
 {
+    if (scale != this->windowScale)
+    {
+        svgRasterCache.Clear();
+    }
     this->windowScale = scale;
     return *this;
 }
@@ -24,8 +24,19 @@
 #include <X11/cursorfont.h>
 
 #include <X11/extensions/Xrandr.h>
+#include <X11/extensions/XShm.h>
+#include <X11/Xlibint.h> // XESetError
+#undef min // defined by Xlibint.h
+#undef max
+#include <X11/extensions/shmproto.h>
+#include <sys/select.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
 #include <algorithm>
+#include <cstring>
+#include <cmath>
 #include "lv2c/Lv2cLog.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 
 #include <cairo/cairo-xlib.h>
 #include <iomanip>
@@ -33,6 +44,7 @@
 #include <limits>
 #include <thread>
 #include <chrono>
+#include <cerrno>
 
 #include "ss.hpp"
 
@@ -44,6 +56,8 @@ static constexpr bool DEBUG_INTERCEPT_X_ERROR_HANDLER = false;
 
 static constexpr int ANIMATION_RATE = 60;
 static constexpr std::chrono::steady_clock::duration ANIMATION_DELAY = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::microseconds(1000000 / ANIMATION_RATE));
+// Tolerance for host-driven idle calls that arrive slightly before the next frame is due.
+static constexpr std::chrono::steady_clock::duration ANIMATION_SLACK = ANIMATION_DELAY / 4;
 
 void Lv2cX11Window::logDebug(Window x11Window, const std::string &message)
 {
@@ -59,6 +73,15 @@ void Lv2cX11Window::logDebug(Window x11Window, const std::string &message)
     }
 #endif
 
+/// @brief Client-side pixels for the window, shared with the X server when MIT-SHM is available.
+struct Lv2cX11Window::BackBuffer
+{
+    XImage *image = nullptr;
+    XShmSegmentInfo shmInfo{};
+    bool useShm = false;
+    bool presentPending = false; // waiting for ShmCompletion.
+};
+
 #define X_INIT_ATOM(name) \
     name = XInternAtom(display, "_" #name, False)
 
@@ -295,6 +318,66 @@ PangoContext *Lv2cX11Window::GetPangoContext()
     return pangoContext;
 }
 
+void Lv2cX11Window::CopyArea(int64_t x, int64_t y, int64_t width, int64_t height, int64_t destX, int64_t destY)
+{
+    if (!cairoSurface || !x11Window)
+    {
+        return;
+    }
+    cairo_surface_flush(cairoSurface);
+
+    if (backBuffer)
+    {
+        WaitForPresent();
+        // keep the back buffer in step with the window. If the copy isn't entirely within
+        // the buffer, redraw the destination instead.
+        int64_t bufferWidth = backBuffer->image->width;
+        int64_t bufferHeight = backBuffer->image->height;
+        if (x < 0 || y < 0 || destX < 0 || destY < 0 ||
+            x + width > bufferWidth || y + height > bufferHeight ||
+            destX + width > bufferWidth || destY + height > bufferHeight ||
+            width <= 0 || height <= 0)
+        {
+            cairoWindow->OnExpose(x11Window, destX, destY, width, height);
+            return;
+        }
+        char *data = backBuffer->image->data;
+        int64_t stride = backBuffer->image->bytes_per_line;
+        constexpr int64_t BYTES_PER_PIXEL = 4;
+        size_t rowBytes = (size_t)(width * BYTES_PER_PIXEL);
+
+        // copy rows in an order that doesn't overwrite source rows before they are copied.
+        if (destY > y)
+        {
+            for (int64_t row = height - 1; row >= 0; --row)
+            {
+                memmove(
+                    data + (destY + row) * stride + destX * BYTES_PER_PIXEL,
+                    data + (y + row) * stride + x * BYTES_PER_PIXEL,
+                    rowBytes);
+            }
+        }
+        else
+        {
+            for (int64_t row = 0; row < height; ++row)
+            {
+                memmove(
+                    data + (destY + row) * stride + destX * BYTES_PER_PIXEL,
+                    data + (y + row) * stride + x * BYTES_PER_PIXEL,
+                    rowBytes);
+            }
+        }
+    }
+
+    // graphics exposures are enabled by default. Areas of the source that aren't available
+    // are reported by GraphicsExpose events, which get added to the damage list.
+    XCopyArea(x11Display, x11Window, x11Window, GetGC(),
+              (int)x, (int)y, (unsigned int)width, (unsigned int)height,
+              (int)destX, (int)destY);
+
+    cairo_surface_mark_dirty_rectangle(cairoSurface, (int)destX, (int)destY, (int)width, (int)height);
+}
+
 bool Lv2cX11Window::PostQuit()
 {
     this->quitting = true;
@@ -443,8 +526,10 @@ Lv2cX11Window::Lv2cX11Window(
 
     if (parameters.owner)
     {
-        parameters.owner->nativeWindow->childWindows.push_back(this);
-        this->parent = parameters.owner->nativeWindow;
+        // owners of X11 windows always have X11 native windows (see CreateChild()).
+        Lv2cX11Window *ownerWindow = static_cast<Lv2cX11Window *>(parameters.owner->nativeWindow);
+        ownerWindow->childWindows.push_back(this);
+        this->parent = ownerWindow;
     }
     CreateSurface(size.Width(), size.Height());
     Sync();
@@ -467,12 +552,18 @@ std::string Lv2cX11Window::GetX11ErrorText(int code)
 
 void Lv2cX11Window::DestroyWindowAndSurface()
 {
+    DestroyBackBuffer();
     if (cairoSurface)
     {
         cairo_surface_destroy(cairoSurface);
         cairoSurface = nullptr;
     }
 
+    if (x11GC)
+    {
+        XFreeGC(x11Display, x11GC);
+        x11GC = nullptr;
+    }
     if (x11Window)
     {
         XDestroyWindow(x11Display, x11Window);
@@ -635,13 +726,14 @@ void Lv2cX11Window::CreateWindow(
     Display *display,
     Lv2cCreateWindowParameters &parameters)
 {
+    this->schedulerMode = parameters.schedulerMode;
     if (display)
     {
         x11Display = display;
     }
     else if (parameters.owner != nullptr)
     {
-        x11Display = parameters.owner->nativeWindow->x11Display;
+        x11Display = static_cast<Lv2cX11Window *>(parameters.owner->nativeWindow)->x11Display;
     }
     else
     {
@@ -810,13 +902,16 @@ void Lv2cX11Window::CreateWindow(
 
 void Lv2cX11Window::CreateSurface(int w, int h)
 {
-    int screen = DefaultScreen(x11Display);
-    cairoSurface = cairo_xlib_surface_create(x11Display, x11Window, DefaultVisual(x11Display, screen), 0, 0);
-    if (cairoSurface == nullptr)
+    if (!CreateBackBuffer(w, h))
     {
-        throw std::runtime_error("Failed to create cairo surface.");
+        int screen = DefaultScreen(x11Display);
+        cairoSurface = cairo_xlib_surface_create(x11Display, x11Window, DefaultVisual(x11Display, screen), 0, 0);
+        if (cairoSurface == nullptr)
+        {
+            throw std::runtime_error("Failed to create cairo surface.");
+        }
+        cairo_xlib_surface_set_size(cairoSurface, w, h);
     }
-    cairo_xlib_surface_set_size(cairoSurface, w, h);
 
     // create  a PangoContext.
     cairo_t *cr = cairo_create(cairoSurface);
@@ -831,8 +926,18 @@ void Lv2cX11Window::SurfaceResize(Lv2cSize size)
     if (!cairoSurface)
         return;
 
-    cairo_surface_destroy(cairoSurface);
-    cairoSurface = nullptr;
+    if (backBuffer)
+    {
+        if (CreateBackBuffer((int)size.Width(), (int)size.Height()))
+        {
+            return;
+        }
+    }
+    else
+    {
+        cairo_surface_destroy(cairoSurface);
+        cairoSurface = nullptr;
+    }
 
     int screen = DefaultScreen(x11Display);
 
@@ -844,6 +949,302 @@ void Lv2cX11Window::SurfaceResize(Lv2cSize size)
     cairo_xlib_surface_set_size(cairoSurface, size.Width(), size.Height());
 }
 
+static thread_local bool shmAttaching = false;
+static thread_local bool shmAttachFailed = false;
+
+// Xlib offers errors to extension hooks for the display before passing them to the process-wide
+// error handler, which belongs to the host when running as a plugin.
+static int ShmAttachErrorHook(Display *display, xError *error, XExtCodes *codes, int *returnCode)
+{
+    if (shmAttaching && error->majorCode == codes->major_opcode && error->minorCode == X_ShmAttach)
+    {
+        shmAttachFailed = true;
+        return True; // handled.
+    }
+    return False;
+}
+
+Lv2cX11Window *Lv2cX11Window::DisplayOwner()
+{
+    // child windows share the display of the window that opened it.
+    Lv2cX11Window *window = this;
+    while (window->parent)
+    {
+        window = window->parent;
+    }
+    return window;
+}
+
+bool Lv2cX11Window::AttachShm(BackBuffer &buffer)
+{
+    Lv2cX11Window *owner = DisplayOwner();
+    if (owner->shmExtension == -1)
+    {
+        // our own extension record for MIT-SHM, to hang the error hook on. It lives as long as the display.
+        XExtCodes *codes = XInitExtension(x11Display, SHMNAME);
+        if (!codes)
+        {
+            return false;
+        }
+        XESetError(x11Display, codes->extension, ShmAttachErrorHook);
+        owner->shmExtension = codes->extension;
+    }
+    // XShmAttach errors arrive asynchronously.
+    XSync(x11Display, False);
+    shmAttachFailed = false;
+    shmAttaching = true;
+    XShmAttach(x11Display, &buffer.shmInfo);
+    XSync(x11Display, False);
+    shmAttaching = false;
+    return !shmAttachFailed;
+}
+
+GC Lv2cX11Window::GetGC()
+{
+    if (!x11GC)
+    {
+        x11GC = XCreateGC(x11Display, x11Window, 0, nullptr);
+    }
+    return x11GC;
+}
+
+static bool HostIsLsbFirst()
+{
+    uint32_t value = 1;
+    return *(uint8_t *)&value == 1;
+}
+
+bool Lv2cX11Window::CreateBackBuffer(int width, int height)
+{
+    DestroyBackBuffer();
+    if (cairoSurface)
+    {
+        cairo_surface_destroy(cairoSurface);
+        cairoSurface = nullptr;
+    }
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+
+    XWindowAttributes attributes;
+    if (!XGetWindowAttributes(x11Display, x11Window, &attributes))
+    {
+        return false;
+    }
+    // The buffer is shared by cairo and X, so the visual must use cairo's native-endian xRGB pixel layout.
+    // Anything else uses an xlib surface.
+    Visual *visual = attributes.visual;
+    int depth = attributes.depth;
+    if (visual->c_class != TrueColor ||
+        (depth != 24 && depth != 32) ||
+        visual->red_mask != 0xFF0000 || visual->green_mask != 0x00FF00 || visual->blue_mask != 0x0000FF)
+    {
+        return false;
+    }
+    cairo_format_t format = depth == 32 ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24;
+    int stride = cairo_format_stride_for_width(format, width);
+    int hostByteOrder = HostIsLsbFirst() ? LSBFirst : MSBFirst;
+
+    auto buffer = std::make_unique<BackBuffer>();
+
+    // MIT-SHM: the server reads pixels straight out of shared memory.
+    // Not available on remote displays, where XShmAttach fails.
+    if (!shmFailed && XShmQueryExtension(x11Display) && ImageByteOrder(x11Display) == hostByteOrder)
+    {
+        XImage *image = XShmCreateImage(x11Display, visual, (unsigned int)depth, ZPixmap, nullptr, &buffer->shmInfo, (unsigned int)width, (unsigned int)height);
+        if (image && image->bits_per_pixel == 32 && image->bytes_per_line == stride)
+        {
+            buffer->shmInfo.shmid = shmget(IPC_PRIVATE, (size_t)image->bytes_per_line * height, IPC_CREAT | 0600);
+            if (buffer->shmInfo.shmid != -1)
+            {
+                buffer->shmInfo.shmaddr = (char *)shmat(buffer->shmInfo.shmid, nullptr, 0);
+                if (buffer->shmInfo.shmaddr != (char *)-1)
+                {
+                    image->data = buffer->shmInfo.shmaddr;
+                    buffer->shmInfo.readOnly = False;
+
+                    if (AttachShm(*buffer))
+                    {
+                        buffer->image = image;
+                        buffer->useShm = true;
+                        shmCompletionEvent = XShmGetEventBase(x11Display) + ShmCompletion;
+                    }
+                    else
+                    {
+                        shmFailed = true;
+                        shmdt(buffer->shmInfo.shmaddr);
+                        image->data = nullptr;
+                    }
+                }
+                // The segment is released once both the server and the client have detached.
+                shmctl(buffer->shmInfo.shmid, IPC_RMID, nullptr);
+            }
+        }
+        if (image && !buffer->image)
+        {
+            XDestroyImage(image);
+        }
+    }
+    if (!buffer->image)
+    {
+        char *data = (char *)malloc((size_t)stride * height);
+        if (!data)
+        {
+            return false;
+        }
+        XImage *image = XCreateImage(x11Display, visual, (unsigned int)depth, ZPixmap, 0, data, (unsigned int)width, (unsigned int)height, 32, stride);
+        if (!image)
+        {
+            free(data);
+            return false;
+        }
+        // pixels are written by cairo in host order. XPutImage swaps them if the server differs.
+        image->byte_order = hostByteOrder;
+        buffer->image = image;
+    }
+
+    cairoSurface = cairo_image_surface_create_for_data(
+        (unsigned char *)buffer->image->data, format, width, height, buffer->image->bytes_per_line);
+    this->backBuffer = std::move(buffer);
+
+    if (cairo_surface_status(cairoSurface) != CAIRO_STATUS_SUCCESS)
+    {
+        DestroyBackBuffer();
+        return false;
+    }
+    return true;
+}
+
+void Lv2cX11Window::DestroyBackBuffer()
+{
+    if (!backBuffer)
+    {
+        return;
+    }
+    WaitForPresent();
+    if (cairoSurface)
+    {
+        cairo_surface_destroy(cairoSurface);
+        cairoSurface = nullptr;
+    }
+    if (backBuffer->useShm)
+    {
+        XShmDetach(x11Display, &backBuffer->shmInfo);
+        XSync(x11Display, False);
+        shmdt(backBuffer->shmInfo.shmaddr);
+        backBuffer->image->data = nullptr;
+    }
+    XDestroyImage(backBuffer->image); // frees malloc'ed data.
+    backBuffer = nullptr;
+}
+
+void Lv2cX11Window::Present(const std::vector<Lv2cRectangle> &deviceRectangles)
+{
+    if (!backBuffer || !x11Window)
+    {
+        return;
+    }
+    LV2C_PROFILE_SCOPE("Lv2cX11Window::Present");
+    cairo_surface_flush(cairoSurface);
+
+    struct PutRect
+    {
+        int x, y;
+        unsigned int width, height;
+    };
+    std::vector<PutRect> putRects;
+    putRects.reserve(deviceRectangles.size());
+
+    XImage *image = backBuffer->image;
+    for (const auto &rectangle : deviceRectangles)
+    {
+        int left = std::max(0, (int)std::floor(rectangle.Left()));
+        int top = std::max(0, (int)std::floor(rectangle.Top()));
+        int right = std::min(image->width, (int)std::ceil(rectangle.Right()));
+        int bottom = std::min(image->height, (int)std::ceil(rectangle.Bottom()));
+        if (right <= left || bottom <= top)
+        {
+            continue;
+        }
+        putRects.push_back(PutRect{left, top, (unsigned int)(right - left), (unsigned int)(bottom - top)});
+    }
+    GC gc = GetGC();
+    for (size_t i = 0; i < putRects.size(); ++i)
+    {
+        const PutRect &r = putRects[i];
+        if (backBuffer->useShm)
+        {
+            // The server reads shared memory when it processes the request. Requests are processed in
+            // order, so a completion event for the last one says that the buffer can be drawn into again.
+            bool sendEvent = i == putRects.size() - 1;
+            XShmPutImage(x11Display, x11Window, gc, image,
+                         r.x, r.y, r.x, r.y, r.width, r.height, sendEvent ? True : False);
+        }
+        else
+        {
+            XPutImage(x11Display, x11Window, gc, image,
+                      r.x, r.y, r.x, r.y, r.width, r.height);
+        }
+    }
+    if (backBuffer->useShm && putRects.size() != 0)
+    {
+        backBuffer->presentPending = true;
+    }
+    XFlush(x11Display);
+}
+
+static Bool IsShmCompletionEvent(Display *display, XEvent *event, XPointer arg)
+{
+    auto *match = (XShmCompletionEvent *)arg;
+    return event->type == match->type && ((XShmCompletionEvent *)event)->drawable == match->drawable;
+}
+
+void Lv2cX11Window::BeginDraw()
+{
+    WaitForPresent();
+}
+
+void Lv2cX11Window::WaitForPresent()
+{
+    if (!backBuffer || !backBuffer->presentPending)
+    {
+        return;
+    }
+    LV2C_PROFILE_SCOPE("Lv2cX11Window::WaitForPresent");
+    using namespace std::chrono;
+
+    XShmCompletionEvent match{};
+    match.type = shmCompletionEvent;
+    match.drawable = x11Window;
+
+    // Usually already queued, since drawing starts a frame after presenting. The completion may also
+    // have been dispatched by ProcessEvents(), which clears presentPending.
+    constexpr auto TIMEOUT = milliseconds(250);
+    auto deadline = steady_clock::now() + TIMEOUT;
+    XEvent event;
+    while (!XCheckIfEvent(x11Display, &event, IsShmCompletionEvent, (XPointer)&match))
+    {
+        auto now = steady_clock::now();
+        if (now >= deadline)
+        {
+            // A round trip guarantees that the server has processed the puts.
+            LogWarning("Lv2cX11Window: Timed out waiting for ShmCompletion.");
+            XSync(x11Display, False);
+            XCheckIfEvent(x11Display, &event, IsShmCompletionEvent, (XPointer)&match);
+            break;
+        }
+        auto microseconds = duration_cast<std::chrono::microseconds>(deadline - now).count();
+        fd_set in_fds;
+        FD_ZERO(&in_fds);
+        int fd = ConnectionNumber(x11Display);
+        FD_SET(fd, &in_fds);
+        struct timeval tv;
+        tv.tv_sec = microseconds / 1000000;
+        tv.tv_usec = microseconds % 1000000;
+        select(fd + 1, &in_fds, nullptr, nullptr, &tv);
+    }
+    backBuffer->presentPending = false;
+}
+
 void Lv2cX11Window::OnIdle()
 {
     if (this->cairoWindow)
@@ -867,26 +1268,61 @@ bool Lv2cX11Window::AnimationLoop()
     {
         clock_t::time_point now = clock_t::now();
 
-        clock_t::duration timeToNextAnimation = (lastAnimationFrameTime + ANIMATION_DELAY) - now;
-        auto microseconds = duration_cast<std::chrono::microseconds>(timeToNextAnimation).count();
-        if (microseconds > 0)
+        if (schedulerMode == Lv2cSchedulerMode::EventDriven)
+        {
+            clock_t::time_point deadline = NextDeadline(now);
+            // Xlib may already have read events into its queue, in which case the socket won't signal.
+            if (deadline > now && XEventsQueued(x11Display, QueuedAlready) == 0)
+            {
+                FD_ZERO(&in_fds);
+                int maxFd = 0;
+                AddFileDescriptors(maxFd, in_fds);
+
+                struct timeval *pTimeout = nullptr;
+                if (deadline != clock_t::time_point::max())
+                {
+                    auto microseconds = duration_cast<std::chrono::microseconds>(deadline - now).count();
+                    if (microseconds < 1)
+                    {
+                        microseconds = 1;
+                    }
+                    tv.tv_usec = microseconds % 1000000;
+                    tv.tv_sec = microseconds / 1000000;
+                    pTimeout = &tv;
+                }
+                // Wait for an X event, a cross-thread wakeup, or the next deadline.
+                int num_ready_fds = select(maxFd, &in_fds, NULL, NULL, pTimeout);
+                if (num_ready_fds < 0 && errno != EINTR)
+                {
+                    throw std::runtime_error("Animation loop select failed.");
+                }
+            }
+        }
+        else
         {
+            clock_t::duration timeToNextAnimation = (lastAnimationFrameTime + ANIMATION_DELAY) - now;
+            auto microseconds = duration_cast<std::chrono::microseconds>(timeToNextAnimation).count();
+            // Events may already be in Xlib's queue (read while waiting for a present to complete), in which case the socket won't signal.
+            if (microseconds > 0 && XEventsQueued(x11Display, QueuedAlready) == 0)
+            {
 
-            // Create a File Description Set containing x11_fd
-            FD_ZERO(&in_fds);
-            int maxFd = 0;
-            AddFileDescriptors(maxFd, in_fds);
+                // Create a File Description Set containing x11_fd
+                FD_ZERO(&in_fds);
+                int maxFd = 0;
+                AddFileDescriptors(maxFd, in_fds);
 
-            tv.tv_usec = microseconds % 1000000;
-            tv.tv_sec = microseconds / 1000000;
+                tv.tv_usec = microseconds % 1000000;
+                tv.tv_sec = microseconds / 1000000;
 
-            // Wait for X Event or a Timer
-            int num_ready_fds = select(maxFd, &in_fds, NULL, NULL, &tv);
-            if (num_ready_fds < 0)
-            {
-                throw std::runtime_error("Animation loop select failed.");
+                // Wait for X Event or a Timer
+                int num_ready_fds = select(maxFd, &in_fds, NULL, NULL, &tv);
+                if (num_ready_fds < 0)
+                {
+                    throw std::runtime_error("Animation loop select failed.");
+                }
             }
         }
+        DrainWakeupEvents();
 
         ProcessEvents();
         if (quitting)
@@ -896,6 +1332,115 @@ bool Lv2cX11Window::AnimationLoop()
     }
 }
 
+Lv2cX11Window::clock_t::time_point Lv2cX11Window::NextDeadline(clock_t::time_point now)
+{
+    clock_t::time_point result = clock_t::time_point::max();
+    if (delayedFocusRestore)
+    {
+        result = std::min(result, restoreFocusTime);
+    }
+    if (cairoWindow)
+    {
+        if (cairoWindow->HasPendingRedraw())
+        {
+            return now;
+        }
+        if (cairoWindow->HasAnimationCallbacks())
+        {
+            result = std::min(result, lastAnimationFrameTime + ANIMATION_DELAY);
+        }
+        auto delayTime = cairoWindow->NextDelayedCallbackTime();
+        if (delayTime)
+        {
+            result = std::min(result, *delayTime);
+        }
+    }
+    for (auto child : childWindows)
+    {
+        result = std::min(result, child->NextDeadline(now));
+    }
+    return result;
+}
+
+bool Lv2cX11Window::AnimationDue(clock_t::time_point now)
+{
+    if (cairoWindow)
+    {
+        if (cairoWindow->HasAnimationCallbacks() && now + ANIMATION_SLACK >= lastAnimationFrameTime + ANIMATION_DELAY)
+        {
+            return true;
+        }
+        auto delayTime = cairoWindow->NextDelayedCallbackTime();
+        if (delayTime && *delayTime <= now)
+        {
+            return true;
+        }
+    }
+    for (auto child : childWindows)
+    {
+        if (child->AnimationDue(now))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Lv2cX11Window::RedrawPending()
+{
+    if (cairoWindow && cairoWindow->HasPendingRedraw())
+    {
+        return true;
+    }
+    for (auto child : childWindows)
+    {
+        if (child->RedrawPending())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Lv2cX11Window::DrainWakeupEvents()
+{
+    if (cairoWindow)
+    {
+        cairoWindow->DrainWakeupEvents();
+    }
+    for (auto child : childWindows)
+    {
+        child->DrainWakeupEvents();
+    }
+}
+
+bool Lv2cX11Window::ProcessIdleWork()
+{
+    if (schedulerMode != Lv2cSchedulerMode::EventDriven)
+    {
+        Animate();
+        OnIdle();
+        XFlush(x11Display);
+        return true;
+    }
+    bool didWork = false;
+    if (AnimationDue(clock_t::now()))
+    {
+        Animate();
+        didWork = true;
+    }
+    if (RedrawPending())
+    {
+        OnIdle();
+        didWork = true;
+    }
+    if (didWork)
+    {
+        XFlush(x11Display);
+    }
+    return didWork;
+}
+
 void Lv2cX11Window::Animate()
 {
 
@@ -965,9 +1510,10 @@ bool Lv2cX11Window::ProcessEvents()
         if (!pendingEvent)
         {
             CheckForRestoreFocus();
-            Animate();
-            OnIdle();
-            XFlush(x11Display);
+            if (ProcessIdleWork() || processedAnyMessage)
+            {
+                ++wakeupCount;
+            }
             return processedAnyMessage;
         }
         else
@@ -982,6 +1528,7 @@ bool Lv2cX11Window::ProcessEvents()
 
 void Lv2cX11Window::ProcessEvent(XEvent &xEvent)
 {
+    LV2C_PROFILE_SCOPE("Lv2cX11Window::ProcessEvent");
     switch (xEvent.type)
     {
     case ButtonPress:
@@ -1091,6 +1638,22 @@ void Lv2cX11Window::ProcessEvent(XEvent &xEvent)
         }
         break;
 
+    case GraphicsExpose:
+    {
+        Lv2cWindow::ptr window = GetLv2cWindow(xEvent.xgraphicsexpose.drawable);
+        if (window)
+        {
+            window->OnExpose(
+                WindowHandle(xEvent.xgraphicsexpose.drawable),
+                xEvent.xgraphicsexpose.x,
+                xEvent.xgraphicsexpose.y,
+                xEvent.xgraphicsexpose.width,
+                xEvent.xgraphicsexpose.height);
+        }
+        break;
+    }
+    case NoExpose:
+        break;
     case Expose:
     {
         Lv2cWindow::ptr window = GetLv2cWindow(xEvent.xexpose.window);
@@ -1177,7 +1740,14 @@ void Lv2cX11Window::ProcessEvent(XEvent &xEvent)
             if (child->size != size)
             {
                 child->size = size;
-                cairo_xlib_surface_set_size(child->cairoSurface, size.Width(), size.Height());
+                if (child->backBuffer)
+                {
+                    child->SurfaceResize(size);
+                }
+                else
+                {
+                    cairo_xlib_surface_set_size(child->cairoSurface, size.Width(), size.Height());
+                }
             }
             child->FireConfigurationChanged();
         }
@@ -1357,9 +1927,18 @@ void Lv2cX11Window::ProcessEvent(XEvent &xEvent)
         break;
     }
     default:
+    {
+        // ShmCompletion is normally consumed by WaitForPresent(), unless it arrives while processing events.
+        Lv2cX11Window *window = GetChild(xEvent.xany.window); // XShmCompletionEvent::drawable
+        if (window && window->backBuffer && window->shmCompletionEvent != -1 && xEvent.type == window->shmCompletionEvent)
+        {
+            window->backBuffer->presentPending = false;
+            break;
+        }
         // LOG_TRACE(0, SS("Dropping unhandled XEevent.type = " << xEvent.type));
         break;
     }
+    }
 }
 
 bool Lv2cX11Window::GrabPointer()
@@ -1454,6 +2033,11 @@ void Lv2cX11Window::RegisterControllerMessages()
     animateMessage = XInternAtom(x11Display, "AnimateMsg", True);
 }
 
+Lv2cNativeWindow *Lv2cX11Window::CreateChild(Lv2cWindow::ptr window, Lv2cCreateWindowParameters &parameters)
+{
+    return new Lv2cX11Window(window, this, parameters);
+}
+
 WindowHandle Lv2cX11Window::Handle()
 {
     return WindowHandle(this->x11Window);
@@ -1466,6 +2050,15 @@ void Lv2cX11Window::AddFileDescriptors(int &maxFd, fd_set &fdSet)
     {
         maxFd = x11_fd + 1;
     }
+    if (cairoWindow && cairoWindow->WakeupFd() != -1)
+    {
+        int wakeupFd = cairoWindow->WakeupFd();
+        FD_SET(wakeupFd, &fdSet);
+        if (wakeupFd + 1 > maxFd)
+        {
+            maxFd = wakeupFd + 1;
+        }
+    }
     for (auto child : childWindows)
     {
         child->AddFileDescriptors(maxFd, fdSet);
@@ -1819,6 +2412,11 @@ bool Lv2cX11Window::waitForX11Event(std::chrono::milliseconds ms)
     {
         return this->parent->waitForX11Event(ms);
     }
+    if (XEventsQueued(x11Display, QueuedAlready) != 0)
+    {
+        // already read from the socket, which won't signal.
+        return true;
+    }
     using namespace std::chrono;
 
     auto microseconds = duration_cast<std::chrono::microseconds>(ms).count();
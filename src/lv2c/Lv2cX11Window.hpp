@@ -24,6 +24,7 @@
 #include <pango/pangocairo.h>
 #include "lv2c/Lv2cLog.hpp"
 #include "lv2c/Lv2cWindow.hpp"
+#include "Lv2cNativeWindow.hpp"
 #include "keysym_names.hpp"
 
 #include <stdlib.h>
@@ -38,13 +39,14 @@ typedef unsigned long XID;
 typedef XID Window;
 typedef XID Atom;
 typedef union _XEvent XEvent;
+typedef struct _XGC *GC;
 
 // typedef struct fd_set;
 
 namespace lv2c
 {
 
-    class Lv2cX11Window
+    class Lv2cX11Window : public Lv2cNativeWindow
     {
         Lv2cX11Window(const Lv2cX11Window &) = delete;
         Lv2cX11Window(Lv2cX11Window &&) = delete;
@@ -81,14 +83,16 @@ namespace lv2c
             Lv2cX11Window *parentNativeWindow,
             Lv2cCreateWindowParameters&parameters);
 
-        ~Lv2cX11Window();
+        ~Lv2cX11Window() override;
 
-        WindowHandle Handle();
+        Lv2cNativeWindow *CreateChild(Lv2cWindow::ptr window, Lv2cCreateWindowParameters &parameters) override;
 
-        void Close();
+        WindowHandle Handle() override;
 
+        void Close() override;
 
-        void WindowTitle(const std::string &title);
+
+        void WindowTitle(const std::string &title) override;
         void SetWindowType(Lv2cWindowType windowType);
         void SetTransientFor(Window dialogWindow, Window parentWindow);
 
@@ -113,41 +117,56 @@ namespace lv2c
         void SetProperty(const std::string &property, const std::vector<int32_t> &data);
 
 
-        void SetMouseCursor(Lv2cCursor cursor);
-        bool ProcessEvents();
+        void SetMouseCursor(Lv2cCursor cursor) override;
+        bool ProcessEvents() override;
 
         void ProcessEvent(XEvent &xEvent);
 
-        bool PostQuit();
+        bool PostQuit() override;
         bool PostQuit(Window x11Window);
-        bool Quitting() const;
+        bool Quitting() const override;
 
         // returns true if done.
-        bool AnimationLoop();
+        bool AnimationLoop() override;
+
+        /// @brief The number of times the event loop has woken up and done work.
+        uint64_t WakeupCount() const override { return wakeupCount; }
+
+        void TraceEvents(bool value) override;
+        cairo_surface_t *GetSurface() override { return cairoSurface; }
 
-        void TraceEvents(bool value);
-        cairo_surface_t *GetSurface() { return cairoSurface; }
+        /// @brief True if drawing goes to a client-side back buffer that must be presented.
+        bool HasBackBuffer() const override { return backBuffer != nullptr; }
+        /// @brief Wait until the X server has finished reading the back buffer.
+        void BeginDraw() override;
+        /// @brief Copy areas of the back buffer to the window (device coordinates).
+        /// With MIT-SHM, returns without waiting for the server to read the buffer (see BeginDraw()).
+        void Present(const std::vector<Lv2cRectangle> &deviceRectangles) override;
 
-        PangoContext *GetPangoContext();
+        /// @brief Copy an area of the window to another location in the window (device coordinates).
+        /// Parts of the source that aren't available (because the window is obscured) are reported as exposed.
+        void CopyArea(int64_t x, int64_t y, int64_t width, int64_t height, int64_t destX, int64_t destY) override;
 
-        Lv2cSize Size() const { return size; }
+        PangoContext *GetPangoContext() override;
 
-        bool GrabPointer();
-        void UngrabPointer();
+        Lv2cSize Size() const override { return size; }
 
-        void SendAnimationFrameMessage();
-        void SendControlChangedMessage(int32_t control, float value);
+        bool GrabPointer() override;
+        void UngrabPointer() override;
 
-        void SetStringProperty(const std::string&key, const std::string&value);
+        void SendAnimationFrameMessage() override;
+        void SendControlChangedMessage(int32_t control, float value) override;
+
+        void SetStringProperty(const std::string&key, const std::string&value) override;
         std::optional<std::string> GetStringProperty(const std::string&key);
 
-        void Resize(int width, int height);
+        void Resize(int width, int height) override;
 
 
         static void SetErrorHandler();
         static void ReleaseErrorHandler();
 
-        void Sync();
+        void Sync() override;
 
 
     private:
@@ -184,6 +203,14 @@ namespace lv2c
 
         void CreateSurface(int w, int h);
         void SurfaceResize(Lv2cSize size);
+
+        struct BackBuffer;
+        bool CreateBackBuffer(int width, int height);
+        void DestroyBackBuffer();
+        bool AttachShm(BackBuffer &buffer);
+        Lv2cX11Window *DisplayOwner();
+        void WaitForPresent();
+        GC GetGC();
         void*GenerateNormalHints(Lv2cCreateWindowParameters &parameters);
         void SetNormalHints(void*);
 
@@ -217,6 +244,15 @@ namespace lv2c
         void Animate();
         clock_t::time_point lastAnimationFrameTime;
 
+        // Event-driven scheduling.
+        clock_t::time_point NextDeadline(clock_t::time_point now);
+        bool AnimationDue(clock_t::time_point now);
+        bool RedrawPending();
+        void DrainWakeupEvents();
+        bool ProcessIdleWork();
+        Lv2cSchedulerMode schedulerMode = Lv2cSchedulerMode::FixedFrameRate;
+        uint64_t wakeupCount = 0;
+
         Lv2cWindowType windowType = Lv2cWindowType::Normal;
         Atom controlMessage = 0;
         Atom animateMessage = 0;
@@ -234,6 +270,11 @@ namespace lv2c
         bool traceEvents = false;
         bool quitting = false;
         cairo_surface_t *cairoSurface = nullptr;
+        std::unique_ptr<BackBuffer> backBuffer;
+        bool shmFailed = false;
+        int shmCompletionEvent = -1;
+        int shmExtension = -1; // per display: only set on the DisplayOwner().
+        GC x11GC = nullptr;
         Display *x11Display = nullptr;
         Window x11Window = 0;
         Window x11ParentWindow = 0;
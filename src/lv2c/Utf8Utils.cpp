@@ -197,11 +197,11 @@ namespace lv2c
                     throw std::runtime_error("Invalid UTF32 character sequence.");
                 }
                 char32_t value2 = *i++;
-                if ((value & UTF16_SURROGATE_TAG_MASK) != UTF16_SURROGATE_2_BASE)
+                if ((value2 & UTF16_SURROGATE_TAG_MASK) != UTF16_SURROGATE_2_BASE)
                 {
                     throw std::runtime_error("Invalid UTF32 character sequence.");
                 }
-                value = (value << 10) + value2;
+                value = 0x10000 + ((value & 0x3FFu) << 10) + (value2 & 0x3FFu);
             }
 
             if (value < 0x7F)
@@ -0,0 +1,198 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+#include "JsonVariant.hpp"
+#include "JsonIo.hpp"
+
+namespace lv2c
+{
+    /// @brief Callbacks for json_buffer_reader::parse().
+    ///
+    /// String views passed to the handler are only valid for the duration of the call.
+    class json_sax_handler
+    {
+    public:
+        virtual ~json_sax_handler() {}
+
+        virtual void null_value() = 0;
+        virtual void bool_value(bool value) = 0;
+        virtual void number_value(double value) = 0;
+        virtual void string_value(std::string_view value) = 0;
+        virtual void start_array() = 0;
+        virtual void end_array() = 0;
+        virtual void start_object() = 0;
+        virtual void key(std::string_view key) = 0;
+        virtual void end_object() = 0;
+    };
+
+    /// @brief Reads JSON from an in-memory buffer.
+    ///
+    /// Accepts the same dialect as json_reader (comments, single-quoted strings, NaN),
+    /// but scans the buffer directly instead of reading character-by-character from
+    /// a std::istream. Strings without escapes are passed to handlers as views into
+    /// the buffer, so the buffer must outlive the reader.
+    ///
+    /// Errors throw json_exception.
+    class json_buffer_reader
+    {
+    public:
+        static constexpr size_t MAX_DEPTH = 512;
+
+        json_buffer_reader(std::string_view text);
+
+        bool allowNaN() const { return allowNaN_; }
+        void allowNaN(bool allow) { allowNaN_ = allow; }
+
+        /// @brief Parse a single value, which must be followed only by whitespace or comments.
+        void parse(json_sax_handler &handler);
+
+        /// @brief Parse a single value into a json_variant.
+        void read(json_variant *value);
+
+    private:
+        void parse_value(json_sax_handler &handler, size_t depth);
+        std::string_view read_string();
+        double read_number();
+        void read_u_escape(std::string &output);
+        uint16_t read_hex4();
+        void consume_token(const char *token, const char *errorMessage);
+        void skip_whitespace();
+        void throw_format_error(const std::string &message);
+
+        bool allowNaN_ = true;
+        const char *start;
+        const char *p;
+        const char *end;
+        std::string scratch;
+    };
+
+    class json_value;
+
+    /// @brief An object member of a json_document.
+    struct json_member;
+
+    /// @brief An immutable JSON value, stored in a json_document's arena.
+    ///
+    /// Strings are views into the document's source text, or into the arena
+    /// if they contained escape sequences.
+    class json_value
+    {
+    public:
+        using ContentType = json_variant::ContentType;
+
+        ContentType type() const { return content_type; }
+        bool is_null() const { return content_type == ContentType::Null; }
+        bool is_bool() const { return content_type == ContentType::Bool; }
+        bool is_number() const { return content_type == ContentType::Number; }
+        bool is_string() const { return content_type == ContentType::String; }
+        bool is_object() const { return content_type == ContentType::Object; }
+        bool is_array() const { return content_type == ContentType::Array; }
+
+        bool as_bool() const;
+        double as_number() const;
+        std::string_view as_string() const;
+
+        /// @brief The number of array elements or object members.
+        size_t size() const;
+
+        /// @brief Array element.
+        const json_value &operator[](size_t index) const;
+
+        /// @brief Object member lookup. Returns nullptr if not present.
+        const json_value *find(std::string_view key) const;
+
+        const json_value *array_begin() const;
+        const json_value *array_end() const;
+        const json_member *object_begin() const;
+        const json_member *object_end() const;
+
+        json_variant to_variant() const;
+
+    private:
+        friend class json_document;
+        void require_type(ContentType contentType) const;
+
+        ContentType content_type = ContentType::Null;
+        union
+        {
+            bool bool_value;
+            double double_value;
+            struct
+            {
+                const char *data;
+                size_t length;
+            } string_value;
+            struct
+            {
+                const void *items;
+                size_t count;
+            } container_value;
+        };
+    };
+
+    struct json_member
+    {
+        std::string_view key;
+        json_value value;
+    };
+
+    /// @brief A read-only JSON DOM with arena-allocated nodes.
+    ///
+    /// The document owns its source text; all nodes and strings are freed 
+    /// together when the document is destroyed.
+    class json_document
+    {
+    public:
+        using ptr = std::shared_ptr<json_document>;
+
+        static ptr parse(std::string text, bool allowNaN = true);
+        static ptr load(const std::string &filename, bool allowNaN = true);
+
+        json_document(const json_document &) = delete;
+        json_document &operator=(const json_document &) = delete;
+
+        const json_value &root() const { return root_; }
+
+        /// @brief Bytes allocated in the arena (excluding the source text).
+        size_t arena_bytes() const { return arenaBytes; }
+
+    private:
+        class builder;
+
+        json_document(std::string &&text);
+
+        void *allocate(size_t size);
+
+        std::string text;
+        json_value root_;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char *blockPosition = nullptr;
+        size_t blockRemaining = 0;
+        size_t arenaBytes = 0;
+    };
+
+}
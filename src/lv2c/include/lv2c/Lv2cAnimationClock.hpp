@@ -0,0 +1,65 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace lv2c
+{
+    /// @brief The clock used for animation callbacks, PostDelayed() and element animations.
+    ///
+    /// Normally reads std::chrono::steady_clock. In manual mode, time stands still 
+    /// except when advanced explicitly, so that animations can be stepped 
+    /// deterministically (see Lv2cHeadlessWindow). Manual mode is process-wide,
+    /// and is intended for tests and benchmarks only.
+    class Lv2cAnimationClock
+    {
+    public:
+        using base_clock = std::chrono::steady_clock;
+        using rep = base_clock::rep;
+        using period = base_clock::period;
+        using duration = base_clock::duration;
+        // time points are interchangeable with steady_clock time points.
+        using time_point = base_clock::time_point;
+        static constexpr bool is_steady = true;
+
+        static time_point now()
+        {
+            if (manual.load(std::memory_order_relaxed))
+            {
+                return time_point(duration(manualTime.load(std::memory_order_relaxed)));
+            }
+            return base_clock::now();
+        }
+
+        /// @brief Enable or disable manual mode.
+        /// Entering manual mode freezes the clock at the current time.
+        static void Manual(bool value);
+        static bool Manual() { return manual; }
+
+        /// @brief Advance the clock (manual mode only).
+        static void Advance(duration value);
+
+    private:
+        static std::atomic<bool> manual;
+        static std::atomic<rep> manualTime;
+    };
+}
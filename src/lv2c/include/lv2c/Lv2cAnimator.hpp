@@ -37,7 +37,7 @@ namespace lv2c
     class Lv2cAnimator
     {
     public:
-        using clock_t = std::chrono::steady_clock;
+        using clock_t = animation_clock_t;
         using easing_function_t = std::function<double(double)>;
 
         ~Lv2cAnimator();
@@ -0,0 +1,123 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "Lv2cDrawingContext.hpp"
+#include "Lv2cSvg.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace lv2c
+{
+    /// @brief Process-wide cache of PNG images and SVG documents loaded from files.
+    ///
+    /// Shared by all Lv2cWindow instances (and so all instances of a plugin UI loaded into the same host
+    /// process), so that each file is parsed once. Entries are keyed by canonical path, and are reloaded
+    /// if the file's modification time changes. Cached assets are shared and must not be modified.
+    ///
+    /// Thread-safe. Entries that are no longer referenced outside the cache are evicted, least-recently 
+    /// used first, when the cache exceeds its memory limit, and all of them are discarded when the last 
+    /// client (Lv2cWindow) is released. Assets that are still in use are never evicted.
+    class Lv2cAssetCache
+    {
+    public:
+        /// @brief The default value of MaxBytes().
+        static constexpr size_t DEFAULT_MAX_BYTES = 32 * 1024 * 1024;
+
+        /// @brief The process-wide instance.
+        static Lv2cAssetCache &Instance();
+
+        Lv2cAssetCache() {}
+        Lv2cAssetCache(const Lv2cAssetCache &) = delete;
+        Lv2cAssetCache &operator=(const Lv2cAssetCache &) = delete;
+
+        /// @brief Get a PNG image.
+        /// @param path The path of the PNG file.
+        /// @returns The image, or an empty surface if the file couldn't be loaded.
+        Lv2cSurface GetPng(const std::filesystem::path &path);
+
+        /// @brief Get an SVG document.
+        /// @param path The path of the SVG file.
+        /// @returns The document. Throws std::runtime_error if the file can't be loaded.
+        Lv2cSvg::ptr GetSvg(const std::filesystem::path &path);
+
+        /// @brief Limit the memory used by unreferenced cache entries.
+        /// @param maxBytes The limit in bytes, or 0 for no limit. Defaults to DEFAULT_MAX_BYTES.
+        ///
+        /// PNG images are charged at their decoded size; SVG documents at their file size.
+        void MaxBytes(size_t maxBytes);
+        size_t MaxBytes() const;
+
+        /// @brief Register a client of the cache. Called by Lv2cWindow.
+        void AddClient();
+        /// @brief Release a client of the cache.
+        /// When the last client is released (e.g. when the last plugin UI in a host closes), entries 
+        /// that are not in use are discarded.
+        void ReleaseClient();
+
+        /// @brief Discard all cached entries. Assets that are in use remain valid.
+        void Clear();
+
+        struct Stats
+        {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            /// @brief Misses caused by a change to the file's modification time.
+            uint64_t reloads = 0;
+            uint64_t evictions = 0;
+            size_t entries = 0;
+            size_t bytes = 0;
+        };
+        Stats GetStats() const;
+        void ResetStats();
+
+    private:
+        struct Entry
+        {
+            std::string key;
+            std::filesystem::file_time_type modified;
+            Lv2cSurface png;
+            Lv2cSvg::ptr svg;
+            size_t bytes = 0;
+
+            bool InUse() const;
+        };
+        using EntryList = std::list<Entry>;
+
+        static std::string MakeKey(const std::filesystem::path &path, char type, std::filesystem::file_time_type *modified);
+        Entry *Find(const std::string &key, std::filesystem::file_time_type modified);
+        Entry &Add(Entry &&entry);
+        void Trim();
+        void DiscardUnused();
+
+        mutable std::mutex mutex;
+        EntryList entries; // most-recently used first.
+        std::unordered_map<std::string, EntryList::iterator> index;
+        size_t maxBytes = DEFAULT_MAX_BYTES;
+        size_t bytes = 0;
+        size_t clients = 0;
+        Stats stats;
+    };
+}
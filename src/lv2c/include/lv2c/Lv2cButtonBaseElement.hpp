@@ -76,7 +76,7 @@ namespace lv2c {
         void CancelKeyboardDelay();
 
 
-        using clock_t = std::chrono::steady_clock;
+        using clock_t = animation_clock_t;
         clock_t::time_point animationStartTime; 
         double animationStartValue = 0;
         bool animationIncreasing = false;
@@ -21,6 +21,7 @@
 
 #include "Lv2cContainerElement.hpp"
 #include "Lv2cButtonBaseElement.hpp"
+#include "Lv2cProfiler.hpp"
 
 
 namespace lv2c {
@@ -75,6 +76,7 @@ namespace lv2c {
         virtual void Measure(Lv2cSize constraint, Lv2cSize maxAvailable,Lv2cDrawingContext &context) override;
         virtual Lv2cSize Arrange(Lv2cSize available,Lv2cDrawingContext &context) override
         {
+            LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
             return super::Arrange(available,context);
         }
         virtual bool WantsFocus() const override { 
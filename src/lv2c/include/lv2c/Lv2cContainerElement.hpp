@@ -88,6 +88,8 @@ namespace lv2c {
         /// @brief Remove all children.
         virtual void RemoveAllChildren();
 
+        virtual void InvalidateComputedStyle() override;
+
         /// @brief Get the number of direct child elements.
         // See LayoutChildren() for an explanation of logical and physical children.
         virtual size_t LayoutChildCount() const;
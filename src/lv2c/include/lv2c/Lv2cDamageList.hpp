@@ -27,11 +27,42 @@ namespace lv2c {
 
     class Lv2cDamageList {
     public:
+        /// @brief Default cost of drawing one more damage rectangle, in device pixels.
+        ///
+        /// Each rectangle costs a full element-tree walk plus a push_group/pop_group, which
+        /// is roughly the cost of painting this many extra pixels.
+        static constexpr int64_t DEFAULT_RECTANGLE_COST = 16384;
+        /// @brief Default cap on the number of rectangles returned by GetDamageList().
+        static constexpr size_t DEFAULT_MAX_RECTANGLES = 16;
+
         void Invalidate(const Lv2cRectangle &rectangle);
         void ExposeRect(int64_t x, int64_t y, int64_t width, int64_t height);
 
+        /// @brief Return and clear the damaged area.
+        ///
+        /// The damaged area is tracked exactly. If a merge policy has been set, rectangles whose
+        /// union adds less than rectangleCost undamaged pixels are merged, and the closest
+        /// rectangles are merged until no more than maxRectangles remain.
         std::vector<Lv2cRectangle> GetDamageList();
 
+        /// @brief Set the cost model used to merge rectangles in GetDamageList().
+        /// @param rectangleCost The cost of drawing an additional rectangle, in device pixels.
+        /// @param maxRectangles The maximum number of rectangles to return (0 for no limit).
+        ///
+        /// By default, rectangles are not merged.
+        void SetMergePolicy(int64_t rectangleCost = DEFAULT_RECTANGLE_COST, size_t maxRectangles = DEFAULT_MAX_RECTANGLES);
+
+        /// @brief Track a scroll of the contents of a rectangle.
+        /// @param rectangle The scrolled area.
+        /// @param dx Horizontal distance the contents moved.
+        /// @param dy Vertical distance the contents moved.
+        ///
+        /// Damaged areas within the rectangle are copied to their scrolled positions (the pixels
+        /// they refer to have moved), and the strips that the scroll exposes are marked as damaged.
+        void Scroll(const Lv2cRectangle &rectangle, int64_t dx, int64_t dy);
+
+        bool IsEmpty() const { return lineCount == 0; }
+
         void SetSize(int64_t width, int64_t height);
         int64_t Width() const;
         int64_t Height() const;
@@ -43,8 +74,10 @@ namespace lv2c {
             DamageRect(int64_t left, int64_t right, int64_t top, int64_t bottom) : left(left),right(right),top(top),bottom(bottom) {}
 
             static DamageRect intersect(const DamageRect &r0, const DamageRect&r1);
+            static DamageRect unionOf(const DamageRect &r0, const DamageRect&r1);
 
-            bool isEmpty() { return right <= left || bottom <= top; }
+            bool isEmpty() const { return right <= left || bottom <= top; }
+            int64_t area() const { return isEmpty() ? 0: (right-left)*(bottom-top); }
 
             int64_t left, right,top,bottom;
         };
@@ -54,27 +87,46 @@ namespace lv2c {
         DamageRect bounds;
 
         struct DamageLine {
-            using ptr = std::unique_ptr<DamageLine>;
-
-            DamageLine(const DamageRect &rect)
-            : top(rect.top),
-              bottom(rect.bottom)
-            {   
+            void reset(const DamageRect &rect)
+            {
+                top = rect.top;
+                bottom = rect.bottom;
+                points.resize(0);
                 points.push_back(rect.left);
                 points.push_back(rect.right);
             }
+            // copy, reusing the points buffer.
+            void assign(const DamageLine &other)
+            {
+                top = other.top;
+                bottom = other.bottom;
+                points.assign(other.points.begin(),other.points.end());
+            }
 
             void addRange(int64_t left, int64_t right);
             bool contains(int64_t left, int64_t right);
 
-            int64_t top;
-            int64_t bottom;
+            int64_t top = 0;
+            int64_t bottom = 0;
             std::vector<int64_t> points;
         };
 
-        static bool canMerge(const DamageLine*line1,const DamageLine*line2);
+        static bool canMerge(const DamageLine&line1,const DamageLine&line2);
+
+        DamageLine&InsertLine(size_t position);
+        void EraseLine(size_t position);
+
+        void MergeRects(std::vector<DamageRect>&rects);
+
+        // damageLines[0..lineCount) are the damaged bands, sorted by top. Lines past lineCount
+        // are spares, kept so that their point buffers get reused from frame to frame.
+        std::vector<DamageLine> damageLines;
+        size_t lineCount = 0;
+
+        std::vector<DamageRect> rectBuffer;
 
-        std::vector<DamageLine::ptr> damageLines;
+        int64_t rectangleCost = 0;
+        size_t maxRectangles = 0;
     };
 
 } // namespace
\ No newline at end of file
@@ -41,7 +41,7 @@ namespace lv2c {
 
     protected:
         double ValueToClient(double value, const Lv2cRectangle&vuRectangle);
-        using clock_t = std::chrono::steady_clock;
+        using clock_t = animation_clock_t;
         AnimationHandle animationHandle;
         clock_t::time_point animationStartTime;
         double animationStartValue = 0;
@@ -97,7 +97,7 @@ namespace lv2c {
         double MaxValue() { return MaxValueProperty.get(); }
 
     protected:
-        using clock_t = std::chrono::steady_clock;
+        using clock_t = animation_clock_t;
         AnimationHandle animationHandle;
         clock_t::time_point leftAnimationStartTime;
         clock_t::time_point rightAnimationStartTime;
@@ -66,7 +66,7 @@ namespace lv2c
 
         void OnValueChanged(double value) override;
     private:
-        using clock_t = std::chrono::steady_clock;
+        using clock_t = animation_clock_t;
 
         bool canDoubleClick = false;
         Lv2cPoint lastMouseDownPosition = Lv2cPoint(-1,-1);
@@ -451,6 +451,7 @@ namespace lv2c
         void rotate(double angle) { cairo_rotate(context, angle); }
         void transform(const cairo_matrix_t *matrix) { cairo_transform(context, matrix); }
         void set_matrix(const cairo_matrix_t *matrix) { cairo_set_matrix(context, matrix); }
+        void get_matrix(cairo_matrix_t *matrix) { cairo_get_matrix(context, matrix); }
         void identity_matrix() { cairo_identity_matrix(context); }
 
         Lv2cRectangle round_to_device(const Lv2cRectangle &rectangle);
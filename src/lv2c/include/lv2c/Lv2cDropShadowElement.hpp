@@ -21,6 +21,7 @@
 
 #include "Lv2cContainerElement.hpp"
 #include "Lv2cBindingProperty.hpp"
+#include "Lv2cShadowCache.hpp"
 
 namespace lv2c
 {
@@ -90,7 +91,9 @@ namespace lv2c
     private:
         bool IsSolidBackground() const;
         bool IsInterior(const Lv2cRectangle &rectangle) const;
+        void GetShadowOffset(double *pXOffset, double *pYOffset, double *pXOffsetFrac, double *pYOffsetFrac);
         void BlurDropShadow(Lv2cDrawingContext &dc, cairo_surface_t *surface, double *pXOffset, double *pYOffset);
+        Lv2cImageSurface RenderShadowNinePatch(const Lv2cShadowCacheKey &key);
         void BlurInsetDropShadow(Lv2cDrawingContext &dc, cairo_surface_t *surface);
         void DrawDropShadow(Lv2cDrawingContext &dc, const Lv2cRectangle &clipRect);
         bool DrawFastDropShadow(Lv2cDrawingContext &dc, const Lv2cRectangle &clipRect);
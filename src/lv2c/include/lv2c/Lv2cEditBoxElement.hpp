@@ -147,11 +147,10 @@ namespace lv2c
         Lv2cSize clientMeasure;
         Lv2cStyle::ptr GetVariantStyle();
         SelectionRange selection;
-        PangoFontDescription*GetFontDescription();
+        const PangoFontDescription*GetFontDescription();
 
         PangoLayout *pangoLayout = nullptr;
         PangoFontDescriptor *fontDescriptor = nullptr;
-        std::string GetFontFamily();
 
         bool singleLine = true;
 
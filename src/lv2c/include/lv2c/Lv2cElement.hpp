@@ -30,6 +30,7 @@
 #include <iostream>
 #include "Lv2cUserData.hpp"
 #include "Lv2cObject.hpp"
+#include "Lv2cAnimationClock.hpp"
 #include <chrono>
 
 
@@ -39,8 +40,8 @@ typedef struct _PangoContext PangoContext;
 namespace lv2c
 {
 
-    using animation_clock_t = std::chrono::steady_clock;
-    using animation_clock_time_point_t = std::chrono::steady_clock::time_point;
+    using animation_clock_t = Lv2cAnimationClock;
+    using animation_clock_time_point_t = animation_clock_t::time_point;
 
     class Lv2cDrawingContext;
 
@@ -82,6 +83,8 @@ namespace lv2c
         virtual bool WillDrawBorder() const;
 
         /// @brief Request a new layout pass for this element.
+        /// Layout dirtiness propagates to the nearest layout boundary (see IsLayoutBoundary()), 
+        /// or to the window. Only the dirty subtree is laid out again.
         virtual void InvalidateLayout();
         /// @brief Request a new layout pass this element's parent.
         /// Does not run layout on the the entire visual tree.
@@ -98,6 +101,28 @@ namespace lv2c
 
         virtual void InvalidateScreenRect(const Lv2cRectangle &screenRectangle);
 
+        /// @brief Draw the element and its children through an offscreen layer.
+        ///
+        /// When enabled, the element's background and subtree are cached in an offscreen surface, and
+        /// composited into the window when drawn. Only areas of the layer that have been invalidated by the element
+        /// or its children are redrawn; the rest of the layer is reused. Damage caused by other elements
+        /// (animations drawn over or beside the element, for example) is repaired by compositing the cached
+        /// layer, without calling OnDraw() for the element or its children.
+        ///
+        /// Useful for complex, mostly-static elements that share screen area with frequently
+        /// animated elements. Off by default.
+        ///
+        /// The layer covers only the visible part of the element (its draw bounds, clipped by
+        /// any scroll viewport above it), so it is redrawn when the element scrolls.
+        Lv2cElement &Layer(bool value);
+        bool Layer() const;
+
+        /// @brief The number of times the contents of the element's layer have been (partially) redrawn.
+        uint64_t LayerRedrawCount() const { return layerRedrawCount; }
+
+        /// @brief The size of the element's layer surface, in device pixels. Empty if no layer has been allocated.
+        Lv2cSize LayerSize() const { return layerDeviceBounds.Size(); }
+
 
         void PrintStructure() const;
     public:
@@ -183,6 +208,9 @@ namespace lv2c
     private:
 
         void PartialLayout();
+        void InvalidateMeasure();
+        bool RelayoutSubtree(Lv2cDrawingContext &context);
+        static void CountLayout();
         Lv2cUserData::ptr userData;
         virtual bool FireKeyDown(const Lv2cKeyboardEventArgs&event);
         virtual bool FireMouseDown(Lv2cMouseEventArgs&event);
@@ -196,10 +224,12 @@ namespace lv2c
         void Style(const Lv2cStyle &style) { 
             this->style = style;
             this->style.SetElement(this);
+            InvalidateComputedStyle();
         }
         void Style(Lv2cStyle &&style) { 
             this->style = std::move(style); 
             this->style.SetElement(this);
+            InvalidateComputedStyle();
         }
 
         Lv2cStyle &Style() { return style; }
@@ -218,6 +248,11 @@ namespace lv2c
 
         const std::vector<Lv2cStyle::ptr>&Classes() const;
 
+        /// @brief Discard cached style property resolutions for this element and its descendants.
+        /// Called when the element's style or classes change, or when the element
+        /// is added to or removed from a parent.
+        virtual void InvalidateComputedStyle();
+
 
         Lv2cSize ClientSize() const { return clientSize; }
         Lv2cRectangle ClientRectangle() const { return Lv2cRectangle{ClientSize()};}
@@ -299,6 +334,31 @@ namespace lv2c
 
         bool LayoutValid() const;
 
+        /// @brief Can the element be laid out again without laying out its parent?
+        /// True if the element has a fixed pixel Width() and Height(), is not stretched, 
+        /// and was arranged by its parent at exactly its measured size. Changes to the 
+        /// contents of a layout boundary don't change its size, so InvalidateLayout() stops
+        /// propagating at the boundary.
+        bool IsLayoutBoundary() const;
+
+        /// @brief Enable or disable measure caching and partial relayout (for all windows). Enabled by default.
+        static void EnableIncrementalLayout(bool enable);
+        static bool IncrementalLayoutEnabled();
+
+        /// @brief Layout counters (for all windows).
+        struct LayoutStatistics {
+            /// @brief Full layout passes.
+            uint64_t layouts = 0;
+            /// @brief Layout passes over dirty subtrees of a layout boundary.
+            uint64_t partialLayouts = 0;
+            /// @brief Calls to Measure().
+            uint64_t measureRequests = 0;
+            /// @brief Calls to Measure() that were answered from the element's measure cache.
+            uint64_t measureCacheHits = 0;
+        };
+        static LayoutStatistics GetLayoutStatistics();
+        static void ResetLayoutStatistics();
+
     protected:
         // utility functions for layout calculations.
         Lv2cSize MeasuredSizeSizeFromStyle(Lv2cSize available);
@@ -411,6 +471,14 @@ namespace lv2c
         std::vector<Lv2cStyle::ptr> classes;
         Lv2cRectangle savedLayoutClipRect;
         bool savedClippedInLayout = false;
+        Lv2cRectangle savedParentBounds;
+
+        // measure cache.
+        bool measureValid = false;
+        Lv2cSize savedMeasureConstraint;
+        Lv2cSize savedMeasureAvailable;
+        uint64_t savedMeasureStyleGeneration = 0;
+        bool relayoutPending = false;
         Lv2cRectangle screenDrawBounds;
         Lv2cRectangle screenBounds;
         Lv2cRectangle screenBorderBounds;
@@ -420,6 +488,14 @@ namespace lv2c
         void PrintStructure(std::ostream&s) const;
         void PrintStructure(std::ostream&s,size_t indent) const;
         Lv2cHoverState hoverState = Lv2cHoverState::Empty;
+
+        void DrawLayer(Lv2cDrawingContext &dc, const Lv2cRectangle &clipBounds);
+        void ReleaseLayer();
+        bool layer = false;
+        Lv2cSurface layerSurface;
+        Lv2cRectangle layerDeviceBounds;
+        Lv2cRectangle layerDirtyRect; // in screen coordinates.
+        uint64_t layerRedrawCount = 0;
     private:
         friend class Lv2cWindow;
         friend class Lv2cContainerElement;
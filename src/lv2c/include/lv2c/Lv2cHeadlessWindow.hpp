@@ -0,0 +1,130 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "Lv2cWindow.hpp"
+#include "Lv2cAnimationClock.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+
+typedef struct _cairo_surface cairo_surface_t;
+
+namespace lv2c
+{
+    class Lv2cHeadlessNativeWindow;
+
+    /// @brief Runs a Lv2cWindow offscreen, without an X server.
+    ///
+    /// The window (and any dialogs it opens) draw into cairo image surfaces. Nothing 
+    /// happens until Frame() is called: each frame runs animation callbacks, due 
+    /// PostDelayed() callbacks, layout, and drawing, just as one pass of the X11 event loop does.
+    /// Input is injected with the Mouse*(), KeyDown(), TypeText() and Resize() methods, 
+    /// and is delivered immediately. Mouse coordinates are in window coordinates 
+    /// (i.e. before WindowScale() is applied).
+    ///
+    /// With a deterministic clock (the default), Lv2cAnimationClock is put into manual mode 
+    /// for the lifetime of the Lv2cHeadlessWindow, and only advances when AdvanceClock() or 
+    /// RunFor() is called. Only one Lv2cHeadlessWindow with a deterministic clock should
+    /// exist at a time.
+    ///
+    /// Intended for tests and benchmarks.
+    class Lv2cHeadlessWindow
+    {
+    public:
+        using self = Lv2cHeadlessWindow;
+        using ptr = std::shared_ptr<self>;
+        using clock_t = Lv2cAnimationClock;
+
+        static ptr Create(Lv2cWindow::ptr window, const Lv2cCreateWindowParameters &parameters, bool deterministicClock = true)
+        {
+            return std::make_shared<self>(window, parameters, deterministicClock);
+        }
+
+        /// @brief Create the window.
+        /// @param window The window to run.
+        /// @param parameters Window parameters. parameters.size must be set. Saved window positions
+        /// are not loaded.
+        /// @param deterministicClock Put Lv2cAnimationClock into manual mode.
+        Lv2cHeadlessWindow(Lv2cWindow::ptr window, const Lv2cCreateWindowParameters &parameters, bool deterministicClock = true);
+        ~Lv2cHeadlessWindow();
+
+        Lv2cHeadlessWindow(const Lv2cHeadlessWindow &) = delete;
+        Lv2cHeadlessWindow &operator=(const Lv2cHeadlessWindow &) = delete;
+
+        Lv2cWindow::ptr Window() const { return window; }
+
+        /// @brief The surface the window draws into (device pixels, CAIRO_FORMAT_RGB24).
+        cairo_surface_t *Surface();
+
+        /// @brief Write the window's surface to a PNG file.
+        void WriteToPng(const std::string &filename);
+
+        /// @brief Run one frame: animation, delayed callbacks, layout and drawing.
+        void Frame();
+
+        /// @brief Perform any pending layout without drawing.
+        ///
+        /// Lets callers time layout separately from painting. The next Frame() draws.
+        void UpdateLayout();
+
+        /// @brief The number of calls to Frame().
+        uint64_t FrameCount() const { return frameCount; }
+
+        /// @brief Advance the deterministic clock without running a frame.
+        void AdvanceClock(clock_t::duration duration);
+
+        /// @brief Advance the deterministic clock, running a frame every frameInterval.
+        void RunFor(
+            clock_t::duration duration,
+            clock_t::duration frameInterval = std::chrono::duration_cast<clock_t::duration>(std::chrono::microseconds(1000000 / 60)));
+
+        /// @brief True if a layout or redraw is pending, or animation or PostDelayed callbacks are waiting.
+        bool HasPendingWork() const;
+
+        void MouseMove(Lv2cPoint point, ModifierState modifierState = ModifierState::Empty);
+        void MouseDown(Lv2cPoint point, uint64_t button = 1, ModifierState modifierState = ModifierState::Empty);
+        void MouseUp(Lv2cPoint point, uint64_t button = 1, ModifierState modifierState = ModifierState::Empty);
+        /// @brief MouseMove, MouseDown and MouseUp at the same point.
+        void Click(Lv2cPoint point, uint64_t button = 1, ModifierState modifierState = ModifierState::Empty);
+        void ScrollWheel(Lv2cScrollDirection direction, Lv2cPoint point, ModifierState modifierState = ModifierState::Empty);
+        void MouseLeave();
+
+        /// @brief Send a key with no text (e.g. XK_Tab, XK_Left).
+        /// @param keysym An X11 keysym.
+        void KeyDown(uint32_t keysym, ModifierState modifierState = ModifierState::Empty);
+
+        /// @brief Send one text key event per UTF-8 character.
+        void TypeText(const std::string &text);
+
+        /// @brief Resize the window.
+        /// @param size The new size, in window coordinates.
+        void Resize(Lv2cSize size);
+
+    private:
+        int64_t ToDevice(double value) const;
+
+        Lv2cWindow::ptr window;
+        Lv2cHeadlessNativeWindow *nativeWindow = nullptr;
+        bool deterministicClock;
+        bool savedManualClock = false;
+        uint64_t frameCount = 0;
+    };
+}
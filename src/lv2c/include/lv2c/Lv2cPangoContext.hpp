@@ -20,11 +20,20 @@
 #pragma once
 
 #include <set>
+#include <map>
+#include <unordered_map>
 #include <string>
+#include <mutex>
+#include <optional>
+#include <cstdint>
+#include "Lv2cTypes.hpp"
 
 typedef struct _PangoContext PangoContext;
 typedef struct _PangoFontMap PangoFontMap;
 typedef struct _PangoFontDescription PangoFontDescription;
+typedef struct _PangoLayout PangoLayout;
+typedef struct _cairo cairo_t;
+
 namespace lv2c
 {
     class Lv2cStyle;
@@ -43,8 +52,84 @@ namespace lv2c
         /// @param fontFamily A css-style list of font families.
         /// @return The first font in the list of requested fonts that is currently installed.
         const std::string GetFontFamily(const std::string&fontFamilies) const;
+
+        /// @brief Create a font description for a style.
+        /// @returns A new font description, which the caller must free with pango_font_description_free.
         PangoFontDescription*GetFontDescription(Lv2cStyle&style) const;
+
+        /// @brief Get an interned font description for a style.
+        /// @returns A font description owned by the context. Do not free or modify it.
+        /// Styles that resolve to the same family, size, weight, style, stretch and variant
+        /// share a single description, so the returned pointer can be compared to detect font changes.
+        const PangoFontDescription*GetSharedFontDescription(Lv2cStyle&style);
+
+        /// @brief Get the logical size of a single line of text, using a shared cache.
+        /// @param layout A layout that is used to measure the text if the measurement isn't cached.
+        /// @param cr The cairo context that the text will be rendered on.
+        /// @param fontDescription An interned font description (see GetSharedFontDescription).
+        /// @param text The text to measure.
+        /// @param markup True if text contains pango markup.
+        /// @param width Receives the width, in pango units.
+        /// @param height Receives the height, in pango units.
+        /// On a cache miss, the layout's text, font, width and ellipsization are modified. On a
+        /// cache hit, the layout is not touched.
+        /// Short strings that repeat (dial value labels, unit suffixes, dropdown items) are measured 
+        /// once, rather than reshaped on every layout pass.
+        ///
+        /// Only measurement is cached. Text that is drawn is still shaped by the element's own layout.
+        /// Text that is empty or longer than MAX_TEXT_CACHE_LENGTH is never cached, and the cache is
+        /// cleared once it holds MAX_TEXT_CACHE_ENTRIES entries.
+        void GetSingleLineSize(
+            PangoLayout*layout,
+            cairo_t*cr,
+            const PangoFontDescription*fontDescription,
+            const std::string&text,
+            bool markup,
+            int*width, int*height);
+
+        /// @brief Counters for the shared text measurement cache.
+        struct TextCacheStatistics {
+            uint64_t fontDescriptions = 0;
+            uint64_t entries = 0;
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+        };
+        TextCacheStatistics GetTextCacheStatistics();
+
+        static constexpr size_t MAX_TEXT_CACHE_ENTRIES = 2048;
+        static constexpr size_t MAX_TEXT_CACHE_LENGTH = 128;
+
     private:
+        struct FontKey {
+            std::string family;
+            int size = 0;
+            int weight = -1;
+            int style = -1;
+            int stretch = -1;
+            int variant = -1;
+            bool operator<(const FontKey&other) const;
+        };
+        struct TextKey {
+            const PangoFontDescription*fontDescription = nullptr;
+            double scale = 1;
+            bool markup = false;
+            std::string text;
+            bool operator==(const TextKey&other) const = default;
+        };
+        struct TextKeyHash {
+            size_t operator()(const TextKey&key) const;
+        };
+        struct TextSize {
+            int width;
+            int height;
+        };
+        mutable std::mutex cacheMutex;
+        std::map<FontKey,PangoFontDescription*> fontDescriptions;
+        mutable std::unordered_map<std::string,std::string> fontFamilyCache;
+        std::unordered_map<TextKey,TextSize,TextKeyHash> textSizes;
+        uint64_t textCacheHits = 0;
+        uint64_t textCacheMisses = 0;
+
         PangoContext*pangoContext = nullptr;
         PangoFontMap *fontmap = nullptr;
         std::set<std::string> fontFamilies;
@@ -19,6 +19,7 @@
 
 #pragma once
 #include "Lv2cValueElement.hpp"
+#include "Lv2cPngStripFrames.hpp"
 #include <memory>
 #include <string>
 
@@ -54,6 +55,7 @@ namespace lv2c
     protected:
         virtual void OnValueChanged(double value) override;
         virtual void OnMount() override;
+        virtual void OnUnmount() override;
         virtual void OnDraw(Lv2cDrawingContext &dc) override;
         virtual Lv2cSize MeasureClient(Lv2cSize clientConstraint, Lv2cSize clientAvailable,Lv2cDrawingContext&context) override;
 
@@ -62,10 +64,12 @@ namespace lv2c
         bool sourceChanged = false;
         void OnSourceChanged(const std::string&source);
         void Load();
+        bool DrawPrescaledFrame(Lv2cDrawingContext &dc, int tile);
 
         int tileCount = 0;
         Lv2cRectangle tileSize;
         Lv2cSurface surface;
+        Lv2cPngStripFrames::ptr frames;
 
     };
 } // namespace
\ No newline at end of file
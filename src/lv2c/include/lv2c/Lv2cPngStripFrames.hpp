@@ -0,0 +1,76 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "Lv2cDrawingContext.hpp"
+#include "Lv2cTypes.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lv2c
+{
+    /// @brief Frames of a PNG strip, resampled to a particular device size.
+    ///
+    /// Each frame is resampled from the strip once, the first time it is drawn, so that
+    /// drawing a frame is a 1:1 copy. Instances are shared by all elements that draw the same 
+    /// strip at the same device size (see Lv2cWindow::GetPngStripFrames()). Not thread-safe.
+    class Lv2cPngStripFrames
+    {
+    public:
+        using self = Lv2cPngStripFrames;
+        using ptr = std::shared_ptr<self>;
+
+        /// @brief Constructor.
+        /// @param strip The PNG strip, as returned by Lv2cWindow::GetPngImage().
+        /// @param tileSize The size of a frame in the strip. Frames are arranged horizontally.
+        /// @param tileCount The number of frames in the strip.
+        /// @param deviceWidth The width of resampled frames, in device pixels.
+        /// @param deviceHeight The height of resampled frames, in device pixels.
+        Lv2cPngStripFrames(const Lv2cSurface &strip, Lv2cSize tileSize, int tileCount, int deviceWidth, int deviceHeight);
+
+        static ptr Create(const Lv2cSurface &strip, Lv2cSize tileSize, int tileCount, int deviceWidth, int deviceHeight)
+        {
+            return std::make_shared<self>(strip, tileSize, tileCount, deviceWidth, deviceHeight);
+        }
+
+        int TileCount() const { return (int)frames.size(); }
+        int DeviceWidth() const { return deviceWidth; }
+        int DeviceHeight() const { return deviceHeight; }
+
+        /// @brief Get a resampled frame, rendering it if necessary.
+        /// @param tile The index of the frame. Clamped to [0..TileCount()-1].
+        Lv2cSurface &Frame(int tile);
+
+        /// @brief The number of frames that have been resampled so far.
+        size_t RenderedFrameCount() const { return renderedFrameCount; }
+
+        /// @brief Memory used by resampled frames, in bytes.
+        size_t Bytes() const;
+
+    private:
+        Lv2cSurface strip;
+        Lv2cSize tileSize;
+        int deviceWidth;
+        int deviceHeight;
+        std::vector<Lv2cSurface> frames;
+        size_t renderedFrameCount = 0;
+    };
+}
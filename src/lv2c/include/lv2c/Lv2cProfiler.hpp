@@ -0,0 +1,198 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace lv2c
+{
+    class Lv2cElement;
+
+    /// @brief Scoped timers for frame profiling, with Chrome trace export.
+    ///
+    /// Instrumentation (the LV2C_PROFILE_* macros) is compiled out unless LV2C_PROFILING is
+    /// defined (configure with -DLV2C_PROFILING=ON). When compiled in, nothing is collected
+    /// until profiling is enabled, either by calling Enable(true), or by setting the LV2C_PROFILE
+    /// environment variable. LV2C_PROFILE=1 enables collection; any other value is taken to be
+    /// the name of a file to which a Chrome trace is written when the process exits.
+    ///
+    /// Traces can be viewed with chrome://tracing or https://ui.perfetto.dev.
+    class Lv2cProfiler
+    {
+    public:
+        using clock_t = std::chrono::steady_clock;
+
+        enum class ElementPhase
+        {
+            Unspecified,
+            Measure,
+            Arrange,
+            Draw
+        };
+
+        struct Span
+        {
+            const char *name;
+            const Lv2cElement *element;
+            const std::type_info *elementType;
+            uint32_t threadId;
+            int64_t startNs;
+            int64_t durationNs;
+        };
+
+        struct ElementCounters
+        {
+            std::string elementType;
+            uint64_t measureCount = 0;
+            int64_t measureTimeNs = 0;
+            uint64_t arrangeCount = 0;
+            int64_t arrangeTimeNs = 0;
+            uint64_t drawCount = 0;
+            /// @brief Inclusive draw time (children included).
+            int64_t drawTimeNs = 0;
+            /// @brief Area drawn, in window coordinates.
+            double damagedArea = 0;
+        };
+
+        /// @brief Spans recorded after this many are dropped.
+        static constexpr size_t MAX_SPANS = 4 * 1024 * 1024;
+
+        /// @brief True if LV2C_PROFILE_* instrumentation was compiled in.
+        static constexpr bool CompiledIn()
+        {
+#ifdef LV2C_PROFILING
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        static bool Enabled() { return enabled.load(std::memory_order_relaxed); }
+        static void Enable(bool value);
+
+        /// @brief Discard collected spans and counters.
+        static void Reset();
+
+        static std::vector<Span> GetSpans();
+        static size_t DroppedSpanCount();
+
+        /// @brief Aggregate counters for a live element (zeroes if there are none).
+        static ElementCounters GetElementCounters(const Lv2cElement *element);
+        static std::map<const Lv2cElement *, ElementCounters> GetAllElementCounters();
+
+        static void WriteChromeTrace(std::ostream &s);
+        static void WriteChromeTrace(const std::string &filename);
+
+        /// @brief Records a span from construction to destruction, if profiling is enabled.
+        ///
+        /// An element scope nested directly in a scope for the same element and phase (an override
+        /// that calls its instrumented base class) records its span, but isn't counted again.
+        class Scope
+        {
+        public:
+            Scope(const char *name)
+                : name(name), active(Enabled())
+            {
+                if (active)
+                {
+                    start = clock_t::now();
+                }
+            }
+            Scope(ElementPhase phase, const Lv2cElement *element)
+                : name(PhaseName(phase)), element(element), phase(phase), active(Enabled())
+            {
+                if (active)
+                {
+                    outerElementScope = currentElementScope;
+                    counted = !outerElementScope || outerElementScope->element != element || outerElementScope->phase != phase;
+                    currentElementScope = this;
+                    start = clock_t::now();
+                }
+            }
+            ~Scope()
+            {
+                if (active)
+                {
+                    AddSpan(name, element, counted ? phase : ElementPhase::Unspecified, start, clock_t::now());
+                    if (element)
+                    {
+                        currentElementScope = outerElementScope;
+                    }
+                }
+            }
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            const char *name;
+            const Lv2cElement *element = nullptr;
+            ElementPhase phase = ElementPhase::Unspecified;
+            bool active;
+            bool counted = true;
+            const Scope *outerElementScope = nullptr;
+            clock_t::time_point start;
+
+            static thread_local const Scope *currentElementScope;
+        };
+
+        static void AddSpan(const char *name, const Lv2cElement *element, ElementPhase phase, clock_t::time_point start, clock_t::time_point end);
+        static void AddDamage(const Lv2cElement *element, double area);
+        /// @brief Drop counters for an element that is being destroyed.
+        static void ForgetElement(const Lv2cElement *element);
+
+    private:
+        static const char *PhaseName(ElementPhase phase);
+        static std::atomic<bool> enabled;
+    };
+}
+
+#ifdef LV2C_PROFILING
+#define LV2C_PROFILE_CONCAT_(a, b) a##b
+#define LV2C_PROFILE_CONCAT(a, b) LV2C_PROFILE_CONCAT_(a, b)
+
+/// Time the enclosing scope. name must be a string literal.
+#define LV2C_PROFILE_SCOPE(name) \
+    ::lv2c::Lv2cProfiler::Scope LV2C_PROFILE_CONCAT(lv2cProfileScope_, __LINE__) { name }
+/// Time the enclosing scope, and add it to the element's counters.
+#define LV2C_PROFILE_ELEMENT_SCOPE(phase, element) \
+    ::lv2c::Lv2cProfiler::Scope LV2C_PROFILE_CONCAT(lv2cProfileScope_, __LINE__) { ::lv2c::Lv2cProfiler::ElementPhase::phase, element }
+#define LV2C_PROFILE_DAMAGE(element, area)                    \
+    do                                                        \
+    {                                                         \
+        if (::lv2c::Lv2cProfiler::Enabled())                  \
+        {                                                     \
+            ::lv2c::Lv2cProfiler::AddDamage(element, area);   \
+        }                                                     \
+    } while (0)
+#define LV2C_PROFILE_FORGET_ELEMENT(element) \
+    ::lv2c::Lv2cProfiler::ForgetElement(element)
+#else
+#define LV2C_PROFILE_SCOPE(name) ((void)0)
+#define LV2C_PROFILE_ELEMENT_SCOPE(phase, element) ((void)0)
+#define LV2C_PROFILE_DAMAGE(element, area) ((void)0)
+#define LV2C_PROFILE_FORGET_ELEMENT(element) ((void)0)
+#endif
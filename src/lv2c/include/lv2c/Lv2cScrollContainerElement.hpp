@@ -107,6 +107,14 @@ namespace lv2c
         virtual bool WantsFocus() const override;
         virtual Lv2cScrollContainerElement& WantsFocus(bool value);
 
+        /// @brief Scroll by copying previously drawn contents.
+        /// When enabled (the default), changing the scroll offset copies the still-visible part of the
+        /// viewport to its new position, and only redraws the newly exposed strip. Blitting is skipped
+        /// automatically when it can't produce correct results (gradient backgrounds, round corners, opacity,
+        /// or layers behind the viewport). Disable it if the child draws content that depends on its
+        /// position in the viewport.
+        BINDING_PROPERTY(BlitScrolling, bool, true)
+
     protected:
         virtual bool OnKeyDown(const Lv2cKeyboardEventArgs&event) override;
 
@@ -114,6 +122,8 @@ namespace lv2c
 
         virtual bool ClipChildren() const override;
 
+        virtual void InvalidateScreenRect(const Lv2cRectangle &screenRectangle) override;
+
         virtual void OnHorizontalScrollEnableChanged(bool value);
         virtual void OnVerticalScrollEnableChanged(bool value);
         virtual void OnHorizontalScrollOffsetChanged(double value);
@@ -140,6 +150,10 @@ namespace lv2c
         bool wantsFocus = false;
         Lv2cRectangle savedLayoutClipRect;
         void RedoFinalLayout();
+        bool CanBlitScroll() const;
+        Lv2cRectangle ScrollViewport() const;
+        Lv2cPoint layoutScrollOffset; // the scroll offset the child was last laid out with.
+        bool scrollingByBlit = false;
         // Hide these methods.
         void AddChild(std::shared_ptr<Lv2cElement> child) override;
         bool RemoveChild(std::shared_ptr<Lv2cElement> element) override;
@@ -37,6 +37,10 @@ namespace lv2c {
     public:
         static std::shared_ptr<Lv2cSettingsFile> GetSharedFile(const std::string&identifier);
 
+        /// @brief The directory in which settings for `identifier` are stored.
+        /// The directory is created if it doesn't exist.
+        static std::filesystem::path GetSettingsDirectory(const std::string &identifier);
+
         Lv2cSettingsFile();
         ~Lv2cSettingsFile();
 
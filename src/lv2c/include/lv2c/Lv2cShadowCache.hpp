@@ -0,0 +1,102 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "Lv2cSurfaceCache.hpp"
+#include "Lv2cTypes.hpp"
+#include <cstddef>
+#include <mutex>
+#include <optional>
+
+namespace lv2c
+{
+    /// @brief Key for a cached drop shadow nine-patch.
+    ///
+    /// Captures everything that affects the rendered nine-patch surface: the (device) nine-patch geometry,
+    /// corner radii, blur radius, sub-pixel shadow offset, shadow color and opacity, and window scale.
+    struct Lv2cShadowCacheKey
+    {
+        int width = 0;
+        int height = 0;
+        Lv2cRectangle deviceBackground;
+        Lv2cRoundCorners deviceRoundCorners{0, 0, 0, 0};
+        double deviceRadius = 0;
+        double deviceXOffset = 0;
+        double deviceYOffset = 0;
+        Lv2cColor color;
+        double windowScale = 1;
+
+        bool operator==(const Lv2cShadowCacheKey &other) const;
+        size_t Hash() const;
+    };
+
+    /// @brief Process-wide LRU cache of rendered drop shadow nine-patches.
+    ///
+    /// Lv2cDropShadowElement renders shadows for solid-background elements as nine-patches. Rendering a
+    /// nine-patch requires a blur, but the result depends only on the element's shadow parameters, so
+    /// repaints of the same (or identically styled) elements can reuse a previously rendered surface.
+    ///
+    /// Cached surfaces are immutable once inserted, and may be shared by multiple windows. Total memory
+    /// use is capped (MaxBytes()); least-recently used entries are evicted when the cap is exceeded.
+    ///
+    /// The cache is thread-safe.
+    class Lv2cShadowCache
+    {
+    public:
+        /// @brief Default memory cap, in bytes.
+        static constexpr size_t DEFAULT_MAX_BYTES = 4 * 1024 * 1024;
+
+        using Key = Lv2cShadowCacheKey;
+        using Stats = Lv2cSurfaceCacheStats;
+
+        /// @brief The process-wide instance.
+        static Lv2cShadowCache &Instance();
+
+        Lv2cShadowCache(size_t maxBytes = DEFAULT_MAX_BYTES);
+
+        /// @brief Find a cached surface.
+        /// @returns The cached surface, or std::nullopt if there isn't one. Counts as a hit or a miss.
+        std::optional<Lv2cImageSurface> Get(const Key &key);
+
+        /// @brief Add a surface to the cache.
+        ///
+        /// The surface must not be modified after it has been added. Surfaces larger than MaxBytes() are not cached.
+        void Put(const Key &key, const Lv2cImageSurface &surface);
+
+        /// @brief Discard all cached surfaces.
+        void Clear();
+
+        /// @brief Set the memory cap, evicting entries if necessary.
+        void MaxBytes(size_t maxBytes);
+        size_t MaxBytes() const;
+
+        Stats GetStats() const;
+        void ResetStats();
+
+    private:
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const { return key.Hash(); }
+        };
+
+        mutable std::mutex mutex;
+        Lv2cSurfaceCache<Key, KeyHash> cache;
+    };
+}
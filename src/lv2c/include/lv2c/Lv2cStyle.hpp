@@ -23,6 +23,8 @@
 #include <memory>
 #include <string>
 #include <optional>
+#include <atomic>
+#include <cstdint>
 
 #include "Lv2cTypes.hpp"
 #include "Lv2cDrawingContext.hpp"
@@ -118,21 +120,25 @@ namespace lv2c
         self &FontWeight(Lv2cFontWeight fontWeight)
         {
             this->fontWeight = fontWeight;
+            Modified();
             return *this;
         }
         self &FontStretch(Lv2cFontStretch value)
         {
             this->fontStretch = value;
+            Modified();
             return *this;
         }
         self &FontStyle(Lv2cFontStyle value)
         {
             this->fontStyle = value;
+            Modified();
             return *this;
         }
         self &FontVariant(Lv2cFontVariant value)
         {
             this->fontVariant = value;
+            Modified();
             return *this;
         }
 
@@ -219,7 +225,65 @@ namespace lv2c
         self&Cursor(const std::optional<Lv2cCursor> & value);
         std::optional<Lv2cCursor> Cursor() const; 
 
+    public:
+        // computed style cache.
+
+        /// @brief Discard cached property resolutions for this style.
+        /// Property getters resolve a value by searching the style, its element's classes, and 
+        /// (for inherited properties) the styles of parent elements. The result of each search is cached 
+        /// until the style, the element's classes, or the element's position in the visual tree
+        /// changes. Lv2cElement::InvalidateComputedStyle() calls this method for all styles in a subtree.
+        void InvalidateComputedStyle();
+
+        /// @brief Enable or disable the computed style cache (for all styles). Enabled by default.
+        static void EnableComputedStyleCache(bool enable);
+        static bool ComputedStyleCacheEnabled();
+
+        /// @brief A counter that changes whenever a style that is not attached to an element (a class) is modified.
+        /// Lets consumers of resolved style values (e.g. the layout measure cache) detect changes to shared classes.
+        static uint64_t ClassStyleGeneration();
+
+        /// @brief Property resolution counters.
+        struct LookupStatistics {
+            /// @brief Calls to property getters, including inherited lookups in parent styles.
+            uint64_t requests = 0;
+            /// @brief Requests that searched the style, its classes, or its parents.
+            uint64_t lookups = 0;
+            /// @brief Requests answered from the computed style cache.
+            uint64_t cacheHits = 0;
+        };
+        static LookupStatistics GetLookupStatistics();
+        static void ResetLookupStatistics();
+
     private:
+        void Modified();
+
+        // Pointers to the members that supplied resolved property values.
+        class ComputedStyleCache
+        {
+        public:
+            ComputedStyleCache() { }
+            // Never copied: cached pointers refer to members of the source style, or its element's classes and parents.
+            ComputedStyleCache(const ComputedStyleCache &) { }
+            ComputedStyleCache &operator=(const ComputedStyleCache &)
+            {
+                Clear();
+                return *this;
+            }
+
+            const void *Find(uint64_t generation, uint32_t key) const;
+            void Add(uint64_t generation, uint32_t key, const void *value);
+            void Clear();
+
+        private:
+            uint64_t generation = 0;
+            std::vector<std::pair<uint32_t, const void *>> entries;
+        };
+        mutable ComputedStyleCache computedStyle;
+
+        template <typename T, typename IS_SET>
+        const T *ResolveMember(T Lv2cStyle::*pMember, bool inherit, IS_SET isSet) const;
+
         std::optional<Lv2cTextAlign> TextAlignOptional() const;
 
         template <typename T>
@@ -0,0 +1,157 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "Lv2cDrawingContext.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+namespace lv2c
+{
+    /// @brief Statistics for an Lv2cSurfaceCache.
+    struct Lv2cSurfaceCacheStats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t maxBytes = 0;
+    };
+
+    /// @brief LRU cache of rendered image surfaces, with a memory cap.
+    ///
+    /// Cached surfaces are shared (reference-counted), and must not be modified once they have been
+    /// added to the cache. Not thread-safe.
+    /// @tparam KEY Key type. Must be equality-comparable.
+    /// @tparam HASH Hash function for KEY.
+    template <typename KEY, typename HASH = std::hash<KEY>>
+    class Lv2cSurfaceCache
+    {
+    public:
+        using Key = KEY;
+        using Stats = Lv2cSurfaceCacheStats;
+
+        Lv2cSurfaceCache(size_t maxBytes)
+            : maxBytes(maxBytes)
+        {
+        }
+
+        /// @brief Find a cached surface.
+        /// @returns The cached surface, or std::nullopt if there isn't one. Counts as a hit or a miss.
+        std::optional<Lv2cImageSurface> Get(const Key &key)
+        {
+            auto f = index.find(key);
+            if (f == index.end())
+            {
+                ++stats.misses;
+                return std::nullopt;
+            }
+            ++stats.hits;
+            // move to front.
+            entries.splice(entries.begin(), entries, f->second);
+            return f->second->surface;
+        }
+
+        /// @brief Add a surface to the cache.
+        ///
+        /// Surfaces larger than MaxBytes() are not cached.
+        void Put(const Key &key, const Lv2cImageSurface &surface_)
+        {
+            Lv2cImageSurface surface = surface_;
+            size_t entryBytes = (size_t)surface.get_stride() * (size_t)surface.get_height();
+            if (entryBytes > maxBytes)
+            {
+                return;
+            }
+            auto f = index.find(key);
+            if (f != index.end())
+            {
+                bytes -= f->second->bytes;
+                entries.erase(f->second);
+                index.erase(f);
+            }
+            Trim(maxBytes - entryBytes);
+
+            entries.push_front(Entry{key, std::move(surface), entryBytes});
+            index[key] = entries.begin();
+            bytes += entryBytes;
+        }
+
+        /// @brief Discard all cached surfaces.
+        void Clear()
+        {
+            index.clear();
+            entries.clear();
+            bytes = 0;
+        }
+
+        /// @brief Set the memory cap, evicting entries if necessary.
+        void MaxBytes(size_t maxBytes)
+        {
+            this->maxBytes = maxBytes;
+            Trim(maxBytes);
+        }
+        size_t MaxBytes() const { return maxBytes; }
+
+        Stats GetStats() const
+        {
+            Stats result = stats;
+            result.entries = entries.size();
+            result.bytes = bytes;
+            result.maxBytes = maxBytes;
+            return result;
+        }
+        void ResetStats()
+        {
+            stats = Stats();
+        }
+
+    private:
+        struct Entry
+        {
+            Key key;
+            Lv2cImageSurface surface;
+            size_t bytes;
+        };
+        using EntryList = std::list<Entry>;
+
+        void Trim(size_t limit)
+        {
+            while (bytes > limit && !entries.empty())
+            {
+                auto &last = entries.back();
+                bytes -= last.bytes;
+                index.erase(last.key);
+                entries.pop_back();
+                ++stats.evictions;
+            }
+        }
+
+        EntryList entries; // most-recently used first.
+        std::unordered_map<Key, typename EntryList::iterator, HASH> index;
+        size_t maxBytes;
+        size_t bytes = 0;
+        Stats stats;
+    };
+}
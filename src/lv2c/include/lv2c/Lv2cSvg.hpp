@@ -20,6 +20,7 @@
 #pragma once
 #include "Lv2cTypes.hpp"
 #include <memory>
+#include <mutex>
 #include <string>
 
 typedef struct _RsvgHandle RsvgHandle;
@@ -53,5 +54,7 @@ namespace lv2c
         void set(RsvgHandle *value);
         RsvgHandle *handle = nullptr;
         Lv2cSize intrinsicSize {24,24};
+        // Documents are shared between windows by Lv2cAssetCache, possibly on different threads.
+        std::mutex renderMutex;
     };
 } // namespace
\ No newline at end of file
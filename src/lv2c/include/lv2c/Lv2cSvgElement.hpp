@@ -55,6 +55,8 @@ namespace lv2c
         Lv2cSize measuredImageSize;
         void Load();
         void OnDraw(Lv2cDrawingContext &dc) override;
+        void RenderImage(Lv2cDrawingContext &dc, const Lv2cSize &size, double rotation, const Lv2cPattern &tintColor);
+        bool DrawCachedImage(Lv2cDrawingContext &dc, const Lv2cSize &size, double rotation, const Lv2cPattern &tintColor);
         void OnMount() override;
 
         bool changed = false;
@@ -0,0 +1,55 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "Lv2cSurfaceCache.hpp"
+#include "Lv2cTypes.hpp"
+#include <string>
+
+namespace lv2c
+{
+    /// @brief Key for a rasterized SVG image.
+    ///
+    /// Identifies an SVG file rendered at a particular device size, sub-pixel device position, rotation and tint.
+    struct Lv2cSvgRasterKey
+    {
+        std::string source;
+        Lv2cSize size;
+        double deviceScale = 1;
+        double xFraction = 0;
+        double yFraction = 0;
+        double rotation = 0;
+        bool tinted = false;
+        Lv2cColor tint;
+
+        bool operator==(const Lv2cSvgRasterKey &other) const;
+        size_t Hash() const;
+
+        struct Hasher
+        {
+            size_t operator()(const Lv2cSvgRasterKey &key) const { return key.Hash(); }
+        };
+    };
+
+    /// @brief Cache of premultiplied ARGB32 surfaces containing rasterized SVG images.
+    ///
+    /// Each Lv2cWindow owns one (see Lv2cWindow::SvgRasterCache()), which is cleared when the window scale changes.
+    using Lv2cSvgRasterCache = Lv2cSurfaceCache<Lv2cSvgRasterKey, Lv2cSvgRasterKey::Hasher>;
+}
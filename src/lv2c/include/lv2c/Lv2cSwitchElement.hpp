@@ -66,7 +66,7 @@ namespace lv2c {
         double secondsPerTick;
 
         double trackWidth = -1;
-        using clock_t = std::chrono::steady_clock;
+        using clock_t = animation_clock_t;
         void StartAnimation();
         void StopAnimation();
         void AnimationTick(const animation_clock_time_point_t&now);
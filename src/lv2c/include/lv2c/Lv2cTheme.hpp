@@ -31,6 +31,8 @@ namespace lv2c {
     public:
         Lv2cThemeColors(bool darkTheme);
 
+        bool operator==(const Lv2cThemeColors &other) const;
+
         bool isDarkTheme;
         Lv2cColor background;
         Lv2cColor paper;
@@ -79,6 +81,20 @@ namespace lv2c {
         static ptr Create(bool darkTheme = true) { return std::make_shared<Lv2cTheme>(darkTheme); }
         static ptr Create(const Lv2cThemeColors &themeColors) { return std::make_shared<Lv2cTheme>(themeColors); }
 
+        /// @brief Get a shared theme.
+        /// Themes are interned by colors, so all windows in the process that use the same colors
+        /// share a single theme (and its styles). Shared themes must not be modified. Use Writable()
+        /// to get a copy that can be customized.
+        static ptr GetShared(bool darkTheme = true);
+        static ptr GetShared(const Lv2cThemeColors &themeColors);
+
+        /// @brief Get a theme that can be modified.
+        /// @returns theme, if it is not shared; otherwise a private copy of theme.
+        static ptr Writable(const ptr &theme);
+
+        /// @brief Is this a shared (immutable) theme? See GetShared().
+        bool IsShared() const { return shared; }
+
         Lv2cTheme(bool darkTheme);
         Lv2cTheme(const Lv2cThemeColors &themeColors);
 
@@ -189,6 +205,8 @@ namespace lv2c {
         std::map<std::string,Lv2cStyle::ptr> customStyles;
         // A place to store theme-related user daa for custom controls. 
         std::map<std::string,Lv2cUserData::ptr> customUserData;
+    private:
+        bool shared = false;
     };
 
 } // namespace
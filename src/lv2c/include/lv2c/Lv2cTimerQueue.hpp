@@ -0,0 +1,121 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#pragma once
+
+#include "Lv2cTypes.hpp"
+#include <chrono>
+#include <functional>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <optional>
+
+namespace lv2c
+{
+
+    /// @brief A deadline-ordered queue of delayed callbacks.
+    ///
+    /// Used by Lv2cWindow to implement PostDelayed. Callbacks are kept in a binary min-heap
+    /// ordered by deadline, so posting and cancelling are O(log n), and finding the next
+    /// deadline is O(1). Cancelled entries are removed lazily from the heap.
+    ///
+    /// Callbacks may post or cancel timers while they are being dispatched. Threads other than the
+    /// UI thread should use PostFromAnyThread(), which pushes onto a lock-free list that is merged
+    /// into the heap the next time the UI thread touches the queue.
+    class Lv2cTimerQueue
+    {
+    public:
+        using clock_t = std::chrono::steady_clock;
+        using Callback = std::function<void()>;
+
+        Lv2cTimerQueue() {}
+        ~Lv2cTimerQueue();
+
+        Lv2cTimerQueue(const Lv2cTimerQueue &) = delete;
+        Lv2cTimerQueue &operator=(const Lv2cTimerQueue &) = delete;
+
+        /// @brief Post a callback (UI thread).
+        /// @param time The time at which the callback should be fired.
+        /// @param callback The callback.
+        /// @return A handle that can be passed to Cancel().
+        AnimationHandle Post(clock_t::time_point time, Callback &&callback);
+
+        /// @brief Post a callback from any thread.
+        /// @param time The time at which the callback should be fired.
+        /// @param callback The callback.
+        /// @return A handle that can be passed to Cancel().
+        /// Does not take the queue lock.
+        AnimationHandle PostFromAnyThread(clock_t::time_point time, Callback &&callback);
+
+        /// @brief Cancel a pending callback.
+        /// @param handle A handle returned by Post() or PostFromAnyThread().
+        /// @return True if the callback was pending, false if it has already fired, or was already cancelled.
+        bool Cancel(AnimationHandle handle);
+
+        /// @brief The deadline of the earliest pending callback, if any.
+        std::optional<clock_t::time_point> NextDeadline();
+
+        /// @brief Fire all callbacks whose deadline is at or before now.
+        /// @param now The current time.
+        /// @return The number of callbacks fired.
+        /// Callbacks are fired in deadline order, with no locks held.
+        size_t Dispatch(clock_t::time_point now);
+
+        /// @brief The number of pending callbacks.
+        size_t Size();
+
+        bool Empty() { return Size() == 0; }
+
+    private:
+        struct HeapEntry
+        {
+            clock_t::time_point time;
+            AnimationHandle handle;
+        };
+        // std::push_heap builds a max-heap; invert the ordering to get earliest-deadline-first.
+        static bool Later(const HeapEntry &left, const HeapEntry &right)
+        {
+            if (left.time != right.time)
+            {
+                return left.time > right.time;
+            }
+            return right.handle < left.handle;
+        }
+
+        struct PendingEntry
+        {
+            clock_t::time_point time;
+            AnimationHandle handle;
+            Callback callback;
+            PendingEntry *next = nullptr;
+        };
+
+        void Insert(clock_t::time_point time, AnimationHandle handle, Callback &&callback);
+        void MergePendingEntries();
+        void DiscardStaleEntries();
+        void CompactHeap();
+
+        std::recursive_mutex mutex;
+        std::vector<HeapEntry> heap;
+        std::map<AnimationHandle, Callback> callbacks;
+        std::atomic<PendingEntry *> pendingEntries{nullptr};
+    };
+}
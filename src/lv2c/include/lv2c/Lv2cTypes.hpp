@@ -26,6 +26,7 @@
 #include <string>
 #include <sstream>
 #include <optional>
+#include <atomic>
 
 struct _cairo;
 typedef struct _cairo cairo_t;
@@ -424,10 +425,11 @@ namespace lv2c
     class AnimationHandle
     {
         friend class Lv2cWindow;
+        friend class Lv2cTimerQueue;
 
     private:
         static AnimationHandle Next();
-        static uint64_t nextHandle;
+        static std::atomic<uint64_t> nextHandle;
 
     public:
         AnimationHandle();
@@ -91,7 +91,10 @@ namespace lv2c
         Lv2cSize clientMeasure;
         Lv2cStyle::ptr GetVariantStyle();
 
-        PangoFontDescription*GetFontDescription();
+        const PangoFontDescription*GetFontDescription();
+        void SetLayoutMarkup(const std::string &markup);
+        std::string layoutMarkup;
+        bool layoutMarkupValid = false;
 
         virtual Lv2cSize MeasureClient(Lv2cSize constraint, Lv2cSize maxAvailable,Lv2cDrawingContext &context) override;
 
@@ -0,0 +1,148 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "Lv2cContainerElement.hpp"
+#include "Lv2cBindingProperty.hpp"
+#include <functional>
+
+namespace lv2c
+{
+    /// @brief How Lv2cVirtualListElement places its items.
+    enum class Lv2cVirtualListOrientation
+    {
+        /// @brief One item per row, top to bottom. Scrolls vertically.
+        Vertical,
+        /// @brief Fill columns top to bottom, then wrap to the next column. Scrolls horizontally.
+        ColumnWrap
+    };
+
+    /// @brief How Lv2cVirtualListElement determines the height of rows.
+    enum class Lv2cVirtualRowHeightMode
+    {
+        /// @brief Every row is exactly RowHeight() high.
+        Fixed,
+        /// @brief RowHeight() is an estimate. The row height is adjusted to the tallest realized item once items have been measured.
+        Estimated
+    };
+
+    /// @brief A list of items that only creates elements for items that are visible.
+    ///
+    /// Lv2cVirtualListElement is intended to be the child of a Lv2cScrollContainerElement. It measures as if
+    /// all items were present, but only creates, measures and mounts elements for the items that fall inside the
+    /// scroll container's viewport (plus Overscan() rows or columns on either side). Elements that scroll out of
+    /// view are returned to a recycle pool, and are rebound to new items as they scroll into view.
+    ///
+    /// Items are supplied by an item template: a factory that creates an unbound item element, and a binder that
+    /// loads the data for a particular item index into an element previously created by the factory. Binders
+    /// must completely reset the state of the element, since elements are reused for different items.
+    ///
+    /// All rows have the same height. In Vertical orientation, items are as wide as the list; in ColumnWrap orientation,
+    /// items are ColumnWidth() wide.
+    ///
+    /// Children are managed by the list. Do not add or remove children directly.
+
+    class Lv2cVirtualListElement : public Lv2cContainerElement
+    {
+    public:
+        virtual const char *Tag() const override { return "VirtualList"; }
+
+        using self = Lv2cVirtualListElement;
+        using super = Lv2cContainerElement;
+        using ptr = std::shared_ptr<self>;
+        static ptr Create() { return std::make_shared<self>(); }
+
+        /// @brief Creates a new, unbound item element.
+        using ItemFactory = std::function<Lv2cElement::ptr()>;
+        /// @brief Load the data for item `index` into an element created by the item factory.
+        using ItemBinder = std::function<void(Lv2cElement::ptr &element, size_t index)>;
+
+        Lv2cVirtualListElement();
+
+        BINDING_PROPERTY(Orientation, Lv2cVirtualListOrientation, Lv2cVirtualListOrientation::Vertical)
+        BINDING_PROPERTY(RowHeightMode, Lv2cVirtualRowHeightMode, Lv2cVirtualRowHeightMode::Fixed)
+        /// @brief The height of rows (an estimate in Estimated mode).
+        BINDING_PROPERTY(RowHeight, double, 32)
+        /// @brief The width of columns in ColumnWrap orientation.
+        BINDING_PROPERTY(ColumnWidth, double, 200)
+        /// @brief The gap between columns in ColumnWrap orientation.
+        BINDING_PROPERTY(ColumnGap, double, 0)
+        /// @brief The number of rows (or columns, in ColumnWrap orientation) to realize outside the visible area.
+        BINDING_PROPERTY(Overscan, int64_t, 2)
+
+        /// @brief Set the item template.
+        /// @param factory Creates unbound item elements.
+        /// @param binder Loads item data into an item element.
+        Lv2cVirtualListElement &ItemTemplate(const ItemFactory &factory, const ItemBinder &binder);
+
+        /// @brief The number of items in the list.
+        size_t ItemCount() const;
+        /// @brief Set the number of items in the list.
+        /// Realized items are rebound, and the list is laid out again.
+        Lv2cVirtualListElement &ItemCount(size_t count);
+
+        /// @brief Rebind all realized items.
+        /// Call when the data of items has changed, but the number of items has not.
+        void Refresh();
+
+        /// @brief The bounds of an item relative to the list's client area.
+        Lv2cRectangle GetItemBounds(size_t index) const;
+
+        /// @brief The number of items that currently have an element.
+        size_t RealizedItemCount() const;
+
+        /// @brief The total number of item elements created by the factory since the list was created.
+        size_t CreatedItemCount() const;
+
+    protected:
+        virtual Lv2cSize MeasureClient(Lv2cSize clientConstraint, Lv2cSize clientAvailable, Lv2cDrawingContext &context) override;
+        virtual void OnUnmount() override;
+
+    public:
+        virtual Lv2cSize Arrange(Lv2cSize available, Lv2cDrawingContext &context) override;
+        virtual void FinalizeLayout(const Lv2cRectangle &layoutClipRect, const Lv2cRectangle &screenOffset, bool clippedInLayout = false) override;
+        virtual void InvalidateLayout() override;
+
+    private:
+        double RowPitch() const;
+        size_t RowsPerColumn(double clientHeight) const;
+        void GetVisibleRange(const Lv2cRectangle &clientVisibleRect, size_t *first, size_t *last) const;
+        void RealizeItems(size_t first, size_t last);
+        void LayoutItem(Lv2cElement::ptr &element, size_t index, Lv2cDrawingContext &context);
+        void ReleaseAllItems();
+        void ReleaseItem(size_t childIndex);
+        Lv2cElement::ptr AcquireItem(size_t index);
+
+        ItemFactory itemFactory;
+        ItemBinder itemBinder;
+        size_t itemCount = 0;
+        size_t createdItemCount = 0;
+
+        std::vector<size_t> realizedIndexes; // item index of each child.
+        std::vector<Lv2cElement::ptr> recyclePool;
+        std::vector<Lv2cElement::ptr> discardedItems; // kept alive until the next layout, in case one of them is handling an event.
+
+        double measuredRowHeight = 0;
+        Lv2cSize clientLayoutSize;
+        bool realizing = false;
+        AnimationHandle rowHeightChangedHandle;
+    };
+}
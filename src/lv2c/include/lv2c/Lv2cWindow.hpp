@@ -28,6 +28,9 @@
 #include "JsonVariant.hpp"
 
 #include "Lv2cDamageList.hpp"
+#include "Lv2cTimerQueue.hpp"
+#include "Lv2cSvgRasterCache.hpp"
+#include "Lv2cPngStripFrames.hpp"
 // #include "Lv2cSvg.hpp"
 
 #include <map>
@@ -37,6 +40,8 @@
 #include <map>
 #include <chrono>
 #include <mutex>
+#include <thread>
+#include <optional>
 
 // forward declaration.
 typedef struct _PangoContext PangoContext;
@@ -44,6 +49,9 @@ typedef struct _PangoContext PangoContext;
 namespace lv2c
 {
     class Lv2cX11Window;
+    class Lv2cNativeWindow;
+    class Lv2cHeadlessWindow;
+    class Lv2cHeadlessNativeWindow;
     class Lv2cTheme;
     class Lv2cSvg;
     class FocusNavigationSelector;
@@ -89,6 +97,18 @@ namespace lv2c
         SouthWest,
         SouthEast
     };
+
+    /// @brief Controls how the native event loop schedules animation and idle processing.
+    enum class Lv2cSchedulerMode
+    {
+        /// @brief Animate, lay out and draw at a fixed frame rate whether or not there is work to do.
+        FixedFrameRate,
+        /// @brief Sleep until there is work to do.
+        /// The event loop wakes for X events, the earliest PostDelayed deadline, pending
+        /// damage or layout, and -- only while animation callbacks are outstanding --
+        /// the next animation frame.
+        EventDriven
+    };
     /// @brief Specifies parameters used to create windows.
     struct Lv2cCreateWindowParameters
     {
@@ -153,6 +173,9 @@ namespace lv2c
         /// the theme color will be copied in automatically.
         Lv2cColor backgroundColor = Lv2cColor(0,0,0,0);
 
+        /// @brief How the native event loop schedules animation and idle processing.
+        /// Applies to the top-level window, which drives the event loop for all of its child windows.
+        Lv2cSchedulerMode schedulerMode = Lv2cSchedulerMode::FixedFrameRate;
 
         Lv2cWindow* owner = nullptr;
     public:
@@ -209,6 +232,19 @@ namespace lv2c
         /// will be redrawn on the next OnIdle cycle.
         void Invalidate(const Lv2cRectangle &bounds);
 
+        /// @brief Scroll the contents of an area of the window.
+        /// @param bounds The area to scroll, in screen coordinates.
+        /// @param dx Horizontal distance to move the contents, in screen coordinates.
+        /// @param dy Vertical distance to move the contents, in screen coordinates.
+        /// The still-visible part of the previously drawn contents is copied to its new position
+        /// on the next Draw(), and only the newly exposed strips are invalidated. Falls back to
+        /// invalidating the entire area if the scroll can't be done by copying (fractional device pixel
+        /// distances, or overlapping popups, for example).
+        void ScrollRect(const Lv2cRectangle &bounds, double dx, double dy);
+
+        /// @brief Create a drawing context for measuring elements outside of a full layout pass.
+        Lv2cDrawingContext CreateDrawingContext();
+
         /// @brief Invalidate the layout of elements in the window
         /// Request an update of layout. The window contents
         /// will be layed out on the next OnIdle cycle.
@@ -295,6 +331,25 @@ namespace lv2c
 
         std::shared_ptr<Lv2cSvg> GetSvgImage(const std::string &filename);
         Lv2cSurface GetPngImage(const std::string &filename);
+
+        /// @brief Frames of a PNG strip, resampled to a device size.
+        /// @param filename The PNG strip file (see GetPngImage()).
+        /// @param tileSize The size of a frame within the PNG file.
+        /// @param deviceWidth The width of a resampled frame, in device pixels.
+        /// @param deviceHeight The height of a resampled frame, in device pixels.
+        /// @returns Shared frames, or null if the file can't be loaded.
+        ///
+        /// Elements that draw the same strip at the same device size share resampled frames.
+        /// Frames are released when the last element using them lets go.
+        Lv2cPngStripFrames::ptr GetPngStripFrames(const std::string &filename, Lv2cSize tileSize, int deviceWidth, int deviceHeight);
+
+        /// @brief Default memory cap for SvgRasterCache(), in bytes.
+        static constexpr size_t SVG_RASTER_CACHE_MAX_BYTES = 8 * 1024 * 1024;
+
+        /// @brief Cache of rasterized SVG images used by Lv2cSvgElement.
+        ///
+        /// Cleared when the window scale changes.
+        Lv2cSvgRasterCache &SvgRasterCache() { return svgRasterCache; }
         static void SetResourceDirectories(const std::vector<std::filesystem::path> &paths);
         static std::filesystem::path findResourceFile(const std::filesystem::path &path);
 
@@ -314,6 +369,11 @@ namespace lv2c
 
         bool Entered() const;
 
+        /// @brief The number of times the native event loop has woken up and done work.
+        /// Counts X event dispatches, animation frames and idle redraws. Useful for 
+        /// verifying that an idle window with Lv2cSchedulerMode::EventDriven consumes no CPU.
+        uint64_t WakeupCount() const;
+
     protected:
         virtual void OnClosing();
         virtual void OnDraw(Lv2cDrawingContext &dc);
@@ -346,9 +406,19 @@ namespace lv2c
         void FireAppFocusOut();
         void Draw();
         void Layout();
+        void LayoutDirtyElements();
+        // Perform any pending full or partial layout.
+        void UpdateLayout();
 
         void Animate();
 
+        /// @brief True if layout or drawing is required.
+        bool HasPendingRedraw() const;
+        /// @brief True if there are outstanding RequestAnimationCallback requests.
+        bool HasAnimationCallbacks() const;
+        /// @brief The time at which the next PostDelayed callback is due, if there is one.
+        std::optional<animation_clock_t::time_point> NextDelayedCallbackTime();
+
     protected:
         virtual bool OnKeyDown(Lv2cKeyboardEventArgs &eventArgs);
         virtual void OnLayoutComplete();
@@ -361,7 +431,6 @@ namespace lv2c
         std::map<std::string,std::weak_ptr<Lv2cObject>> memoObjects;
 
 
-        Lv2cDrawingContext CreateDrawingContext();
         void Idle();
         void Size(const Lv2cSize &size);
 
@@ -395,6 +464,9 @@ namespace lv2c
 
         void FireEnter();
         void FireLeave();
+
+        // Mount the root element once a native window has been attached.
+        void MountRootElement();
     private:
         double windowScale = 1.0;
         Lv2cRectangle lastFocusRectangle;
@@ -408,7 +480,7 @@ namespace lv2c
         Lv2cElement *focusElement = nullptr;
         Lv2cSize size;
         std::string windowTitle;
-        Lv2cX11Window *nativeWindow = nullptr;
+        Lv2cNativeWindow *nativeWindow = nullptr;
         Lv2cCreateWindowParameters windowParameters;
         Lv2cRectangle bounds;
 
@@ -417,29 +489,47 @@ namespace lv2c
         bool valid = false;
         bool layoutValid = false;
 
+        // Layout boundaries whose subtrees need layout (see Lv2cElement::IsLayoutBoundary()).
+        std::vector<Lv2cElement *> dirtyLayoutElements;
+        uint64_t layoutClassStyleGeneration = 0;
+        void InvalidateElementLayout(Lv2cElement *element);
+        void CancelElementLayout(Lv2cElement *element);
+
         std::shared_ptr<Lv2cRootElement> rootElement;
 
         std::shared_ptr<Lv2cTheme> theme;
 
         std::map<AnimationHandle, AnimationCallback> animationCallbacks;
 
-        struct DelayRecord
+        Lv2cTimerQueue delayCallbacks;
+
+        struct PendingScroll
         {
-            animation_clock_t::time_point time;
-            DelayCallback callback;
+            Lv2cRectangle deviceBounds;
+            int64_t dx, dy;
         };
+        std::vector<PendingScroll> pendingScrolls;
+        void ApplyPendingScrolls();
 
-        std::recursive_mutex delayCallbacksMutex;
-        std::map<AnimationHandle, DelayRecord> delayCallbacks;
+        // Wakes the native event loop when callbacks are posted from non-UI threads.
+        void WakeEventLoop();
+        void DrainWakeupEvents();
+        int WakeupFd() const { return wakeupFd; }
+        int wakeupFd = -1;
+        std::thread::id uiThreadId;
 
         static std::vector<std::filesystem::path> resourceDirectories;
 
         std::map<std::string, std::shared_ptr<Lv2cSvg>> svgCache;
         std::map<std::string, Lv2cSurface> pngCache;
+        std::map<std::string, std::weak_ptr<Lv2cPngStripFrames>> pngStripFrames;
+        Lv2cSvgRasterCache svgRasterCache{SVG_RASTER_CACHE_MAX_BYTES};
 
 
     private:
         friend class Lv2cX11Window;
+        friend class Lv2cHeadlessWindow;
+        friend class Lv2cHeadlessNativeWindow;
         friend class Lv2cDialog;
         friend class Lv2cElement;
     };
@@ -20,14 +20,8 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-/*////////////////////////////////////////////////////////////////////////////////////////////
-SECURITY WARNING: Please review the security note at the top of GlobMatcher.hpp
-                Not suitable for use on internet-facing content.
-//////////////////////////////////////////////////////////////////////////////////////////*/
-
-
 #include "lv2c_ui/GlobMatcher.hpp"
-#include <sstream>
+#include <algorithm>
 
 using namespace std;
 using namespace lv2c::ui;
@@ -42,177 +36,19 @@ static bool isEndOfSegment(char c)
 #endif
 }
 
-class GlobExpression
-{
-    friend class GlobMatcher;
-
-public:
-    virtual ~GlobExpression() {}
-
-    bool NextMatchesOne(char c) { return next->MatchesOne(c); }
-    bool NextMatches(const char *p)
-    {
-        // guard against "*?*?*?*?*?*[!b]*" DDOSattacks.
-        if (++backtrackingAttempts > GlobMatcher::MAX_BACKTRACKING_ATTEMPTS)
-        {
-            throw std::runtime_error("Maximum backtracking attempts exceeded. Please simplify your pattern.");
-        }
-        return next->Matches(p);
-    }
-
-    virtual bool MatchesOne(char c) = 0;
-    virtual bool Matches(const char *p) = 0;
-
-    virtual bool isMatchMany() const { return false; }
-
-    uint64_t backtrackingAttempts = 0;
-    GlobExpression *next = nullptr;
-};
-
-class MatchManyExpression : public GlobExpression
-{
-public:
-    MatchManyExpression() {}
-
-public:
-    virtual bool isMatchMany() const override { return true; }
-    using ptr = std::shared_ptr<MatchManyExpression>;
-    static ptr Create() { return std::make_shared<MatchManyExpression>(); }
-
-    virtual bool MatchesOne(char c) override { return isEndOfSegment(c); }
-    bool Matches(const char *p) override
-    {
-        while (true)
-        {
-            if (next->isMatchMany())
-            {
-                return NextMatches(p); // avoid  "*********" DOS attack. *?*?*?*?*?*?*?* isn't great either.
-            }
-            if (isEndOfSegment(*p))
-            {
-                return NextMatches(p);
-            }
-            if (NextMatchesOne(*p))
-            {
-                if (NextMatches(p))
-                {
-                    return true;
-                }
-            }
-            ++p;
-        }
-    }
-};
-
-class MatchEndExpression : public GlobExpression
-{
-public:
-    MatchEndExpression() {}
-
-public:
-    using ptr = std::shared_ptr<MatchEndExpression>;
-    static ptr Create() { return std::make_shared<MatchEndExpression>(); }
-    bool MatchesOne(char c) override
-    {
-        return isEndOfSegment(c);
-    }
-    bool Matches(const char *p) override
-    {
-        return isEndOfSegment(*p);
-    }
-};
-
-class MatchOneExpression : public GlobExpression
-{
-public:
-    MatchOneExpression() {}
-
-public:
-    using ptr = std::shared_ptr<MatchOneExpression>;
-    static ptr Create() { return std::make_shared<MatchOneExpression>(); }
-
-    bool MatchesOne(char c) override
-    {
-        return !isEndOfSegment(c);
-    }
-    bool Matches(const char *p) override
-    {
-        if (isEndOfSegment(*p))
-            return false;
-        ++p;
-        return NextMatches(p);
-    }
-};
-
-class MatchRunExpression : public GlobExpression
-{
-public:
-    MatchRunExpression(const std::string &text) : text(text) {}
-
-public:
-    using ptr = std::shared_ptr<MatchRunExpression>;
-    static ptr Create(const std::string text) { return std::make_shared<MatchRunExpression>(text); }
-
-    bool MatchesOne(char c) override
-    {
-        return c == text[0];
-    }
-    bool Matches(const char *p) override
-    {
-        const char *match = text.c_str();
-        while (true)
-        {
-            if (*match == '\0')
-            {
-                return NextMatches(p);
-            }
-            if (*match != *p)
-                return false;
-            ++p;
-            ++match;
-        }
-    }
-
-private:
-    std::string text;
-};
-
-class MatchAlternatesExpression : public GlobExpression
+size_t GlobMatcher::StateSetHash::operator()(const StateSet &stateSet) const
 {
-public:
-    MatchAlternatesExpression(bool inverted, const std::string &alternates) : inverted(inverted), alternates(alternates) {}
-
-public:
-    using ptr = std::shared_ptr<MatchAlternatesExpression>;
-    static ptr Create(bool inverted, const std::string text) { return std::make_shared<MatchAlternatesExpression>(inverted, text); }
-
-    bool MatchesOne(char c)
-    {
-        if (isEndOfSegment(c))
-            return false; // never allowed to match, even if we parsed it wrong.
-        bool match = alternates.find_first_of(c) != string::npos;
-        return match != inverted;
-    }
-    bool Matches(const char *p)
+    size_t result = 0;
+    for (uint64_t word : stateSet)
     {
-        if (isEndOfSegment(*p))
-            return false; // never allowed to match, even if we parsed it wrong.
-        bool match = alternates.find_first_of(*p) != string::npos;
-        if (match != inverted)
-        {
-            ++p;
-            return NextMatches(p);
-        }
-        return false;
+        result = result * 0x9E3779B97F4A7C15ull + std::hash<uint64_t>()(word);
     }
-
-private:
-    bool inverted;
-    std::string alternates;
-};
+    return result;
+}
 
 GlobMatcher::GlobMatcher()
 {
+    SetPattern("");
 }
 
 GlobMatcher::GlobMatcher(const std::string &pattern)
@@ -220,201 +56,173 @@ GlobMatcher::GlobMatcher(const std::string &pattern)
     SetPattern(pattern);
 }
 
-void GlobMatcher::PushRun(std::string &run)
-{
-    if (run.size() != 0)
-    {
-        expressions.push_back(MatchRunExpression::Create(run));
-        run.resize(0);
-    }
-}
 void GlobMatcher::SetPattern(const std::string &pattern)
 {
-    expressions.resize(0);
+    tokens.resize(0);
+    loops.assign(1, false);
+    matchAll = (pattern == "" || pattern == "*");
 
-    if (pattern == "" || pattern == "*")
-    {
-        return;
-    }
-    std::stringstream s(pattern);
-    using int_type = std::stringstream::int_type;
-    std::string run;
-    while (true)
+    CharSet segmentChars;
+    segmentChars.set();
+    for (int c = 0; c < 256; ++c)
     {
-        int_type c = s.get();
-        if (c == EOF)
-        {
-            break;
-        }
-        if (c == '\\')
+        if (isEndOfSegment((char)c))
         {
-            c = s.get();
-            if (c == EOF)
-            {
-                throw std::runtime_error("Invalid pattern.");
-            }
-            run.push_back((char)c);
+            segmentChars.reset(c);
         }
-        else if (c == '*')
+    }
+
+    size_t i = 0;
+    while (i < pattern.length())
+    {
+        char c = pattern[i++];
+        CharSet token;
+        if (c == '*')
         {
-            PushRun(run);
-            expressions.push_back(MatchManyExpression::Create());
+            loops.back() = true; // "**" is the same as "*".
+            continue;
         }
         else if (c == '?')
         {
-            PushRun(run);
-            expressions.push_back(MatchOneExpression::Create());
+            token = segmentChars;
         }
-        else if (c == '[')
+        else if (c == '[' && pattern.find(']', i) != std::string::npos)
         {
-            PushRun(run);
-            std::string alternates;
-            bool inverse = false;
-            c = s.get();
-            if (c == '!')
+            bool inverted = false;
+            if (pattern[i] == '!')
+            {
+                inverted = true;
+                ++i;
+            }
+            while (pattern[i] != ']')
             {
-                inverse = true;
-                alternates.push_back((char)c);
-                c = s.get();
+                token.set((uint8_t)pattern[i++]);
             }
-            while (true)
+            ++i;
+            if (inverted)
             {
-                if (c == EOF)
-                    throw ::runtime_error("Invalid pattern.");
-                if (c == ']')
-                    break;
-                alternates.push_back((char)c);
-                c = s.get();
+                token.flip();
             }
-            expressions.push_back(MatchAlternatesExpression::Create(inverse, alternates));
+            token &= segmentChars; // never allowed to match a separator.
         }
         else
         {
-            run.push_back((char)c);
+            if (c == '\\' && i < pattern.length())
+            {
+                c = pattern[i++];
+            }
+            token.set((uint8_t)c);
         }
+        tokens.push_back(token);
+        loops.push_back(false);
     }
-    PushRun(run);
-    expressions.push_back(MatchEndExpression::Create());
+    stateWords = (tokens.size() + 1 + 63) / 64;
+    ResetDfa();
+}
 
-    for (size_t i = 0; i < expressions.size() - 1; ++i)
-    {
-        expressions[i]->next = expressions[i + 1].get();
-    }
+void GlobMatcher::ResetDfa()
+{
+    dfaStates.resize(0);
+    dfaStateIndex.clear();
+
+    StateSet nfaStates(stateWords, 0);
+    AddDfaState(nfaStates); // DEAD_STATE
+    nfaStates[0] = 1;
+    startState = AddDfaState(nfaStates);
 }
 
-bool GlobMatcher::Matches(const std::string &text)
+int32_t GlobMatcher::AddDfaState(const StateSet &nfaStates)
 {
-    if (expressions.size() == 0)
-        return true;
-    for (auto &expression : expressions)
+    auto f = dfaStateIndex.find(nfaStates);
+    if (f != dfaStateIndex.end())
+    {
+        return f->second;
+    }
+    int32_t index = (int32_t)dfaStates.size();
+    dfaStates.emplace_back();
+    DfaState &dfaState = dfaStates.back();
+    dfaState.nfaStates = nfaStates;
+    size_t acceptState = tokens.size();
+    dfaState.accepting = (nfaStates[acceptState / 64] & (1ull << (acceptState % 64))) != 0;
+    std::fill(std::begin(dfaState.transitions), std::end(dfaState.transitions), UNKNOWN_TRANSITION);
+    dfaStateIndex[nfaStates] = index;
+    return index;
+}
+
+int32_t GlobMatcher::Transition(int32_t dfaState, uint8_t c)
+{
+    int32_t result = dfaStates[dfaState].transitions[c];
+    if (result != UNKNOWN_TRANSITION)
     {
-        expression->backtrackingAttempts = 0;
+        return result;
     }
-    const char *p = text.c_str();
-    while (true)
+
+    // Step the NFA. State i advances to i+1 if token i accepts c, and stays put on a '*' loop.
+    // A separator starts a new path segment, which the pattern may start matching from.
+    bool segmentChar = !isEndOfSegment((char)c);
+    const StateSet &nfaStates = dfaStates[dfaState].nfaStates;
+    StateSet next(stateWords, 0);
+    for (size_t i = 0; i < tokens.size() + 1; ++i)
     {
-        if (expressions[0]->Matches(p))
+        if ((nfaStates[i / 64] & (1ull << (i % 64))) == 0)
         {
-            return true;
+            continue;
         }
-        while (!isEndOfSegment(*p))
+        if (i < tokens.size() && tokens[i].test(c))
         {
-            ++p;
+            next[(i + 1) / 64] |= 1ull << ((i + 1) % 64);
         }
-        if (*p == '\0')
+        if (segmentChar && loops[i])
         {
-            return false;
+            next[i / 64] |= 1ull << (i % 64);
         }
-        ++p;
     }
-}
-
-#ifdef ENABLE_GLOBMATCHER_UNIT_TEST
-
-static void TestMatch(const std::string &pattern, const std::string &target, bool expected)
-{
-    GlobMatcher matcher(pattern);
-
-    bool match = matcher.Matches(target);
-    if (match != expected)
+    if (!segmentChar)
     {
-        throw std::runtime_error("Test failed.");
+        next[0] |= 1;
     }
-}
-static void ExpectException(const std::string &pattern, const std::string &target)
-{
-    bool hadException = false;
-    try
-    {
-        GlobMatcher matcher(pattern);
 
-        bool match = matcher.Matches(target);
-        (void)match;
-    }
-    catch (const std::exception &e)
+    if (dfaStates.size() >= MAX_DFA_STATES && dfaStateIndex.find(next) == dfaStateIndex.end())
     {
-        hadException = true;
+        // Keep memory bounded for patterns with very large DFAs. The cache refills as required.
+        ResetDfa();
+        return AddDfaState(next);
     }
-    if (!hadException)
+    result = AddDfaState(next);
+    dfaStates[dfaState].transitions[c] = result;
+    return result;
+}
+
+bool GlobMatcher::Matches(const std::string &text)
+{
+    if (matchAll)
+        return true;
+    int32_t state = startState;
+    for (char c : text)
     {
-        throw std::runtime_error("Test failed.");
+        if (isEndOfSegment(c))
+        {
+            if (dfaStates[state].accepting)
+            {
+                return true;
+            }
+            if (c == '\0')
+            {
+                return false;
+            }
+        }
+        state = Transition(state, (uint8_t)c);
     }
+    return dfaStates[state].accepting;
 }
 
-#include <iostream>
-#include <chrono>
-void GlobMatcherTest()
+std::vector<bool> GlobMatcher::Matches(const std::vector<std::string> &texts)
 {
-    cout << "Running Glob Matcher test " << endl;
-
-    TestMatch("a*c", "axb/axc", true);
-
-    TestMatch("a", "a", true);
-    TestMatch("a", "a/b", true);
-    TestMatch("a", "b/a", true);
-    TestMatch("a", "b/c", false);
-
-    TestMatch("*", "abc", true);
-    TestMatch("*c", "abc", true);
-    TestMatch("a*c", "a/c", false);
-    TestMatch("a*c", "axb/axc", true);
-
-    TestMatch("?", "", false);
-    TestMatch("?", "b", true);
-    TestMatch("?", "bb", false);
-    TestMatch("*?", "", false);
-    TestMatch("*?", "b", true);
-    TestMatch("*?", "bb", true);
-    TestMatch("?b", "bb", true);
-    TestMatch("b?", "bb", true);
-    TestMatch("*b?b*", "aaaababaaaa", true);
-    TestMatch("*b??b*", "aaaababaaaa", false);
-
-    TestMatch("[a]", "a", true);
-    TestMatch("[!a]", "a", false);
-
-    TestMatch("[a][!a]", "ab", true);
-    TestMatch("[a][!a]", "aa", false);
-    TestMatch("[abc][!a]", "cb", true);
-    TestMatch("[abc][!a]", "db", false);
-    TestMatch("[abc][!a]", "ba", false);
-    TestMatch("[abc]*[!a]", "bcccccc", true);
-
-    TestMatch("[]", "a", false);
-    TestMatch("[!]", "a", true);
-
-    using clock_t = std::chrono::steady_clock;
-
+    std::vector<bool> result;
+    result.reserve(texts.size());
+    for (const auto &text : texts)
     {
-        auto start = clock_t::now();
-        ExpectException("*[!]*[!]*[!]*[!]x", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa");
-
-        auto duration = clock_t::now() - start;
-        uint64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-        cout << "Worst-case execution time: " << ms << "ms." << endl;
+        result.push_back(Matches(text));
     }
-
-    cout << "Glob Matcher test succeeded. " << endl;
+    return result;
 }
-
-#endif
\ No newline at end of file
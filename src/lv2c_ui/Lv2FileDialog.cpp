@@ -25,12 +25,14 @@
 #include "lv2c/Lv2cEditBoxElement.hpp"
 #include "lv2c/Lv2cDropdownElement.hpp"
 #include "lv2c/Lv2cScrollContainerElement.hpp"
+#include "lv2c/Lv2cVirtualListElement.hpp"
 #include "lv2c/Lv2cIndefiniteProgressElement.hpp"
 #include "lv2c/Lv2cSvgElement.hpp"
 #include "lv2c/Lv2cTheme.hpp"
 #include "lv2c/IcuString.hpp"
 #include "lv2c/Lv2cLog.hpp"
 #include "lv2c_ui/GlobMatcher.hpp"
+#include "lv2c_ui/Lv2FileIndex.hpp"
 #include <filesystem>
 #include <algorithm>
 #include "lv2c_ui/MimeTypes.hpp"
@@ -85,29 +87,10 @@ bool IsHiddenFile(const std::filesystem::path &path)
 
 namespace lv2c::ui
 {
-    // directories forbidden because they are dangerous, infested with symlinks, and/or just plain uninteresting for practical searches.
-
-#ifdef __linux__
-    static const std::vector<std::filesystem::path> forbiddenDirectories{
-        "/dev", "/sys", "/proc", "/snap", "/run", "/tmp", "/boot", "/root", "/lost+found", "/var/run", "/var/tmp", "/var/cache"};
-
     static bool IsForbiddenDirectory(const std::filesystem::path &path)
     {
-        for (auto &directory : forbiddenDirectories)
-        {
-            if (path == directory)
-            {
-                return true;
-            }
-        }
-        return false;
+        return Lv2FileIndex::IsForbiddenDirectory(path);
     }
-#else
-    static bool IsForbiddenDirectory(const std::filesystem::path &path)
-    {
-        return false;
-    }
-#endif
 }
 
 static std::filesystem::path ConvertHomePath(const std::string &path)
@@ -130,6 +113,7 @@ static std::filesystem::path ConvertHomePath(const std::string &path)
 
 static constexpr size_t MAX_MATCHES = 200;
 
+
 class Lv2FileDialog::SearchTask : public Lv2cObject
 {
     SearchTask()
@@ -138,12 +122,14 @@ class Lv2FileDialog::SearchTask : public Lv2cObject
 
 public:
     using CallbackT = std::function<void(const std::vector<std::string> &results, SearchStatus status)>;
+    /// @param index A ready index of the files below `path`, or null to search the filesystem.
     SearchTask(
         Lv2FileDialog *dlg,
         const std::string &path,
         const std::string &searchString,
+        Lv2FileIndex::ptr index,
         std::function<void(const std::vector<std::string> &results, SearchStatus status)> callback)
-        : dlg(dlg), path(path), searchString(searchString), callback(callback), icuString(IcuString::Instance())
+        : dlg(dlg), path(path), searchString(searchString), index(std::move(index)), callback(callback), icuString(IcuString::Instance())
     {
         lastUpdateTime = animation_clock_t::now();
 
@@ -325,7 +311,14 @@ private:
     {
         try
         {
-            Search(this->path);
+            if (index)
+            {
+                QueryIndex();
+            }
+            else
+            {
+                Search(this->path);
+            }
         }
         catch (const CanceledException &e)
         {
@@ -443,6 +436,41 @@ public:
         return true;
     }
 
+    /// Search the filename index instead of crawling the filesystem.
+    void QueryIndex()
+    {
+        size_t prefixLength = path.ends_with('/') ? path.length() : path.length() + 1;
+        size_t fileCount = 0;
+        try
+        {
+            index->ForEachFile(
+                path,
+                [this, prefixLength, &fileCount](const std::string &file)
+                {
+                    // the index is locked while we're called, so don't post interim results.
+                    if (++fileCount % 1024 == 0 && Canceled())
+                    {
+                        return false;
+                    }
+                    std::filesystem::path filePath{file};
+                    if (dlg->FileTypeMatch(filePath))
+                    {
+                        std::string relativePath = file.substr(prefixLength);
+                        MatchScore score = GlobMatch(filePath.filename().string(), relativePath, searchString);
+                        if (score != MatchScore::NoMatch)
+                        {
+                            result.push_back(SearchResult{score, std::move(filePath)});
+                        }
+                    }
+                    return true;
+                });
+        }
+        catch (const std::exception &e)
+        {
+            LogDebug(SS("Search: " << e.what()));
+        }
+    }
+
     MatchScore Matches(const std::filesystem::directory_entry &dirEntry)
     {
         std::filesystem::path path = dirEntry.path();
@@ -506,6 +534,7 @@ public:
     AnimationHandle postResultHandle;
     const std::string path;
     std::string searchString;
+    Lv2FileIndex::ptr index;
 
     std::vector<SearchResult> result;
     std::function<void(const std::vector<std::string> &results, SearchStatus status)> callback;
@@ -515,6 +544,162 @@ public:
     std::mutex mutex;
 };
 
+
+class Lv2FileDialog::DirectoryLoadTask : public std::enable_shared_from_this<DirectoryLoadTask>
+{
+public:
+    using ptr = std::shared_ptr<DirectoryLoadTask>;
+    using CallbackT = std::function<void(std::vector<FileListEntry> &&files, bool complete, const std::string &error)>;
+
+    /// Enumerate a directory on a worker thread.
+    /// Sorted batches of files are delivered to callback on the UI thread. Directories are delivered in batches
+    /// at least every BATCH_INTERVAL, so that the file list fills incrementally on slow filesystems.
+    static ptr Start(Lv2FileDialog *dlg, const std::filesystem::path &path, CallbackT &&callback)
+    {
+        ptr result = std::make_shared<DirectoryLoadTask>(dlg, path, std::move(callback));
+        result->thread = std::make_unique<std::thread>(
+            [result = result.get()]()
+            {
+                result->ThreadProc();
+            });
+        return result;
+    }
+
+    DirectoryLoadTask(Lv2FileDialog *dlg, const std::filesystem::path &path, CallbackT &&callback)
+        : dlg(dlg), path(path), fileFilter(dlg->currentFileFilter), callback(std::move(callback)), icuString(IcuString::Instance())
+    {
+    }
+    ~DirectoryLoadTask()
+    {
+        // Only waits if the library is being unloaded (see RetireDirectoryLoadTask).
+        Cancel();
+        if (thread)
+        {
+            thread->join();
+            thread = nullptr;
+        }
+    }
+
+    /// Stop delivering results. Does not wait for the worker thread, which may be blocked on a slow filesystem.
+    void Cancel()
+    {
+        std::lock_guard lock{mutex};
+        canceled = true;
+        dlg = nullptr;
+    }
+    bool Finished()
+    {
+        std::lock_guard lock{mutex};
+        return finished;
+    }
+
+private:
+    static constexpr size_t MAX_BATCH_SIZE = 1024;
+    static constexpr std::chrono::milliseconds BATCH_INTERVAL{100};
+
+    bool Canceled()
+    {
+        std::lock_guard lock{mutex};
+        return canceled;
+    }
+
+    void ThreadProc()
+    {
+        std::vector<FileListEntry> batch;
+        std::string error;
+        auto lastPostTime = clock_t::now();
+
+        errno = 0;
+        try
+        {
+            for (auto &dirEntry : std::filesystem::directory_iterator(path))
+            {
+                if (Canceled())
+                {
+                    break;
+                }
+                const auto &path = dirEntry.path();
+                if (IsForbiddenDirectory(path) || IsHiddenFile(path))
+                {
+                    continue;
+                }
+                if (dirEntry.is_directory())
+                {
+                    batch.push_back(FileListEntry{path, true, path.filename().string()});
+                }
+                else if (dirEntry.is_regular_file())
+                {
+                    if (Lv2FileDialog::FileTypeMatch(fileFilter, path))
+                    {
+                        batch.push_back(FileListEntry{path, false, path.filename().string()});
+                    }
+                }
+                auto now = clock_t::now();
+                if (batch.size() >= MAX_BATCH_SIZE || (batch.size() != 0 && now - lastPostTime >= BATCH_INTERVAL))
+                {
+                    PostBatch(std::move(batch), false, error);
+                    batch = std::vector<FileListEntry>();
+                    lastPostTime = now;
+                }
+            }
+        }
+        catch (std::exception &e)
+        {
+            if (errno)
+            {
+                error = strerror(errno);
+            }
+            else
+            {
+                error = e.what();
+            }
+        }
+        PostBatch(std::move(batch), true, error);
+        std::lock_guard lock{mutex};
+        finished = true;
+    }
+
+    void PostBatch(std::vector<FileListEntry> &&batch, bool complete, const std::string &error)
+    {
+        // sort on the worker thread, so that the UI thread only has to merge.
+        std::sort(batch.begin(), batch.end(),
+                  [this](const FileListEntry &a, const FileListEntry &b)
+                  {
+                      return Lv2FileDialog::CompareFileListEntries(*icuString, a, b);
+                  });
+
+        std::lock_guard lock{mutex};
+        if (canceled)
+        {
+            return;
+        }
+        // shared_ptr allows the capture variable to be copied and moved painlessly.
+        auto data = std::make_shared<std::vector<FileListEntry>>(std::move(batch));
+        dlg->PostDelayed(
+            0,
+            [weakThis = weak_from_this(), data = std::move(data), complete, error]()
+            {
+                // Cancel() is only called on the UI thread, so this test isn't racy.
+                auto self = weakThis.lock();
+                if (self && !self->Canceled())
+                {
+                    self->callback(std::move(*data), complete, error);
+                }
+            });
+    }
+
+    Lv2FileDialog *dlg;
+    std::filesystem::path path;
+    std::optional<Lv2FileFilter> fileFilter;
+    CallbackT callback;
+    IcuString::Ptr icuString;
+
+    std::unique_ptr<std::thread> thread;
+    bool canceled = false;
+    bool finished = false;
+    std::mutex mutex;
+};
+
 Lv2FileDialog::Lv2FileDialog(const std::string &title, const std::string &settingsKey)
     : icuString(IcuString::Instance())
 {
@@ -919,16 +1104,19 @@ Lv2cElement::ptr Lv2FileDialog::RenderFileList()
         FilesScrollOffsetProperty.Bind(scroll->HorizontalScrollOffsetProperty);
 
         {
-            auto body = Lv2cFlexGridElement::Create();
+            // Only the visible files get elements, so that directories with thousands of files load quickly.
+            auto body = Lv2cVirtualListElement::Create();
             this->fileListContainer = body;
+            body->Orientation(Lv2cVirtualListOrientation::ColumnWrap)
+                .RowHeightMode(Lv2cVirtualRowHeightMode::Estimated)
+                .RowHeight(32)
+                .ColumnWidth(300)
+                .ColumnGap(16)
+                .Overscan(1);
             body->Style()
                 .HorizontalAlignment(Lv2cAlignment::Start)
                 .VerticalAlignment(Lv2cAlignment::Stretch)
-                .Padding({8, 8, 8, 24})
-                .FlexDirection(Lv2cFlexDirection::Column)
-                .FlexWrap(Lv2cFlexWrap::Wrap)
-                .ColumnGap(16)
-                .RowGap(0);
+                .Padding({8, 8, 8, 24});
             scroll->Child(body);
         }
         container->AddChild(scroll);
@@ -1249,41 +1437,6 @@ void Lv2FileDialog::OnSelectedLocationChanged(int64_t value)
     }
 }
 
-struct Lv2FileDialog::Lv2cDialogFile
-{
-    Lv2cDialogFile(const std::filesystem::directory_entry &dirEntry)
-        : isDirectory(dirEntry.is_directory()), path(dirEntry.path())
-    {
-        label = path.filename();
-        fileSize = 0;
-        if (isDirectory)
-        {
-            fileSize = 0;
-        }
-        else if (dirEntry.is_regular_file())
-        {
-            fileSize = dirEntry.file_size();
-        }
-        lastModified = dirEntry.last_write_time();
-    }
-    bool isDirectory;
-    std::filesystem::path path;
-    std::string label;
-    uintmax_t fileSize;
-    std::filesystem::file_time_type lastModified;
-};
-
-std::string Lv2FileDialog::GetIcon(const Lv2cDialogFile &file)
-{
-    if (file.isDirectory)
-    {
-        return "FileDialog/folder.svg";
-    }
-    else
-    {
-        return GetIcon(file.path);
-    }
-}
 
 std::string Lv2FileDialog::GetIcon(const std::filesystem::path &path)
 {
@@ -1313,252 +1466,269 @@ std::string Lv2FileDialog::GetIcon(const std::filesystem::path &path)
     return "FileDialog/document_file.svg";
 }
 
-void Lv2FileDialog::LoadMixedDirectoryFiles(const std::vector<std::string> &files)
+class Lv2FileDialog::FileListItemElement : public Lv2cButtonBaseElement
 {
+public:
+    using self = FileListItemElement;
+    using super = Lv2cButtonBaseElement;
+    using ptr = std::shared_ptr<self>;
+    static ptr Create(Lv2FileDialog *dialog, bool mixedDirectories) { return std::make_shared<self>(dialog, mixedDirectories); }
 
-    for (auto &file : files)
+    FileListItemElement(Lv2FileDialog *dialog, bool mixedDirectories)
     {
-        std::filesystem::path path{file};
-
-        auto buttonBase = Lv2cButtonBaseElement::Create();
-        buttonBase->Style()
-            .HorizontalAlignment(Lv2cAlignment::Stretch)
-            .MinWidth(200);
-        if (file == SelectedFile())
+        Style()
+            .HorizontalAlignment(Lv2cAlignment::Stretch);
+        auto container = Lv2cFlexGridElement::Create();
+        container->Style()
+            .FlexWrap(Lv2cFlexWrap::NoWrap)
+            .ColumnGap(8)
+            .FlexAlignItems(mixedDirectories ? Lv2cAlignment::Start : Lv2cAlignment::Center)
+            .Padding({8, 4, 8, 4});
         {
-            buttonBase->HoverState(buttonBase->HoverState() + Lv2cHoverState::Selected);
+            icon = Lv2cSvgElement::Create();
+            icon->Style()
+                .Width(24)
+                .Height(24)
+                .TintColor(dialog->Theme().secondaryTextColor);
+            container->AddChild(icon);
         }
         {
-            auto container = Lv2cFlexGridElement::Create();
-            container->Style()
-                .FlexWrap(Lv2cFlexWrap::NoWrap)
-                .ColumnGap(8)
-                .FlexAlignItems(Lv2cAlignment::Start)
-                .Padding({8, 4, 8, 4});
+            auto stack = Lv2cFlexGridElement::Create();
+            stack->Style()
+                .FlexDirection(Lv2cFlexDirection::Column)
+                .FlexWrap(Lv2cFlexWrap::NoWrap);
             {
+                title = Lv2cTypographyElement::Create();
+                title->Variant(Lv2cTypographyVariant::BodyPrimary);
+                title->Style()
+                    .SingleLine(true)
+                    .Ellipsize(Lv2cEllipsizeMode::Center);
+                if (mixedDirectories)
                 {
-                    auto icon = Lv2cSvgElement::Create();
-                    std::string iconPath = GetIcon(path);
-                    icon->Source(iconPath);
-                    icon->Style()
-                        .Width(24)
-                        .Height(24)
-                        .TintColor(Theme().secondaryTextColor);
-                    container->AddChild(icon);
-                }
-                {
-                    auto stack = Lv2cFlexGridElement::Create();
-                    stack->Style()
-                        .FlexDirection(Lv2cFlexDirection::Column)
-                        .FlexWrap(Lv2cFlexWrap::NoWrap);
-                    {
-                        auto text = Lv2cTypographyElement::Create();
-                        text->Text(path.filename().string()).Variant(Lv2cTypographyVariant::BodyPrimary);
-
-                        text->Style()
-                            .SingleLine(true)
-                            .Ellipsize(Lv2cEllipsizeMode::Center)
-                            .Padding({0, 2, 0, 4});
-                        stack->AddChild(text);
-                    }
-                    {
-                        auto text = Lv2cTypographyElement::Create();
-                        text->Text(path.parent_path().string()).Variant(Lv2cTypographyVariant::BodySecondary);
-                        text->Style()
-                            .SingleLine(true)
-                            .Ellipsize(Lv2cEllipsizeMode::Start);
-                        stack->AddChild(text);
-                    }
-                    container->AddChild(stack);
-                }
-                {
-                    auto favoriteIcon = Lv2cSvgElement::Create();
-                    favoriteIcon->Style()
-                        .Width(20)
-                        .Height(20)
-                        .Padding({0})
-                        .TintColor(Theme().secondaryTextColor);
-                    if (IsFavorite(file))
-                    {
-                        favoriteIcon->Source("FileDialog/favorites.svg");
-                    }
-                    else
-                    {
-                        favoriteIcon->Source("blank.svg");
-                    }
-                    container->AddChild(favoriteIcon);
+                    title->Style().Padding({0, 2, 0, 4});
                 }
+                stack->AddChild(title);
             }
-            buttonBase->AddChild(container);
-            std::filesystem::path filePath = file;
-            buttonBase->Clicked.AddListener(
-                [this, filePath](const Lv2cMouseEventArgs &eventArgs)
-                {
-                    CheckValid();
-                    OnFileSelected(filePath,eventArgs);
-                    return true;
-                });
+            if (mixedDirectories)
+            {
+                subtitle = Lv2cTypographyElement::Create();
+                subtitle->Variant(Lv2cTypographyVariant::BodySecondary);
+                subtitle->Style()
+                    .SingleLine(true)
+                    .Ellipsize(Lv2cEllipsizeMode::Start);
+                stack->AddChild(subtitle);
+            }
+            container->AddChild(stack);
         }
+        {
+            favoriteIcon = Lv2cSvgElement::Create();
+            favoriteIcon->Style()
+                .Width(20)
+                .Height(20)
+                .Padding({0})
+                .TintColor(dialog->Theme().secondaryTextColor);
+            container->AddChild(favoriteIcon);
+        }
+        AddChild(container);
 
-        fileListContainer->AddChild(buttonBase);
+        Clicked.AddListener(
+            [this, dialog](const Lv2cMouseEventArgs &eventArgs)
+            {
+                dialog->CheckValid();
+                std::filesystem::path filePath = this->path; // OnFileSelected may rebind this item.
+                dialog->OnFileSelected(filePath, eventArgs);
+                return true;
+            });
     }
-}
-
-void Lv2FileDialog::LoadFiles(const std::filesystem::path &path)
-{
-    using namespace std::filesystem;
 
-    std::vector<Lv2cDialogFile> files;
-
-    errno = 0;
-    try
+    void Bind(const std::filesystem::path &path, const std::string &iconSource, bool selected, bool favorite)
     {
-        for (auto &dirEntry : std::filesystem::directory_iterator(path))
+        this->path = path;
+        icon->Source(iconSource);
+        title->Text(path.filename().string());
+        if (subtitle)
         {
-
-            const auto &path = dirEntry.path();
-            if (IsForbiddenDirectory(path))
-            {
-                continue;
-            }
-            if (dirEntry.is_directory())
-            {
-                if (!IsHiddenFile(path))
-                {
-
-                    files.push_back(Lv2cDialogFile(dirEntry));
-                }
-            }
-            else if (dirEntry.is_regular_file())
-            {
-                if (!IsHiddenFile(path))
-                {
-                    if (this->FileTypeMatch(path))
-                    {
-                        files.push_back(Lv2cDialogFile(dirEntry));
-                    }
-                }
-            }
+            subtitle->Text(path.parent_path().string());
         }
-    }
-    catch (std::exception &e)
-    {
-        std::string error;
-        if (errno)
+        favoriteIcon->Source(favorite ? "FileDialog/favorites.svg" : "blank.svg");
+        if (selected)
         {
-            error = strerror(errno);
+            HoverState(HoverState() + Lv2cHoverState::Selected);
         }
         else
         {
-            error = e.what();
+            HoverState(HoverState() - Lv2cHoverState::Selected);
         }
-        this->noFilesLabel->Text(error);
-        this->noFilesLabel->Style()
-            .Visibility(Lv2cVisibility::Visible);
-        return;
     }
 
-    if (files.size() == 0)
+private:
+    std::filesystem::path path;
+    Lv2cSvgElement::ptr icon;
+    Lv2cTypographyElement::ptr title;
+    Lv2cTypographyElement::ptr subtitle;
+    Lv2cSvgElement::ptr favoriteIcon;
+};
+
+void Lv2FileDialog::ClearFileList()
+{
+    fileListEntries.clear();
+    if (fileListContainer)
     {
+        fileListContainer->ItemCount(0);
+    }
+}
 
-        this->noFilesLabel->Style().Visibility(Lv2cVisibility::Visible);
-        this->noFilesLabel->Text("No files.");
+void Lv2FileDialog::SetFileListEntries(std::vector<FileListEntry> &&entries, bool mixedDirectories)
+{
+    if (!fileListContainer)
+    {
+        return;
     }
-    else
+    if (this->fileListMixedDirectories != mixedDirectories)
     {
-        this->noFilesLabel->Style().Visibility(Lv2cVisibility::Collapsed);
+        this->fileListMixedDirectories = mixedDirectories;
+        fileListContainer->RowHeight(mixedDirectories ? 48 : 32);
+        fileListContainer->ItemTemplate(
+            [this, mixedDirectories]()
+            {
+                return FileListItemElement::Create(this, mixedDirectories);
+            },
+            [this](Lv2cElement::ptr &element, size_t index)
+            {
+                BindFileListItem(*(FileListItemElement *)element.get(), index);
+            });
     }
-    std::sort(files.begin(), files.end(),
-              [this](const Lv2cDialogFile &a, const Lv2cDialogFile &b)
-              {
-                  if (a.isDirectory != b.isDirectory)
-                  {
-                      return a.isDirectory;
-                  }
-                  return icuString->collationCompare(a.label, b.label) < 0;
-              });
+    this->fileListEntries = std::move(entries);
+    fileListContainer->ItemCount(fileListEntries.size());
+}
+
+void Lv2FileDialog::BindFileListItem(FileListItemElement &item, size_t index)
+{
+    const FileListEntry &entry = fileListEntries[index];
+    std::string icon = entry.isDirectory ? "FileDialog/folder.svg" : GetIcon(entry.path);
+    item.Bind(
+        entry.path,
+        icon,
+        entry.path.string() == SelectedFile(),
+        IsFavorite(entry.path));
+}
 
+void Lv2FileDialog::LoadMixedDirectoryFiles(const std::vector<std::string> &files)
+{
+    std::vector<FileListEntry> entries;
+    entries.reserve(files.size());
     for (auto &file : files)
     {
-        auto buttonBase = Lv2cButtonBaseElement::Create();
-        buttonBase->Style()
-            .HorizontalAlignment(Lv2cAlignment::Stretch);
-        if (file.path.string() == SelectedFile())
+        entries.push_back(FileListEntry{std::filesystem::path(file), false});
+    }
+    SetFileListEntries(std::move(entries), true);
+}
+
+bool Lv2FileDialog::CompareFileListEntries(IcuString &icuString, const FileListEntry &a, const FileListEntry &b)
+{
+    if (a.isDirectory != b.isDirectory)
+    {
+        return a.isDirectory;
+    }
+    return icuString.collationCompare(a.label, b.label) < 0;
+}
+
+void Lv2FileDialog::CancelDirectoryLoad()
+{
+    if (directoryLoadTask)
+    {
+        // Don't wait for the worker thread, which may be blocked on a slow filesystem.
+        directoryLoadTask->Cancel();
+        SearchProgressActive(false);
+        RetireDirectoryLoadTask(std::move(directoryLoadTask));
+        directoryLoadTask = nullptr;
+    }
+}
+
+Lv2FileDialog::~Lv2FileDialog()
+{
+    if (directoryLoadTask)
+    {
+        directoryLoadTask->Cancel();
+        RetireDirectoryLoadTask(std::move(directoryLoadTask));
+    }
+}
+
+void Lv2FileDialog::RetireDirectoryLoadTask(std::shared_ptr<DirectoryLoadTask> &&task)
+{
+    // Canceled tasks are kept at process level until their threads finish, so that closing a dialog
+    // never waits on a slow filesystem. Any that are still running when the library is unloaded are
+    // joined then, so that no thread outlives the code it runs.
+    struct Reaper
+    {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<DirectoryLoadTask>> tasks;
+    };
+    static Reaper reaper;
+
+    std::lock_guard lock{reaper.mutex};
+    std::erase_if(
+        reaper.tasks,
+        [](const std::shared_ptr<DirectoryLoadTask> &task)
         {
-            buttonBase->HoverState(buttonBase->HoverState() + Lv2cHoverState::Selected);
-        }
+            return task->Finished();
+        });
+    if (!task->Finished())
+    {
+        reaper.tasks.push_back(std::move(task));
+    }
+}
+
+void Lv2FileDialog::LoadFiles(const std::filesystem::path &path)
+{
+    CancelDirectoryLoad();
+    SetNoFilesLabel("");
+
+    directoryLoadTask = DirectoryLoadTask::Start(
+        this,
+        path,
+        [this](std::vector<FileListEntry> &&files, bool complete, const std::string &error)
+        {
+            CheckValid();
+            OnDirectoryLoadBatch(std::move(files), complete, error);
+        });
+}
+
+void Lv2FileDialog::OnDirectoryLoadBatch(std::vector<FileListEntry> &&files, bool complete, const std::string &error)
+{
+    if (files.size() != 0)
+    {
+        // Batches arrive sorted.
+        std::vector<FileListEntry> merged;
+        merged.reserve(fileListEntries.size() + files.size());
+        std::merge(
+            std::make_move_iterator(fileListEntries.begin()), std::make_move_iterator(fileListEntries.end()),
+            std::make_move_iterator(files.begin()), std::make_move_iterator(files.end()),
+            std::back_inserter(merged),
+            [this](const FileListEntry &a, const FileListEntry &b)
+            {
+                return CompareFileListEntries(*icuString, a, b);
+            });
+        SetFileListEntries(std::move(merged), false);
+    }
+    // Only show progress for directories that take more than one batch interval to load.
+    SearchProgressActive(!complete);
+    if (complete)
+    {
+        if (error.length() != 0)
         {
-            // minimum width.
-            auto spacer = Lv2cElement::Create();
-            spacer->Style()
-                .Width(200)
-                .Height(0);
-            buttonBase->AddChild(spacer);
+            SetNoFilesLabel(error);
         }
+        else if (fileListEntries.size() == 0)
         {
-            auto container = Lv2cFlexGridElement::Create();
-            container->Style()
-                .FlexWrap(Lv2cFlexWrap::NoWrap)
-                .ColumnGap(8)
-                .FlexAlignItems(Lv2cAlignment::Center)
-                .Padding({8, 4, 8, 4});
-            {
-                {
-                    auto icon = Lv2cSvgElement::Create();
-                    std::string iconPath = GetIcon(file);
-                    icon->Source(iconPath);
-                    icon->Style()
-                        .Width(24)
-                        .Height(24)
-                        .TintColor(Theme().secondaryTextColor);
-                    container->AddChild(icon);
-                }
-                {
-                    auto text = Lv2cTypographyElement::Create();
-                    text->Text(file.label).Variant(Lv2cTypographyVariant::BodyPrimary);
-                    text->Style()
-                        .SingleLine(true)
-                        .Ellipsize(Lv2cEllipsizeMode::Center);
-                    container->AddChild(text);
-                }
-                {
-                    auto favoriteIcon = Lv2cSvgElement::Create();
-                    favoriteIcon->Style()
-                        .Width(20)
-                        .Height(20)
-                        .Padding({0})
-                        .TintColor(Theme().secondaryTextColor);
-                    if (IsFavorite(file.path))
-                    {
-                        favoriteIcon->Source("FileDialog/favorites.svg");
-                    }
-                    else
-                    {
-                        favoriteIcon->Source("blank.svg");
-                    }
-                    container->AddChild(favoriteIcon);
-                }
-            }
-            buttonBase->AddChild(container);
-            std::filesystem::path filePath = file.path;
-            buttonBase->Clicked.AddListener(
-                [this, filePath](const Lv2cMouseEventArgs &eventArgs)
-                {
-                    CheckValid();
-                    OnFileSelected(filePath,eventArgs);
-                    return true;
-                });
+            SetNoFilesLabel("No files.");
         }
-
-        fileListContainer->AddChild(buttonBase);
     }
 }
 
 void Lv2FileDialog::LoadSearchResults()
 {
-
-    std::vector<Lv2cElement::ptr> noChildren;
-    fileListContainer->Children(noChildren);
+    ClearFileList();
 
     if (currentSearchStatus == SearchStatus::Idle)
     {
@@ -1643,10 +1813,9 @@ void Lv2FileDialog::LoadFileList()
     {
         return;
     }
-    std::vector<Lv2cElement::ptr> noChildren;
-    fileListContainer->Children(noChildren);
+    CancelDirectoryLoad();
+    ClearFileList();
 
-    // unmount all the existing children.
     switch (currentLocation.locationType)
     {
     case LocationType::None:
@@ -1665,7 +1834,6 @@ void Lv2FileDialog::LoadFileList()
         break;
     }
     }
-    fileListContainer->InvalidateParentLayout();
 }
 
 std::vector<std::string> Lv2FileDialog::GetFavoritesVector()
@@ -1753,7 +1921,15 @@ void Lv2FileDialog::Navigate(const std::filesystem::path &path_)
         CloseSearchBox(false);
 
         SelectedFile(path.string());
-        LoadFileList(); // could do this directly.
+        if (currentLocation.locationType == LocationType::Path && fileListMixedDirectories == false && !directoryLoadTask)
+        {
+            // The directory listing is already loaded. Just update the selection.
+            fileListContainer->Refresh();
+        }
+        else
+        {
+            LoadFileList();
+        }
         LoadBreadcrumbBar();
     }
 }
@@ -1987,6 +2163,7 @@ bool Lv2FileDialog::FileLocation::operator==(const FileLocation &other) const
 void Lv2FileDialog::OnClosing()
 {
     CancelSearchTimer();
+    CancelDirectoryLoad();
     if (currentPanel.locationType != LocationType::None) // don't save if something went wrong.
     {
         SaveSettings();
@@ -2161,6 +2338,7 @@ void Lv2FileDialog::OpenSearchBox()
         return;
     searchBoxOpen = true;
     searchSavedLocation = this->currentLocation;
+    GetFileIndex(); // start loading the index.
 
     SearchVisible(true);
     this->currentSearchStatus = SearchStatus::Idle;
@@ -2240,8 +2418,10 @@ void Lv2FileDialog::StartSearchTimer(bool noDelay)
     if (this->currentLocation.locationType == LocationType::Path)
     {
         // handle file search
+        // Searching an index is cheap enough to do on every keystroke.
+        bool indexReady = fileIndex && fileIndex->Ready();
         searchTimerHandle = this->PostDelayed(
-            noDelay ? 125 : 1000, // Well. Actually, dealy until the animation completes.
+            noDelay || indexReady ? 125 : 1000, // Well. Actually, dealy until the animation completes.
             [this]()
             {
                 StartSearchTask();
@@ -2256,8 +2436,8 @@ void Lv2FileDialog::StartSearchTimer(bool noDelay)
 
 void Lv2FileDialog::DirectSearch()
 {
-    std::vector<Lv2cElement::ptr> noChildren;
-    fileListContainer->Children(noChildren);
+    CancelDirectoryLoad();
+    ClearFileList();
 
     std::vector<std::string> baseList;
     switch (currentLocation.locationType)
@@ -2297,20 +2477,53 @@ void Lv2FileDialog::DirectSearch()
     }
 }
 
+Lv2FileIndex::ptr Lv2FileDialog::GetFileIndex()
+{
+    if (currentLocation.locationType != LocationType::Path)
+    {
+        return nullptr;
+    }
+    // Index the root of the current panel, so that the index can be shared by all the locations in the panel.
+    std::filesystem::path locationPath = ConvertHomePath(currentLocation.path);
+    std::filesystem::path root = locationPath;
+    if (currentPanel.locationType == LocationType::Path)
+    {
+        std::filesystem::path panelPath = ConvertHomePath(currentPanel.path);
+        if (isParentDirectory(panelPath, locationPath))
+        {
+            root = panelPath;
+        }
+    }
+    root = root.lexically_normal();
+    if (!fileIndex || fileIndex->Root() != root)
+    {
+        fileIndex = Lv2FileIndex::GetIndex(root);
+    }
+    return fileIndex;
+}
+
 void Lv2FileDialog::StartSearchTask()
 {
     if (this->currentLocation.locationType == LocationType::Path)
     {
-
+        CancelDirectoryLoad();
         SelectedFile("");
         FilesScrollOffset(0);
         this->searchTask = nullptr; // join with the old searchtask if there is one.
         SearchProgressActive(false);
 
+        // An index that isn't ready yet would return partial results. Crawl the filesystem instead.
+        auto index = GetFileIndex();
+        if (index && !index->Ready())
+        {
+            index = nullptr;
+        }
+
         this->searchTask = std::make_unique<SearchTask>(
             this,
             ConvertHomePath(currentLocation.path),
             searchEdit->Text(),
+            std::move(index),
             [this](const std::vector<std::string> &results, SearchStatus status)
             {
                 CheckValid();
@@ -2330,11 +2543,16 @@ void Lv2FileDialog::StartSearchTask()
 
 bool Lv2FileDialog::FileTypeMatch(const std::filesystem::path &path) const
 {
-    if (!currentFileFilter.has_value())
+    return FileTypeMatch(currentFileFilter, path);
+}
+
+bool Lv2FileDialog::FileTypeMatch(const std::optional<Lv2FileFilter> &fileFilter, const std::filesystem::path &path)
+{
+    if (!fileFilter.has_value())
     {
         return true;
     }
-    auto &filter = currentFileFilter.value();
+    auto &filter = fileFilter.value();
     if (filter.extensions.size() == 0 && filter.mimeTypes.size() == 0)
     {
         return true;
@@ -0,0 +1,782 @@
+// MIT License
+//
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "lv2c_ui/Lv2FileIndex.hpp"
+#include "lv2c/Lv2cSettingsFile.hpp"
+#include "lv2c/Lv2cLog.hpp"
+#include "ss.hpp"
+#include <fstream>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace lv2c;
+using namespace lv2c::ui;
+
+static constexpr const char *CACHE_FILE_HEADER = "lv2c_file_index 1";
+static constexpr std::chrono::seconds SAVE_DELAY{10};
+static constexpr int MAX_SYM_LINK_LEVEL = 4;
+
+std::mutex Lv2FileIndex::sharedIndexMutex;
+std::map<std::string, std::weak_ptr<Lv2FileIndex>> Lv2FileIndex::sharedIndexes;
+
+// directories forbidden because they are dangerous, infested with symlinks, and/or just plain uninteresting for practical searches.
+#ifdef __linux__
+static const std::vector<std::filesystem::path> forbiddenDirectories{
+    "/dev", "/sys", "/proc", "/snap", "/run", "/tmp", "/boot", "/root", "/lost+found", "/var/run", "/var/tmp", "/var/cache"};
+#else
+static const std::vector<std::filesystem::path> forbiddenDirectories;
+#endif
+
+bool Lv2FileIndex::IsForbiddenDirectory(const std::filesystem::path &path)
+{
+    for (auto &directory : forbiddenDirectories)
+    {
+        if (path == directory)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool IsHiddenName(const std::string &name)
+{
+    return name.starts_with('.');
+}
+
+static bool IsParent(const std::filesystem::path &parent, const std::filesystem::path &child)
+{
+    auto iParent = parent.begin();
+    auto iChild = child.begin();
+    while (iParent != parent.end())
+    {
+        if (iChild == child.end())
+        {
+            return false;
+        }
+        if ((*iParent) != (*iChild))
+        {
+            return false;
+        }
+        ++iParent;
+        ++iChild;
+    }
+    return true;
+}
+
+static std::string DirectoryPrefix(const std::string &directory)
+{
+    if (directory.ends_with('/'))
+    {
+        return directory;
+    }
+    return directory + "/";
+}
+
+static uint64_t StableHash(const std::string &value)
+{
+    // FNV-1a. std::hash isn't guaranteed to be stable across builds.
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : value)
+    {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+Lv2FileIndex::ptr Lv2FileIndex::GetIndex(const std::filesystem::path &root)
+{
+    std::string key = root.lexically_normal().string();
+    std::lock_guard lock{sharedIndexMutex};
+
+    auto f = sharedIndexes.find(key);
+    if (f != sharedIndexes.end())
+    {
+        auto result = f->second.lock();
+        if (result)
+        {
+            return result;
+        }
+    }
+    std::filesystem::path cacheFile;
+    try
+    {
+        cacheFile = Lv2cSettingsFile::GetSettingsDirectory("file_index") / SS(std::hex << StableHash(key) << ".index");
+    }
+    catch (const std::exception &e)
+    {
+        LogError(SS("Can't create file index directory. " << e.what()));
+    }
+    auto index = std::make_shared<Lv2FileIndex>(key, cacheFile);
+    // Releasing the last shared reference retires the index instead of destroying it.
+    ptr result{
+        index.get(),
+        [index](Lv2FileIndex *) mutable
+        {
+            index->Stop();
+            Retire(std::move(index));
+        }};
+    sharedIndexes[key] = result;
+    return result;
+}
+
+void Lv2FileIndex::Retire(std::shared_ptr<Lv2FileIndex> &&index)
+{
+    // Stopped indexes are kept at process level until their threads finish, so that releasing an index
+    // never waits on a crawl of a slow filesystem, or on saving the cache file. Any that are still running
+    // when the library is unloaded are joined then, so that no thread outlives the code it runs.
+    struct Reaper
+    {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<Lv2FileIndex>> indexes;
+    };
+    static Reaper reaper;
+
+    std::lock_guard lock{reaper.mutex};
+    std::erase_if(
+        reaper.indexes,
+        [](const std::shared_ptr<Lv2FileIndex> &index)
+        {
+            return index->Finished();
+        });
+    if (!index->Finished())
+    {
+        reaper.indexes.push_back(std::move(index));
+    }
+}
+
+Lv2FileIndex::Lv2FileIndex(const std::filesystem::path &root, const std::filesystem::path &cacheFile)
+    : root(root.lexically_normal()), cacheFile(cacheFile)
+{
+#ifdef __linux__
+    wakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd == -1)
+    {
+        LogError(SS("Lv2FileIndex: inotify not available. " << strerror(errno)));
+    }
+#endif
+    thread = std::make_unique<std::thread>(
+        [this]()
+        {
+            ThreadProc();
+            {
+                std::lock_guard lock{stateMutex};
+                finished = true;
+            }
+        });
+}
+
+Lv2FileIndex::~Lv2FileIndex()
+{
+    Stop();
+    if (thread)
+    {
+        thread->join();
+        thread = nullptr;
+    }
+#ifdef __linux__
+    if (inotifyFd != -1)
+    {
+        close(inotifyFd);
+    }
+    if (wakeupFd != -1)
+    {
+        close(wakeupFd);
+    }
+#endif
+}
+
+void Lv2FileIndex::Stop()
+{
+    {
+        std::lock_guard lock{stateMutex};
+        stopping = true;
+    }
+    stateChanged.notify_all();
+#ifdef __linux__
+    if (wakeupFd != -1)
+    {
+        uint64_t value = 1;
+        if (write(wakeupFd, &value, sizeof(value)) < 0)
+        {
+            // counter saturated. The thread will wake anyway.
+        }
+    }
+#endif
+}
+
+bool Lv2FileIndex::Stopping() const
+{
+    std::lock_guard lock{stateMutex};
+    return stopping;
+}
+
+bool Lv2FileIndex::Finished() const
+{
+    std::lock_guard lock{stateMutex};
+    return finished;
+}
+
+bool Lv2FileIndex::Ready() const
+{
+    std::lock_guard lock{stateMutex};
+    return ready;
+}
+
+bool Lv2FileIndex::Current() const
+{
+    std::lock_guard lock{stateMutex};
+    return current;
+}
+
+bool Lv2FileIndex::WaitUntilReady(std::chrono::milliseconds timeout) const
+{
+    std::unique_lock lock{stateMutex};
+    return stateChanged.wait_for(lock, timeout, [this]() { return ready || stopping || abandoned; }) && ready;
+}
+
+void Lv2FileIndex::SetReady(bool current)
+{
+    {
+        std::lock_guard lock{stateMutex};
+        this->ready = true;
+        this->current = this->current || current;
+    }
+    stateChanged.notify_all();
+}
+
+uint64_t Lv2FileIndex::Version() const
+{
+    std::shared_lock lock{filesMutex};
+    return version;
+}
+
+void Lv2FileIndex::ForEachFile(const std::filesystem::path &directory, const std::function<bool(const std::string &path)> &callback) const
+{
+    std::string prefix = DirectoryPrefix(directory.lexically_normal().string());
+
+    std::shared_lock lock{filesMutex};
+    for (auto i = files.lower_bound(prefix); i != files.end(); ++i)
+    {
+        if (!i->starts_with(prefix))
+        {
+            break;
+        }
+        if (!callback(*i))
+        {
+            break;
+        }
+    }
+}
+
+bool Lv2FileIndex::LoadCache()
+{
+    if (cacheFile.empty() || !std::filesystem::exists(cacheFile))
+    {
+        return false;
+    }
+    std::set<std::string> cachedFiles;
+    try
+    {
+        std::ifstream f(cacheFile);
+        std::string line;
+        if (!std::getline(f, line) || line != CACHE_FILE_HEADER)
+        {
+            return false;
+        }
+        if (!std::getline(f, line) || line != root.string())
+        {
+            return false;
+        }
+        std::string prefix = DirectoryPrefix(root.string());
+        while (std::getline(f, line))
+        {
+            if (line.length() != 0)
+            {
+                cachedFiles.insert(cachedFiles.end(), prefix + line);
+            }
+            if (cachedFiles.size() > MAX_INDEXED_FILES)
+            {
+                return false;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LogError(SS("Lv2FileIndex: Can't read " << cacheFile << ". " << e.what()));
+        return false;
+    }
+    {
+        std::unique_lock lock{filesMutex};
+        files = std::move(cachedFiles);
+        ++version;
+    }
+    return true;
+}
+
+void Lv2FileIndex::SaveCache()
+{
+    if (cacheFile.empty())
+    {
+        return;
+    }
+    std::filesystem::path tmpPath = std::filesystem::path(cacheFile.string() + ".$$$");
+    bool written = false;
+    {
+        std::shared_lock lock{filesMutex};
+        std::ofstream f(tmpPath);
+        f << CACHE_FILE_HEADER << '\n'
+          << root.string() << '\n';
+        size_t prefixLength = DirectoryPrefix(root.string()).length();
+        for (const auto &file : files)
+        {
+            if (file.find('\n') == std::string::npos)
+            {
+                f.write(file.c_str() + prefixLength, file.length() - prefixLength);
+                f << '\n';
+            }
+        }
+        if (f)
+        {
+            written = true;
+        }
+        dirty = false;
+    }
+    try
+    {
+        if (written)
+        {
+            std::filesystem::rename(tmpPath, cacheFile);
+        }
+        else
+        {
+            LogError(SS("Lv2FileIndex: Can't write " << cacheFile));
+            std::filesystem::remove(tmpPath);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LogError(SS("Lv2FileIndex: Can't write " << cacheFile << ". " << e.what()));
+    }
+}
+
+bool Lv2FileIndex::Crawl(const std::filesystem::path &directory, std::set<std::string> &result, size_t maxFiles, int symLinkLevel)
+{
+    // returns false if the crawl was abandoned (stopping, too many files, or out of watches).
+    if (IsForbiddenDirectory(directory))
+    {
+        return true;
+    }
+    AddWatch(directory);
+    if (watchesExhausted)
+    {
+        return false;
+    }
+    try
+    {
+        for (const auto &entry : std::filesystem::directory_iterator(directory))
+        {
+            if (Stopping())
+            {
+                return false;
+            }
+            const auto &path = entry.path();
+            if (IsHiddenName(path.filename().string()))
+            {
+                continue;
+            }
+            try
+            {
+                if (entry.is_directory())
+                {
+                    if (entry.is_symlink())
+                    {
+                        if (symLinkLevel + 1 >= MAX_SYM_LINK_LEVEL)
+                        {
+                            continue;
+                        }
+                        auto canonicalChild = std::filesystem::canonical(path);
+                        auto canonicalPath = std::filesystem::canonical(directory);
+                        if (IsParent(canonicalChild, canonicalPath))
+                        {
+                            continue;
+                        }
+                        if (!Crawl(path, result, maxFiles, symLinkLevel + 1))
+                        {
+                            return false;
+                        }
+                    }
+                    else
+                    {
+                        if (!Crawl(path, result, maxFiles, symLinkLevel))
+                        {
+                            return false;
+                        }
+                    }
+                }
+                else if (entry.is_regular_file())
+                {
+                    result.insert(path.string());
+                    if (result.size() > maxFiles)
+                    {
+                        return false;
+                    }
+                }
+            }
+            catch (const std::exception &e)
+            {
+                LogDebug(SS("Lv2FileIndex: " << e.what() << "(" << path << ")"));
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LogDebug(SS("Lv2FileIndex: " << e.what() << "(" << directory << ")"));
+    }
+    return true;
+}
+
+void Lv2FileIndex::AddFile(const std::string &path)
+{
+    std::unique_lock lock{filesMutex};
+    if (files.insert(path).second)
+    {
+        ++version;
+        dirty = true;
+    }
+}
+
+void Lv2FileIndex::RemoveFile(const std::string &path)
+{
+    std::unique_lock lock{filesMutex};
+    if (files.erase(path) != 0)
+    {
+        ++version;
+        dirty = true;
+    }
+}
+
+void Lv2FileIndex::RemoveDirectory(const std::string &path)
+{
+    std::string prefix = DirectoryPrefix(path);
+    {
+        std::unique_lock lock{filesMutex};
+        auto first = files.lower_bound(prefix);
+        auto last = first;
+        while (last != files.end() && last->starts_with(prefix))
+        {
+            ++last;
+        }
+        if (first != last)
+        {
+            files.erase(first, last);
+            ++version;
+            dirty = true;
+        }
+    }
+#ifdef __linux__
+    // a moved directory keeps its watches, which now have the wrong path.
+    for (auto i = watches.begin(); i != watches.end();)
+    {
+        if (i->second == path || i->second.starts_with(prefix))
+        {
+            inotify_rm_watch(inotifyFd, i->first);
+            i = watches.erase(i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+#endif
+}
+
+void Lv2FileIndex::AddWatch(const std::filesystem::path &directory)
+{
+#ifdef __linux__
+    if (inotifyFd == -1 || watchesExhausted)
+    {
+        return;
+    }
+    int wd = inotify_add_watch(
+        inotifyFd, directory.c_str(),
+        IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+    if (wd == -1)
+    {
+        if (errno == ENOSPC)
+        {
+            // reported by Abandon().
+            watchesExhausted = true;
+        }
+        return;
+    }
+    watches[wd] = directory.string();
+#endif
+}
+
+void Lv2FileIndex::RemoveWatches()
+{
+#ifdef __linux__
+    for (auto &watch : watches)
+    {
+        inotify_rm_watch(inotifyFd, watch.first);
+    }
+    watches.clear();
+#endif
+}
+
+void Lv2FileIndex::ProcessEvents()
+{
+#ifdef __linux__
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    bool overflowed = false;
+    while (true)
+    {
+        ssize_t nRead = read(inotifyFd, buffer, sizeof(buffer));
+        if (nRead <= 0)
+        {
+            break;
+        }
+        for (char *p = buffer; p < buffer + nRead;)
+        {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                overflowed = true;
+                continue;
+            }
+            auto fWatch = watches.find(event->wd);
+            if (fWatch == watches.end())
+            {
+                continue;
+            }
+            if (event->mask & IN_IGNORED)
+            {
+                watches.erase(fWatch);
+                continue;
+            }
+            if (event->len == 0 || IsHiddenName(event->name))
+            {
+                continue;
+            }
+            std::filesystem::path path = std::filesystem::path(fWatch->second) / event->name;
+            if (event->mask & IN_ISDIR)
+            {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                {
+                    size_t fileCount;
+                    {
+                        std::shared_lock lock{filesMutex};
+                        fileCount = files.size();
+                    }
+                    std::set<std::string> newFiles;
+                    if (fileCount > MAX_INDEXED_FILES || !Crawl(path, newFiles, MAX_INDEXED_FILES - fileCount, 0))
+                    {
+                        if (!Stopping())
+                        {
+                            Abandon();
+                        }
+                        return;
+                    }
+                    std::unique_lock lock{filesMutex};
+                    files.insert(newFiles.begin(), newFiles.end());
+                    ++version;
+                    dirty = true;
+                }
+                else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                {
+                    RemoveDirectory(path.string());
+                }
+            }
+            else
+            {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                {
+                    std::error_code ec;
+                    if (std::filesystem::is_regular_file(path, ec))
+                    {
+                        AddFile(path.string());
+                    }
+                }
+                else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                {
+                    RemoveFile(path.string());
+                }
+            }
+        }
+    }
+    if (overflowed)
+    {
+        // lost track of changes. Start over.
+        RemoveWatches();
+        std::set<std::string> newFiles;
+        if (Crawl(root, newFiles, MAX_INDEXED_FILES, 0))
+        {
+            std::unique_lock lock{filesMutex};
+            files = std::move(newFiles);
+            ++version;
+            dirty = true;
+        }
+        else if (!Stopping())
+        {
+            Abandon();
+        }
+    }
+#endif
+}
+
+void Lv2FileIndex::Abandon()
+{
+    // An index that can't be kept current would silently return stale results. Drop it, so that
+    // searches crawl the filesystem instead.
+    if (watchesExhausted)
+    {
+        LogWarning(SS("Lv2FileIndex: Out of inotify watches. " << root << " not indexed. (Increase /proc/sys/fs/inotify/max_user_watches)"));
+    }
+    else
+    {
+        LogWarning(SS("Lv2FileIndex: More than " << MAX_INDEXED_FILES << " files below " << root << ". Not indexed."));
+    }
+    RemoveWatches();
+    {
+        std::unique_lock lock{filesMutex};
+        files.clear();
+        ++version;
+        dirty = false;
+    }
+    if (!cacheFile.empty())
+    {
+        std::error_code ec;
+        std::filesystem::remove(cacheFile, ec);
+    }
+    {
+        std::lock_guard lock{stateMutex};
+        ready = false;
+        current = false;
+        abandoned = true;
+    }
+    stateChanged.notify_all();
+}
+
+void Lv2FileIndex::ThreadProc()
+{
+    if (LoadCache())
+    {
+        SetReady(false);
+    }
+
+    std::set<std::string> crawledFiles;
+    if (!Crawl(root, crawledFiles, MAX_INDEXED_FILES, 0))
+    {
+        if (!Stopping())
+        {
+            Abandon();
+        }
+        else
+        {
+            {
+                std::lock_guard lock{stateMutex};
+                ready = false;
+            }
+            stateChanged.notify_all();
+        }
+        return;
+    }
+    {
+        std::unique_lock lock{filesMutex};
+        if (files != crawledFiles)
+        {
+            files = std::move(crawledFiles);
+            ++version;
+            dirty = true;
+        }
+    }
+    SetReady(true);
+
+    // process changes until we're told to stop.
+    auto lastSaveTime = clock_t::now() - SAVE_DELAY;
+    while (!abandoned && !Stopping())
+    {
+        bool isDirty;
+        {
+            std::shared_lock lock{filesMutex};
+            isDirty = dirty;
+        }
+        auto now = clock_t::now();
+        if (isDirty && now - lastSaveTime >= SAVE_DELAY)
+        {
+            SaveCache();
+            lastSaveTime = now;
+            isDirty = false;
+        }
+#ifdef __linux__
+        int timeoutMs = -1;
+        if (isDirty)
+        {
+            timeoutMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(lastSaveTime + SAVE_DELAY - now).count() + 1;
+        }
+        struct pollfd fds[2];
+        int nFds = 0;
+        fds[nFds].fd = wakeupFd;
+        fds[nFds].events = POLLIN;
+        fds[nFds++].revents = 0;
+        if (inotifyFd != -1)
+        {
+            fds[nFds].fd = inotifyFd;
+            fds[nFds].events = POLLIN;
+            fds[nFds++].revents = 0;
+        }
+        int rc = poll(fds, nFds, timeoutMs);
+        if (rc < 0 && errno != EINTR)
+        {
+            LogError(SS("Lv2FileIndex: poll failed. " << strerror(errno)));
+            break;
+        }
+        if (nFds > 1 && (fds[1].revents & POLLIN))
+        {
+            ProcessEvents();
+        }
+#else
+        std::unique_lock lock{stateMutex};
+        stateChanged.wait_for(lock, SAVE_DELAY, [this]() { return stopping; });
+#endif
+    }
+    bool isDirty;
+    {
+        std::shared_lock lock{filesMutex};
+        isDirty = dirty;
+    }
+    if (isDirty)
+    {
+        SaveCache();
+    }
+}
@@ -23,6 +23,7 @@
 #include "lv2c/Lv2cNumericEditBoxElement.hpp"
 #include "lv2c/Lv2cTypographyElement.hpp"
 #include "lv2c/Lv2cWindow.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include "lv2c_ui/Lv2ControlConstants.hpp"
 
 #define XK_MISCELLANY
@@ -48,6 +49,7 @@ namespace lv2c::ui
 
         virtual Lv2cSize Arrange(Lv2cSize available,Lv2cDrawingContext &context) override
         {
+            LV2C_PROFILE_ELEMENT_SCOPE(Arrange, this);
             Lv2cSize result = super::Arrange(available,context);
 
 
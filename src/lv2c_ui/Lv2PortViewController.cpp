@@ -687,6 +687,54 @@ namespace lv2c::ui
     {
         return viewType;
     }
+    Lv2PortUpdateClass Lv2PortViewController::GetUpdateClass() const
+    {
+        switch (viewType)
+        {
+        case Lv2PortViewType::VuMeter:
+        case Lv2PortViewType::StereoVuMeter:
+        case Lv2PortViewType::StereoVuMeterRight:
+            if (portInfo.units() == Lv2Units::none || portInfo.units() == Lv2Units::unknown)
+            {
+                return Lv2PortUpdateClass::Lfo;
+            }
+            return Lv2PortUpdateClass::VuMeter;
+        case Lv2PortViewType::Tuner:
+            return Lv2PortUpdateClass::Tuner;
+        case Lv2PortViewType::Progress:
+        case Lv2PortViewType::LED:
+        case Lv2PortViewType::StatusOutputMessage:
+        case Lv2PortViewType::TextOutput:
+            return Lv2PortUpdateClass::TextOutput;
+        default:
+            return Lv2PortUpdateClass::Input;
+        }
+    }
+
+    Lv2PortUpdateClass Lv2PortViewController::GetUpdateClass(const Lv2PortInfo &portInfo)
+    {
+        Lv2PortViewController controller(portInfo);
+        return controller.GetUpdateClass();
+    }
+
+    double Lv2PortViewController::DefaultUpdateRate(Lv2PortUpdateClass updateClass)
+    {
+        switch (updateClass)
+        {
+        case Lv2PortUpdateClass::VuMeter:
+            return 30; // matches VuOutputPort.
+        case Lv2PortUpdateClass::Tuner:
+            return 15;
+        case Lv2PortUpdateClass::Lfo:
+            return 30;
+        case Lv2PortUpdateClass::TextOutput:
+            return 10;
+        case Lv2PortUpdateClass::Input:
+        default:
+            return 0;
+        }
+    }
+
     Lv2PortViewType Lv2PortViewController::CalculateViewType()
     {
         if (this->IsInputControl())
@@ -240,9 +240,7 @@ void Lv2TunerElement::PreparePangoContext()
         // pangoLayout = pango_cairo_create_layout(context.get());
 
         pangoLayout = pango_layout_new(GetPangoContext());
-        auto fontDescriptor = gPangoContext.GetFontDescription(this->Style());
-        pango_layout_set_font_description(pangoLayout, fontDescriptor);
-        pango_font_description_free(fontDescriptor);
+        pango_layout_set_font_description(pangoLayout, gPangoContext.GetSharedFontDescription(this->Style()));
     }
 }
 
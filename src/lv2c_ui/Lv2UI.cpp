@@ -20,6 +20,7 @@
 #include "lv2c_ui/Lv2UI.hpp"
 #include "lv2c_ui/Lv2PortView.hpp"
 #include "lv2c/Lv2cSettingsFile.hpp"
+#include "lv2c/Lv2cProfiler.hpp"
 #include "lv2c_ui/Lv2PortViewFactory.hpp"
 #include "lv2c_ui/Lv2FrequencyPlotElement.hpp"
 #include "lv2c_ui/Lv2FileElement.hpp"
@@ -49,6 +50,7 @@
 #include <cassert>
 
 #include <vector>
+#include <algorithm>
 #include <string.h>
 
 #include "lv2c/Lv2cGroupElement.hpp"
@@ -146,6 +148,10 @@ Lv2UI::Lv2UI(std::shared_ptr<Lv2PluginInfo> pluginInfo, const Lv2cCreateWindowPa
     this->bindingSites.resize(pluginInfo->ports().size());
     this->bindingSiteObserverHandles.resize(pluginInfo->ports().size());
     this->currentHostPortValues.resize(pluginInfo->ports().size());
+    this->pendingHostPortValues.resize(pluginInfo->ports().size());
+    this->pendingHostPortDirty.resize(pluginInfo->ports().size());
+    this->portUpdateClasses.resize(pluginInfo->ports().size(), Lv2PortUpdateClass::Input);
+    this->portUpdateDeadlines.resize(pluginInfo->ports().size());
 
     for (size_t i = 0; i < pluginInfo->ports().size(); ++i)
     {
@@ -163,6 +169,7 @@ Lv2UI::Lv2UI(std::shared_ptr<Lv2PluginInfo> pluginInfo, const Lv2cCreateWindowPa
             this->bindingSiteMap[port.symbol()] = bindingSites[index];
 
             currentHostPortValues[index] = port.default_value();
+            portUpdateClasses[index] = Lv2PortViewController::GetUpdateClass(port);
 
             if (port.is_input())
             {
@@ -175,8 +182,18 @@ Lv2UI::Lv2UI(std::shared_ptr<Lv2PluginInfo> pluginInfo, const Lv2cCreateWindowPa
         }
 
     }
+    for (Lv2PortUpdateClass updateClass : {
+             Lv2PortUpdateClass::Input,
+             Lv2PortUpdateClass::VuMeter,
+             Lv2PortUpdateClass::Tuner,
+             Lv2PortUpdateClass::Lfo,
+             Lv2PortUpdateClass::TextOutput})
+    {
+        portUpdateClassRates[updateClass] = Lv2PortViewController::DefaultUpdateRate(updateClass);
+    }
+    UpdatePortUpdateIntervals();
 
-    this->Theme(Lv2cTheme::Create(true));
+    this->Theme(Lv2cTheme::GetShared(true));
     this->portViewFactory = Lv2PortViewFactory::Create();
 }
 
@@ -186,6 +203,7 @@ Lv2UI::~Lv2UI()
 
     if (cairoWindow)
     {
+        CancelPortUpdateCallbacks();
         cairoWindow->CloseRootWindow();
         cairoWindow = nullptr;
     }
@@ -315,6 +333,17 @@ bool Lv2UI::instantiate(
     return true;
 }
 
+void Lv2UI::AttachWindow(Lv2cWindow::ptr window, LV2UI_Write_Function writeFunction, LV2UI_Controller controller)
+{
+    this->writeFunction = writeFunction;
+    this->controller = controller;
+    this->cairoWindow = window;
+    if (theme)
+    {
+        cairoWindow->Theme(theme);
+    }
+}
+
 void Lv2UI::InitUrids()
 {
     urids.log__Error = GetUrid(LV2_LOG__Error);
@@ -344,6 +373,7 @@ void Lv2UI::ui_port_event(
     uint32_t format,
     const void *buffer)
 {
+    LV2C_PROFILE_SCOPE("Lv2UI::ui_port_event");
     if (port_index < this->pluginInfo->ports().size())
     {
         if (pluginInfo->ports()[port_index].is_atom_port())
@@ -378,11 +408,34 @@ void Lv2UI::ui_port_event(
                 float value = *(float *)buffer;
                 if (port_index >= 0 && port_index < bindingSites.size())
                 {
-                    this->currentHostPortValues[port_index] = value;
-                    auto bindingSite = bindingSites[port_index];
-                    if (bindingSite)
+                    ++portUpdateStatistics.received;
+                    if (coalescePortUpdates && cairoWindow)
+                    {
+                        pendingHostPortValues[port_index] = value;
+                        if (pendingHostPortDirty[port_index])
+                        {
+                            ++portUpdateStatistics.coalesced;
+                        }
+                        else
+                        {
+                            pendingHostPortDirty[port_index] = true;
+                            pendingHostPorts.push_back(port_index);
+                            if (portUpdateDeadlines[port_index] < nextPortUpdateDeadline)
+                            {
+                                nextPortUpdateDeadline = portUpdateDeadlines[port_index];
+                                if (portUpdateDelayHandle)
+                                {
+                                    // an earlier deadline than the one we're waiting for.
+                                    cairoWindow->CancelPostDelayed(portUpdateDelayHandle);
+                                    portUpdateDelayHandle = AnimationHandle::InvalidHandle;
+                                }
+                            }
+                            SchedulePortUpdates();
+                        }
+                    }
+                    else
                     {
-                        bindingSite->set(value);
+                        SetHostPortValue(port_index, value);
                     }
                 }
             }
@@ -390,6 +443,202 @@ void Lv2UI::ui_port_event(
     }
 }
 
+void Lv2UI::SetHostPortValue(uint32_t portIndex, float value)
+{
+    this->currentHostPortValues[portIndex] = value;
+    auto bindingSite = bindingSites[portIndex];
+    if (bindingSite)
+    {
+        ++portUpdateStatistics.applied;
+        bindingSite->set(value);
+    }
+}
+
+void Lv2UI::ApplyPendingPortUpdates(const animation_clock_time_point_t &now)
+{
+    if (pendingHostPorts.empty())
+    {
+        return;
+    }
+    ++portUpdateStatistics.frames;
+
+    // Observers may post further port events; swap so that they land in the next frame.
+    std::vector<uint32_t> ports;
+    ports.swap(pendingHostPorts);
+    nextPortUpdateDeadline = animation_clock_time_point_t::max();
+
+    for (uint32_t portIndex : ports)
+    {
+        if (!pendingHostPortDirty[portIndex])
+        {
+            // superseded by a user edit while applying an earlier port.
+            continue;
+        }
+        auto &deadline = portUpdateDeadlines[portIndex];
+        if (deadline > now)
+        {
+            // not due yet. Keep the latest value pending.
+            pendingHostPorts.push_back(portIndex);
+            nextPortUpdateDeadline = std::min(nextPortUpdateDeadline, deadline);
+            continue;
+        }
+        auto interval = portUpdateIntervals[portIndex];
+        if (interval.count() != 0)
+        {
+            // Hold the cadence if we're only slightly late; otherwise restart it from now.
+            deadline += interval;
+            if (deadline <= now)
+            {
+                deadline = now + interval;
+            }
+        }
+        pendingHostPortDirty[portIndex] = false;
+        SetHostPortValue(portIndex, pendingHostPortValues[portIndex]);
+    }
+    for (uint32_t portIndex : pendingHostPorts)
+    {
+        nextPortUpdateDeadline = std::min(nextPortUpdateDeadline, portUpdateDeadlines[portIndex]);
+    }
+    SchedulePortUpdates();
+}
+
+void Lv2UI::SchedulePortUpdates()
+{
+    if (!cairoWindow || pendingHostPorts.empty() || portUpdateAnimationHandle || portUpdateDelayHandle)
+    {
+        return;
+    }
+    auto now = animation_clock_t::now();
+    if (nextPortUpdateDeadline <= now)
+    {
+        portUpdateAnimationHandle = cairoWindow->RequestAnimationCallback(
+            [this](const animation_clock_time_point_t &now)
+            {
+                portUpdateAnimationHandle = AnimationHandle::InvalidHandle;
+                ApplyPendingPortUpdates(now);
+            });
+    }
+    else
+    {
+        auto delay = std::chrono::ceil<std::chrono::milliseconds>(nextPortUpdateDeadline - now);
+        portUpdateDelayHandle = cairoWindow->PostDelayed(
+            delay,
+            [this]()
+            {
+                portUpdateDelayHandle = AnimationHandle::InvalidHandle;
+                SchedulePortUpdates();
+            });
+    }
+}
+
+void Lv2UI::CancelPortUpdateCallbacks()
+{
+    if (cairoWindow)
+    {
+        if (portUpdateAnimationHandle)
+        {
+            cairoWindow->CancelAnimationCallback(portUpdateAnimationHandle);
+        }
+        if (portUpdateDelayHandle)
+        {
+            cairoWindow->CancelPostDelayed(portUpdateDelayHandle);
+        }
+    }
+    portUpdateAnimationHandle = AnimationHandle::InvalidHandle;
+    portUpdateDelayHandle = AnimationHandle::InvalidHandle;
+}
+
+void Lv2UI::UpdatePortUpdateIntervals()
+{
+    portUpdateIntervals.resize(pluginInfo->ports().size());
+    for (size_t i = 0; i < portUpdateIntervals.size(); ++i)
+    {
+        double hz = GetPortUpdateRate((uint32_t)i);
+        if (hz > 0)
+        {
+            portUpdateIntervals[i] = std::chrono::duration_cast<animation_clock_t::duration>(
+                std::chrono::duration<double>(1.0 / hz));
+        }
+        else
+        {
+            portUpdateIntervals[i] = animation_clock_t::duration::zero();
+        }
+    }
+}
+
+Lv2UI &Lv2UI::PortUpdateRate(Lv2PortUpdateClass updateClass, double hz)
+{
+    portUpdateClassRates[updateClass] = std::max(hz, 0.0);
+    UpdatePortUpdateIntervals();
+    return *this;
+}
+
+double Lv2UI::PortUpdateRate(Lv2PortUpdateClass updateClass) const
+{
+    auto f = portUpdateClassRates.find(updateClass);
+    if (f == portUpdateClassRates.end())
+    {
+        return 0;
+    }
+    return f->second;
+}
+
+Lv2UI &Lv2UI::PortUpdateRate(const std::string &portSymbol, double hz)
+{
+    portUpdateSymbolRates[portSymbol] = std::max(hz, 0.0);
+    UpdatePortUpdateIntervals();
+    return *this;
+}
+
+double Lv2UI::GetPortUpdateRate(uint32_t portIndex) const
+{
+    if (portIndex >= pluginInfo->ports().size())
+    {
+        return 0;
+    }
+    auto f = portUpdateSymbolRates.find(pluginInfo->ports()[portIndex].symbol());
+    if (f != portUpdateSymbolRates.end())
+    {
+        return f->second;
+    }
+    return PortUpdateRate(portUpdateClasses[portIndex]);
+}
+
+Lv2UI &Lv2UI::CoalescePortUpdates(bool value)
+{
+    if (coalescePortUpdates != value)
+    {
+        coalescePortUpdates = value;
+        if (!value)
+        {
+            CancelPortUpdateCallbacks();
+            // flush, ignoring deadlines.
+            std::vector<uint32_t> ports;
+            ports.swap(pendingHostPorts);
+            for (uint32_t portIndex : ports)
+            {
+                if (pendingHostPortDirty[portIndex])
+                {
+                    pendingHostPortDirty[portIndex] = false;
+                    SetHostPortValue(portIndex, pendingHostPortValues[portIndex]);
+                }
+            }
+            nextPortUpdateDeadline = animation_clock_time_point_t::max();
+        }
+    }
+    return *this;
+}
+
+bool Lv2UI::CoalescePortUpdates() const
+{
+    return coalescePortUpdates;
+}
+
+void Lv2UI::ResetPortUpdateStatistics()
+{
+    portUpdateStatistics = PortUpdateStatistics();
+}
+
 int Lv2UI::ui_show()
 {
 
@@ -413,6 +662,7 @@ void Lv2UI::ui_delete()
 
     if (cairoWindow)
     {
+        CancelPortUpdateCallbacks();
         cairoWindow->CloseRootWindow();
     }
     cairoWindow = nullptr;
@@ -850,6 +1100,19 @@ Lv2cElement::ptr Lv2UI::RenderControl(Lv2cBindingProperty<double> &value, const
 
 void Lv2UI::OnPortValueChanged(int32_t portIndex, double value)
 {
+    if (pendingHostPortDirty[portIndex])
+    {
+        // A user edit supersedes a pending host value (often the host's echo of an earlier edit).
+        pendingHostPortDirty[portIndex] = false;
+        // Not listed if ApplyPendingPortUpdates() is running, and applying another port's value led to this edit.
+        // Its loop skips ports that are no longer dirty.
+        auto i = std::find(pendingHostPorts.begin(), pendingHostPorts.end(), (uint32_t)portIndex);
+        if (i != pendingHostPorts.end())
+        {
+            pendingHostPorts.erase(i);
+        }
+        ++portUpdateStatistics.superseded;
+    }
     float floatValue = (float)value;
     if (this->controller != nullptr)
     {
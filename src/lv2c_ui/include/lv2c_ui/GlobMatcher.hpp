@@ -20,34 +20,33 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 #pragma once
-/*////////////////////////////////////////////////////////////////////////////////////////////
-SECURITY WARNING: Not suitable for use on Internet-facing user input.
-
-This code may have a potential DDOS vulnerability if used on patterns supplied by remote
-users.  Perfectly fine for local user input though.
-
-See analysis at the end of this file.
-//////////////////////////////////////////////////////////////////////////////////////////*/
 #include <vector>
-#include <memory>
+#include <bitset>
+#include <cstdint>
 #include <string>
-
-#ifndef NDEBUG
-#define ENABLE_GLOBMATCHER_UNIT_TEST
-#endif
-class GlobExpression;
+#include <unordered_map>
 
 namespace lv2c::ui
 {
     /// @brief Matches strings against patterns with '*' or '?' wildcards.
     /// Call SetPattern to prepare the pattern for matching. Call Matches() to 
     /// find out if the pattern matches.
+    ///
+    /// The pattern must match an entire path segment of the text. '*' and '?' never
+    /// match a path separator. [abc] and [!abc] match one character from (or not from) a set.
+    ///
+    /// Patterns are compiled to an NFA with one state per pattern position, which is
+    /// converted lazily to a DFA as text is matched. Matching time is linear in the length 
+    /// of the text, regardless of the pattern. Malformed patterns (a trailing '\\', or 
+    /// an unterminated '[') match the offending characters literally.
+    ///
     /// Not threadsafe.
     class GlobMatcher
     {
 
     public:
-        static constexpr uint64_t MAX_BACKTRACKING_ATTEMPTS = 10000; // see not at head of file.
+        /// @brief Maximum number of DFA states cached before the cache is flushed.
+        static constexpr size_t MAX_DFA_STATES = 1024;
 
         GlobMatcher();
         GlobMatcher(const std::string &pattern);
@@ -55,39 +54,47 @@ namespace lv2c::ui
         void SetPattern(const std::string &pattern);
         bool Matches(const std::string &text);
 
-    private:
-        void PushRun(std::string &run);
-
-        std::vector<std::shared_ptr<GlobExpression>> expressions;
-    };
+        /// @brief Match the pattern against a batch of names.
+        /// @param texts The names to match.
+        /// @returns A vector the same size as texts, with true for each name that matches.
+        std::vector<bool> Matches(const std::vector<std::string> &texts);
 
-#ifdef ENABLE_GLOBMATCHER_UNIT_TEST
+        /// @brief The number of DFA states currently cached (for testing).
+        size_t DfaStateCount() const { return dfaStates.size(); }
 
-    extern void GlobMatcherTest();
-#endif
+    private:
+        using CharSet = std::bitset<256>;
+        using StateSet = std::vector<uint64_t>;
+
+        static constexpr int32_t UNKNOWN_TRANSITION = -1;
+        static constexpr int32_t DEAD_STATE = 0;
+
+        struct DfaState
+        {
+            StateSet nfaStates;
+            bool accepting = false;
+            int32_t transitions[256];
+        };
+
+        struct StateSetHash
+        {
+            size_t operator()(const StateSet &stateSet) const;
+        };
+
+        void ResetDfa();
+        int32_t AddDfaState(const StateSet &nfaStates);
+        int32_t Transition(int32_t dfaState, uint8_t c);
+
+        bool matchAll = false;
+        // tokens[i] is the set of characters that advance NFA state i to state i+1.
+        std::vector<CharSet> tokens;
+        // loops[i] is true if NFA state i has a '*' self-loop.
+        std::vector<bool> loops;
+        size_t stateWords = 0;
+
+        int32_t startState = DEAD_STATE;
+        std::vector<DfaState> dfaStates;
+        std::unordered_map<StateSet, int32_t, StateSetHash> dfaStateIndex;
+    };
 
 } // namespace
-
-/*////////////////////////////////////////////////////////////////////////////////////////////
-The issue: Worst-case performance for the pattern matcher is N^P (n = target length, P = number of
-* patterns), when faced with patterns that require backtracking to match. The simplest vulnerability
-is:
-
-   *?*?*?*?*?*?*?*?*?*?*?*X
-
-which is solvable, but variations of `*[!X]*[!Y*[!Z]*` are more difficult to deal with.
-
-The current implementation limits the maimum number of backtracking operations
-and throws an exception if the limit is exeeded. CPU use for a pathological
-case: < 1 ms.
-
-However, it's not absolutely clear that this fully addresses the problem. 10,000 backtracks
-x 1,000 *'s applied to five hundred targets? ....
-
-The fix: remove [] functionality, and merge *?*?*?*?* nodes to a new "at least 4 characters"
-node, which would produce O 2^N execution time! (So also limit the maximum complexity of patterns).
-
-Perfectly fine for local use. If a user wants to construct a pathological pattern, so be it. There
-are easier ways to pin a CPU.
-
-///////////////////////////////////////////////////////////////////////////////////////////*/
@@ -38,9 +38,11 @@ namespace lv2c
     class Lv2cFlexGridElement;
     class Lv2cTypographyElement;
     class Lv2cEditBoxElement;
+    class Lv2cVirtualListElement;
 }
 namespace lv2c::ui
 {
+    class Lv2FileIndex;
 
     struct Lv2FileFilter {
         std::string label;
@@ -59,6 +61,7 @@ namespace lv2c::ui
         static ptr Create(const std::string &title, const std::string &settingsKey) { return std::make_shared<self>(title, settingsKey); }
 
         Lv2FileDialog(const std::string &title, const std::string &settingsKey);
+        virtual ~Lv2FileDialog();
 
         virtual void Show(lv2c::Lv2cWindow *parent) override;
 
@@ -154,6 +157,9 @@ namespace lv2c::ui
 
         void StartSearchTask();
 
+        std::shared_ptr<Lv2FileIndex> fileIndex;
+        std::shared_ptr<Lv2FileIndex> GetFileIndex();
+
         bool searchVisible = false;
 
         Lv2FileDialog &SearchVisible(bool visible);
@@ -185,7 +191,20 @@ namespace lv2c::ui
         static std::vector<FilePanel> gPanels;
         std::vector<FilePanel> panels;
 
-        struct Lv2cDialogFile;
+        struct FileListEntry
+        {
+            std::filesystem::path path;
+            bool isDirectory = false;
+            std::string label;
+        };
+        static bool CompareFileListEntries(IcuString &icuString, const FileListEntry &a, const FileListEntry &b);
+
+        class DirectoryLoadTask;
+        std::shared_ptr<DirectoryLoadTask> directoryLoadTask;
+        static void RetireDirectoryLoadTask(std::shared_ptr<DirectoryLoadTask> &&task);
+        void CancelDirectoryLoad();
+        void OnDirectoryLoadBatch(std::vector<FileListEntry> &&files, bool complete, const std::string &error);
+        class FileListItemElement;
 
         FilePanel currentPanel;
         FileLocation currentLocation;
@@ -208,13 +227,15 @@ namespace lv2c::ui
 
         bool IsFavorite(const std::string &fileName);
 
-        std::string GetIcon(const Lv2cDialogFile &file);
         std::string GetIcon(const std::filesystem::path &path);
 
         void LoadBreadcrumbBar();
         void LoadFiles(const std::filesystem::path &path);
 
         void LoadMixedDirectoryFiles(const std::vector<std::string> &files);
+        void SetFileListEntries(std::vector<FileListEntry> &&entries, bool mixedDirectories);
+        void ClearFileList();
+        void BindFileListItem(FileListItemElement &item, size_t index);
         void LoadFavorites();
         void LoadRecent();
         void LoadFileList();
@@ -239,7 +260,9 @@ namespace lv2c::ui
         EventHandle okEventHandle, cancelEventHandle, clearValueEventHandle;
 
         std::vector<Lv2cElement::ptr> locations;
-        std::shared_ptr<Lv2cContainerElement> fileListContainer;
+        std::shared_ptr<Lv2cVirtualListElement> fileListContainer;
+        std::vector<FileListEntry> fileListEntries;
+        std::optional<bool> fileListMixedDirectories; // the layout of the current item template.
         std::unordered_set<std::string> favorites;
 
         std::vector<std::string> recentEntries;
@@ -289,6 +312,7 @@ namespace lv2c::ui
         double breadcrumbBarWidth = 0;
         double searchButtonWidth = 0;
         bool FileTypeMatch(const std::filesystem::path &path) const;
+        static bool FileTypeMatch(const std::optional<Lv2FileFilter> &fileFilter, const std::filesystem::path &path);
 
         std::optional<Lv2FileFilter> currentFileFilter;
     };
@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <chrono>
+
+namespace lv2c::ui
+{
+    /// @brief A persistent index of the filenames below a directory.
+    ///
+    /// The index is loaded from a cache file (if there is one), and then refreshed by crawling the
+    /// directory tree on a worker thread. Once the crawl is complete, the index is kept up to date
+    /// using inotify, and changes are written back to the cache file periodically.
+    ///
+    /// Hidden files, hidden directories and forbidden system directories are not indexed.
+    ///
+    /// An index that can't be kept up to date is abandoned, and is never Ready(): callers must 
+    /// search the filesystem directly instead. That happens if the directory tree grows past 
+    /// MAX_INDEXED_FILES, or needs more inotify watches than the system allows (see /proc/sys/fs/inotify/max_user_watches).
+    ///
+    /// Lv2FileIndex is thread-safe.
+    class Lv2FileIndex
+    {
+    public:
+        using self = Lv2FileIndex;
+        using ptr = std::shared_ptr<self>;
+
+        /// @brief Get the shared index for a directory.
+        /// The index is cached in the Lv2cSettingsFile settings directory. Indexes are shared
+        /// while there are outstanding references to them. Releasing the last reference stops the
+        /// index without waiting for its worker thread, which may be blocked on a slow filesystem.
+        static ptr GetIndex(const std::filesystem::path &root);
+
+        /// @brief Create an index.
+        /// @param root The directory to index.
+        /// @param cacheFile The file in which to persist the index. Empty to disable persistence.
+        Lv2FileIndex(const std::filesystem::path &root, const std::filesystem::path &cacheFile);
+        /// @brief Stops the index, and waits for its worker thread to finish.
+        ~Lv2FileIndex();
+
+        /// @brief Maximum number of files that will be indexed.
+        /// Indexes that would be larger than this are never Ready().
+        static constexpr size_t MAX_INDEXED_FILES = 500000;
+
+        const std::filesystem::path &Root() const { return root; }
+
+        /// @brief True if the index can be queried.
+        /// An index is ready once it has been loaded from the cache file, or once the initial crawl has completed.
+        bool Ready() const;
+
+        /// @brief Wait until the index is ready.
+        /// @returns Ready()
+        bool WaitUntilReady(std::chrono::milliseconds timeout) const;
+
+        /// @brief True once the index has been refreshed by crawling the filesystem.
+        bool Current() const;
+
+        /// @brief Incremented every time the contents of the index change.
+        uint64_t Version() const;
+
+        /// @brief Call `callback` with the absolute path of each indexed file below `directory`.
+        /// @param directory An absolute directory path.
+        /// @param callback Return false to stop enumerating.
+        /// The index is locked while callbacks are made, so callbacks should not block.
+        void ForEachFile(const std::filesystem::path &directory, const std::function<bool(const std::string &path)> &callback) const;
+
+        /// @brief Directories that are never indexed or searched.
+        static bool IsForbiddenDirectory(const std::filesystem::path &path);
+
+    private:
+        using clock_t = std::chrono::steady_clock;
+
+        void ThreadProc();
+        void Stop();
+        bool Finished() const;
+        static void Retire(std::shared_ptr<Lv2FileIndex> &&index);
+        bool LoadCache();
+        void SaveCache();
+        bool Crawl(const std::filesystem::path &directory, std::set<std::string> &files, size_t maxFiles, int symLinkLevel);
+        void Abandon();
+        void AddFile(const std::string &path);
+        void RemoveFile(const std::string &path);
+        void RemoveDirectory(const std::string &path);
+        bool Stopping() const;
+        void SetReady(bool current);
+
+        void AddWatch(const std::filesystem::path &directory);
+        void RemoveWatches();
+        void ProcessEvents();
+
+        std::filesystem::path root;
+        std::filesystem::path cacheFile;
+
+        mutable std::shared_mutex filesMutex;
+        std::set<std::string> files;
+        uint64_t version = 0;
+        bool dirty = false;
+
+        mutable std::mutex stateMutex;
+        mutable std::condition_variable stateChanged;
+        bool ready = false;
+        bool current = false;
+        bool stopping = false;
+        bool abandoned = false;
+        bool finished = false;
+
+        int inotifyFd = -1;
+        int wakeupFd = -1;
+        bool watchesExhausted = false;
+        std::map<int, std::string> watches;
+
+        std::unique_ptr<std::thread> thread;
+
+        static std::mutex sharedIndexMutex;
+        static std::map<std::string, std::weak_ptr<Lv2FileIndex>> sharedIndexes;
+    };
+}
@@ -47,6 +47,20 @@ namespace lv2c::ui {
         Tuner,
         Other
     };
+
+    /// @brief Classes of port used to select the rate at which the UI consumes host port notifications.
+    enum class Lv2PortUpdateClass {
+        /// @brief Input controls. Not rate limited.
+        Input,
+        /// @brief dB meters.
+        VuMeter,
+        /// @brief Tuner outputs.
+        Tuner,
+        /// @brief Unitless signal outputs (e.g. LFO outputs).
+        Lfo,
+        /// @brief Text, status, LED and progress outputs.
+        TextOutput,
+    };
     class Lv2PortViewController {
     public:
         using self = Lv2PortViewController;
@@ -60,6 +74,14 @@ namespace lv2c::ui {
 
         Lv2PortViewType GetViewType() const;
 
+        /// @brief The update class of the port, derived from its view type and units.
+        Lv2PortUpdateClass GetUpdateClass() const;
+        static Lv2PortUpdateClass GetUpdateClass(const Lv2PortInfo &portInfo);
+
+        /// @brief The default maximum redraw rate for an update class, in Hz.
+        /// @returns The maximum rate, or 0 if updates of the class are not rate limited.
+        static double DefaultUpdateRate(Lv2PortUpdateClass updateClass);
+
         Lv2cBindingProperty<double> DialValueProperty;
         Lv2PortViewController&DialValue(double value);
         double DialValue() const;
@@ -27,6 +27,7 @@
 #include "Lv2UI_NativeCallbacks.hpp"
 #include "lv2c/IcuString.hpp"
 #include "Lv2PluginInfo.hpp"
+#include "Lv2PortViewController.hpp"
 #include "lv2c/Lv2cElement.hpp"
 #include "lv2c/Lv2cContainerElement.hpp"
 #include "lv2c/Lv2cBindingProperty.hpp"
@@ -64,6 +65,9 @@ namespace lv2c::ui
         Lv2UI(std::shared_ptr<Lv2PluginInfo> pluginInfo, const Lv2cCreateWindowParameters& windowParameters);
         virtual ~Lv2UI();
 
+        /// @brief Set the theme for the UI.
+        /// By default, UIs use a shared theme (see Lv2cTheme::GetShared()), which must not be modified. To customize 
+        /// the theme, pass a copy obtained from Lv2cTheme::Writable(Theme()) to this method.
         Lv2UI& Theme(Lv2cTheme::ptr theme);
         Lv2cTheme::ptr Theme();
 
@@ -104,6 +108,51 @@ namespace lv2c::ui
 
         Lv2cWindow::ptr Window() { return cairoWindow; }
 
+        /// @brief Coalesce control port notifications from the host.
+        /// @param value True to enable coalescing.
+        /// When enabled, ui_port_event records only the latest value of each control port, and
+        /// dirty ports are applied to their binding sites once per animation frame. Hosts
+        /// that send meter ports at audio-block rate otherwise trigger a full binding cascade for
+        /// every notification. Disabled by default. Disabling coalescing flushes pending updates immediately.
+        Lv2UI& CoalescePortUpdates(bool value);
+        bool CoalescePortUpdates() const;
+
+        /// @brief Set the maximum redraw rate for a class of ports.
+        /// @param updateClass The class of port.
+        /// @param hz The maximum rate, in Hz. 0 removes the limit.
+        /// Rate limits apply only when CoalescePortUpdates is enabled. Pending values for a 
+        /// port are held until its deadline expires, so the cost of redrawing a 
+        /// UI with many meters is bounded by the policy rather than by the host's notification
+        /// rate. Each port's class is derived from its Lv2PortInfo (see Lv2PortViewController::GetUpdateClass),
+        /// and defaults to Lv2PortViewController::DefaultUpdateRate.
+        Lv2UI& PortUpdateRate(Lv2PortUpdateClass updateClass, double hz);
+        double PortUpdateRate(Lv2PortUpdateClass updateClass) const;
+
+        /// @brief Set the maximum redraw rate for a single port.
+        /// @param portSymbol The symbol of the port.
+        /// @param hz The maximum rate, in Hz. 0 removes the limit.
+        /// Overrides the rate of the port's update class.
+        Lv2UI& PortUpdateRate(const std::string&portSymbol, double hz);
+
+        /// @brief The effective maximum redraw rate of a port, in Hz, or 0 if the port is not rate limited.
+        double GetPortUpdateRate(uint32_t portIndex) const;
+
+        /// @brief Counters for control port notifications received from the host.
+        struct PortUpdateStatistics {
+            /// @brief Control port notifications received.
+            uint64_t received = 0;
+            /// @brief Notifications superseded by a later value before they were applied.
+            uint64_t coalesced = 0;
+            /// @brief Pending notifications discarded because the user edited the port before they were applied.
+            uint64_t superseded = 0;
+            /// @brief Values written to binding sites.
+            uint64_t applied = 0;
+            /// @brief Animation frames in which pending port updates were applied.
+            uint64_t frames = 0;
+        };
+        const PortUpdateStatistics&GetPortUpdateStatistics() const { return portUpdateStatistics; }
+        void ResetPortUpdateStatistics();
+
     public:
 
         struct PatchPropertyEventArgs {
@@ -169,6 +218,26 @@ namespace lv2c::ui
         std::vector<Observable<double>::handle_t> bindingSiteObserverHandles;
         std::vector<double> currentHostPortValues;
 
+        void SetHostPortValue(uint32_t portIndex, float value);
+        void ApplyPendingPortUpdates(const animation_clock_time_point_t &now);
+        void SchedulePortUpdates();
+        void CancelPortUpdateCallbacks();
+        void UpdatePortUpdateIntervals();
+        bool coalescePortUpdates = false;
+        std::vector<float> pendingHostPortValues;
+        std::vector<uint8_t> pendingHostPortDirty;
+        std::vector<uint32_t> pendingHostPorts;
+        AnimationHandle portUpdateAnimationHandle;
+        AnimationHandle portUpdateDelayHandle;
+        PortUpdateStatistics portUpdateStatistics;
+
+        std::map<Lv2PortUpdateClass, double> portUpdateClassRates;
+        std::map<std::string, double> portUpdateSymbolRates;
+        std::vector<Lv2PortUpdateClass> portUpdateClasses;
+        std::vector<animation_clock_t::duration> portUpdateIntervals;
+        std::vector<animation_clock_time_point_t> portUpdateDeadlines;
+        animation_clock_time_point_t nextPortUpdateDeadline = animation_clock_time_point_t::max();
+
         std::map<LV2_URID,std::shared_ptr<Lv2cBindingProperty<std::string>>> filePropertyBindingSites;
 
         void OnPortValueChanged(int32_t portIndex, double value);
@@ -211,6 +280,16 @@ namespace lv2c::ui
             LV2UI_Widget *widget,
             const LV2_Feature *const *features) override;
 
+        /// @brief Run the UI in an existing window, without an LV2 host.
+        /// @param window The window.
+        /// @param writeFunction Receives writes to input control ports.
+        /// @param controller Passed to writeFunction.
+        ///
+        /// For tests and benchmarks that run a UI in a Lv2cHeadlessWindow. Takes the place of instantiate(), 
+        /// but does not render the UI or map URIDs. As with a window created by instantiate(), the window 
+        /// is closed when the UI is deleted.
+        void AttachWindow(Lv2cWindow::ptr window, LV2UI_Write_Function writeFunction, LV2UI_Controller controller);
+
         virtual void ui_port_event(
             uint32_t port_index,
             uint32_t buffer_size,
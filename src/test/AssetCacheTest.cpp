@@ -0,0 +1,95 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+#include "lv2c/Lv2cAssetCache.hpp"
+#include <fstream>
+#include <unistd.h>
+
+using namespace lv2c;
+namespace fs = std::filesystem;
+
+static void WriteSvg(const fs::path &path, const std::string &color)
+{
+    std::ofstream f(path);
+    f << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"24\" height=\"24\">"
+      << "<rect width=\"24\" height=\"24\" fill=\"" << color << "\"/></svg>";
+}
+
+TEST_CASE("Lv2cAssetCache", "[asset_cache]")
+{
+    fs::path testDirectory = fs::temp_directory_path() / ("lv2c_asset_cache_test_" + std::to_string(getpid()));
+    fs::remove_all(testDirectory);
+    fs::create_directories(testDirectory);
+    fs::path a = testDirectory / "a.svg";
+    fs::path b = testDirectory / "b.svg";
+    WriteSvg(a, "red");
+    WriteSvg(b, "blue");
+
+    Lv2cAssetCache cache;
+
+    // same file, different spellings of the path.
+    Lv2cSvg::ptr svgA = cache.GetSvg(a);
+    REQUIRE(svgA);
+    REQUIRE(cache.GetSvg(testDirectory / "." / "a.svg") == svgA);
+    auto stats = cache.GetStats();
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.entries == 1);
+
+    // a modified file is reloaded.
+    fs::last_write_time(a, fs::last_write_time(a) + std::chrono::seconds(10));
+    Lv2cSvg::ptr reloaded = cache.GetSvg(a);
+    REQUIRE(reloaded != svgA);
+    REQUIRE(cache.GetStats().reloads == 1);
+    REQUIRE(cache.GetSvg(a) == reloaded);
+
+    // entries that are in use are not evicted.
+    Lv2cSvg::ptr svgB = cache.GetSvg(b);
+    cache.MaxBytes(1);
+    REQUIRE(cache.GetStats().entries == 2);
+    REQUIRE(cache.GetStats().evictions == 0);
+
+    svgA = nullptr;
+    reloaded = nullptr;
+    cache.MaxBytes(1); // trims.
+    stats = cache.GetStats();
+    REQUIRE(stats.entries == 1);
+    REQUIRE(stats.evictions == 1);
+    REQUIRE(cache.GetSvg(b) == svgB);
+
+    cache.Clear();
+    REQUIRE(cache.GetStats().entries == 0);
+    REQUIRE(svgB->intrinsic_size() == Lv2cSize(24, 24)); // still valid.
+
+    // unused entries are discarded when the last client is released.
+    cache.MaxBytes(0);
+    cache.AddClient();
+    cache.AddClient();
+    svgA = cache.GetSvg(a);
+    svgB = cache.GetSvg(b);
+    cache.ReleaseClient();
+    REQUIRE(cache.GetStats().entries == 2);
+    svgA = nullptr;
+    cache.ReleaseClient();
+    REQUIRE(cache.GetStats().entries == 1); // b is still in use.
+    REQUIRE(cache.GetSvg(b) == svgB);
+
+    fs::remove_all(testDirectory);
+}
@@ -0,0 +1,168 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cBlur.hpp"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace lv2c;
+
+namespace
+{
+    struct TestImage
+    {
+        TestImage(int64_t width, int64_t height)
+            : width(width), height(height), stride((width + 3) & ~3)
+        {
+            data.resize(stride * height);
+        }
+        int64_t width, height, stride;
+        std::vector<uint8_t> data;
+    };
+
+    // A rounded-rectangle-ish mask with noise, similar to what drop shadows get fed.
+    TestImage MakeTestImage(int64_t width, int64_t height, int64_t margin, uint32_t seed)
+    {
+        TestImage result(width, height);
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> noise(0, 255);
+        for (int64_t y = 0; y < height; ++y)
+        {
+            for (int64_t x = 0; x < width; ++x)
+            {
+                bool inside = x >= margin && x < width - margin && y >= margin && y < height - margin;
+                uint8_t v = inside ? 255 : 0;
+                if ((x + y) % 7 == 0)
+                {
+                    v = (uint8_t)noise(rng);
+                }
+                result.data[y * result.stride + x] = v;
+            }
+        }
+        return result;
+    }
+
+    int64_t MaxDifference(const TestImage &a, const TestImage &b)
+    {
+        int64_t result = 0;
+        for (int64_t y = 0; y < a.height; ++y)
+        {
+            for (int64_t x = 0; x < a.width; ++x)
+            {
+                int64_t diff = std::abs((int64_t)a.data[y * a.stride + x] - (int64_t)b.data[y * b.stride + x]);
+                result = std::max(result, diff);
+            }
+        }
+        return result;
+    }
+}
+
+TEST_CASE("Lv2cBlur drop shadow matches reference", "[blur]")
+{
+    for (double radius : {0.5, 1.0, 1.5, 2.0, 3.0, 4.5, 8.0, 16.0})
+    {
+        for (double offsetFrac : {0.0, 0.25, -0.5})
+        {
+            TestImage image = MakeTestImage(61, 43, 9, 1);
+            TestImage reference = image;
+
+            Lv2cBlur::DropShadow(image.data.data(), image.width, image.height, image.stride, radius, offsetFrac, -offsetFrac);
+            Lv2cBlur::DropShadowReference(reference.data.data(), reference.width, reference.height, reference.stride, radius, offsetFrac, -offsetFrac);
+
+            INFO("radius: " << radius << " offsetFrac: " << offsetFrac);
+            REQUIRE(MaxDifference(image, reference) <= 1);
+        }
+    }
+}
+
+TEST_CASE("Lv2cBlur inset shadow matches reference", "[blur]")
+{
+    for (double radius : {0.5, 1.0, 2.0, 3.0, 5.0, 12.0})
+    {
+        for (int64_t offset : {0, 2, -3, 7})
+        {
+            TestImage image = MakeTestImage(53, 37, 6, 2);
+            TestImage reference = image;
+
+            Lv2cBlur::InsetShadow(image.data.data(), image.width, image.height, image.stride, radius, offset, -offset, 0, 0);
+            Lv2cBlur::InsetShadowReference(reference.data.data(), reference.width, reference.height, reference.stride, radius, offset, -offset, 0, 0);
+
+            INFO("radius: " << radius << " offset: " << offset);
+            REQUIRE(MaxDifference(image, reference) <= 1);
+        }
+    }
+}
+
+TEST_CASE("Lv2cBlur radius larger than image", "[blur]")
+{
+    TestImage image = MakeTestImage(5, 3, 1, 3);
+    TestImage reference = image;
+    Lv2cBlur::DropShadow(image.data.data(), image.width, image.height, image.stride, 10.0, 0, 0);
+    Lv2cBlur::DropShadowReference(reference.data.data(), reference.width, reference.height, reference.stride, 10.0, 0, 0);
+    REQUIRE(MaxDifference(image, reference) <= 1);
+}
+
+// Microbenchmark. Hidden by default; run with `CatchTest "[blur_benchmark]"`.
+TEST_CASE("Lv2cBlur benchmark", "[.][blur_benchmark]")
+{
+    using clock = std::chrono::steady_clock;
+
+    // shadow buffer for a 200x100 dp element, at 1x and 2x window scales.
+    for (double windowScale : {1.0, 2.0})
+    {
+        for (double radius : {2.0, 4.0, 8.0, 16.0})
+        {
+            double deviceRadius = radius * windowScale;
+            int64_t width = (int64_t)((200 + 4 * radius) * windowScale);
+            int64_t height = (int64_t)((100 + 4 * radius) * windowScale);
+            TestImage source = MakeTestImage(width, height, (int64_t)(2 * deviceRadius), 4);
+
+            constexpr int ITERATIONS = 5;
+            TestImage image = source;
+            auto start = clock::now();
+            for (int i = 0; i < ITERATIONS; ++i)
+            {
+                image = source;
+                Lv2cBlur::DropShadowReference(image.data.data(), image.width, image.height, image.stride, deviceRadius, 0, 0);
+            }
+            auto referenceTime = std::chrono::duration<double, std::milli>(clock::now() - start).count() / ITERATIONS;
+
+            start = clock::now();
+            for (int i = 0; i < ITERATIONS; ++i)
+            {
+                image = source;
+                Lv2cBlur::DropShadow(image.data.data(), image.width, image.height, image.stride, deviceRadius, 0, 0);
+            }
+            auto fastTime = std::chrono::duration<double, std::milli>(clock::now() - start).count() / ITERATIONS;
+
+            cout << "scale: " << windowScale
+                 << " radius: " << radius
+                 << " size: " << width << "x" << height
+                 << " 2D: " << referenceTime << "ms"
+                 << " separable: " << fastTime << "ms"
+                 << " speedup: " << (referenceTime / fastTime) << "x" << endl;
+        }
+    }
+}
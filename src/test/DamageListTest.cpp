@@ -23,6 +23,7 @@
 #include <stdexcept>
 #include <iostream>
 #include <cstdlib>
+#include <chrono>
 using namespace std;
 using namespace lv2c;
 
@@ -218,6 +219,241 @@ TEST_CASE( "DamageList Test", "[damage_list]" ) {
      RowTests();
     ColumnTests();
 }
+
+static bool IsDamaged(const std::vector<Lv2cRectangle> &damage, double x, double y)
+{
+    for (auto &rect : damage)
+    {
+        if (rect.Contains(Lv2cPoint(x + 0.5, y + 0.5)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST_CASE("DamageList Scroll", "[damage_list]")
+{
+    Lv2cRectangle scrollRect{10, 10, 50, 100};
+    {
+        // scroll up: bottom strip is exposed.
+        Lv2cDamageList list;
+        list.SetSize(100, 200);
+        list.GetDamageList();
+
+        list.Scroll(scrollRect, 0, -20);
+        auto damage = list.GetDamageList();
+        double area = 0;
+        for (auto &rect : damage)
+        {
+            area += rect.Area();
+        }
+        REQUIRE(area == 50 * 20);
+        REQUIRE(IsDamaged(damage, 10, 90));
+        REQUIRE(IsDamaged(damage, 59, 109));
+        REQUIRE(!IsDamaged(damage, 10, 89));
+    }
+    {
+        // existing damage moves with the content, and stays where it was.
+        Lv2cDamageList list;
+        list.SetSize(100, 200);
+        list.GetDamageList();
+
+        list.Invalidate(Lv2cRectangle(20, 50, 10, 10));
+        list.Invalidate(Lv2cRectangle(80, 50, 10, 10)); // outside the scroll rect.
+        list.Scroll(scrollRect, 0, 30);
+        auto damage = list.GetDamageList();
+
+        REQUIRE(IsDamaged(damage, 20, 50));
+        REQUIRE(IsDamaged(damage, 20, 80));
+        REQUIRE(IsDamaged(damage, 29, 89));
+        REQUIRE(!IsDamaged(damage, 20, 90));
+        REQUIRE(IsDamaged(damage, 80, 50));
+        REQUIRE(!IsDamaged(damage, 80, 80));
+        // exposed strip at the top.
+        REQUIRE(IsDamaged(damage, 10, 10));
+        REQUIRE(IsDamaged(damage, 59, 39));
+        REQUIRE(!IsDamaged(damage, 10, 70));
+    }
+    {
+        // damage scrolled out of the rectangle is clipped.
+        Lv2cDamageList list;
+        list.SetSize(100, 200);
+        list.GetDamageList();
+
+        list.Invalidate(Lv2cRectangle(20, 100, 10, 10));
+        list.Scroll(scrollRect, -5, 5);
+        auto damage = list.GetDamageList();
+        for (auto &rect : damage)
+        {
+            REQUIRE(rect.Bottom() <= 110);
+        }
+        REQUIRE(IsDamaged(damage, 55, 50)); // exposed right-hand strip.
+    }
+}
+static double TotalArea(const std::vector<Lv2cRectangle> &rects)
+{
+    double area = 0;
+    for (auto &rect : rects)
+    {
+        area += rect.Area();
+    }
+    return area;
+}
+
+// 30 level meters, 8 pixels wide, spaced 20 pixels apart.
+static std::vector<Lv2cRectangle> MeterRects()
+{
+    std::vector<Lv2cRectangle> result;
+    for (size_t i = 0; i < 30; ++i)
+    {
+        result.push_back(Lv2cRectangle(10 + i * 20.0, 50, 8, 200));
+    }
+    return result;
+}
+
+TEST_CASE("DamageList merge policy", "[damage_list]")
+{
+    {
+        // no policy: exact damage.
+        Lv2cDamageList list;
+        list.SetSize(1000, 1000);
+        list.GetDamageList();
+        for (auto &rect : MeterRects())
+        {
+            list.Invalidate(rect);
+        }
+        auto damage = list.GetDamageList();
+        REQUIRE(damage.size() == 30);
+        REQUIRE(TotalArea(damage) == 30 * 8 * 200);
+    }
+    {
+        // gaps are cheaper than tree walks.
+        Lv2cDamageList list;
+        list.SetMergePolicy(12 * 200 + 1, 16);
+        list.SetSize(1000, 1000);
+        list.GetDamageList();
+        for (auto &rect : MeterRects())
+        {
+            list.Invalidate(rect);
+        }
+        auto damage = list.GetDamageList();
+        REQUIRE(damage.size() == 1);
+        REQUIRE(damage[0] == Lv2cRectangle(10, 50, 29 * 20 + 8, 200));
+    }
+    {
+        // gaps are more expensive than tree walks, but the rectangle count is capped.
+        Lv2cDamageList list;
+        list.SetMergePolicy(12 * 200, 8);
+        list.SetSize(1000, 1000);
+        list.GetDamageList();
+        for (auto &rect : MeterRects())
+        {
+            list.Invalidate(rect);
+        }
+        auto damage = list.GetDamageList();
+        REQUIRE(damage.size() == 8);
+        for (auto &rect : MeterRects())
+        {
+            REQUIRE(IsDamaged(damage, rect.Left(), rect.Top()));
+            REQUIRE(IsDamaged(damage, rect.Right() - 1, rect.Bottom() - 1));
+        }
+    }
+    {
+        // distant rectangles are not merged.
+        Lv2cDamageList list;
+        list.SetMergePolicy();
+        list.SetSize(1000, 1000);
+        list.GetDamageList();
+        list.Invalidate(Lv2cRectangle(0, 0, 10, 10));
+        list.Invalidate(Lv2cRectangle(500, 500, 10, 10));
+        list.Invalidate(Lv2cRectangle(12, 0, 10, 10)); // close to the first.
+        auto damage = list.GetDamageList();
+        REQUIRE(damage.size() == 2);
+        REQUIRE(TotalArea(damage) == 22 * 10 + 100);
+    }
+}
+
+TEST_CASE("DamageList merged damage covers exact damage", "[damage_list]")
+{
+    constexpr int SIZE = 64;
+    std::srand(7);
+    for (int iteration = 0; iteration < 200; ++iteration)
+    {
+        Lv2cDamageList exact;
+        exact.SetSize(SIZE, SIZE);
+        exact.GetDamageList();
+        Lv2cDamageList merged;
+        merged.SetMergePolicy(std::rand() % 200, std::rand() % 6);
+        merged.SetSize(SIZE, SIZE);
+        merged.GetDamageList();
+
+        int rectCount = 1 + std::rand() % 20;
+        for (int i = 0; i < rectCount; ++i)
+        {
+            Lv2cRectangle rect(std::rand() % SIZE, std::rand() % SIZE, 1 + std::rand() % 16, 1 + std::rand() % 16);
+            exact.Invalidate(rect);
+            merged.Invalidate(rect);
+        }
+        auto exactDamage = exact.GetDamageList();
+        auto mergedDamage = merged.GetDamageList();
+        REQUIRE(mergedDamage.size() <= exactDamage.size());
+        for (int y = 0; y < SIZE; ++y)
+        {
+            for (int x = 0; x < SIZE; ++x)
+            {
+                if (IsDamaged(exactDamage, x, y))
+                {
+                    REQUIRE(IsDamaged(mergedDamage, x, y));
+                }
+            }
+        }
+        // the list is reusable after GetDamageList().
+        REQUIRE(merged.IsEmpty());
+    }
+}
+
+// Benchmark. Hidden by default; run with `CatchTest "[damage_list_benchmark]"`.
+TEST_CASE("DamageList benchmark", "[.][damage_list_benchmark]")
+{
+    using clock = std::chrono::steady_clock;
+    constexpr size_t FRAMES = 100000;
+
+    auto meters = MeterRects();
+    for (bool merge : {false, true})
+    {
+        Lv2cDamageList list;
+        if (merge)
+        {
+            list.SetMergePolicy();
+        }
+        list.SetSize(1000, 1000);
+        list.GetDamageList();
+
+        size_t rectangles = 0;
+        double area = 0;
+        auto start = clock::now();
+        for (size_t frame = 0; frame < FRAMES; ++frame)
+        {
+            for (size_t i = 0; i < meters.size(); ++i)
+            {
+                // meters change height from frame to frame.
+                Lv2cRectangle rect = meters[i];
+                double height = (double)((frame * 7 + i * 13) % 200);
+                list.Invalidate(Lv2cRectangle(rect.Left(), rect.Bottom() - height, rect.Width(), height));
+            }
+            auto damage = list.GetDamageList();
+            rectangles += damage.size();
+            area += TotalArea(damage);
+        }
+        auto ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        cout << (merge ? "merged" : "exact ")
+             << " frames: " << FRAMES
+             << " time: " << ms << "ms"
+             << " rects/frame: " << (double)rectangles / FRAMES
+             << " area/frame: " << area / FRAMES << endl;
+    }
+}
 // int main(int argc, char **argv)
 // {
 //     std::srand(1);
@@ -0,0 +1,112 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "CatchTest.hpp"
+#include "lv2c_ui/Lv2FileIndex.hpp"
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace lv2c::ui;
+namespace fs = std::filesystem;
+
+static void Touch(const fs::path &path)
+{
+    std::ofstream f(path);
+    f << "x";
+}
+
+static std::vector<std::string> IndexedFiles(const Lv2FileIndex &index, const fs::path &directory)
+{
+    std::vector<std::string> result;
+    index.ForEachFile(
+        directory,
+        [&result](const std::string &path)
+        {
+            result.push_back(path);
+            return true;
+        });
+    return result;
+}
+
+static bool WaitFor(const std::function<bool()> &condition)
+{
+    for (int i = 0; i < 200; ++i)
+    {
+        if (condition())
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+TEST_CASE("FileIndex", "[file_index]")
+{
+    fs::path testDirectory = fs::temp_directory_path() / ("lv2c_file_index_test_" + std::to_string(getpid()));
+    fs::remove_all(testDirectory);
+    fs::path root = testDirectory / "root";
+    fs::create_directories(root / "a" / "b");
+    fs::create_directories(root / ".hidden");
+    Touch(root / "one.wav");
+    Touch(root / "a" / "two.wav");
+    Touch(root / "a" / "b" / "three.wav");
+    Touch(root / ".hidden" / "four.wav");
+    Touch(root / ".five.wav");
+    fs::path cacheFile = testDirectory / "cache.index";
+
+    {
+        Lv2FileIndex index{root, cacheFile};
+        REQUIRE(index.WaitUntilReady(std::chrono::milliseconds(5000)));
+        REQUIRE(index.Current());
+
+        auto files = IndexedFiles(index, root);
+        REQUIRE(files.size() == 3);
+        REQUIRE(IndexedFiles(index, root / "a").size() == 2);
+        REQUIRE(IndexedFiles(index, root / "a" / "b").size() == 1);
+
+#ifdef __linux__
+        // changes are tracked with inotify.
+        Touch(root / "a" / "new.wav");
+        REQUIRE(WaitFor([&]() { return IndexedFiles(index, root / "a").size() == 3; }));
+
+        fs::create_directories(root / "c");
+        Touch(root / "c" / "six.wav");
+        REQUIRE(WaitFor([&]() { return IndexedFiles(index, root / "c").size() == 1; }));
+
+        fs::remove_all(root / "a");
+        REQUIRE(WaitFor([&]() { return IndexedFiles(index, root).size() == 2; }));
+#endif
+    }
+    // the index is persisted.
+    REQUIRE(fs::exists(cacheFile));
+    {
+        fs::remove_all(root);
+        fs::create_directories(root);
+
+        Lv2FileIndex index{root, cacheFile};
+        REQUIRE(index.WaitUntilReady(std::chrono::milliseconds(5000)));
+        // wait for the crawl to correct the cached contents.
+        REQUIRE(WaitFor([&]() { return index.Current(); }));
+        REQUIRE(IndexedFiles(index, root).size() == 0);
+    }
+    fs::remove_all(testDirectory);
+}
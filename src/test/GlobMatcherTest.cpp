@@ -0,0 +1,149 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "CatchTest.hpp"
+
+#include "lv2c_ui/GlobMatcher.hpp"
+#include "ss.hpp"
+#include <chrono>
+#include <iostream>
+
+using namespace lv2c::ui;
+using namespace std;
+
+static bool GlobMatch(const std::string &pattern, const std::string &text)
+{
+    GlobMatcher matcher(pattern);
+    return matcher.Matches(text);
+}
+
+TEST_CASE("GlobMatcher patterns", "[glob]")
+{
+    REQUIRE(GlobMatch("a", "a"));
+    REQUIRE(GlobMatch("a", "a/b"));
+    REQUIRE(GlobMatch("a", "b/a"));
+    REQUIRE(!GlobMatch("a", "b/c"));
+
+    REQUIRE(GlobMatch("", "abc"));
+    REQUIRE(GlobMatch("*", "abc"));
+    REQUIRE(GlobMatch("**", ""));
+    REQUIRE(GlobMatch("*c", "abc"));
+    REQUIRE(!GlobMatch("a*c", "a/c"));
+    REQUIRE(GlobMatch("a*c", "axb/axc"));
+    REQUIRE(GlobMatch("sub/*.txt", "sub/file.txt"));
+    REQUIRE(!GlobMatch("sub*.txt", "sub/file.txt"));
+
+    REQUIRE(!GlobMatch("?", ""));
+    REQUIRE(GlobMatch("?", "b"));
+    REQUIRE(!GlobMatch("?", "bb"));
+    REQUIRE(!GlobMatch("*?", ""));
+    REQUIRE(GlobMatch("*?", "b"));
+    REQUIRE(GlobMatch("*?", "bb"));
+    REQUIRE(GlobMatch("?b", "bb"));
+    REQUIRE(GlobMatch("b?", "bb"));
+    REQUIRE(GlobMatch("*b?b*", "aaaababaaaa"));
+    REQUIRE(!GlobMatch("*b??b*", "aaaababaaaa"));
+
+    REQUIRE(GlobMatch("[a]", "a"));
+    REQUIRE(!GlobMatch("[!a]", "a"));
+    REQUIRE(GlobMatch("[a][!a]", "ab"));
+    REQUIRE(!GlobMatch("[a][!a]", "aa"));
+    REQUIRE(GlobMatch("[abc][!a]", "cb"));
+    REQUIRE(!GlobMatch("[abc][!a]", "db"));
+    REQUIRE(!GlobMatch("[abc][!a]", "ba"));
+    REQUIRE(GlobMatch("[abc]*[!a]", "bcccccc"));
+    REQUIRE(!GlobMatch("[]", "a"));
+    REQUIRE(GlobMatch("[!]", "a"));
+    REQUIRE(!GlobMatch("a[!]b", "a/b"));
+
+    REQUIRE(GlobMatch("\\*", "*"));
+    REQUIRE(!GlobMatch("\\*", "a"));
+}
+
+TEST_CASE("GlobMatcher malformed patterns", "[glob]")
+{
+    REQUIRE_NOTHROW(GlobMatcher("abc["));
+    REQUIRE(GlobMatch("abc[", "abc["));
+    REQUIRE(GlobMatch("a\\", "a\\"));
+}
+
+TEST_CASE("GlobMatcher pathological patterns", "[glob]")
+{
+    using clock_t = std::chrono::steady_clock;
+
+    std::string text(10000, 'a');
+    std::string pattern;
+    for (int i = 0; i < 100; ++i)
+    {
+        pattern += "*[!]*?";
+    }
+
+    auto start = clock_t::now();
+    GlobMatcher matcher(pattern + "x");
+    REQUIRE(!matcher.Matches(text));
+    matcher.SetPattern(pattern);
+    REQUIRE(matcher.Matches(text));
+    REQUIRE(matcher.DfaStateCount() <= GlobMatcher::MAX_DFA_STATES);
+
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(clock_t::now() - start).count();
+    REQUIRE(ms < 1000);
+}
+
+TEST_CASE("GlobMatcher batch", "[glob]")
+{
+    GlobMatcher matcher("*.wav");
+    std::vector<std::string> names{"a.wav", "b.flac", "dir/c.wav", "d.wav/e"};
+    std::vector<bool> expected{true, false, true, true};
+    REQUIRE(matcher.Matches(names) == expected);
+}
+
+// Benchmark. Hidden by default; run with `CatchTest "[glob_benchmark]"`.
+TEST_CASE("GlobMatcher benchmark", "[.][glob_benchmark]")
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr size_t FILE_COUNT = 100000;
+    std::vector<std::string> names;
+    names.reserve(FILE_COUNT);
+    const char *extensions[] = {".wav", ".flac", ".mp3", ".json", ".nam", ".txt"};
+    for (size_t i = 0; i < FILE_COUNT; ++i)
+    {
+        names.push_back(SS("samples/bank" << (i % 97) << "/Guitar Amp Model " << i << extensions[i % 6]));
+    }
+
+    for (const char *pattern : {"*.wav", "*Amp*Model*1?3*", "*[!x]*[!x]*[!x]*[!x]y"})
+    {
+        GlobMatcher matcher(pattern);
+        auto start = clock::now();
+        std::vector<bool> matches = matcher.Matches(names);
+        auto ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        size_t count = 0;
+        for (bool match : matches)
+        {
+            if (match)
+                ++count;
+        }
+        cout << "pattern: " << pattern
+             << " files: " << FILE_COUNT
+             << " matches: " << count
+             << " time: " << ms << "ms"
+             << " dfa states: " << matcher.DfaStateCount() << endl;
+    }
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cHeadlessWindow.hpp"
+#include "lv2c/Lv2cRootElement.hpp"
+#include "lv2c/Lv2cAnimationClock.hpp"
+
+using namespace lv2c;
+using namespace std::chrono_literals;
+
+namespace
+{
+    class MouseTestElement : public Lv2cElement
+    {
+    public:
+        using ptr = std::shared_ptr<MouseTestElement>;
+        static ptr Create() { return std::make_shared<MouseTestElement>(); }
+
+        int mouseDownCount = 0;
+        int mouseUpCount = 0;
+        Lv2cPoint lastPoint;
+
+    protected:
+        virtual bool OnMouseDown(Lv2cMouseEventArgs &event) override
+        {
+            ++mouseDownCount;
+            lastPoint = event.point;
+            CaptureMouse();
+            return true;
+        }
+        virtual bool OnMouseUp(Lv2cMouseEventArgs &event) override
+        {
+            ++mouseUpCount;
+            ReleaseCapture();
+            return true;
+        }
+    };
+
+    Lv2cCreateWindowParameters TestWindowParameters()
+    {
+        Lv2cCreateWindowParameters parameters;
+        parameters.size = Lv2cSize(200, 100);
+        parameters.title = "HeadlessWindowTest";
+        return parameters;
+    }
+}
+
+TEST_CASE("Lv2cAnimationClock manual mode", "[headless]")
+{
+    Lv2cAnimationClock::Manual(true);
+    auto t0 = Lv2cAnimationClock::now();
+    REQUIRE(Lv2cAnimationClock::now() == t0);
+    Lv2cAnimationClock::Advance(250ms);
+    REQUIRE(Lv2cAnimationClock::now() - t0 == std::chrono::duration_cast<Lv2cAnimationClock::duration>(250ms));
+    Lv2cAnimationClock::Manual(false);
+    REQUIRE(!Lv2cAnimationClock::Manual());
+    REQUIRE_THROWS(Lv2cAnimationClock::Advance(1ms));
+}
+
+TEST_CASE("Lv2cHeadlessWindow layout and resize", "[headless]")
+{
+    auto window = Lv2cWindow::Create();
+    auto element = Lv2cElement::Create();
+    element->Style().HorizontalAlignment(Lv2cAlignment::Stretch).VerticalAlignment(Lv2cAlignment::Stretch);
+    window->GetRootElement()->AddChild(element);
+
+    Lv2cHeadlessWindow::ptr headless = Lv2cHeadlessWindow::Create(window, TestWindowParameters());
+    REQUIRE(Lv2cAnimationClock::Manual());
+    headless->Frame();
+    REQUIRE(headless->FrameCount() == 1);
+    REQUIRE(window->Size() == Lv2cSize(200, 100));
+    REQUIRE(element->ClientSize() == Lv2cSize(200, 100));
+    REQUIRE(!headless->HasPendingWork());
+
+    headless->Resize(Lv2cSize(300, 150));
+    headless->Frame();
+    REQUIRE(window->Size() == Lv2cSize(300, 150));
+    REQUIRE(element->ClientSize() == Lv2cSize(300, 150));
+
+    headless = nullptr;
+    REQUIRE(!Lv2cAnimationClock::Manual());
+}
+
+TEST_CASE("Lv2cHeadlessWindow mouse input", "[headless]")
+{
+    auto window = Lv2cWindow::Create();
+    auto element = MouseTestElement::Create();
+    element->Style().Width(50).Height(40).Margin({10, 20, 0, 0});
+    window->GetRootElement()->AddChild(element);
+
+    Lv2cHeadlessWindow headless{window, TestWindowParameters()};
+    headless.Frame();
+
+    headless.Click(Lv2cPoint(15, 25));
+    REQUIRE(element->mouseDownCount == 1);
+    REQUIRE(element->mouseUpCount == 1);
+    REQUIRE(element->lastPoint == Lv2cPoint(5, 5));
+
+    // outside the element.
+    headless.Click(Lv2cPoint(150, 80));
+    REQUIRE(element->mouseDownCount == 1);
+}
+
+TEST_CASE("Lv2cHeadlessWindow deterministic timers", "[headless]")
+{
+    auto window = Lv2cWindow::Create();
+    Lv2cHeadlessWindow headless{window, TestWindowParameters()};
+    headless.Frame();
+
+    int fired = 0;
+    window->PostDelayed(100ms, [&fired]() { ++fired; });
+    headless.RunFor(99ms, 33ms);
+    REQUIRE(fired == 0);
+    REQUIRE(headless.HasPendingWork());
+    headless.RunFor(1ms);
+    REQUIRE(fired == 1);
+    REQUIRE(headless.FrameCount() == 1 + 3 + 1);
+}
@@ -0,0 +1,195 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "CatchTest.hpp"
+#include "lv2c/JsonBufferReader.hpp"
+#include "lv2c/JsonIo.hpp"
+#include "ss.hpp"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+using namespace lv2c;
+using namespace std;
+
+static json_variant StreamRead(const std::string &text)
+{
+    std::stringstream s(text);
+    json_variant result;
+    s >> result;
+    return result;
+}
+
+static json_variant BufferRead(const std::string &text)
+{
+    json_variant result;
+    json_buffer_reader reader(text);
+    reader.read(&result);
+    return result;
+}
+
+// Similar in shape to the values in JsonTest.cpp.
+static json_variant MakeTestVariant()
+{
+    json_variant v = json_variant::object();
+    v["a"] = 1;
+    v["b"] = "abc";
+    v["c"] = true;
+    v["d"] = json_variant();
+    v["e"] = -1.25e-3;
+    v["f"] = "quote \" backslash \\ tab \t newline \n unicode \xC3\xA9 \xF0\x9F\x8E\xB8";
+
+    auto t = json_variant::array();
+    t.resize(2);
+    t[0] = std::vector<int>{1, 2, 3};
+    t[1] = json_variant::object();
+    t[1]["a"] = json_variant::array();
+    t[1]["b"] = 99;
+    t[1]["c"] = json_variant::object();
+    t[1]["d"] = false;
+    v["g"] = t;
+    return v;
+}
+
+TEST_CASE("json_buffer_reader matches json_reader", "[json]")
+{
+    json_variant v = MakeTestVariant();
+    std::string text = SS(v);
+    REQUIRE(BufferRead(text) == v);
+    REQUIRE(BufferRead(text) == StreamRead(text));
+
+    std::string extended =
+        "// comment\n"
+        "{ 'single': 'it''s', /* nested /* block */ comment */ \"n\": +3, \"nan\": NaN, \"dup\": 1, \"dup\": 2 }";
+    json_variant result = BufferRead(extended);
+    REQUIRE(result["single"].as_string() == "it's");
+    REQUIRE(result["n"].as_number() == 3);
+    REQUIRE(std::isnan(result["nan"].as_number()));
+    REQUIRE(result["dup"].as_number() == 2);
+    REQUIRE(result.as_object()->size() == 4);
+
+    REQUIRE(BufferRead("\"\\ud83c\\udfb8\"").as_string() == "\xF0\x9F\x8E\xB8");
+}
+
+TEST_CASE("json_buffer_reader errors", "[json]")
+{
+    REQUIRE_THROWS_AS(BufferRead(""), json_exception);
+    REQUIRE_THROWS_AS(BufferRead("[1,2"), json_exception);
+    REQUIRE_THROWS_AS(BufferRead("{\"a\" 1}"), json_exception);
+    REQUIRE_THROWS_AS(BufferRead("\"abc"), json_exception);
+    REQUIRE_THROWS_AS(BufferRead("\"\\ud83c\""), json_exception);
+    REQUIRE_THROWS_AS(BufferRead("tru"), json_exception);
+    REQUIRE_THROWS_AS(BufferRead("1 2"), json_exception);
+    REQUIRE_THROWS_AS(BufferRead("/* unterminated"), json_exception);
+    REQUIRE_THROWS_AS(BufferRead(std::string(json_buffer_reader::MAX_DEPTH + 2, '[')), json_exception);
+
+    json_buffer_reader reader("NaN");
+    reader.allowNaN(false);
+    json_variant result;
+    REQUIRE_THROWS_AS(reader.read(&result), json_exception);
+}
+
+TEST_CASE("json_document", "[json]")
+{
+    json_variant v = MakeTestVariant();
+    json_document::ptr document = json_document::parse(SS(v));
+    const json_value &root = document->root();
+
+    REQUIRE(root.is_object());
+    REQUIRE(root.size() == 7);
+    REQUIRE(root.find("a")->as_number() == 1);
+    REQUIRE(root.find("missing") == nullptr);
+    REQUIRE(root.find("d")->is_null());
+    REQUIRE(root.find("f")->as_string() == v["f"].as_string());
+    REQUIRE((*root.find("g"))[0][2].as_number() == 3);
+    REQUIRE((*root.find("g"))[1].find("a")->size() == 0);
+    REQUIRE_THROWS(root.find("b")->as_number());
+
+    // unescaped strings are views into the source text, so only containers and
+    // the one escaped string live in the arena.
+    REQUIRE(document->arena_bytes() > 0);
+    REQUIRE(document->arena_bytes() < 100000);
+
+    REQUIRE(root.to_variant() == v);
+}
+
+namespace
+{
+    class CountingHandler : public json_sax_handler
+    {
+    public:
+        size_t values = 0;
+        size_t keys = 0;
+        size_t containers = 0;
+        void null_value() override { ++values; }
+        void bool_value(bool) override { ++values; }
+        void number_value(double) override { ++values; }
+        void string_value(std::string_view) override { ++values; }
+        void start_array() override { ++containers; }
+        void end_array() override {}
+        void start_object() override { ++containers; }
+        void key(std::string_view) override { ++keys; }
+        void end_object() override {}
+    };
+}
+
+// Benchmark. Hidden by default; run with `CatchTest "[json_benchmark]"`.
+TEST_CASE("json_buffer_reader benchmark", "[.][json_benchmark]")
+{
+    using clock = std::chrono::steady_clock;
+
+    json_variant element = MakeTestVariant();
+    json_variant document = json_variant::array();
+    constexpr size_t ELEMENTS = 20000;
+    document.resize(ELEMENTS);
+    for (size_t i = 0; i < ELEMENTS; ++i)
+    {
+        document[i] = element;
+    }
+    std::string text = SS(document);
+
+    constexpr int ITERATIONS = 5;
+    auto time = [&](auto fn)
+    {
+        auto start = clock::now();
+        for (int i = 0; i < ITERATIONS; ++i)
+        {
+            fn();
+        }
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count() / ITERATIONS;
+    };
+
+    double streamTime = time([&]() { REQUIRE(StreamRead(text).size() == ELEMENTS); });
+    double bufferTime = time([&]() { REQUIRE(BufferRead(text).size() == ELEMENTS); });
+    double documentTime = time([&]() { REQUIRE(json_document::parse(text)->root().size() == ELEMENTS); });
+    double saxTime = time([&]()
+                          {
+        CountingHandler handler;
+        json_buffer_reader reader(text);
+        reader.parse(handler);
+        REQUIRE(handler.containers > ELEMENTS); });
+
+    cout << "size: " << text.length() / 1024 << "KiB"
+         << " json_reader: " << streamTime << "ms"
+         << " json_buffer_reader: " << bufferTime << "ms"
+         << " json_document: " << documentTime << "ms"
+         << " sax: " << saxTime << "ms" << endl;
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cHeadlessWindow.hpp"
+#include "lv2c/Lv2cRootElement.hpp"
+#include "lv2c/Lv2cContainerElement.hpp"
+#include "lv2c/Lv2cScrollContainerElement.hpp"
+
+using namespace lv2c;
+
+namespace
+{
+    Lv2cCreateWindowParameters TestWindowParameters()
+    {
+        Lv2cCreateWindowParameters parameters;
+        parameters.size = Lv2cSize(200, 100);
+        parameters.title = "LayerTest";
+        return parameters;
+    }
+}
+
+TEST_CASE("Lv2cElement layer redraws", "[headless][layers]")
+{
+    auto window = Lv2cWindow::Create();
+
+    auto layered = Lv2cContainerElement::Create();
+    layered->Style().Width(100).Height(50).Background(Lv2cColor(0.2, 0.2, 0.2));
+    layered->Layer(true);
+    auto child = Lv2cElement::Create();
+    child->Style().Width(20).Height(20).Margin({10}).Background(Lv2cColor(1, 0, 0));
+    layered->AddChild(child);
+
+    // drawn over the layered element, like a spinner or VU meter.
+    auto sibling = Lv2cElement::Create();
+    sibling->Style().Width(40).Height(40).Margin({50, 5, 0, 0}).Background(Lv2cColor(0, 1, 0));
+
+    window->GetRootElement()->AddChild(layered);
+    window->GetRootElement()->AddChild(sibling);
+
+    Lv2cHeadlessWindow headless{window, TestWindowParameters()};
+    headless.Frame();
+    REQUIRE(layered->LayerRedrawCount() == 1);
+    REQUIRE(layered->LayerSize() == Lv2cSize(100, 50));
+
+    // nothing invalidated.
+    headless.Frame();
+    REQUIRE(layered->LayerRedrawCount() == 1);
+
+    // damage from a sibling is repaired from the cached layer.
+    for (int i = 0; i < 5; ++i)
+    {
+        sibling->Invalidate();
+        headless.Frame();
+    }
+    REQUIRE(layered->LayerRedrawCount() == 1);
+
+    // invalidating the layered subtree redraws the layer.
+    child->Invalidate();
+    headless.Frame();
+    REQUIRE(layered->LayerRedrawCount() == 2);
+
+    layered->Invalidate();
+    headless.Frame();
+    REQUIRE(layered->LayerRedrawCount() == 3);
+
+    // so does a new layout.
+    layered->InvalidateLayout();
+    headless.Frame();
+    REQUIRE(layered->LayerRedrawCount() == 4);
+
+    // turning the layer off releases it.
+    layered->Layer(false);
+    headless.Frame();
+    REQUIRE(layered->LayerRedrawCount() == 4);
+    REQUIRE(layered->LayerSize() == Lv2cSize(0, 0));
+}
+
+TEST_CASE("Lv2cElement layer is clipped to the scroll viewport", "[headless][layers]")
+{
+    auto window = Lv2cWindow::Create();
+
+    auto scrollContainer = Lv2cScrollContainerElement::Create();
+    scrollContainer->Style()
+        .HorizontalAlignment(Lv2cAlignment::Stretch)
+        .VerticalAlignment(Lv2cAlignment::Stretch);
+    scrollContainer->VerticalScrollEnabled(true);
+
+    auto layered = Lv2cElement::Create();
+    layered->Style().Width(150).Height(10000).Background(Lv2cColor(0.2, 0.2, 0.2));
+    layered->Layer(true);
+    scrollContainer->Child(layered);
+
+    window->GetRootElement()->AddChild(scrollContainer);
+
+    Lv2cHeadlessWindow headless{window, TestWindowParameters()};
+    headless.Frame();
+    REQUIRE(layered->LayerRedrawCount() == 1);
+    REQUIRE(layered->LayerSize().Width() == 150);
+    REQUIRE(layered->LayerSize().Height() <= 100);
+
+    // newly visible content is drawn into the layer.
+    scrollContainer->VerticalScrollOffset(5000);
+    headless.Frame();
+    REQUIRE(layered->LayerRedrawCount() == 2);
+    REQUIRE(layered->LayerSize().Height() <= 100);
+}
@@ -0,0 +1,161 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cContainerElement.hpp"
+#include "lv2c/Lv2cDrawingContext.hpp"
+#include "lv2c/Lv2cStyle.hpp"
+
+using namespace lv2c;
+
+namespace
+{
+    struct LayoutCacheFixture
+    {
+        LayoutCacheFixture()
+            : surface(CAIRO_FORMAT_ARGB32, 16, 16),
+              context(surface)
+        {
+            Lv2cElement::EnableIncrementalLayout(true);
+
+            root = Lv2cContainerElement::Create();
+            for (size_t i = 0; i < 3; ++i)
+            {
+                auto group = Lv2cContainerElement::Create();
+                group->Style().Padding({4});
+                for (size_t j = 0; j < 3; ++j)
+                {
+                    auto leaf = Lv2cElement::Create();
+                    leaf->Style().Width(20).Height(10);
+                    group->AddChild(leaf);
+                }
+                root->AddChild(group);
+                groups.push_back(group);
+            }
+        }
+        void Measure()
+        {
+            root->Measure(Lv2cSize(0, 0), Lv2cSize(400, 300), context);
+        }
+        Lv2cImageSurface surface;
+        Lv2cDrawingContext context;
+        Lv2cContainerElement::ptr root;
+        std::vector<Lv2cContainerElement::ptr> groups;
+    };
+}
+
+TEST_CASE("Lv2cElement measure cache", "[layout_cache]")
+{
+    LayoutCacheFixture fixture;
+    constexpr uint64_t ELEMENT_COUNT = 1 + 3 + 9;
+
+    Lv2cElement::ResetLayoutStatistics();
+    fixture.Measure();
+    auto stats = Lv2cElement::GetLayoutStatistics();
+    REQUIRE(stats.measureRequests == ELEMENT_COUNT);
+    REQUIRE(stats.measureCacheHits == 0);
+    Lv2cSize measure = fixture.root->MeasuredSize();
+
+    // nothing changed.
+    Lv2cElement::ResetLayoutStatistics();
+    fixture.Measure();
+    stats = Lv2cElement::GetLayoutStatistics();
+    REQUIRE(stats.measureRequests == 1);
+    REQUIRE(stats.measureCacheHits == 1);
+    REQUIRE(fixture.root->MeasuredSize() == measure);
+
+    // different constraints.
+    Lv2cElement::ResetLayoutStatistics();
+    fixture.root->Measure(Lv2cSize(0, 0), Lv2cSize(500, 300), fixture.context);
+    stats = Lv2cElement::GetLayoutStatistics();
+    REQUIRE(stats.measureRequests == ELEMENT_COUNT);
+    REQUIRE(stats.measureCacheHits == 0);
+
+    SECTION("InvalidateLayout re-measures the element and its ancestors only")
+    {
+        fixture.Measure();
+        auto leaf = fixture.groups[1]->Child(2);
+        leaf->InvalidateLayout();
+
+        Lv2cElement::ResetLayoutStatistics();
+        fixture.Measure();
+        stats = Lv2cElement::GetLayoutStatistics();
+        // root, three groups (one of them re-measured), three leaves in the dirty group.
+        REQUIRE(stats.measureRequests == 1 + 3 + 3);
+        REQUIRE(stats.measureCacheHits == 2 + 2);
+    }
+    SECTION("Style changes invalidate measurements")
+    {
+        fixture.Measure();
+        auto leaf = fixture.groups[0]->Child(0);
+        leaf->Style().Width(30);
+
+        Lv2cElement::ResetLayoutStatistics();
+        fixture.Measure();
+        stats = Lv2cElement::GetLayoutStatistics();
+        REQUIRE(stats.measureRequests == 1 + 3 + 3);
+        REQUIRE(stats.measureCacheHits == 2 + 2);
+        REQUIRE(fixture.root->MeasuredSize().Width() == 30 + 8);
+    }
+    SECTION("Class changes invalidate all measurements")
+    {
+        fixture.Measure();
+        auto cls = Lv2cStyle::Create();
+        cls->Padding({2});
+
+        Lv2cElement::ResetLayoutStatistics();
+        fixture.Measure();
+        stats = Lv2cElement::GetLayoutStatistics();
+        REQUIRE(stats.measureRequests == ELEMENT_COUNT);
+        REQUIRE(stats.measureCacheHits == 0);
+    }
+    SECTION("Measure cache can be disabled")
+    {
+        Lv2cElement::EnableIncrementalLayout(false);
+        Lv2cElement::ResetLayoutStatistics();
+        fixture.Measure();
+        stats = Lv2cElement::GetLayoutStatistics();
+        Lv2cElement::EnableIncrementalLayout(true);
+        REQUIRE(stats.measureRequests == ELEMENT_COUNT);
+        REQUIRE(stats.measureCacheHits == 0);
+    }
+}
+
+TEST_CASE("Lv2cElement layout boundaries", "[layout_cache]")
+{
+    LayoutCacheFixture fixture;
+    fixture.Measure();
+    auto leaf = fixture.groups[0]->Child(0);
+    Lv2cSize size = leaf->MeasuredSize();
+
+    REQUIRE(!leaf->IsLayoutBoundary()); // not laid out yet.
+    leaf->Layout(Lv2cRectangle(0, 0, size.Width(), size.Height()));
+    REQUIRE(leaf->IsLayoutBoundary());
+
+    leaf->Layout(Lv2cRectangle(0, 0, size.Width() + 10, size.Height()));
+    REQUIRE(!leaf->IsLayoutBoundary()); // arranged at a size other than its measure.
+
+    leaf->Layout(Lv2cRectangle(0, 0, size.Width(), size.Height()));
+    leaf->Style().HorizontalAlignment(Lv2cAlignment::Stretch);
+    REQUIRE(!leaf->IsLayoutBoundary());
+
+    REQUIRE(!fixture.groups[0]->IsLayoutBoundary()); // auto-sized.
+}
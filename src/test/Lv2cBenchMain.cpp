@@ -0,0 +1,384 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// lv2c_bench: renders each demo page offscreen, and reports timings as JSON.
+//
+// Usage: lv2c_bench [--iterations N] [--page <title substring>] [--output <file>]
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string.h>
+
+#include "lv2c/JsonIo.hpp"
+#include "lv2c/Lv2cHeadlessWindow.hpp"
+#include "lv2c/Lv2cLog.hpp"
+#include "lv2c/Lv2cRootElement.hpp"
+#include "lv2c/Lv2cScrollContainerElement.hpp"
+#include "lv2c/Lv2cWindow.hpp"
+
+#include "TunerTestPage.hpp"
+#include "TableTestPage.hpp"
+#include "PaletteTestPage.hpp"
+#include "StandardDialogTestPage.hpp"
+#include "DialTestPage.hpp"
+#include "VerticalStackTest.hpp"
+#include "Lv2ControlTestPage.hpp"
+#include "TypographyTestPage.hpp"
+#include "FlexGridTestPage.hpp"
+#include "EditBoxTestPage.hpp"
+#include "ButtonTestPage.hpp"
+#include "SvgTestPage.hpp"
+#include "PngTestPage.hpp"
+#include "DropdownTestPage.hpp"
+#include "DropShadowTestPage.hpp"
+#include "ScrollBarTestPage.hpp"
+#include "MotionBlurTestPage.hpp"
+#include "Lv2UiTestPage.hpp"
+
+using namespace std;
+using namespace lv2c;
+
+using bench_clock_t = std::chrono::steady_clock;
+
+static void SetResourceDirectories(const char *argv0)
+{
+    std::filesystem::path t = argv0;
+    std::filesystem::path executableDirectory = t.parent_path();
+    executableDirectory = std::filesystem::weakly_canonical(executableDirectory);
+
+    std::vector<filesystem::path> resourceDirectories;
+    resourceDirectories.push_back(executableDirectory / "resources");
+
+    resourceDirectories.push_back(executableDirectory);
+    char *env = getenv("RESOURCEDIR");
+    if (env)
+    {
+        resourceDirectories.push_back(env);
+    }
+    Lv2cWindow::SetResourceDirectories(resourceDirectories);
+}
+
+static std::vector<std::function<std::shared_ptr<TestPage>()>> PageFactories()
+{
+    return {
+        []() { return Lv2UiTestPage::Create(); },
+        []() { return Lv2ControlTestPage::Create(); },
+        []() { return StandardDialogTestPage::Create(); },
+        []() { return DialTestPage::Create(); },
+        []() { return PngTestPage::Create(); },
+        []() { return EditBoxTestPage::Create(); },
+        []() { return TypographyTestPage::Create(); },
+        []() { return FlexGridTestPage::Create(); },
+        []() { return TableTestPage::Create(); },
+        []() { return ButtonTestPage::Create(); },
+        []() { return SvgTestPage::Create(); },
+        []() { return ScrollBarTestPage::Create(); },
+        []() { return DropdownTestPage::Create(); },
+        []() { return DropShadowTestPage::Create(); },
+        []() { return MotionBlurTestPage::Create(); },
+        []() { return PaletteTestPage::Create(); },
+        []() { return VerticalStackTestPage::Create(); },
+        []() { return TunerTestPage::Create(); },
+    };
+}
+
+static double ElapsedMs(bench_clock_t::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(bench_clock_t::now() - start).count();
+}
+
+static double TimeMs(const std::function<void()> &fn)
+{
+    auto start = bench_clock_t::now();
+    fn();
+    return ElapsedMs(start);
+}
+
+// mean/median/min/max of a set of samples, in milliseconds.
+static json_variant Statistics(std::vector<double> samples)
+{
+    if (samples.empty())
+    {
+        return json_variant(); // null
+    }
+    std::sort(samples.begin(), samples.end());
+    double total = 0;
+    for (double sample : samples)
+    {
+        total += sample;
+    }
+    json_variant result = json_variant::object();
+    result["meanMs"] = total / samples.size();
+    result["medianMs"] = samples[samples.size() / 2];
+    result["minMs"] = samples.front();
+    result["maxMs"] = samples.back();
+    result["samples"] = samples.size();
+    return result;
+}
+
+template <typename T>
+static std::shared_ptr<T> FindElement(const Lv2cElement::ptr &element, const std::function<bool(T *)> &predicate)
+{
+    T *typed = dynamic_cast<T *>(element.get());
+    if (typed && predicate(typed))
+    {
+        return std::dynamic_pointer_cast<T>(element);
+    }
+    Lv2cContainerElement *container = dynamic_cast<Lv2cContainerElement *>(element.get());
+    if (container)
+    {
+        for (size_t i = 0; i < container->ChildCount(); ++i)
+        {
+            auto result = FindElement<T>(container->Child(i), predicate);
+            if (result)
+            {
+                return result;
+            }
+        }
+    }
+    return nullptr;
+}
+
+static json_variant BenchmarkPage(
+    const std::function<std::shared_ptr<TestPage>()> &factory,
+    double windowScale,
+    size_t iterations)
+{
+    const Lv2cSize WINDOW_SIZE{800, 600};
+    constexpr double SCROLL_STEP = 20;
+    constexpr auto FRAME_INTERVAL = std::chrono::duration_cast<Lv2cAnimationClock::duration>(std::chrono::microseconds(1000000 / 60));
+    constexpr size_t ANIMATION_FRAMES = 120;
+
+    json_variant result = json_variant::object();
+
+    // Cold start: create the page and the window, and mount the elements.
+    auto coldStartTime = bench_clock_t::now();
+    Lv2cTheme::ptr theme = Lv2cTheme::Create(true);
+    std::shared_ptr<TestPage> page = factory();
+    auto window = Lv2cWindow::Create();
+    window->Theme(theme);
+    window->WindowScale(windowScale);
+
+    auto pageView = page->CreatePageView(theme);
+    auto pageContainer = Lv2cContainerElement::Create();
+    pageContainer->Style()
+        .Theme(theme)
+        .Background(theme->paper)
+        .HorizontalAlignment(Lv2cAlignment::Stretch)
+        .VerticalAlignment(Lv2cAlignment::Stretch);
+    pageContainer->AddChild(pageView);
+    window->GetRootElement()->AddChild(pageContainer);
+
+    Lv2cCreateWindowParameters parameters;
+    parameters.size = WINDOW_SIZE;
+    parameters.title = page->Title();
+    parameters.backgroundColor = theme->paper;
+
+    Lv2cHeadlessWindow headless{window, parameters};
+    double coldStartMs = ElapsedMs(coldStartTime);
+
+    result["page"] = page->Title();
+    result["windowScale"] = windowScale;
+    result["coldStartMs"] = coldStartMs;
+    result["firstLayoutMs"] = TimeMs([&]() { headless.UpdateLayout(); });
+    result["firstPaintMs"] = TimeMs([&]() { headless.Frame(); });
+
+    // let startup animations and posted callbacks settle.
+    headless.RunFor(std::chrono::seconds(1));
+
+    std::vector<double> samples;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        window->Invalidate();
+        samples.push_back(TimeMs([&]() { headless.Frame(); }));
+    }
+    result["fullRepaint"] = Statistics(samples);
+
+    // A single control: the first focusable element, or failing that, the first element with no children.
+    Lv2cElement::ptr control = FindElement<Lv2cElement>(
+        pageView,
+        [](Lv2cElement *element)
+        {
+            return element->WantsFocus();
+        });
+    if (!control)
+    {
+        control = FindElement<Lv2cElement>(
+            pageView,
+            [](Lv2cElement *element)
+            {
+                return dynamic_cast<Lv2cContainerElement *>(element) == nullptr;
+            });
+    }
+    samples.resize(0);
+    if (control)
+    {
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            control->Invalidate();
+            samples.push_back(TimeMs([&]() { headless.Frame(); }));
+        }
+    }
+    result["controlRepaint"] = Statistics(samples);
+
+    auto scrollContainer = FindElement<Lv2cScrollContainerElement>(
+        pageView,
+        [](Lv2cScrollContainerElement *element)
+        {
+            return element->MaximumVerticalScrollOffset() > 0;
+        });
+    samples.resize(0);
+    if (scrollContainer)
+    {
+        double maximum = scrollContainer->MaximumVerticalScrollOffset();
+        double offset = 0;
+        double direction = 1;
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            offset += direction * SCROLL_STEP;
+            if (offset > maximum || offset < 0)
+            {
+                direction = -direction;
+                offset = std::clamp(offset, 0.0, maximum);
+            }
+            scrollContainer->VerticalScrollOffset(offset);
+            samples.push_back(TimeMs([&]() { headless.Frame(); }));
+        }
+    }
+    result["scrollStep"] = Statistics(samples);
+
+    // Animation frames: only frames that had work to do are counted.
+    samples.resize(0);
+    for (size_t i = 0; i < ANIMATION_FRAMES; ++i)
+    {
+        headless.AdvanceClock(FRAME_INTERVAL);
+        bool busy = headless.HasPendingWork();
+        double ms = TimeMs([&]() { headless.Frame(); });
+        if (busy)
+        {
+            samples.push_back(ms);
+        }
+    }
+    result["animationFrame"] = Statistics(samples);
+    return result;
+}
+
+static void PrintHelp()
+{
+    cout << "lv2c_bench - Benchmark lv2c demo pages offscreen." << endl
+         << "Usage: lv2c_bench [options]" << endl
+         << "Options:" << endl
+         << "   --iterations N     Number of samples per measurement (default 20)." << endl
+         << "   --page TEXT        Only run pages whose title contains TEXT." << endl
+         << "   --output FILE      Write JSON results to FILE instead of stdout." << endl
+         << "   --help             Display this message." << endl;
+}
+
+int main(int argc, char **argv)
+{
+    size_t iterations = 20;
+    std::string pageFilter;
+    std::string outputFile;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--help")
+        {
+            PrintHelp();
+            return EXIT_SUCCESS;
+        }
+        if (i + 1 >= argc)
+        {
+            cerr << "Error: Invalid arguments." << endl;
+            PrintHelp();
+            return EXIT_FAILURE;
+        }
+        if (arg == "--iterations")
+        {
+            iterations = std::max(1, atoi(argv[++i]));
+        }
+        else if (arg == "--page")
+        {
+            pageFilter = argv[++i];
+        }
+        else if (arg == "--output")
+        {
+            outputFile = argv[++i];
+        }
+        else
+        {
+            cerr << "Error: Unknown option " << arg << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    SetResourceDirectories(argv[0]);
+    lv2c::SetLogLevel(Lv2cLogLevel::Error);
+
+    try
+    {
+        json_variant results = json_variant::array();
+        for (auto &factory : PageFactories())
+        {
+            if (!pageFilter.empty() && factory()->Title().find(pageFilter) == std::string::npos)
+            {
+                continue;
+            }
+            for (double windowScale : {1.0, 2.0})
+            {
+                results.as_array()->push_back(BenchmarkPage(factory, windowScale, iterations));
+            }
+        }
+
+        json_variant report = json_variant::object();
+        report["benchmark"] = "lv2c_bench";
+        report["iterations"] = iterations;
+        report["results"] = std::move(results);
+
+        if (outputFile.empty())
+        {
+            json_writer writer(cout);
+            report.write(writer);
+            cout << endl;
+        }
+        else
+        {
+            std::ofstream f(outputFile);
+            if (!f)
+            {
+                throw std::runtime_error("Can't open " + outputFile);
+            }
+            json_writer writer(f);
+            report.write(writer);
+            f << endl;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "lv2c/Lv2cSettingsFile.hpp"
 
 
@@ -156,6 +157,7 @@ void TestWindow::CreateWindow()
     parameters.positioning = Lv2cWindowPositioning::CenterOnDesktop;
     parameters.settingsObject = settings.Root();
     parameters.backgroundColor = theme->paper;
+    parameters.schedulerMode = Lv2cSchedulerMode::EventDriven;
 
     super::CreateWindow(parameters);
 
@@ -361,6 +363,22 @@ int main(int argc, char **argv)
 
     SetResourceDirectories(argv[0]);
 
+    // LV2C_STYLE_CACHE=0 disables the computed style cache; LV2C_STYLE_STATS=1 reports style lookup counts on exit.
+    const char *styleCacheEnv = getenv("LV2C_STYLE_CACHE");
+    if (styleCacheEnv && strcmp(styleCacheEnv, "0") == 0)
+    {
+        Lv2cStyle::EnableComputedStyleCache(false);
+    }
+    bool reportStyleStats = getenv("LV2C_STYLE_STATS") != nullptr;
+
+    // LV2C_INCREMENTAL_LAYOUT=0 disables measure caching and partial layout; LV2C_LAYOUT_STATS=1 reports layout counts on exit.
+    const char *incrementalLayoutEnv = getenv("LV2C_INCREMENTAL_LAYOUT");
+    if (incrementalLayoutEnv && strcmp(incrementalLayoutEnv, "0") == 0)
+    {
+        Lv2cElement::EnableIncrementalLayout(false);
+    }
+    bool reportLayoutStats = getenv("LV2C_LAYOUT_STATS") != nullptr;
+
     while (true)
     {       
         rerenderRequested = false;
@@ -376,5 +394,22 @@ int main(int argc, char **argv)
             break;
         }
     }
+    if (reportStyleStats)
+    {
+        auto stats = Lv2cStyle::GetLookupStatistics();
+        cout << "Style lookups: " << stats.requests << " requests, "
+             << stats.lookups << " searches, "
+             << stats.cacheHits << " cache hits"
+             << (Lv2cStyle::ComputedStyleCacheEnabled() ? "" : " (cache disabled)") << endl;
+    }
+    if (reportLayoutStats)
+    {
+        auto stats = Lv2cElement::GetLayoutStatistics();
+        cout << "Layout: " << stats.layouts << " full layouts, "
+             << stats.partialLayouts << " partial layouts, "
+             << stats.measureRequests << " measures, "
+             << stats.measureCacheHits << " measure cache hits"
+             << (Lv2cElement::IncrementalLayoutEnabled() ? "" : " (incremental layout disabled)") << endl;
+    }
 
 }
@@ -0,0 +1,137 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cPngStripFrames.hpp"
+#include "lv2c/Lv2cWindow.hpp"
+#include <filesystem>
+#include <unistd.h>
+
+using namespace std;
+using namespace lv2c;
+namespace fs = std::filesystem;
+
+static Lv2cSurface MakeStrip(int tileCount, int tileSize)
+{
+    Lv2cImageSurface strip{cairo_format_t::CAIRO_FORMAT_ARGB32, tileCount * tileSize, tileSize};
+    {
+        Lv2cDrawingContext dc{strip};
+        for (int i = 0; i < tileCount; ++i)
+        {
+            dc.set_source(Lv2cColor(i / (double)tileCount, 0, 0));
+            dc.rectangle(i * tileSize, 0, tileSize, tileSize);
+            dc.fill();
+        }
+    }
+    strip.flush();
+    return strip;
+}
+
+static uint32_t GetPixel(const Lv2cSurface &surface, int x, int y)
+{
+    Lv2cImageSurface imageSurface{surface};
+    return ((uint32_t *)(imageSurface.get_data() + y * imageSurface.get_stride()))[x];
+}
+
+// Check that a rendered frame is the tile scaled to the frame size. Pixels are checked away from the tile edges,
+// where interpolation blends in neighbouring tiles.
+static void CheckFrame(Lv2cPngStripFrames &frames, const Lv2cSurface &strip, int tile, int tileSize, int frameSize)
+{
+    Lv2cSurface &frame = frames.Frame(tile);
+    for (int y = frameSize / 4; y < frameSize * 3 / 4; y += frameSize / 8)
+    {
+        for (int x = frameSize / 4; x < frameSize * 3 / 4; x += frameSize / 8)
+        {
+            int stripX = tile * tileSize + x * tileSize / frameSize;
+            int stripY = y * tileSize / frameSize;
+            REQUIRE(GetPixel(frame, x, y) == GetPixel(strip, stripX, stripY));
+        }
+    }
+}
+
+TEST_CASE("Lv2cPngStripFrames lazy resampling", "[png_strip_frames]")
+{
+    constexpr int TILE_COUNT = 16;
+    Lv2cPngStripFrames frames{MakeStrip(TILE_COUNT, 32), Lv2cSize(32, 32), TILE_COUNT, 48, 48};
+
+    REQUIRE(frames.TileCount() == TILE_COUNT);
+    REQUIRE(frames.RenderedFrameCount() == 0);
+
+    Lv2cSurface &frame = frames.Frame(3);
+    REQUIRE(frame);
+    REQUIRE(frame.size() == Lv2cSize(48, 48));
+    REQUIRE(frames.RenderedFrameCount() == 1);
+
+    // second use is a cache hit.
+    REQUIRE(frames.Frame(3).get() == frame.get());
+    REQUIRE(frames.RenderedFrameCount() == 1);
+
+    frames.Frame(4);
+    REQUIRE(frames.RenderedFrameCount() == 2);
+
+    // out-of-range frames are clamped.
+    REQUIRE(frames.Frame(1000).get() == frames.Frame(TILE_COUNT - 1).get());
+    REQUIRE(frames.Frame(-1).get() == frames.Frame(0).get());
+    REQUIRE(frames.RenderedFrameCount() == 4);
+}
+
+TEST_CASE("Lv2cPngStripFrames frame contents", "[png_strip_frames]")
+{
+    constexpr int TILE_COUNT = 16;
+    Lv2cSurface strip = MakeStrip(TILE_COUNT, 32);
+    Lv2cPngStripFrames frames{strip, Lv2cSize(32, 32), TILE_COUNT, 48, 48};
+
+    CheckFrame(frames, strip, 0, 32, 48);
+    CheckFrame(frames, strip, 3, 32, 48);
+    CheckFrame(frames, strip, TILE_COUNT - 1, 32, 48);
+    // each frame shows its own tile.
+    REQUIRE(GetPixel(frames.Frame(3), 24, 24) != GetPixel(frames.Frame(4), 24, 24));
+}
+
+TEST_CASE("Lv2cWindow shares PNG strip frames", "[png_strip_frames]")
+{
+    constexpr int TILE_COUNT = 16;
+    fs::path testDirectory = fs::temp_directory_path() / ("lv2c_png_strip_frames_test_" + std::to_string(getpid()));
+    fs::create_directories(testDirectory);
+    std::string file = (testDirectory / "strip.png").string();
+    std::string otherFile = (testDirectory / "other.png").string();
+    Lv2cSurface strip = MakeStrip(TILE_COUNT, 32);
+    REQUIRE(strip.write_to_png(file.c_str()) == CAIRO_STATUS_SUCCESS);
+    REQUIRE(strip.write_to_png(otherFile.c_str()) == CAIRO_STATUS_SUCCESS);
+
+    {
+        auto window = Lv2cWindow::Create();
+        Lv2cPngStripFrames::ptr frames = window->GetPngStripFrames(file, Lv2cSize(32, 32), 48, 48);
+        REQUIRE(frames);
+        REQUIRE(frames->TileCount() == TILE_COUNT);
+        CheckFrame(*frames, strip, 5, 32, 48);
+
+        // shared for the same file, tile size and device size.
+        REQUIRE(window->GetPngStripFrames(file, Lv2cSize(32, 32), 48, 48) == frames);
+        REQUIRE(frames->RenderedFrameCount() == 1);
+
+        REQUIRE(window->GetPngStripFrames(otherFile, Lv2cSize(32, 32), 48, 48) != frames);
+        REQUIRE(window->GetPngStripFrames(file, Lv2cSize(16, 32), 48, 48) != frames);
+        REQUIRE(window->GetPngStripFrames(file, Lv2cSize(32, 32), 64, 48) != frames);
+        REQUIRE(window->GetPngStripFrames(file, Lv2cSize(32, 32), 48, 64) != frames);
+    }
+    fs::remove_all(testDirectory);
+}
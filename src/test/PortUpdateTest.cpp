@@ -0,0 +1,277 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cHeadlessWindow.hpp"
+#include "lv2c/Lv2cAnimationClock.hpp"
+#include "lv2c_ui/Lv2UI.hpp"
+#include "SamplePluginInfo.hpp"
+#include <vector>
+
+using namespace lv2c;
+using namespace lv2c::ui;
+using namespace std::chrono_literals;
+
+namespace
+{
+    constexpr uint32_t LEVEL_PORT = 0;    // "level", an input port.
+    constexpr uint32_t VU_PORT = 1;       // "vu", a dB output port.
+    constexpr uint32_t LFO_RATE_PORT = 2; // "lfoRate", an input port.
+    constexpr uint32_t LFO_PORT = 4;      // "lfoOut", an output port.
+
+    struct PortWrite
+    {
+        uint32_t portIndex;
+        float value;
+    };
+
+    class PortUpdateTestUI : public Lv2UI
+    {
+    public:
+        PortUpdateTestUI()
+            : Lv2UI(SamplePluginInfo::Create(), Lv2cCreateWindowParameters())
+        {
+        }
+
+        void Attach(Lv2cWindow::ptr window)
+        {
+            AttachWindow(window, &PortUpdateTestUI::Write, (LV2UI_Controller)this);
+        }
+
+        void HostPortEvent(uint32_t portIndex, float value)
+        {
+            ui_port_event(portIndex, sizeof(float), 0, &value);
+        }
+
+        std::vector<PortWrite> writes;
+
+    private:
+        static void Write(LV2UI_Controller controller, uint32_t portIndex, uint32_t bufferSize, uint32_t protocol, const void *buffer)
+        {
+            ((PortUpdateTestUI *)controller)->writes.push_back(PortWrite{portIndex, *(const float *)buffer});
+        }
+    };
+
+    Lv2cCreateWindowParameters TestWindowParameters()
+    {
+        Lv2cCreateWindowParameters parameters;
+        parameters.size = Lv2cSize(200, 100);
+        parameters.title = "PortUpdateTest";
+        return parameters;
+    }
+}
+
+TEST_CASE("Lv2UI coalesces host port updates per frame", "[port_updates]")
+{
+    PortUpdateTestUI ui;
+    auto window = Lv2cWindow::Create();
+    Lv2cHeadlessWindow headless{window, TestWindowParameters()};
+    ui.Attach(window);
+    ui.CoalescePortUpdates(true);
+    headless.Frame();
+
+    double defaultValue = ui.GetControlValue("level");
+    for (int i = 1; i <= 5; ++i)
+    {
+        ui.HostPortEvent(LEVEL_PORT, (float)i);
+    }
+    REQUIRE(ui.GetPortUpdateStatistics().received == 5);
+    REQUIRE(ui.GetPortUpdateStatistics().coalesced == 4);
+    REQUIRE(ui.GetPortUpdateStatistics().applied == 0);
+    REQUIRE(ui.GetControlValue("level") == defaultValue);
+
+    headless.Frame();
+    REQUIRE(ui.GetPortUpdateStatistics().applied == 1);
+    REQUIRE(ui.GetPortUpdateStatistics().frames == 1);
+    REQUIRE(ui.GetControlValue("level") == 5);
+    // values from the host aren't echoed back to it.
+    REQUIRE(ui.writes.empty());
+
+    // nothing pending.
+    headless.Frame();
+    REQUIRE(ui.GetPortUpdateStatistics().frames == 1);
+
+    // disabling coalescing flushes pending values.
+    ui.HostPortEvent(LEVEL_PORT, 7);
+    ui.CoalescePortUpdates(false);
+    REQUIRE(ui.GetControlValue("level") == 7);
+    ui.HostPortEvent(LEVEL_PORT, 8);
+    REQUIRE(ui.GetControlValue("level") == 8);
+    REQUIRE(ui.GetPortUpdateStatistics().applied == 3);
+}
+
+TEST_CASE("Lv2UI user edits supersede pending host port updates", "[port_updates]")
+{
+    PortUpdateTestUI ui;
+    auto window = Lv2cWindow::Create();
+    Lv2cHeadlessWindow headless{window, TestWindowParameters()};
+    ui.Attach(window);
+    ui.CoalescePortUpdates(true);
+    headless.Frame();
+
+    // The user drags a control. The host echoes the first write, and the user
+    // writes a newer value before the echo is applied.
+    ui.SetControlValue("level", 1);
+    ui.HostPortEvent(LEVEL_PORT, 1);
+    ui.SetControlValue("level", 2);
+    REQUIRE(ui.GetPortUpdateStatistics().superseded == 1);
+
+    headless.Frame();
+    REQUIRE(ui.GetControlValue("level") == 2);
+    REQUIRE(ui.GetPortUpdateStatistics().applied == 0);
+    REQUIRE(ui.writes.size() == 2);
+    REQUIRE(ui.writes.back().portIndex == LEVEL_PORT);
+    REQUIRE(ui.writes.back().value == 2);
+
+    // later host values are applied as usual.
+    ui.HostPortEvent(LEVEL_PORT, 3);
+    headless.Frame();
+    REQUIRE(ui.GetControlValue("level") == 3);
+    REQUIRE(ui.GetPortUpdateStatistics().applied == 1);
+}
+
+TEST_CASE("Lv2UI user edits made while applying host port updates", "[port_updates]")
+{
+    PortUpdateTestUI ui;
+    auto window = Lv2cWindow::Create();
+    Lv2cHeadlessWindow headless{window, TestWindowParameters()};
+    ui.Attach(window);
+    ui.CoalescePortUpdates(true);
+    headless.Frame();
+
+    // a binding that edits lfoRate when level changes.
+    auto handle = ui.GetControlProperty("level").addObserver(
+        [&ui](double value)
+        {
+            ui.SetControlValue("lfoRate", 0.5);
+        });
+
+    // both are pending when level is applied, so the edit supersedes the pending lfoRate value.
+    ui.HostPortEvent(LEVEL_PORT, 1);
+    ui.HostPortEvent(LFO_RATE_PORT, 2);
+    headless.Frame();
+    REQUIRE(ui.GetControlValue("level") == 1);
+    REQUIRE(ui.GetControlValue("lfoRate") == 0.5);
+    REQUIRE(ui.GetPortUpdateStatistics().applied == 1);
+    REQUIRE(ui.GetPortUpdateStatistics().superseded == 1);
+    REQUIRE(ui.writes.size() == 1);
+    REQUIRE(ui.writes.back().portIndex == LFO_RATE_PORT);
+    REQUIRE(ui.writes.back().value == 0.5f);
+
+    // nothing left pending, and later host values are applied as usual.
+    headless.Frame();
+    REQUIRE(ui.GetPortUpdateStatistics().frames == 1);
+    ui.HostPortEvent(LFO_RATE_PORT, 2);
+    headless.Frame();
+    REQUIRE(ui.GetControlValue("lfoRate") == 2);
+}
+
+TEST_CASE("Lv2UI port update rates", "[port_updates]")
+{
+    PortUpdateTestUI ui;
+    REQUIRE(ui.GetPortUpdateRate(LEVEL_PORT) == 0);
+    REQUIRE(ui.GetPortUpdateRate(VU_PORT) == Lv2PortViewController::DefaultUpdateRate(Lv2PortUpdateClass::VuMeter));
+
+    ui.PortUpdateRate(Lv2PortUpdateClass::VuMeter, 10);
+    REQUIRE(ui.PortUpdateRate(Lv2PortUpdateClass::VuMeter) == 10);
+    REQUIRE(ui.GetPortUpdateRate(VU_PORT) == 10);
+
+    // symbol rates override class rates.
+    ui.PortUpdateRate("vu", 20);
+    REQUIRE(ui.GetPortUpdateRate(VU_PORT) == 20);
+    ui.PortUpdateRate(Lv2PortUpdateClass::VuMeter, 5);
+    REQUIRE(ui.GetPortUpdateRate(VU_PORT) == 20);
+
+    ui.PortUpdateRate(Lv2PortUpdateClass::Input, -1);
+    REQUIRE(ui.PortUpdateRate(Lv2PortUpdateClass::Input) == 0);
+}
+
+TEST_CASE("Lv2UI rate limits hold their cadence", "[port_updates]")
+{
+    PortUpdateTestUI ui;
+    auto window = Lv2cWindow::Create();
+    Lv2cHeadlessWindow headless{window, TestWindowParameters()};
+    ui.Attach(window);
+    ui.CoalescePortUpdates(true);
+    ui.PortUpdateRate("vu", 10);
+    headless.Frame();
+
+    // Notifications every 10ms are applied at 10Hz.
+    for (int i = 1; i <= 100; ++i)
+    {
+        ui.HostPortEvent(VU_PORT, (float)-i);
+        headless.RunFor(10ms, 10ms);
+    }
+    REQUIRE(ui.GetPortUpdateStatistics().received == 100);
+    REQUIRE(ui.GetPortUpdateStatistics().applied == 10);
+    REQUIRE(ui.GetPortUpdateStatistics().coalesced == 89); // and one still pending.
+    // the latest value is kept pending, and applied at the next deadline.
+    headless.RunFor(100ms, 10ms);
+    REQUIRE(ui.GetControlValue("vu") == -100);
+    REQUIRE(!headless.HasPendingWork());
+
+    // With frames every 30ms, deadlines advance by the interval rather than restarting
+    // from each late frame, so the average rate stays at 10Hz instead of dropping to 1/120ms.
+    ui.ResetPortUpdateStatistics();
+    for (int i = 0; i < 100; ++i)
+    {
+        ui.HostPortEvent(VU_PORT, (float)i);
+        headless.RunFor(30ms, 30ms);
+    }
+    REQUIRE(ui.GetPortUpdateStatistics().applied >= 29);
+    REQUIRE(ui.GetPortUpdateStatistics().applied <= 31);
+}
+
+TEST_CASE("Lv2UI reschedules port updates for an earlier deadline", "[port_updates]")
+{
+    PortUpdateTestUI ui;
+    auto window = Lv2cWindow::Create();
+    Lv2cHeadlessWindow headless{window, TestWindowParameters()};
+    ui.Attach(window);
+    ui.CoalescePortUpdates(true);
+    ui.PortUpdateRate("vu", 1);
+    ui.PortUpdateRate("lfoOut", 10);
+    headless.Frame();
+
+    // apply once to start the 1s interval, then leave a value waiting for the next deadline.
+    ui.HostPortEvent(VU_PORT, -10);
+    headless.Frame();
+    REQUIRE(ui.GetControlValue("vu") == -10);
+    ui.HostPortEvent(VU_PORT, -20);
+    headless.RunFor(100ms, 10ms);
+    REQUIRE(ui.GetControlValue("vu") == -10);
+
+    // An lfoOut value is due now, well before the pending vu deadline.
+    ui.HostPortEvent(LFO_PORT, 0.5f);
+    headless.RunFor(10ms, 10ms);
+    REQUIRE(ui.GetControlValue("lfoOut") == 0.5f);
+    REQUIRE(ui.GetControlValue("vu") == -10);
+
+    // a second lfoOut value waits for its own 100ms deadline (applied in the first frame after it), not vu's.
+    ui.HostPortEvent(LFO_PORT, 0.25f);
+    headless.RunFor(90ms, 10ms);
+    REQUIRE(ui.GetControlValue("lfoOut") == 0.5f);
+    headless.RunFor(20ms, 10ms);
+    REQUIRE(ui.GetControlValue("lfoOut") == 0.25f);
+    REQUIRE(ui.GetControlValue("vu") == -10);
+
+    headless.RunFor(1000ms, 10ms);
+    REQUIRE(ui.GetControlValue("vu") == -20);
+}
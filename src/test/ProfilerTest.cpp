@@ -0,0 +1,205 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cProfiler.hpp"
+#include "lv2c/Lv2cHeadlessWindow.hpp"
+#include "lv2c/Lv2cRootElement.hpp"
+#include "lv2c/JsonVariant.hpp"
+#include "lv2c/JsonIo.hpp"
+#include <sstream>
+
+using namespace lv2c;
+
+namespace
+{
+    struct ProfilerFixture
+    {
+        ProfilerFixture()
+        {
+            savedEnabled = Lv2cProfiler::Enabled();
+            Lv2cProfiler::Reset();
+            Lv2cProfiler::Enable(true);
+        }
+        ~ProfilerFixture()
+        {
+            Lv2cProfiler::Enable(savedEnabled);
+            Lv2cProfiler::Reset();
+        }
+        bool savedEnabled;
+    };
+}
+
+TEST_CASE("Lv2cProfiler spans", "[profiler]")
+{
+    ProfilerFixture fixture;
+    {
+        Lv2cProfiler::Scope outer{"Outer"};
+        {
+            Lv2cProfiler::Scope inner{"Inner"};
+        }
+    }
+    Lv2cProfiler::Enable(false);
+    {
+        Lv2cProfiler::Scope ignored{"Ignored"};
+    }
+
+    auto spans = Lv2cProfiler::GetSpans();
+    REQUIRE(spans.size() == 2);
+    // spans are recorded when they end.
+    REQUIRE(std::string(spans[0].name) == "Inner");
+    REQUIRE(std::string(spans[1].name) == "Outer");
+    REQUIRE(spans[1].startNs <= spans[0].startNs);
+    REQUIRE(spans[1].startNs + spans[1].durationNs >= spans[0].startNs + spans[0].durationNs);
+}
+
+TEST_CASE("Lv2cProfiler element counters", "[profiler]")
+{
+    ProfilerFixture fixture;
+    auto element = Lv2cElement::Create();
+    for (int i = 0; i < 3; ++i)
+    {
+        Lv2cProfiler::Scope scope{Lv2cProfiler::ElementPhase::Draw, element.get()};
+        Lv2cProfiler::AddDamage(element.get(), 100);
+    }
+    {
+        Lv2cProfiler::Scope scope{Lv2cProfiler::ElementPhase::Measure, element.get()};
+    }
+    auto counters = Lv2cProfiler::GetElementCounters(element.get());
+    REQUIRE(counters.drawCount == 3);
+    REQUIRE(counters.damagedArea == 300);
+    REQUIRE(counters.measureCount == 1);
+    REQUIRE(counters.arrangeCount == 0);
+    REQUIRE(counters.elementType == "lv2c::Lv2cElement");
+
+    auto all = Lv2cProfiler::GetAllElementCounters();
+    REQUIRE(all.size() == 1);
+
+    const Lv2cElement *p = element.get();
+    element = nullptr;
+    if (Lv2cProfiler::CompiledIn())
+    {
+        // destroyed elements are forgotten.
+        REQUIRE(Lv2cProfiler::GetElementCounters(p).drawCount == 0);
+    }
+}
+
+TEST_CASE("Lv2cProfiler nested element scopes", "[profiler]")
+{
+    ProfilerFixture fixture;
+    auto element = Lv2cElement::Create();
+    auto child = Lv2cElement::Create();
+    {
+        // an override that calls its instrumented base class.
+        Lv2cProfiler::Scope scope{Lv2cProfiler::ElementPhase::Arrange, element.get()};
+        {
+            Lv2cProfiler::Scope baseScope{Lv2cProfiler::ElementPhase::Arrange, element.get()};
+            Lv2cProfiler::Scope childScope{Lv2cProfiler::ElementPhase::Arrange, child.get()};
+        }
+        Lv2cProfiler::Scope measureScope{Lv2cProfiler::ElementPhase::Measure, element.get()};
+    }
+    REQUIRE(Lv2cProfiler::GetSpans().size() == 4);
+    REQUIRE(Lv2cProfiler::GetElementCounters(element.get()).arrangeCount == 1);
+    REQUIRE(Lv2cProfiler::GetElementCounters(element.get()).measureCount == 1);
+    REQUIRE(Lv2cProfiler::GetElementCounters(child.get()).arrangeCount == 1);
+
+    // scopes that follow are counted.
+    {
+        Lv2cProfiler::Scope scope{Lv2cProfiler::ElementPhase::Arrange, element.get()};
+    }
+    REQUIRE(Lv2cProfiler::GetElementCounters(element.get()).arrangeCount == 2);
+}
+
+TEST_CASE("Lv2cProfiler damage macro", "[profiler]")
+{
+    ProfilerFixture fixture;
+    auto element = Lv2cElement::Create();
+    bool damaged = false;
+    bool elseTaken = false;
+    // expands to a single statement.
+    if (damaged)
+        LV2C_PROFILE_DAMAGE(element.get(), 100);
+    else
+        elseTaken = true;
+    REQUIRE(elseTaken);
+    LV2C_PROFILE_DAMAGE(element.get(), 100);
+    if (Lv2cProfiler::CompiledIn())
+    {
+        REQUIRE(Lv2cProfiler::GetElementCounters(element.get()).damagedArea == 100);
+    }
+}
+
+TEST_CASE("Lv2cProfiler Chrome trace", "[profiler]")
+{
+    ProfilerFixture fixture;
+    auto element = Lv2cElement::Create();
+    {
+        Lv2cProfiler::Scope scope{"Frame"};
+        Lv2cProfiler::Scope elementScope{Lv2cProfiler::ElementPhase::Arrange, element.get()};
+    }
+    std::stringstream s;
+    Lv2cProfiler::WriteChromeTrace(s);
+
+    json_variant trace;
+    s >> trace;
+    auto &events = trace["traceEvents"].as_array();
+    REQUIRE(events->size() == 2);
+    json_variant &arrange = (*events)[0];
+    REQUIRE(arrange["name"].as_string() == "Arrange");
+    REQUIRE(arrange["ph"].as_string() == "X");
+    REQUIRE(arrange["args"]["element"].as_string() == "lv2c::Lv2cElement");
+    REQUIRE((*events)[1]["name"].as_string() == "Frame");
+    REQUIRE((*events)[1]["dur"].as_number() >= 0);
+}
+
+TEST_CASE("Lv2cProfiler frame instrumentation", "[profiler]")
+{
+    if (!Lv2cProfiler::CompiledIn())
+    {
+        return;
+    }
+    ProfilerFixture fixture;
+    auto window = Lv2cWindow::Create();
+    auto element = Lv2cElement::Create();
+    element->Style().Width(50).Height(20);
+    window->GetRootElement()->AddChild(element);
+
+    Lv2cCreateWindowParameters parameters;
+    parameters.size = Lv2cSize(200, 100);
+    Lv2cHeadlessWindow headless{window, parameters};
+    headless.Frame();
+
+    auto counters = Lv2cProfiler::GetElementCounters(element.get());
+    REQUIRE(counters.measureCount >= 1);
+    REQUIRE(counters.arrangeCount >= 1);
+    REQUIRE(counters.drawCount == 1);
+    REQUIRE(counters.damagedArea == 50 * 20);
+
+    bool sawLayout = false;
+    bool sawDraw = false;
+    for (auto &span : Lv2cProfiler::GetSpans())
+    {
+        std::string name = span.name;
+        sawLayout |= name == "Lv2cWindow::Layout";
+        sawDraw |= name == "Lv2cWindow::Draw";
+    }
+    REQUIRE(sawLayout);
+    REQUIRE(sawDraw);
+}
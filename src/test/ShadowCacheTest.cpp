@@ -0,0 +1,100 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cShadowCache.hpp"
+
+using namespace std;
+using namespace lv2c;
+
+static Lv2cShadowCacheKey MakeKey(double radius)
+{
+    Lv2cShadowCacheKey key;
+    key.width = 32;
+    key.height = 32;
+    key.deviceBackground = Lv2cRectangle(4, 4, 24, 24);
+    key.deviceRoundCorners = Lv2cRoundCorners{2, 2, 2, 2};
+    key.deviceRadius = radius;
+    key.color = Lv2cColor(0, 0, 0, 0.5);
+    return key;
+}
+
+TEST_CASE("Lv2cShadowCache hits and misses", "[shadow_cache]")
+{
+    Lv2cShadowCache cache;
+
+    REQUIRE(!cache.Get(MakeKey(4)));
+    cache.Put(MakeKey(4), Lv2cImageSurface(cairo_format_t::CAIRO_FORMAT_ARGB32, 32, 32));
+    REQUIRE(cache.Get(MakeKey(4)));
+    REQUIRE(!cache.Get(MakeKey(5)));
+
+    Lv2cShadowCacheKey otherColor = MakeKey(4);
+    otherColor.color = Lv2cColor(1, 0, 0, 0.5);
+    REQUIRE(!cache.Get(otherColor));
+
+    Lv2cShadowCacheKey otherScale = MakeKey(4);
+    otherScale.windowScale = 2;
+    REQUIRE(!cache.Get(otherScale));
+
+    auto stats = cache.GetStats();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 4);
+    REQUIRE(stats.entries == 1);
+    REQUIRE(stats.bytes == 32 * 32 * 4);
+
+    cache.ResetStats();
+    REQUIRE(cache.GetStats().hits == 0);
+    REQUIRE(cache.GetStats().entries == 1);
+}
+
+TEST_CASE("Lv2cShadowCache LRU eviction", "[shadow_cache]")
+{
+    constexpr size_t ENTRY_BYTES = 32 * 32 * 4;
+    Lv2cShadowCache cache{ENTRY_BYTES * 3};
+
+    for (int i = 0; i < 3; ++i)
+    {
+        cache.Put(MakeKey(i), Lv2cImageSurface(cairo_format_t::CAIRO_FORMAT_ARGB32, 32, 32));
+    }
+    // touch 0, so that 1 is least-recently used.
+    REQUIRE(cache.Get(MakeKey(0)));
+
+    cache.Put(MakeKey(3), Lv2cImageSurface(cairo_format_t::CAIRO_FORMAT_ARGB32, 32, 32));
+
+    REQUIRE(cache.GetStats().evictions == 1);
+    REQUIRE(cache.GetStats().bytes <= ENTRY_BYTES * 3);
+    REQUIRE(cache.Get(MakeKey(0)));
+    REQUIRE(!cache.Get(MakeKey(1)));
+    REQUIRE(cache.Get(MakeKey(2)));
+    REQUIRE(cache.Get(MakeKey(3)));
+
+    // too large to cache.
+    cache.Put(MakeKey(4), Lv2cImageSurface(cairo_format_t::CAIRO_FORMAT_ARGB32, 64, 64));
+    REQUIRE(!cache.Get(MakeKey(4)));
+    REQUIRE(cache.GetStats().entries == 3);
+
+    cache.MaxBytes(ENTRY_BYTES);
+    REQUIRE(cache.GetStats().entries == 1);
+    REQUIRE(cache.Get(MakeKey(3)));
+
+    cache.Clear();
+    REQUIRE(cache.GetStats().entries == 0);
+    REQUIRE(cache.GetStats().bytes == 0);
+}
@@ -0,0 +1,137 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cContainerElement.hpp"
+#include "lv2c/Lv2cStyle.hpp"
+#include <iostream>
+
+using namespace lv2c;
+
+static Lv2cContainerElement::ptr BuildTree(Lv2cContainerElement::ptr root, size_t depth, size_t breadth, const Lv2cStyle::ptr &cls)
+{
+    Lv2cContainerElement::ptr parent = root;
+    for (size_t d = 0; d < depth; ++d)
+    {
+        auto level = Lv2cContainerElement::Create();
+        level->Style().Padding({4});
+        parent->AddChild(level);
+        for (size_t i = 0; i < breadth; ++i)
+        {
+            auto leaf = Lv2cElement::Create();
+            leaf->AddClass(cls);
+            level->AddChild(leaf);
+        }
+        parent = level;
+    }
+    return parent;
+}
+
+static void ReadStyles(Lv2cElement *element)
+{
+    auto &style = element->Style();
+    (void)style.FontFamily();
+    (void)style.FontSize();
+    (void)style.Color();
+    (void)style.Background();
+    (void)style.Margin();
+    (void)style.Padding();
+    (void)style.Theme();
+    (void)style.SingleLine();
+    (void)style.Visibility();
+    if (element->isContainer())
+    {
+        for (auto &child : ((Lv2cContainerElement *)element)->Children())
+        {
+            ReadStyles(child.get());
+        }
+    }
+}
+
+TEST_CASE("Lv2cStyle computed style invalidation", "[style_cache]")
+{
+    Lv2cStyle::EnableComputedStyleCache(true);
+
+    auto root = Lv2cContainerElement::Create();
+    root->Style().FontFamily("Serif").FontSize(12);
+    auto cls = Lv2cStyle::Create();
+    auto deepest = BuildTree(root, 4, 2, cls);
+    auto leaf = deepest->Child(0);
+
+    REQUIRE(leaf->Style().FontFamily() == "Serif");
+    REQUIRE(leaf->Style().FontSize().PixelValue() == 12);
+
+    // ancestor style change.
+    root->Style().FontFamily("Sans");
+    REQUIRE(leaf->Style().FontFamily() == "Sans");
+
+    // class change.
+    cls->FontFamily("Mono");
+    REQUIRE(leaf->Style().FontFamily() == "Mono");
+    leaf->RemoveClass(cls);
+    REQUIRE(leaf->Style().FontFamily() == "Sans");
+
+    // own style change.
+    leaf->Style().FontSize(20);
+    REQUIRE(leaf->Style().FontSize().PixelValue() == 20);
+
+    // reparenting.
+    auto otherRoot = Lv2cContainerElement::Create();
+    otherRoot->Style().FontFamily("Cursive");
+    deepest->RemoveChild(leaf);
+    REQUIRE(leaf->Style().FontFamily() == "");
+    otherRoot->AddChild(leaf);
+    REQUIRE(leaf->Style().FontFamily() == "Cursive");
+}
+
+TEST_CASE("Lv2cStyle lookup count", "[style_cache]")
+{
+    constexpr size_t PASSES = 10;
+
+    auto root = Lv2cContainerElement::Create();
+    root->Style().FontFamily("Serif").FontSize(12).Color(Lv2cColor(1, 1, 1));
+    auto cls = Lv2cStyle::Create();
+    cls->Background(Lv2cColor(0, 0, 0)).Margin({2});
+    BuildTree(root, 12, 4, cls);
+
+    Lv2cStyle::EnableComputedStyleCache(false);
+    Lv2cStyle::ResetLookupStatistics();
+    for (size_t i = 0; i < PASSES; ++i)
+    {
+        ReadStyles(root.get());
+    }
+    auto uncached = Lv2cStyle::GetLookupStatistics();
+
+    Lv2cStyle::EnableComputedStyleCache(true);
+    Lv2cStyle::ResetLookupStatistics();
+    for (size_t i = 0; i < PASSES; ++i)
+    {
+        ReadStyles(root.get());
+    }
+    auto cached = Lv2cStyle::GetLookupStatistics();
+
+    std::cout << "Style lookups (" << PASSES << " passes): "
+              << uncached.lookups << " uncached, "
+              << cached.lookups << " cached (" << cached.cacheHits << " cache hits)" << std::endl;
+
+    REQUIRE(uncached.cacheHits == 0);
+    REQUIRE(cached.lookups < uncached.lookups / PASSES * 2);
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cSvgRasterCache.hpp"
+
+using namespace std;
+using namespace lv2c;
+
+static Lv2cSvgRasterKey MakeKey(const std::string &source)
+{
+    Lv2cSvgRasterKey key;
+    key.source = source;
+    key.size = Lv2cSize(24, 24);
+    key.deviceScale = 1.5;
+    return key;
+}
+
+TEST_CASE("Lv2cSvgRasterKey equality", "[svg_raster_cache]")
+{
+    Lv2cSvgRasterKey key = MakeKey("fx_folder.svg");
+    REQUIRE(key == MakeKey("fx_folder.svg"));
+    REQUIRE(key.Hash() == MakeKey("fx_folder.svg").Hash());
+    REQUIRE(!(key == MakeKey("fx_file.svg")));
+
+    // tint color is ignored unless tinted.
+    Lv2cSvgRasterKey untinted = key;
+    untinted.tint = Lv2cColor(1, 0, 0);
+    REQUIRE(untinted == key);
+    REQUIRE(untinted.Hash() == key.Hash());
+
+    Lv2cSvgRasterKey tinted = key;
+    tinted.tinted = true;
+    REQUIRE(!(tinted == key));
+    Lv2cSvgRasterKey redTint = tinted;
+    redTint.tint = Lv2cColor(1, 0, 0);
+    REQUIRE(!(tinted == redTint));
+
+    Lv2cSvgRasterKey rotated = key;
+    rotated.rotation = 90;
+    REQUIRE(!(rotated == key));
+
+    Lv2cSvgRasterKey scaled = key;
+    scaled.deviceScale = 2;
+    REQUIRE(!(scaled == key));
+
+    Lv2cSvgRasterKey shifted = key;
+    shifted.xFraction = 0.5;
+    REQUIRE(!(shifted == key));
+}
+
+TEST_CASE("Lv2cSvgRasterCache lookups", "[svg_raster_cache]")
+{
+    Lv2cSvgRasterCache cache{1024 * 1024};
+    REQUIRE(!cache.Get(MakeKey("a.svg")));
+    cache.Put(MakeKey("a.svg"), Lv2cImageSurface(cairo_format_t::CAIRO_FORMAT_ARGB32, 36, 36));
+    REQUIRE(cache.Get(MakeKey("a.svg")));
+    REQUIRE(!cache.Get(MakeKey("b.svg")));
+
+    auto stats = cache.GetStats();
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.misses == 2);
+    REQUIRE(stats.entries == 1);
+
+    cache.Clear();
+    REQUIRE(!cache.Get(MakeKey("a.svg")));
+}
@@ -0,0 +1,182 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cPangoContext.hpp"
+#include "lv2c/Lv2cStyle.hpp"
+#include <pango/pangocairo.h>
+
+using namespace lv2c;
+
+namespace
+{
+    class TextMeasurer
+    {
+    public:
+        TextMeasurer()
+        {
+            surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 16, 16);
+            cr = cairo_create(surface);
+            layout = pango_layout_new(gPangoContext.get());
+        }
+        ~TextMeasurer()
+        {
+            g_object_unref(layout);
+            cairo_destroy(cr);
+            cairo_surface_destroy(surface);
+        }
+        cairo_t *Context() { return cr; }
+
+        Lv2cSize Measure(const PangoFontDescription *font, const std::string &text, bool markup = false)
+        {
+            int width = 0, height = 0;
+            gPangoContext.GetSingleLineSize(layout, cr, font, text, markup, &width, &height);
+            return Lv2cSize(width, height);
+        }
+
+    private:
+        cairo_surface_t *surface = nullptr;
+        cairo_t *cr = nullptr;
+        PangoLayout *layout = nullptr;
+    };
+
+    // Tests share gPangoContext, so compare counts before and after, rather than absolute counts.
+    struct CacheDelta
+    {
+        Lv2cPangoContext::TextCacheStatistics start = gPangoContext.GetTextCacheStatistics();
+
+        uint64_t Hits() { return gPangoContext.GetTextCacheStatistics().hits - start.hits; }
+        uint64_t Misses() { return gPangoContext.GetTextCacheStatistics().misses - start.misses; }
+    };
+}
+
+TEST_CASE("Lv2cPangoContext font description interning", "[text_cache]")
+{
+    Lv2cStyle a;
+    a.FontFamily("Serif").FontSize(17);
+    Lv2cStyle b;
+    b.FontFamily("Serif").FontSize(17);
+
+    const PangoFontDescription *fontA = gPangoContext.GetSharedFontDescription(a);
+    uint64_t count = gPangoContext.GetTextCacheStatistics().fontDescriptions;
+
+    // Styles that resolve to the same font share a description.
+    REQUIRE(gPangoContext.GetSharedFontDescription(b) == fontA);
+    REQUIRE(gPangoContext.GetSharedFontDescription(a) == fontA);
+    REQUIRE(gPangoContext.GetTextCacheStatistics().fontDescriptions == count);
+
+    // Each resolved property is part of the key.
+    b.FontSize(18);
+    const PangoFontDescription *fontB = gPangoContext.GetSharedFontDescription(b);
+    REQUIRE(fontB != fontA);
+
+    b.FontSize(17).FontWeight(Lv2cFontWeight::Bold);
+    const PangoFontDescription *fontC = gPangoContext.GetSharedFontDescription(b);
+    REQUIRE(fontC != fontA);
+    REQUIRE(fontC != fontB);
+
+    REQUIRE(gPangoContext.GetTextCacheStatistics().fontDescriptions == count + 2);
+
+    // Owned copies are still available to callers that modify or free them.
+    PangoFontDescription *copy = gPangoContext.GetFontDescription(a);
+    REQUIRE(copy != fontA);
+    REQUIRE(pango_font_description_equal(copy, fontA));
+    pango_font_description_free(copy);
+}
+
+TEST_CASE("Lv2cPangoContext text size cache key", "[text_cache]")
+{
+    TextMeasurer measurer;
+    Lv2cStyle style;
+    style.FontFamily("Sans").FontSize(13);
+    const PangoFontDescription *font = gPangoContext.GetSharedFontDescription(style);
+    style.FontSize(26);
+    const PangoFontDescription *largeFont = gPangoContext.GetSharedFontDescription(style);
+
+    CacheDelta delta;
+    Lv2cSize size = measurer.Measure(font, "-12.5 dB");
+    REQUIRE(delta.Misses() == 1);
+    REQUIRE(size.Width() > 0);
+
+    // a hit returns the measured size.
+    REQUIRE(measurer.Measure(font, "-12.5 dB") == size);
+    REQUIRE(delta.Hits() == 1);
+
+    // text, font, markup and device scale are all part of the key.
+    measurer.Measure(font, "-12.6 dB");
+    REQUIRE(delta.Misses() == 2);
+
+    Lv2cSize largeSize = measurer.Measure(largeFont, "-12.5 dB");
+    REQUIRE(delta.Misses() == 3);
+    REQUIRE(largeSize.Width() > size.Width());
+
+    measurer.Measure(font, "-12.5 dB", true);
+    REQUIRE(delta.Misses() == 4);
+
+    cairo_scale(measurer.Context(), 2, 2);
+    measurer.Measure(font, "-12.5 dB");
+    REQUIRE(delta.Misses() == 5);
+
+    REQUIRE(delta.Hits() == 1);
+}
+
+TEST_CASE("Lv2cPangoContext text size cache bounds", "[text_cache]")
+{
+    TextMeasurer measurer;
+    Lv2cStyle style;
+    style.FontFamily("Sans").FontSize(11);
+    const PangoFontDescription *font = gPangoContext.GetSharedFontDescription(style);
+
+    SECTION("Empty and long text are not cached")
+    {
+        std::string longText(Lv2cPangoContext::MAX_TEXT_CACHE_LENGTH + 1, 'x');
+        CacheDelta delta;
+        uint64_t entries = delta.start.entries;
+
+        Lv2cSize longSize = measurer.Measure(font, longText);
+        REQUIRE(measurer.Measure(font, longText) == longSize);
+        REQUIRE(longSize.Width() > 0);
+        measurer.Measure(font, "");
+        measurer.Measure(font, "");
+
+        REQUIRE(delta.Hits() == 0);
+        REQUIRE(delta.Misses() == 0);
+        REQUIRE(gPangoContext.GetTextCacheStatistics().entries == entries);
+    }
+    SECTION("The cache is cleared when full")
+    {
+        CacheDelta delta;
+        measurer.Measure(font, "first");
+        measurer.Measure(font, "first");
+        REQUIRE(delta.Hits() == 1);
+
+        for (size_t i = 0; i < Lv2cPangoContext::MAX_TEXT_CACHE_ENTRIES; ++i)
+        {
+            measurer.Measure(font, "item " + std::to_string(i));
+            REQUIRE(gPangoContext.GetTextCacheStatistics().entries <= Lv2cPangoContext::MAX_TEXT_CACHE_ENTRIES);
+        }
+        REQUIRE(delta.Misses() == 1 + Lv2cPangoContext::MAX_TEXT_CACHE_ENTRIES);
+
+        // "first" was dropped when the cache was cleared.
+        measurer.Measure(font, "first");
+        REQUIRE(delta.Hits() == 1);
+        REQUIRE(delta.Misses() == 2 + Lv2cPangoContext::MAX_TEXT_CACHE_ENTRIES);
+    }
+}
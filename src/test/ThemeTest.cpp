@@ -0,0 +1,53 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cTheme.hpp"
+
+using namespace lv2c;
+
+TEST_CASE("Lv2cTheme shared themes", "[theme]")
+{
+    Lv2cTheme::ptr dark = Lv2cTheme::GetShared(true);
+    REQUIRE(dark->IsShared());
+    REQUIRE(dark->isDarkTheme);
+    REQUIRE(Lv2cTheme::GetShared(true) == dark);
+    REQUIRE(Lv2cTheme::GetShared(Lv2cThemeColors(true)) == dark);
+    REQUIRE(Lv2cTheme::GetShared(false) != dark);
+    REQUIRE(!Lv2cTheme::GetShared(false)->isDarkTheme);
+
+    Lv2cThemeColors customColors(true);
+    customColors.primaryColor = Lv2cColor("#FF0000");
+    Lv2cTheme::ptr custom = Lv2cTheme::GetShared(customColors);
+    REQUIRE(custom != dark);
+    REQUIRE(Lv2cTheme::GetShared(customColors) == custom);
+
+    // copy on write.
+    Lv2cTheme::ptr writable = Lv2cTheme::Writable(dark);
+    REQUIRE(writable != dark);
+    REQUIRE(!writable->IsShared());
+    REQUIRE(writable->titleStyle != dark->titleStyle);
+    REQUIRE(static_cast<const Lv2cThemeColors &>(*writable) == *dark);
+    REQUIRE(Lv2cTheme::Writable(writable) == writable);
+
+    // themes created directly aren't shared.
+    REQUIRE(!Lv2cTheme::Create(true)->IsShared());
+}
@@ -0,0 +1,135 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cTimerQueue.hpp"
+#include <thread>
+#include <vector>
+#include <iostream>
+
+using namespace std;
+using namespace lv2c;
+
+using clock_t_ = Lv2cTimerQueue::clock_t;
+
+TEST_CASE("Lv2cTimerQueue ordering", "[timer_queue]")
+{
+    Lv2cTimerQueue queue;
+    auto t0 = clock_t_::now();
+    std::vector<int> fired;
+
+    queue.Post(t0 + 30ms, [&fired]() { fired.push_back(3); });
+    queue.Post(t0 + 10ms, [&fired]() { fired.push_back(1); });
+    queue.Post(t0 + 20ms, [&fired]() { fired.push_back(2); });
+    // equal deadlines fire in the order they were posted.
+    queue.Post(t0 + 20ms, [&fired]() { fired.push_back(4); });
+
+    REQUIRE(queue.Size() == 4);
+    REQUIRE(queue.NextDeadline().value() == t0 + 10ms);
+
+    REQUIRE(queue.Dispatch(t0) == 0);
+    REQUIRE(queue.Dispatch(t0 + 20ms) == 3);
+    REQUIRE(fired == std::vector<int>{1, 2, 4});
+    REQUIRE(queue.NextDeadline().value() == t0 + 30ms);
+
+    REQUIRE(queue.Dispatch(t0 + 1s) == 1);
+    REQUIRE(fired == std::vector<int>{1, 2, 4, 3});
+    REQUIRE(queue.Empty());
+    REQUIRE(!queue.NextDeadline().has_value());
+}
+
+TEST_CASE("Lv2cTimerQueue cancel", "[timer_queue]")
+{
+    Lv2cTimerQueue queue;
+    auto t0 = clock_t_::now();
+    int fired = 0;
+
+    auto h1 = queue.Post(t0 + 10ms, [&fired]() { ++fired; });
+    auto h2 = queue.Post(t0 + 20ms, [&fired]() { ++fired; });
+
+    REQUIRE(queue.Cancel(h1));
+    REQUIRE(!queue.Cancel(h1));
+    REQUIRE(queue.NextDeadline().value() == t0 + 20ms);
+
+    REQUIRE(queue.Dispatch(t0 + 1s) == 1);
+    REQUIRE(fired == 1);
+    REQUIRE(!queue.Cancel(h2));
+
+    // heavy cancel traffic must not grow the heap without bound.
+    for (int i = 0; i < 10000; ++i)
+    {
+        auto h = queue.Post(t0 + 1h, []() {});
+        REQUIRE(queue.Cancel(h));
+    }
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("Lv2cTimerQueue re-entrancy", "[timer_queue]")
+{
+    Lv2cTimerQueue queue;
+    auto t0 = clock_t_::now();
+    std::vector<int> fired;
+    AnimationHandle cancelMe;
+
+    queue.Post(t0, [&]()
+               {
+        fired.push_back(1);
+        // posted while dispatching: due now, but must wait for the next Dispatch.
+        queue.Post(t0, [&fired]() { fired.push_back(3); });
+        REQUIRE(queue.Cancel(cancelMe)); });
+    cancelMe = queue.Post(t0 + 1ms, [&fired]() { fired.push_back(2); });
+
+    REQUIRE(queue.Dispatch(t0 + 1ms) == 1);
+    REQUIRE(fired == std::vector<int>{1});
+    REQUIRE(queue.Dispatch(t0 + 1ms) == 1);
+    REQUIRE(fired == std::vector<int>{1, 3});
+}
+
+TEST_CASE("Lv2cTimerQueue cross-thread posting", "[timer_queue]")
+{
+    Lv2cTimerQueue queue;
+    auto t0 = clock_t_::now();
+    std::atomic<int> fired = 0;
+
+    constexpr int THREADS = 4;
+    constexpr int POSTS = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t)
+    {
+        threads.emplace_back([&queue, &fired, t0]()
+                             {
+            for (int i = 0; i < POSTS; ++i)
+            {
+                queue.PostFromAnyThread(t0 + std::chrono::microseconds(i), [&fired]() { ++fired; });
+            } });
+    }
+    size_t dispatched = 0;
+    while (dispatched < THREADS * POSTS)
+    {
+        dispatched += queue.Dispatch(t0 + 1s);
+        std::this_thread::yield();
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    REQUIRE(fired == THREADS * POSTS);
+    REQUIRE(queue.Empty());
+}
@@ -0,0 +1,183 @@
+// Copyright (c) 2023 Robin E. R. Davies
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of
+// this software and associated documentation files (the "Software"), to deal in
+// the Software without restriction, including without limitation the rights to
+// use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+// the Software, and to permit persons to whom the Software is furnished to do so,
+// subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+// FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+// COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+// IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+// CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include "CatchTest.hpp"
+
+#include "lv2c/Lv2cWindow.hpp"
+#include "lv2c/Lv2cDrawingContext.hpp"
+#include "lv2c/Lv2cContainerElement.hpp"
+#include "lv2c/Lv2cScrollContainerElement.hpp"
+#include "lv2c/Lv2cVirtualListElement.hpp"
+
+using namespace lv2c;
+
+namespace
+{
+    constexpr size_t ITEM_COUNT = 10000;
+    constexpr double VIEWPORT_HEIGHT = 100;
+
+    // Lays out an element tree without a native window.
+    class TestRootElement : public Lv2cContainerElement
+    {
+    public:
+        using ptr = std::shared_ptr<TestRootElement>;
+        static ptr Create() { return std::make_shared<TestRootElement>(); }
+
+        using Lv2cContainerElement::Mount;
+
+        void LayoutTree(Lv2cSize size)
+        {
+            Lv2cImageSurface surface{cairo_format_t::CAIRO_FORMAT_ARGB32, 1, 1};
+            Lv2cDrawingContext dc{surface};
+            Lv2cRectangle bounds{size};
+            Measure(size, size, dc);
+            Arrange(size, dc);
+            Layout(bounds);
+            FinalizeLayout(bounds, bounds);
+        }
+    };
+
+    class TestItemElement : public Lv2cElement
+    {
+    public:
+        using ptr = std::shared_ptr<TestItemElement>;
+        static ptr Create() { return std::make_shared<TestItemElement>(); }
+
+        size_t index = (size_t)-1;
+    };
+
+    struct VirtualListFixture
+    {
+        VirtualListFixture(double itemHeight, Lv2cVirtualRowHeightMode rowHeightMode = Lv2cVirtualRowHeightMode::Fixed)
+        {
+            window = Lv2cWindow::Create();
+            root = TestRootElement::Create();
+
+            scrollContainer = Lv2cScrollContainerElement::Create();
+            scrollContainer->Style()
+                .Width(200)
+                .Height(VIEWPORT_HEIGHT);
+            scrollContainer->BlitScrolling(false);
+
+            list = Lv2cVirtualListElement::Create();
+            list->Style().HorizontalAlignment(Lv2cAlignment::Stretch);
+            list->RowHeight(20).Overscan(2).RowHeightMode(rowHeightMode);
+            list->ItemTemplate(
+                [itemHeight]()
+                {
+                    auto element = TestItemElement::Create();
+                    element->Style().Height(itemHeight);
+                    return element;
+                },
+                [](Lv2cElement::ptr &element, size_t index)
+                {
+                    std::dynamic_pointer_cast<TestItemElement>(element)->index = index;
+                });
+            list->ItemCount(ITEM_COUNT);
+            scrollContainer->Child(list);
+            root->AddChild(scrollContainer);
+            root->Mount(window.get());
+            Layout();
+        }
+
+        void Layout()
+        {
+            root->LayoutTree(Lv2cSize(200, VIEWPORT_HEIGHT));
+        }
+
+        // Items realized for [first,last), checking that each element is bound to the item it is positioned at.
+        void GetRealizedRange(size_t *first, size_t *last)
+        {
+            *first = ITEM_COUNT;
+            *last = 0;
+            for (size_t i = 0; i < list->ChildCount(); ++i)
+            {
+                auto item = std::dynamic_pointer_cast<TestItemElement>(list->Child(i));
+                REQUIRE(item->index < ITEM_COUNT);
+                REQUIRE(item->Bounds().Top() == list->GetItemBounds(item->index).Top());
+                *first = std::min(*first, item->index);
+                *last = std::max(*last, item->index + 1);
+            }
+        }
+
+        Lv2cWindow::ptr window;
+        TestRootElement::ptr root;
+        Lv2cScrollContainerElement::ptr scrollContainer;
+        Lv2cVirtualListElement::ptr list;
+    };
+}
+
+TEST_CASE("Lv2cVirtualListElement realizes only visible items", "[virtual_list]")
+{
+    VirtualListFixture fixture{20};
+    auto &list = fixture.list;
+
+    // 100px viewport, 20px rows: 5 visible rows, 2 rows of overscan on each side, and a partially visible row.
+    constexpr size_t MAX_REALIZED = 5 + 2 * 2 + 1;
+
+    REQUIRE(list->ClientSize().Height() == ITEM_COUNT * 20);
+    REQUIRE(list->RealizedItemCount() > 0);
+    REQUIRE(list->RealizedItemCount() <= MAX_REALIZED);
+
+    size_t first, last;
+    fixture.GetRealizedRange(&first, &last);
+    REQUIRE(first == 0);
+
+    double maxOffset = ITEM_COUNT * 20 - VIEWPORT_HEIGHT;
+    for (double offset = 0; offset <= maxOffset; offset += 997)
+    {
+        fixture.scrollContainer->VerticalScrollOffset(offset);
+
+        REQUIRE(list->RealizedItemCount() <= MAX_REALIZED);
+        fixture.GetRealizedRange(&first, &last);
+        REQUIRE(first * 20 <= offset);
+        REQUIRE(last * 20 >= offset + VIEWPORT_HEIGHT);
+    }
+    fixture.scrollContainer->VerticalScrollOffset(maxOffset);
+    fixture.GetRealizedRange(&first, &last);
+    REQUIRE(last == ITEM_COUNT);
+
+    // elements are recycled, not created for every item that scrolls into view.
+    REQUIRE(list->CreatedItemCount() <= 2 * MAX_REALIZED);
+}
+
+TEST_CASE("Lv2cVirtualListElement estimated row height", "[virtual_list]")
+{
+    // items are taller than the 20px estimate.
+    VirtualListFixture fixture{30, Lv2cVirtualRowHeightMode::Estimated};
+    auto &list = fixture.list;
+
+    // the first layout pass uses the estimate, and measures the realized items.
+    REQUIRE(list->ClientSize().Height() == ITEM_COUNT * 20);
+
+    // the list requests another layout pass, which uses the measured row height.
+    fixture.Layout();
+
+    REQUIRE(list->GetItemBounds(1).Top() == 30);
+    REQUIRE(list->ClientSize().Height() == ITEM_COUNT * 30);
+    constexpr size_t MAX_REALIZED = 100 / 30 + 2 * 2 + 2;
+    REQUIRE(list->RealizedItemCount() <= MAX_REALIZED);
+
+    size_t first, last;
+    fixture.scrollContainer->VerticalScrollOffset(ITEM_COUNT * 30 / 2);
+    fixture.GetRealizedRange(&first, &last);
+    REQUIRE(first * 30 <= ITEM_COUNT * 30 / 2);
+    REQUIRE(last * 30 >= ITEM_COUNT * 30 / 2 + VIEWPORT_HEIGHT);
+    REQUIRE(list->CreatedItemCount() <= 2 * MAX_REALIZED);
+}